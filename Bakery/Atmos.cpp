@@ -2,29 +2,62 @@
 #include <vector>
 #include <string>
 #include <cassert>
-
-#include <DirectXTex.h>
-#pragma comment(lib, "DirectXTex.lib")
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
 
 #include "Common/Common.h"
 #include "Interface/IPrelight.h" // hfx::PrecomputeAtmos
 
 #include "Atmos.h"
+#include "AtmosCache.h"
+#include "AtmosLutPack.h"
+#include "DDSWriter.h"
+
+// LUT 저장 포맷 (변환 오차는 저장할 때 출력된다)
+//  Scattering은 A (단산란 Mie)가 있어야 해서 RGBA16F까지. Transmittance는 지평선 근처에서 B가 R보다 몇 자릿수 작아
+//  지수를 공유하는 RGB9E5로는 B가 뭉개지므로 RGBA16F. Irradiance는 채널 크기가 비슷해 RGB9E5 (상대오차 ~1e-2 미만)
+static constexpr EAtmosLutFormat ATMOS_TRANSMITTANCE_FORMAT = ATMOS_LUT_FORMAT_RGBA16F;
+static constexpr EAtmosLutFormat ATMOS_SCATTERING_FORMAT = ATMOS_LUT_FORMAT_RGBA16F;
+static constexpr EAtmosLutFormat ATMOS_IRRADIANCE_FORMAT = ATMOS_LUT_FORMAT_RGB9E5;
+
+// 저장할 때 변환한 행을 모아 두는 버퍼 크기. 최대 메모리 = 소스 LUT + 이것 (볼륨 사본을 만들지 않는다)
+static constexpr size_t ATMOS_LUT_STAGING_BYTES = 4ull << 20;
 
-static AtmosParams MakeEarthLikeParams();
-static bool Save2DRGBasDDS(const float* srcRGB, int W, int H, const std::wstring& path);
-static bool SaveScattering3D_RGBA_DDS(const float* srcRGBA, int R, int MU, int MU_S, int NU, const std::wstring& path);
+static bool Save2DRGBasDDS(const float* srcRGB, int W, int H, EAtmosLutFormat fmt, const std::wstring& path);
+static bool SaveScattering3D_RGBA_DDS(const float* srcRGBA, int R, int MU, int MU_S, int NU, EAtmosLutFormat fmt, const std::wstring& path);
+static bool SavePresetVolumeRGB_DDS(const std::vector<const float*>& srcRGB, int W, int H, EAtmosLutFormat fmt, const std::wstring& path);
+static bool SaveScatteringStack_DDS(const std::vector<const float*>& srcRGBA, int R, int MU, int MU_S, int NU, EAtmosLutFormat fmt, const std::wstring& path);
 
 // ---------------- Sample ----------------
 void RunAtmosPrecomputeAndSave()
 {
 	AtmosParams atmosParams = MakeEarthLikeParams();
 
+	// 같은 파라미터 + 같은 베이크 코드면 캐시 파일을 매핑해서 그대로 쓴다
+	const std::wstring cacheDir = L"../../Resources/Atmos/Cache";
+	const uint64_t cacheKey = HashAtmosParams(atmosParams);
+	const std::wstring cachePath = GetAtmosCachePath(cacheDir, cacheKey);
+
+	MappedAtmosCache cache;
 	AtmosResult atmosResult{};
-	if (!prl::PrecomputeAtmos(atmosParams, &atmosResult))
+	const bool bCacheHit = cache.Open(cachePath, cacheKey);
+	if (bCacheHit)
 	{
-		std::cerr << "[Sample] PrecomputeAtmos failed.\n";
-		return;
+		atmosResult = cache.GetResult();
+		std::cout << "[Sample] Atmos cache hit: " << std::hex << cacheKey << std::dec << std::endl;
+	}
+	else
+	{
+		if (!prl::PrecomputeAtmos(atmosParams, &atmosResult))
+		{
+			std::cerr << "[Sample] PrecomputeAtmos failed.\n";
+			return;
+		}
+		const bool bStored = StoreAtmosCache(cachePath, cacheKey, atmosResult);
+		std::cout << "[Sample] Atmos cache miss: " << std::hex << cacheKey << std::dec
+			<< (bStored ? " (stored)" : " (store FAILED)") << std::endl;
 	}
 
 	// 저장 경로
@@ -32,29 +65,154 @@ void RunAtmosPrecomputeAndSave()
 	const std::wstring sPath = L"../../Resources/Atmos/Scattering.dds";
 	const std::wstring ePath = L"../../Resources/Atmos/Irradiance.dds";
 
-	bool bOkT = Save2DRGBasDDS(atmosResult.TransmittanceRGB, atmosResult.TransmittanceW, atmosResult.TransmittanceH, tPath);
+	bool bOkT = Save2DRGBasDDS(atmosResult.TransmittanceRGB, atmosResult.TransmittanceW, atmosResult.TransmittanceH, ATMOS_TRANSMITTANCE_FORMAT, tPath);
 
 	bool bOkS = SaveScattering3D_RGBA_DDS(
 		atmosResult.ScatteringRGBA,
 		atmosResult.ScatteringR, atmosResult.ScatteringMu,
 		atmosResult.ScatteringMuS, atmosResult.ScatteringNu,
-		sPath);
+		ATMOS_SCATTERING_FORMAT, sPath);
 
-	bool bOkE = Save2DRGBasDDS(atmosResult.IrradianceRGB, atmosResult.IrradianceW, atmosResult.IrradianceH, ePath);
+	bool bOkE = Save2DRGBasDDS(atmosResult.IrradianceRGB, atmosResult.IrradianceW, atmosResult.IrradianceH, ATMOS_IRRADIANCE_FORMAT, ePath);
 
 	std::cout << "[Sample] Save DDS:"
 		<< " T=" << (bOkT ? "OK" : "FAIL")
 		<< " S=" << (bOkS ? "OK" : "FAIL")
 		<< " E=" << (bOkE ? "OK" : "FAIL") << std::endl;
 
-	// 결과 버퍼 해제 (현재 구현이 new[]라면)
-	delete[] atmosResult.TransmittanceRGB;
-	delete[] atmosResult.ScatteringRGBA;
-	delete[] atmosResult.IrradianceRGB;
+	// 결과 버퍼 해제 (캐시 적중이면 매핑 view라 cache 소멸 시 풀린다)
+	if (!bCacheHit)
+	{
+		delete[] atmosResult.TransmittanceRGB;
+		delete[] atmosResult.ScatteringRGBA;
+		delete[] atmosResult.IrradianceRGB;
+	}
+}
+
+// ---------------- Preset sweep ----------------
+// 날씨 프리셋을 한 번에 구워 프리셋 축이 붙은 LUT로 저장한다 (프리셋마다 캐시는 따로)
+//  TransmittanceArray / IrradianceArray : 3D, W x H x 프리셋 (z = 프리셋). z = (blend + 0.5) / 프리셋 수로 샘플링하면
+//                                         이웃 프리셋 사이 보간이 trilinear 한 번으로 끝난다
+//  ScatteringArray : 3D, NU*MU_S x MU x (R * 프리셋), 프리셋 p의 r slice는 [p * R, (p + 1) * R).
+//                    r texel 좌표를 [0, R-1]로 clamp한 뒤 p * R을 더하면 이웃 프리셋과 섞이지 않는다 (3D 텍스처 배열이 없어 z에 쌓는다)
+// 모든 프리셋의 LUT 크기/매핑이 같아야 한다
+void RunAtmosPresetSweepAndSave()
+{
+	struct AtmosPreset
+	{
+		const char* Name;
+		float MieScale;	// 기본 Mie 산란/소광 배율 (에어로졸 농도)
+		float MieG;
+	};
+	const AtmosPreset presetDescs[] =
+	{
+		{ "Clear",    0.5f, 0.76f },
+		{ "Default",  1.0f, 0.80f },
+		{ "Hazy",     3.0f, 0.82f },
+		{ "Overcast", 8.0f, 0.85f },
+	};
+	const int numPresets = int(sizeof(presetDescs) / sizeof(presetDescs[0]));
+
+	std::vector<AtmosParams> params(numPresets);
+	for (int p = 0; p < numPresets; ++p)
+	{
+		AtmosParams& ap = params[p];
+		ap = MakeEarthLikeParams();
+		ap.MieScattering = FLOAT3{ ap.MieScattering.x * presetDescs[p].MieScale, ap.MieScattering.y * presetDescs[p].MieScale, ap.MieScattering.z * presetDescs[p].MieScale };
+		ap.MieExtinction = FLOAT3{ ap.MieExtinction.x * presetDescs[p].MieScale, ap.MieExtinction.y * presetDescs[p].MieScale, ap.MieExtinction.z * presetDescs[p].MieScale };
+		ap.MieG = presetDescs[p].MieG;
+	}
+
+	// 캐시 적중은 매핑, 나머지만 한 번에 굽는다
+	const std::wstring cacheDir = L"../../Resources/Atmos/Cache";
+	std::vector<std::unique_ptr<MappedAtmosCache>> caches(numPresets);
+	std::vector<AtmosResult> results(numPresets);
+	std::vector<int> missIndices;
+	std::vector<AtmosParams> missParams;
+	for (int p = 0; p < numPresets; ++p)
+	{
+		const uint64_t key = HashAtmosParams(params[p]);
+		caches[p] = std::make_unique<MappedAtmosCache>();
+		if (caches[p]->Open(GetAtmosCachePath(cacheDir, key), key))
+		{
+			results[p] = caches[p]->GetResult();
+		}
+		else
+		{
+			missIndices.push_back(p);
+			missParams.push_back(params[p]);
+		}
+	}
+
+	std::vector<AtmosResult> baked(missParams.size());
+	if (!missParams.empty())
+	{
+		if (!prl::PrecomputeAtmosBatch(missParams.data(), int(missParams.size()), baked.data()))
+		{
+			std::cerr << "[Sweep] PrecomputeAtmosBatch failed.\n";
+			return;
+		}
+		for (size_t m = 0; m < missIndices.size(); ++m)
+		{
+			const int p = missIndices[m];
+			const uint64_t key = HashAtmosParams(params[p]);
+			results[p] = baked[m];
+			StoreAtmosCache(GetAtmosCachePath(cacheDir, key), key, baked[m]);
+		}
+	}
+	std::cout << "[Sweep] " << numPresets << " preset(s), baked " << missParams.size()
+		<< ", cache hit " << (numPresets - int(missParams.size())) << std::endl;
+
+	bool bSameLayout = true;
+	const AtmosResult& r0 = results[0];
+	for (const AtmosResult& r : results)
+	{
+		bSameLayout = bSameLayout
+			&& r.TransmittanceW == r0.TransmittanceW && r.TransmittanceH == r0.TransmittanceH
+			&& r.ScatteringR == r0.ScatteringR && r.ScatteringMu == r0.ScatteringMu && r.ScatteringMuS == r0.ScatteringMuS && r.ScatteringNu == r0.ScatteringNu
+			&& r.IrradianceW == r0.IrradianceW && r.IrradianceH == r0.IrradianceH
+			&& r.LutMapping == r0.LutMapping && r.ScatteringLayout == r0.ScatteringLayout;
+	}
+
+	if (bSameLayout)
+	{
+		std::vector<const float*> trans, scat, irr;
+		for (const AtmosResult& r : results)
+		{
+			trans.push_back(r.TransmittanceRGB);
+			scat.push_back(r.ScatteringRGBA);
+			irr.push_back(r.IrradianceRGB);
+		}
+
+		const bool bOkT = SavePresetVolumeRGB_DDS(trans, r0.TransmittanceW, r0.TransmittanceH, ATMOS_TRANSMITTANCE_FORMAT, L"../../Resources/Atmos/TransmittanceArray.dds");
+		const bool bOkS = SaveScatteringStack_DDS(scat, r0.ScatteringR, r0.ScatteringMu, r0.ScatteringMuS, r0.ScatteringNu, ATMOS_SCATTERING_FORMAT, L"../../Resources/Atmos/ScatteringArray.dds");
+		const bool bOkE = SavePresetVolumeRGB_DDS(irr, r0.IrradianceW, r0.IrradianceH, ATMOS_IRRADIANCE_FORMAT, L"../../Resources/Atmos/IrradianceArray.dds");
+
+		std::cout << "[Sweep] Save DDS:"
+			<< " T=" << (bOkT ? "OK" : "FAIL")
+			<< " S=" << (bOkS ? "OK" : "FAIL")
+			<< " E=" << (bOkE ? "OK" : "FAIL") << std::endl;
+		for (int p = 0; p < numPresets; ++p)
+		{
+			std::cout << "[Sweep]   slice " << p << ": " << presetDescs[p].Name << std::endl;
+		}
+	}
+	else
+	{
+		std::cerr << "[Sweep] Presets differ in LUT size/mapping; array DDS skipped.\n";
+	}
+
+	// 새로 구운 결과만 해제 (캐시 적중은 매핑 view)
+	for (AtmosResult& r : baked)
+	{
+		delete[] r.TransmittanceRGB;
+		delete[] r.ScatteringRGBA;
+		delete[] r.IrradianceRGB;
+	}
 }
 
 // ---------------- Sample Parameter Builder ----------------
-static AtmosParams MakeEarthLikeParams()
+AtmosParams MakeEarthLikeParams()
 {
 	AtmosParams p{};
 	p.PlanetRadius = 6'360'000.0f;	// Earth radius ~6,360km
@@ -83,85 +241,89 @@ static AtmosParams MakeEarthLikeParams()
 
 	// LUT sizes (Bruneton style)
 	p.TransmittanceW = 256; p.TransmittanceH = 64;
-	p.ScatteringR = 32;  p.ScatteringMu = 128; p.ScatteringMuS = 32; p.ScatteringNu = 8;
+	p.ScatteringR = 16;  p.ScatteringMu = 64; p.ScatteringMuS = 32; p.ScatteringNu = 8;
 	p.IrradianceW = 64;  p.IrradianceH = 16;
+	p.LutMapping = ATMOS_LUT_MAPPING_BRUNETON;	// 비선형 매핑: 32x128 균등과 비슷한 품질을 1/4 texel로 (SkyObject와 맞출 것)
 
-	p.MultipleScatteringOrders = 1; // 현재 CPU 레퍼런스는 단산란만
+	p.MultipleScatteringOrders = 4; // 단산란 + 2~4차 (Bruneton). 1이면 단산란만
+	p.bUseTransmittanceLUT = true;
+	p.Quality = ATMOS_QUALITY_BALANCED;	// 오프라인 굽기 + 캐시라 적응형 적분으로 (FIXED 대비 단산란 평균 오차 ~1/100, 시간 ~4배)
+	p.NumThreads = 0;	// 0 = 하드웨어 스레드 전부
 	return p;
 }
 
 // ---------------- DDS Save util ----------------
-// 2D RGB(float*) -> RGBA32F DDS
-static bool Save2DRGBasDDS(const float* srcRGB, int W, int H, const std::wstring& path)
+// 변환 + 스트리밍 저장 + float 대비 오차 출력. W x H x D 볼륨 (D = 0이면 2D), rowSrc(z, y) = 출력 행 (z, y)의 texel W개 (연속)
+static bool SaveLutDDS(EAtmosLutFormat fmt, int W, int H, int D, int srcChannels,
+	const std::function<const float*(int z, int y)>& rowSrc, const std::wstring& path)
 {
-	DirectX::ScratchImage img;
-	HRESULT hr = img.Initialize2D(DXGI_FORMAT_R32G32B32A32_FLOAT, W, H, /*arraySize*/1, /*mips*/1);
-	if (FAILED(hr))
+	DDSTextureDesc desc = {};
+	desc.Format = GetAtmosLutDDSFormat(fmt);
+	desc.BytesPerTexel = GetAtmosLutTexelBytes(fmt);
+	desc.Width = uint32_t(W);
+	desc.Height = uint32_t(H);
+	desc.Depth = uint32_t(D);
+	desc.ArraySize = 1;
+
+	DDSStreamWriter writer;
+	if (!writer.Open(path, desc))
 	{
 		return false;
 	}
 
-	const DirectX::Image* im = img.GetImage(0, 0, 0);
-	for (int y = 0; y < H; ++y)
+	AtmosLutPackError err;
+	const bool bPacked = PackAtmosLutRows(fmt, W, H * std::max(D, 1), srcChannels,
+		[&](int row) { return rowSrc(row / H, row % H); },
+		/*numThreads*/0, ATMOS_LUT_STAGING_BYTES,
+		[&](const void* data, size_t bytes) { return writer.Write(data, bytes); },
+		&err);
+	if (!writer.Close() || !bPacked)
 	{
-		float* row = reinterpret_cast<float*>(im->pixels + size_t(y) * im->rowPitch);
-		for (int x = 0; x < W; ++x)
-		{
-			size_t s = (size_t(y) * W + x) * 3;
-			row[x * 4 + 0] = srcRGB[s + 0];
-			row[x * 4 + 1] = srcRGB[s + 1];
-			row[x * 4 + 2] = srcRGB[s + 2];
-			row[x * 4 + 3] = 1.0f;
-		}
+		return false;
 	}
 
-	return SUCCEEDED(SaveToDDSFile(*im, DirectX::DDS_FLAGS_NONE, path.c_str()));
+	std::cout << "[Atmos] " << std::filesystem::path(path).filename().string() << " " << GetAtmosLutFormatName(fmt)
+		<< " (" << GetAtmosLutPackPathName() << "): max abs " << err.MaxAbs << ", max rel " << err.MaxRel << ", rms rel " << err.RmsRel << std::endl;
+	return true;
+}
+
+// 2D RGB(float*) -> DDS (fmt가 RGBA면 A = 1)
+static bool Save2DRGBasDDS(const float* srcRGB, int W, int H, EAtmosLutFormat fmt, const std::wstring& path)
+{
+	return SaveLutDDS(fmt, W, H, /*2D*/0, 3,
+		[=](int, int y) { return srcRGB + size_t(y) * W * 3; }, path);
 }
 
 // 3D RGBA(float*) -> DDS (Scattering(4D): packed to 3D -> NU*MU_S × MU × R)
 // Indexing of srcRGBA: ((((r * MU + mu) * MU_S + mu_s) * NU + nu) * 4 + c)
+// x = mu_s * NU + nu 라서 (r, mu) 한 줄은 소스에서도 연속이다. fmt는 A가 있는 포맷이어야 한다
 static bool SaveScattering3D_RGBA_DDS(
 	const float* srcRGBA,
 	int R, int MU, int MU_S, int NU,
+	EAtmosLutFormat fmt,
 	const std::wstring& path)
 {
 	// Resoulution of 3d texture : X = NU*MU_S, Y = MU, Z = R
 	const int W = NU * MU_S;
-	const int H = MU;
-	const int D = R;
-
-	DirectX::ScratchImage img;
-	HRESULT hr = img.Initialize3D(DXGI_FORMAT_R32G32B32A32_FLOAT, W, H, D, /*mips*/1);
-	if (FAILED(hr))
-	{
-		return false;
-	}
+	return SaveLutDDS(fmt, W, MU, R, 4,
+		[=](int r, int mu) { return srcRGBA + ((size_t)r * MU + mu) * W * 4; }, path);
+}
 
-	for (int z = 0; z < D; ++z)
-	{
-		const DirectX::Image* slice = img.GetImage(0, 0, z);
-		for (int y = 0; y < H; ++y)
-		{
-			float* row = reinterpret_cast<float*>(slice->pixels + size_t(y) * slice->rowPitch);
-			for (int x = 0; x < W; ++x)
-			{
-				// x -> (mu_s, nu) 로 역매핑
-				int mu = y;
-				int r = z;
-				int mus = x / NU;
-				int nu = x % NU;
-
-				size_t idx4 = ((((size_t)r * MU + mu) * MU_S + mus) * NU + nu);
-				size_t s = idx4 * 4;
-
-				row[x * 4 + 0] = srcRGBA[s + 0];
-				row[x * 4 + 1] = srcRGBA[s + 1];
-				row[x * 4 + 2] = srcRGBA[s + 2];
-				row[x * 4 + 3] = srcRGBA[s + 3];
-			}
-		}
-	}
+// 2D RGB LUT 여러 개 -> 3D DDS (W x H x 프리셋 수)
+static bool SavePresetVolumeRGB_DDS(const std::vector<const float*>& srcRGB, int W, int H, EAtmosLutFormat fmt, const std::wstring& path)
+{
+	return SaveLutDDS(fmt, W, H, int(srcRGB.size()), 3,
+		[&](int z, int y) { return srcRGB[z] + size_t(y) * W * 3; }, path);
+}
 
-	// Save entire volume
-	return SUCCEEDED(SaveToDDSFile(img.GetImages(), img.GetImageCount(), img.GetMetadata(), DirectX::DDS_FLAGS_NONE, path.c_str()));
+// Scattering LUT 여러 개 -> 3D DDS (NU*MU_S x MU x R*프리셋 수). 프리셋 안의 배치는 SaveScattering3D_RGBA_DDS와 같다
+static bool SaveScatteringStack_DDS(
+	const std::vector<const float*>& srcRGBA,
+	int R, int MU, int MU_S, int NU,
+	EAtmosLutFormat fmt,
+	const std::wstring& path)
+{
+	const int W = NU * MU_S;
+	return SaveLutDDS(fmt, W, MU, R * int(srcRGBA.size()), 4,
+		[&](int z, int mu) { return srcRGBA[z / R] + ((size_t)(z % R) * MU + mu) * W * 4; }, path);
 }
\ No newline at end of file
@@ -1,4 +1,13 @@
 ﻿#pragma once
 #include <string>
+#include "Interface/AtmosStruct.h"
 
-void RunAtmosPrecomputeAndSave();
\ No newline at end of file
+// 샘플 / 스윕 / 회귀 측정이 함께 쓰는 Earth 프리셋
+AtmosParams MakeEarthLikeParams();
+
+void RunAtmosPrecomputeAndSave();
+void RunAtmosPresetSweepAndSave();
+
+// Earth 프리셋 bake의 기준 비교 + 단계별 성능 기록 (AtmosRegression.cpp). 기준이 없거나 어긋나면 false
+// bRecordGolden이면 비교 대신 goldenDir의 기준 파일을 이번 결과로 다시 쓴다
+bool RunAtmosRegression(const std::wstring& goldenDir, bool bRecordGolden);
\ No newline at end of file
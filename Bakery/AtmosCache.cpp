@@ -0,0 +1,179 @@
+﻿#include <iostream>
+#include <filesystem>
+#include <cstring>
+
+#include "Common/Common.h"
+#include "Common/AtomicFile.h"
+#include "AtmosCache.h"
+
+// ---------------- Key ----------------
+namespace
+{
+	struct Fnv1a64
+	{
+		uint64_t H = 0xcbf29ce484222325ull;
+
+		void Bytes(const void* data, size_t size)
+		{
+			const uint8_t* p = (const uint8_t*)data;
+			for (size_t i = 0; i < size; ++i)
+			{
+				H ^= p[i];
+				H *= 0x100000001b3ull;
+			}
+		}
+		void U32(uint32_t v) { Bytes(&v, sizeof(v)); }
+		void I32(int32_t v) { Bytes(&v, sizeof(v)); }
+		// -0.0f 와 0.0f 를 같은 키로 보도록 0은 비트를 정규화
+		void F32(float v) { uint32_t bits; v = (v == 0.0f) ? 0.0f : v; memcpy(&bits, &v, sizeof(bits)); U32(bits); }
+		void F3(const FLOAT3& v) { F32(v.x); F32(v.y); F32(v.z); }
+		void Profile(const DensityProfile& d)
+		{
+			for (const DensityLayer& l : d.Layers)
+			{
+				F32(l.Width); F32(l.ExpTerm); F32(l.LinearTerm); F32(l.ConstantTerm); F32(l.Scale);
+			}
+		}
+	};
+
+	constexpr uint64_t AlignUp16(uint64_t x) { return (x + 15) & ~15ull; }
+}
+
+// 구조체 바이트를 통째로 해시하면 패딩/bool 표현에 따라 키가 흔들리므로 필드별로 넣는다.
+// AtmosParams에 결과를 바꾸는 필드가 생기면 여기에도 추가할 것
+static void HashParamFields(Fnv1a64& h, const AtmosParams& p)
+{
+	h.F32(p.PlanetRadius); h.F32(p.AtmosphereHeight);
+	h.F3(p.RayleighScattering); h.Profile(p.Rayleigh);
+	h.F3(p.MieScattering); h.F3(p.MieExtinction); h.Profile(p.Mie); h.F32(p.MieG);
+	h.F3(p.OzoneAbsorption); h.Profile(p.Ozone);
+	h.F3(p.GroundAlbedo); h.F3(p.SolarIrradiance); h.F32(p.SunAngularRadius);
+
+	h.I32(p.TransmittanceW); h.I32(p.TransmittanceH);
+	h.I32(p.ScatteringR); h.I32(p.ScatteringMu); h.I32(p.ScatteringMuS); h.I32(p.ScatteringNu);
+	h.I32(p.IrradianceW); h.I32(p.IrradianceH);
+	h.I32((int32_t)p.LutMapping);
+	h.I32(p.MultipleScatteringOrders);
+	h.U32(p.bCompactScattering ? 1u : 0u);
+	h.U32(p.bUseTransmittanceLUT ? 1u : 0u);
+	h.U32(p.bForceNumericTransmittance ? 1u : 0u);
+	h.I32((int32_t)p.Quality);
+	h.I32(p.SpectralWavelengths);
+	// NumThreads는 결과에 영향이 없다
+}
+
+uint64_t HashAtmosParams(const AtmosParams& p)
+{
+	Fnv1a64 h;
+	h.U32(AtmosCacheFileHeader::VERSION);
+	h.U32(ATMOS_BAKE_CODE_VERSION);
+	HashParamFields(h, p);
+	return h.H;
+}
+
+uint64_t HashAtmosParamFields(const AtmosParams& p)
+{
+	Fnv1a64 h;
+	HashParamFields(h, p);
+	return h.H;
+}
+
+uint64_t HashAtmosLutBits(const float* data, size_t count)
+{
+	Fnv1a64 h;
+	h.Bytes(data, count * sizeof(float));
+	return h.H;
+}
+
+std::wstring GetAtmosCachePath(const std::wstring& dir, uint64_t key)
+{
+	wchar_t name[32];
+	swprintf_s(name, L"%016llx.hatm", (unsigned long long)key);
+	return (std::filesystem::path(dir) / name).wstring();
+}
+
+// ---------------- Store ----------------
+bool StoreAtmosCache(const std::wstring& path, uint64_t key, const AtmosResult& result)
+{
+	const size_t Tcount = size_t(result.TransmittanceW) * result.TransmittanceH * 3;
+	const size_t Scount = size_t(result.ScatteringR) * result.ScatteringMu * result.ScatteringMuS * result.ScatteringNu * 4;
+	const size_t Ecount = size_t(result.IrradianceW) * result.IrradianceH * 3;
+
+	AtmosCacheFileHeader header = {};
+	header.Key = key;
+	header.TransmittanceW = result.TransmittanceW; header.TransmittanceH = result.TransmittanceH;
+	header.ScatteringR = result.ScatteringR; header.ScatteringMu = result.ScatteringMu;
+	header.ScatteringMuS = result.ScatteringMuS; header.ScatteringNu = result.ScatteringNu;
+	header.IrradianceW = result.IrradianceW; header.IrradianceH = result.IrradianceH;
+	header.LutMapping = (int32_t)result.LutMapping;
+	header.ScatteringLayout = (int32_t)result.ScatteringLayout;
+	header.TransmittanceOffset = AlignUp16(sizeof(AtmosCacheFileHeader));
+	header.ScatteringOffset = AlignUp16(header.TransmittanceOffset + Tcount * sizeof(float));
+	header.IrradianceOffset = AlignUp16(header.ScatteringOffset + Scount * sizeof(float));
+	header.FileSize = header.IrradianceOffset + Ecount * sizeof(float);
+
+	// 프로세스별 임시 파일에 다 쓴 다음 교체
+	AtomicFileWriter file;
+	if (!file.Open(path))
+	{
+		return false;
+	}
+	file.Write(&header, sizeof(header));
+	file.WriteAt(header.TransmittanceOffset, result.TransmittanceRGB, Tcount * sizeof(float));
+	file.WriteAt(header.ScatteringOffset, result.ScatteringRGBA, Scount * sizeof(float));
+	file.WriteAt(header.IrradianceOffset, result.IrradianceRGB, Ecount * sizeof(float));
+	return file.Commit();
+}
+
+// ---------------- Load (mapped) ----------------
+bool MappedAtmosCache::Open(const std::wstring& path, uint64_t key)
+{
+	Close();
+
+	if (!m_File.Open(path))
+	{
+		return false;
+	}
+	const uint64_t fileSize = m_File.GetSize();
+	if (fileSize < sizeof(AtmosCacheFileHeader))
+	{
+		Close();
+		return false;
+	}
+
+	AtmosCacheFileHeader h;
+	memcpy(&h, m_File.GetData(), sizeof(h));
+	const size_t Tcount = size_t(h.TransmittanceW) * h.TransmittanceH * 3;
+	const size_t Scount = size_t(h.ScatteringR) * h.ScatteringMu * h.ScatteringMuS * h.ScatteringNu * 4;
+	const size_t Ecount = size_t(h.IrradianceW) * h.IrradianceH * 3;
+	const bool bValid = h.Magic == AtmosCacheFileHeader::MAGIC && h.Version == AtmosCacheFileHeader::VERSION && h.Key == key
+		&& h.FileSize == fileSize
+		&& h.TransmittanceOffset + Tcount * sizeof(float) <= h.ScatteringOffset
+		&& h.ScatteringOffset + Scount * sizeof(float) <= h.IrradianceOffset
+		&& h.IrradianceOffset + Ecount * sizeof(float) <= h.FileSize
+		&& (h.TransmittanceOffset | h.ScatteringOffset | h.IrradianceOffset) % 16 == 0;
+	if (!bValid)
+	{
+		std::cerr << "[Bakery] Atmos cache: ignoring stale or damaged file." << std::endl;
+		Close();
+		return false;
+	}
+
+	const uint8_t* base = m_File.GetData();
+	m_Result.TransmittanceW = h.TransmittanceW; m_Result.TransmittanceH = h.TransmittanceH;
+	m_Result.TransmittanceRGB = (float*)(base + h.TransmittanceOffset);
+	m_Result.ScatteringR = h.ScatteringR; m_Result.ScatteringMu = h.ScatteringMu;
+	m_Result.ScatteringMuS = h.ScatteringMuS; m_Result.ScatteringNu = h.ScatteringNu;
+	m_Result.ScatteringRGBA = (float*)(base + h.ScatteringOffset);
+	m_Result.ScatteringLayout = (EAtmosScatteringLayout)h.ScatteringLayout;
+	m_Result.LutMapping = (EAtmosLutMapping)h.LutMapping;
+	m_Result.IrradianceW = h.IrradianceW; m_Result.IrradianceH = h.IrradianceH;
+	m_Result.IrradianceRGB = (float*)(base + h.IrradianceOffset);
+	return true;
+}
+
+void MappedAtmosCache::Close()
+{
+	m_File.Close();
+	m_Result = {};
+}
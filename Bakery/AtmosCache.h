@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <string>
+#include "Common/MappedFile.h"
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// 대기 LUT 디스크 캐시 (HATM)
+// - 키 = AtmosParams 필드 + ATMOS_BAKE_CODE_VERSION 의 FNV-1a 64 해시 (NumThreads는 결과와 무관해 제외)
+// - 파일 하나에 세 LUT를 float 그대로 담는다: <dir>/<key 16진수>.hatm
+// - 적중 시 파일을 매핑해 AtmosResult 포인터가 view를 가리킨다 (복사 없음, 읽기 전용)
+// - 저장은 임시 파일에 쓴 뒤 rename → 같은 키를 동시에 굽는 프로세스끼리 깨진 파일을 보지 않는다
+// ===============================================================
+
+// [AtmosCacheFileHeader][Transmittance RGB][Scattering RGBA][Irradiance RGB] (각 블록 16바이트 정렬)
+struct AtmosCacheFileHeader
+{
+	static constexpr uint32_t MAGIC = 0x4D544148; // 'HATM'
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t Magic = MAGIC;
+	uint32_t Version = VERSION;
+	uint64_t Key = 0;
+
+	int32_t TransmittanceW = 0, TransmittanceH = 0;
+	int32_t ScatteringR = 0, ScatteringMu = 0, ScatteringMuS = 0, ScatteringNu = 0;
+	int32_t IrradianceW = 0, IrradianceH = 0;
+	int32_t LutMapping = 0;
+	int32_t ScatteringLayout = 0;
+
+	uint64_t TransmittanceOffset = 0;	// 파일 선두 기준 바이트 오프셋
+	uint64_t ScatteringOffset = 0;
+	uint64_t IrradianceOffset = 0;
+	uint64_t FileSize = 0;
+};
+
+uint64_t HashAtmosParams(const AtmosParams& p);
+
+// 회귀 기준 파일용 해시. 캐시/코드 버전을 넣지 않아 bake 코드가 바뀌어도 같은 변형이면 같은 값이다
+uint64_t HashAtmosParamFields(const AtmosParams& p);
+uint64_t HashAtmosLutBits(const float* data, size_t count);
+
+// <dir>/<key>.hatm
+std::wstring GetAtmosCachePath(const std::wstring& dir, uint64_t key);
+
+// 구운 결과를 캐시 파일로 저장 (디렉터리가 없으면 만든다)
+bool StoreAtmosCache(const std::wstring& path, uint64_t key, const AtmosResult& result);
+
+// 캐시 파일을 읽기 전용으로 매핑. GetResult()의 포인터는 Close/소멸 전까지 유효하다 (delete 금지)
+class MappedAtmosCache
+{
+public:
+	MappedAtmosCache() = default;
+	MappedAtmosCache(const MappedAtmosCache&) = delete;
+	MappedAtmosCache& operator=(const MappedAtmosCache&) = delete;
+	~MappedAtmosCache() { Close(); }
+
+	// 파일이 없거나 키/버전/크기가 맞지 않으면 false (miss)
+	bool Open(const std::wstring& path, uint64_t key);
+	void Close();
+
+	const AtmosResult& GetResult() const { return m_Result; }
+
+private:
+	MappedFile m_File;
+	AtmosResult m_Result = {};
+};
@@ -0,0 +1,574 @@
+﻿#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include "Common/ParallelFor.h"
+
+#include "AtmosLutPack.h"
+
+// MSVC는 /arch 없이도 intrinsic을 쓸 수 있다. GCC/Clang은 함수 단위 target 지정이 필요.
+#if defined(_MSC_VER) && !defined(__clang__)
+#  define LUTPACK_TARGET_AVX2
+#else
+#  define LUTPACK_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#endif
+
+static uint32_t AsUint(float f)
+{
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+static float AsFloat(uint32_t u)
+{
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+// RGB9E5: 9비트 가수 최대값 (511 / 512) * 2^16
+static constexpr float RGB9E5_MAX = 65408.0f;
+
+// ---------------- scalar ----------------
+// float → half, round-to-nearest-even (F16C의 _MM_FROUND_TO_NEAREST_INT와 같은 결과). Inf 유지, NaN은 quiet NaN 하나로
+static uint16_t FloatToHalf(float v)
+{
+	const uint32_t infBits = 255u << 23;
+	const uint32_t halfOverflow = (127u + 16u) << 23;			// 2^16 이상은 Inf
+	const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	uint32_t f = AsUint(v);
+	const uint32_t sign = f & 0x80000000u;
+	f ^= sign;
+
+	uint16_t h;
+	if (f >= halfOverflow)
+	{
+		h = (f > infBits) ? 0x7E00 : 0x7C00;
+	}
+	else if (f < (113u << 23))
+	{
+		// half 비정규수: magic 값을 더하면 FPU가 가수 자리에서 반올림해 준다
+		h = uint16_t(AsUint(AsFloat(f) + AsFloat(denormMagic)) - denormMagic);
+	}
+	else
+	{
+		const uint32_t mantOdd = (f >> 13) & 1u;
+		f += ((15u - 127u) << 23) + 0xFFFu;
+		f += mantOdd;
+		h = uint16_t(f >> 13);
+	}
+	return uint16_t(h | (sign >> 16));
+}
+
+static float HalfToFloat(uint16_t h)
+{
+	const uint32_t sign = uint32_t(h & 0x8000u) << 16;
+	const uint32_t exp = (h >> 10) & 0x1Fu;
+	const uint32_t mant = h & 0x3FFu;
+	if (exp == 0)
+	{
+		return AsFloat(sign | AsUint(float(mant) * (1.0f / 16777216.0f)));	// mant * 2^-24
+	}
+	if (exp == 31)
+	{
+		return AsFloat(sign | 0x7F800000u | (mant << 13));
+	}
+	return AsFloat(sign | ((exp + 112u) << 23) | (mant << 13));
+}
+
+// 부호 없는 float (5비트 지수, bias 15, MANT비트 가수). 음수 / NaN → 0, 최대 유한값을 넘으면 (Inf 포함) 최대값
+template<int MANT>
+static uint32_t FloatToSmallFloat(float v)
+{
+	constexpr int SHIFT = 23 - MANT;
+	const float maxV = AsFloat(((15u + 127u) << 23) | (((1u << MANT) - 1u) << SHIFT));
+	if (!(v > 0.0f))
+	{
+		return 0;
+	}
+	v = std::min(v, maxV);
+
+	uint32_t i = AsUint(v);
+	if (i < (113u << 23))
+	{
+		// 2^-14 미만은 비정규수 (단위 2^-(14 + MANT)). 반올림이 2^MANT가 되면 그대로 최소 정규수 비트가 된다
+		return uint32_t(std::lrint(v * AsFloat((127u + 14u + MANT) << 23)));
+	}
+	i -= 112u << 23;
+	return (i + (1u << (SHIFT - 1)) - 1u + ((i >> SHIFT) & 1u)) >> SHIFT;
+}
+
+template<int MANT>
+static float SmallFloatToFloat(uint32_t bits)
+{
+	const uint32_t exp = bits >> MANT;
+	const uint32_t mant = bits & ((1u << MANT) - 1u);
+	if (exp == 0)
+	{
+		return float(mant) * AsFloat((127u - 14u - MANT) << 23);
+	}
+	return AsFloat(((exp + 112u) << 23) | (mant << (23 - MANT)));
+}
+
+static float ClampRGB9E5(float v)
+{
+	return (v > 0.0f) ? std::min(v, RGB9E5_MAX) : 0.0f;
+}
+
+// 공유 지수 = 최대 채널을 9비트 가수에 담는 최소 지수 (D3D RGB9E5 규칙, 반올림만 nearest-even)
+static uint32_t FloatToRGB9E5(float r, float g, float b)
+{
+	r = ClampRGB9E5(r);
+	g = ClampRGB9E5(g);
+	b = ClampRGB9E5(b);
+	const float maxC = std::max(r, std::max(g, b));
+
+	int expShared = std::max(int(AsUint(maxC) >> 23) - 127, -16) + 16;	// [0, 31]
+	float scale = AsFloat(uint32_t(127 + 24 - expShared) << 23);			// 1 / 2^(expShared - 24)
+	if (std::lrint(maxC * scale) == 512)
+	{
+		++expShared;
+		scale *= 0.5f;
+	}
+	const uint32_t rm = uint32_t(std::lrint(r * scale));
+	const uint32_t gm = uint32_t(std::lrint(g * scale));
+	const uint32_t bm = uint32_t(std::lrint(b * scale));
+	return rm | (gm << 9) | (bm << 18) | (uint32_t(expShared) << 27);
+}
+
+static void RGB9E5ToFloat(uint32_t v, float* outRGB)
+{
+	const float scale = AsFloat(uint32_t(127 - 24 + int(v >> 27)) << 23);	// 2^(exp - 24)
+	outRGB[0] = float(v & 0x1FFu) * scale;
+	outRGB[1] = float((v >> 9) & 0x1FFu) * scale;
+	outRGB[2] = float((v >> 18) & 0x1FFu) * scale;
+}
+
+static uint32_t FloatToR11G11B10(const float* rgb)
+{
+	return FloatToSmallFloat<6>(rgb[0]) | (FloatToSmallFloat<6>(rgb[1]) << 11) | (FloatToSmallFloat<5>(rgb[2]) << 22);
+}
+
+static void PackHalfScalar(const float* src, int srcChannels, int count, uint16_t* dst)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const float* s = src + size_t(i) * srcChannels;
+		dst[i * 4 + 0] = FloatToHalf(s[0]);
+		dst[i * 4 + 1] = FloatToHalf(s[1]);
+		dst[i * 4 + 2] = FloatToHalf(s[2]);
+		dst[i * 4 + 3] = FloatToHalf(srcChannels == 4 ? s[3] : 1.0f);
+	}
+}
+
+static void PackR11G11B10Scalar(const float* src, int srcChannels, int count, uint32_t* dst)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		dst[i] = FloatToR11G11B10(src + size_t(i) * srcChannels);
+	}
+}
+
+static void PackRGB9E5Scalar(const float* src, int srcChannels, int count, uint32_t* dst)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const float* s = src + size_t(i) * srcChannels;
+		dst[i] = FloatToRGB9E5(s[0], s[1], s[2]);
+	}
+}
+
+// ---------------- AVX2 (+F16C) ----------------
+// 나머지 texel은 scalar 함수로 처리한다 (결과가 같으므로 섞여도 된다)
+LUTPACK_TARGET_AVX2 static void PackHalfAVX2(const float* src, int srcChannels, int count, uint16_t* dst)
+{
+	int i = 0;
+	if (srcChannels == 4)
+	{
+		for (; i + 2 <= count; i += 2)
+		{
+			const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + size_t(i) * 4), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + size_t(i) * 4), h);
+		}
+	}
+	else
+	{
+		// texel 하나를 4 float로 읽으면 다음 texel의 R까지 읽으므로 뒤에 texel이 하나 더 있을 때만
+		const __m128 one = _mm_set1_ps(1.0f);
+		for (; i + 3 <= count; i += 2)
+		{
+			const __m128 t0 = _mm_blend_ps(_mm_loadu_ps(src + size_t(i) * 3), one, 0x8);
+			const __m128 t1 = _mm_blend_ps(_mm_loadu_ps(src + size_t(i) * 3 + 3), one, 0x8);
+			const __m128i h = _mm256_cvtps_ph(_mm256_set_m128(t1, t0), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + size_t(i) * 4), h);
+		}
+	}
+	PackHalfScalar(src + size_t(i) * srcChannels, srcChannels, count - i, dst + size_t(i) * 4);
+}
+
+// 8 texel의 채널 c (AoS stride = srcChannels)
+LUTPACK_TARGET_AVX2 static __m256 GatherChannel8(const float* src, const __m256i& stride, int c)
+{
+	return _mm256_i32gather_ps(src + c, stride, 4);
+}
+
+template<int MANT>
+LUTPACK_TARGET_AVX2 static __m256i SmallFloat8(__m256 v)
+{
+	constexpr int SHIFT = 23 - MANT;
+	const __m256 maxV = _mm256_castsi256_ps(_mm256_set1_epi32(int(((15u + 127u) << 23) | (((1u << MANT) - 1u) << SHIFT))));
+	v = _mm256_max_ps(v, _mm256_setzero_ps());	// NaN이면 두 번째 피연산자 (0)
+	v = _mm256_min_ps(v, maxV);
+
+	const __m256i i = _mm256_castps_si256(v);
+	const __m256i denormMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(int(113u << 23)), i);
+	const __m256i denorm = _mm256_cvtps_epi32(_mm256_mul_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(int((127u + 14u + MANT) << 23)))));
+
+	__m256i n = _mm256_sub_epi32(i, _mm256_set1_epi32(int(112u << 23)));
+	const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(n, SHIFT), _mm256_set1_epi32(1));
+	n = _mm256_add_epi32(n, _mm256_set1_epi32(int((1u << (SHIFT - 1)) - 1u)));
+	n = _mm256_srli_epi32(_mm256_add_epi32(n, odd), SHIFT);
+	return _mm256_blendv_epi8(n, denorm, denormMask);
+}
+
+LUTPACK_TARGET_AVX2 static void PackR11G11B10AVX2(const float* src, int srcChannels, int count, uint32_t* dst)
+{
+	const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(srcChannels));
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const float* s = src + size_t(i) * srcChannels;
+		const __m256i r = SmallFloat8<6>(GatherChannel8(s, stride, 0));
+		const __m256i g = SmallFloat8<6>(GatherChannel8(s, stride, 1));
+		const __m256i b = SmallFloat8<5>(GatherChannel8(s, stride, 2));
+		const __m256i packed = _mm256_or_si256(r, _mm256_or_si256(_mm256_slli_epi32(g, 11), _mm256_slli_epi32(b, 22)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+	}
+	PackR11G11B10Scalar(src + size_t(i) * srcChannels, srcChannels, count - i, dst + i);
+}
+
+LUTPACK_TARGET_AVX2 static void PackRGB9E5AVX2(const float* src, int srcChannels, int count, uint32_t* dst)
+{
+	const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(srcChannels));
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 maxV = _mm256_set1_ps(RGB9E5_MAX);
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const float* s = src + size_t(i) * srcChannels;
+		const __m256 r = _mm256_min_ps(_mm256_max_ps(GatherChannel8(s, stride, 0), zero), maxV);
+		const __m256 g = _mm256_min_ps(_mm256_max_ps(GatherChannel8(s, stride, 1), zero), maxV);
+		const __m256 b = _mm256_min_ps(_mm256_max_ps(GatherChannel8(s, stride, 2), zero), maxV);
+		const __m256 maxC = _mm256_max_ps(r, _mm256_max_ps(g, b));
+
+		__m256i expShared = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(maxC), 23), _mm256_set1_epi32(127));
+		expShared = _mm256_add_epi32(_mm256_max_epi32(expShared, _mm256_set1_epi32(-16)), _mm256_set1_epi32(16));
+		__m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(_mm256_set1_epi32(127 + 24), expShared), 23));
+
+		const __m256i bump = _mm256_cmpeq_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(maxC, scale)), _mm256_set1_epi32(512));
+		expShared = _mm256_sub_epi32(expShared, bump);	// bump = -1
+		scale = _mm256_blendv_ps(scale, _mm256_mul_ps(scale, _mm256_set1_ps(0.5f)), _mm256_castsi256_ps(bump));
+
+		const __m256i rm = _mm256_cvtps_epi32(_mm256_mul_ps(r, scale));
+		const __m256i gm = _mm256_cvtps_epi32(_mm256_mul_ps(g, scale));
+		const __m256i bm = _mm256_cvtps_epi32(_mm256_mul_ps(b, scale));
+		const __m256i packed = _mm256_or_si256(_mm256_or_si256(rm, _mm256_slli_epi32(gm, 9)),
+			_mm256_or_si256(_mm256_slli_epi32(bm, 18), _mm256_slli_epi32(expShared, 27)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+	}
+	PackRGB9E5Scalar(src + size_t(i) * srcChannels, srcChannels, count - i, dst + i);
+}
+
+// ---------------- dispatch ----------------
+struct AtmosLutPackTable
+{
+	void (*Half)(const float*, int, int, uint16_t*);
+	void (*R11G11B10)(const float*, int, int, uint32_t*);
+	void (*RGB9E5)(const float*, int, int, uint32_t*);
+	const char* Name;
+};
+
+static void CpuId(int leaf, int subLeaf, uint32_t out[4])
+{
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuidex(regs, leaf, subLeaf);
+	for (int i = 0; i < 4; ++i) out[i] = (uint32_t)regs[i];
+#else
+	__cpuid_count(leaf, subLeaf, out[0], out[1], out[2], out[3]);
+#endif
+}
+
+static uint64_t ReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static AtmosLutPackTable SelectAtmosLutPack()
+{
+	const AtmosLutPackTable scalar = { PackHalfScalar, PackR11G11B10Scalar, PackRGB9E5Scalar, "scalar" };
+	const AtmosLutPackTable avx2 = { PackHalfAVX2, PackR11G11B10AVX2, PackRGB9E5AVX2, "AVX2+F16C" };
+
+	uint32_t regs[4];
+	CpuId(0, 0, regs);
+	if (regs[0] < 7)
+	{
+		return scalar;
+	}
+
+	// leaf 1 ECX: OSXSAVE(27), AVX(28), F16C(29)
+	CpuId(1, 0, regs);
+	const bool bOSXSave = (regs[2] & (1u << 27)) != 0;
+	const bool bAVX = (regs[2] & (1u << 28)) != 0;
+	const bool bF16C = (regs[2] & (1u << 29)) != 0;
+	if (!bOSXSave || !bAVX || !bF16C)
+	{
+		return scalar;
+	}
+
+	// OS가 YMM 상태(XCR0 bit 1, 2)를 저장해야 쓸 수 있다
+	if ((ReadXCR0() & 0x6) != 0x6)
+	{
+		return scalar;
+	}
+
+	// leaf 7 EBX: AVX2(5)
+	CpuId(7, 0, regs);
+	return (regs[1] & (1u << 5)) ? avx2 : scalar;
+}
+
+static const AtmosLutPackTable& GetAtmosLutPackTable()
+{
+	static const AtmosLutPackTable s_Table = SelectAtmosLutPack();
+	return s_Table;
+}
+
+const char* GetAtmosLutPackPathName()
+{
+	return GetAtmosLutPackTable().Name;
+}
+
+// ---------------- API ----------------
+EDDSFormat GetAtmosLutDDSFormat(EAtmosLutFormat fmt)
+{
+	switch (fmt)
+	{
+	case ATMOS_LUT_FORMAT_RGBA16F:		return DDS_FORMAT_R16G16B16A16_FLOAT;
+	case ATMOS_LUT_FORMAT_R11G11B10F:	return DDS_FORMAT_R11G11B10_FLOAT;
+	case ATMOS_LUT_FORMAT_RGB9E5:		return DDS_FORMAT_R9G9B9E5_SHAREDEXP;
+	default:							return DDS_FORMAT_R32G32B32A32_FLOAT;
+	}
+}
+
+uint32_t GetAtmosLutTexelBytes(EAtmosLutFormat fmt)
+{
+	switch (fmt)
+	{
+	case ATMOS_LUT_FORMAT_RGBA16F:		return 8;
+	case ATMOS_LUT_FORMAT_R11G11B10F:	return 4;
+	case ATMOS_LUT_FORMAT_RGB9E5:		return 4;
+	default:							return 16;
+	}
+}
+
+const char* GetAtmosLutFormatName(EAtmosLutFormat fmt)
+{
+	switch (fmt)
+	{
+	case ATMOS_LUT_FORMAT_RGBA16F:		return "RGBA16F";
+	case ATMOS_LUT_FORMAT_R11G11B10F:	return "R11G11B10F";
+	case ATMOS_LUT_FORMAT_RGB9E5:		return "RGB9E5";
+	default:							return "RGBA32F";
+	}
+}
+
+bool AtmosLutFormatHasAlpha(EAtmosLutFormat fmt)
+{
+	return fmt == ATMOS_LUT_FORMAT_RGBA32F || fmt == ATMOS_LUT_FORMAT_RGBA16F;
+}
+
+void PackAtmosTexels(EAtmosLutFormat fmt, const float* src, int srcChannels, int count, void* dst)
+{
+	const AtmosLutPackTable& table = GetAtmosLutPackTable();
+	switch (fmt)
+	{
+	case ATMOS_LUT_FORMAT_RGBA16F:
+		table.Half(src, srcChannels, count, static_cast<uint16_t*>(dst));
+		break;
+	case ATMOS_LUT_FORMAT_R11G11B10F:
+		table.R11G11B10(src, srcChannels, count, static_cast<uint32_t*>(dst));
+		break;
+	case ATMOS_LUT_FORMAT_RGB9E5:
+		table.RGB9E5(src, srcChannels, count, static_cast<uint32_t*>(dst));
+		break;
+	default:
+		if (srcChannels == 4)
+		{
+			memcpy(dst, src, size_t(count) * 4 * sizeof(float));
+		}
+		else
+		{
+			float* d = static_cast<float*>(dst);
+			for (int i = 0; i < count; ++i)
+			{
+				d[i * 4 + 0] = src[size_t(i) * 3 + 0];
+				d[i * 4 + 1] = src[size_t(i) * 3 + 1];
+				d[i * 4 + 2] = src[size_t(i) * 3 + 2];
+				d[i * 4 + 3] = 1.0f;
+			}
+		}
+		break;
+	}
+}
+
+void UnpackAtmosTexels(EAtmosLutFormat fmt, const void* src, int count, float* dstRGBA)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		float* d = dstRGBA + size_t(i) * 4;
+		switch (fmt)
+		{
+		case ATMOS_LUT_FORMAT_RGBA16F:
+		{
+			const uint16_t* s = static_cast<const uint16_t*>(src) + size_t(i) * 4;
+			for (int c = 0; c < 4; ++c)
+			{
+				d[c] = HalfToFloat(s[c]);
+			}
+			break;
+		}
+		case ATMOS_LUT_FORMAT_R11G11B10F:
+		{
+			const uint32_t v = static_cast<const uint32_t*>(src)[i];
+			d[0] = SmallFloatToFloat<6>(v & 0x7FFu);
+			d[1] = SmallFloatToFloat<6>((v >> 11) & 0x7FFu);
+			d[2] = SmallFloatToFloat<5>(v >> 22);
+			d[3] = 1.0f;
+			break;
+		}
+		case ATMOS_LUT_FORMAT_RGB9E5:
+			RGB9E5ToFloat(static_cast<const uint32_t*>(src)[i], d);
+			d[3] = 1.0f;
+			break;
+		default:
+			memcpy(d, static_cast<const float*>(src) + size_t(i) * 4, 4 * sizeof(float));
+			break;
+		}
+	}
+}
+
+bool PackAtmosLutRows(EAtmosLutFormat fmt, int W, int numRows, int srcChannels, const AtmosLutRowSource& rowSrc,
+	int numThreads, size_t stagingBytes, const AtmosLutRowSink& sink, AtmosLutPackError* outError)
+{
+	assert(srcChannels == 3 || srcChannels == 4);
+
+	// A를 버리는 포맷에 RGBA (Scattering의 단산란 Mie)를 넣으면 정보가 사라진다
+	if (srcChannels == 4 && !AtmosLutFormatHasAlpha(fmt))
+	{
+		return false;
+	}
+
+	numThreads = ResolveThreadCount(numThreads);
+	const size_t rowBytes = size_t(W) * GetAtmosLutTexelBytes(fmt);
+	const int rowsPerChunk = int(std::max<size_t>(stagingBytes / rowBytes, 1));
+
+	// 상대오차 바닥값용 LUT 최대값
+	float peak = 0.0f;
+	if (outError)
+	{
+		std::vector<float> rowPeak(numRows, 0.0f);
+		ParallelFor(numRows, numThreads, [&](int row)
+			{
+				const float* src = rowSrc(row);
+				float m = 0.0f;
+				for (int i = 0; i < W * srcChannels; ++i)
+				{
+					m = std::max(m, std::fabs(src[i]));
+				}
+				rowPeak[row] = m;
+			});
+		for (float m : rowPeak)
+		{
+			peak = std::max(peak, m);
+		}
+	}
+	const double floorV = std::max(double(peak) * 1e-3, 1e-30);
+
+	struct RowError
+	{
+		double MaxAbs = 0.0;
+		double MaxRel = 0.0;
+		double SumSqRel = 0.0;
+	};
+	std::vector<RowError> rowErrors(outError ? numRows : 0);
+
+	// staging 한 묶음씩: 병렬 변환 → sink (파일 쓰기는 순서대로)
+	std::vector<uint8_t> staging(rowBytes * std::min(rowsPerChunk, numRows));
+	for (int chunkBegin = 0; chunkBegin < numRows; chunkBegin += rowsPerChunk)
+	{
+		const int chunkRows = std::min(rowsPerChunk, numRows - chunkBegin);
+		ParallelFor(chunkRows, numThreads, [&](int local)
+			{
+				const int row = chunkBegin + local;
+				const float* src = rowSrc(row);
+				uint8_t* dst = staging.data() + size_t(local) * rowBytes;
+				PackAtmosTexels(fmt, src, srcChannels, W, dst);
+
+				if (outError)
+				{
+					std::vector<float> unpacked(size_t(W) * 4);
+					UnpackAtmosTexels(fmt, dst, W, unpacked.data());
+
+					RowError& e = rowErrors[row];
+					for (int i = 0; i < W; ++i)
+					{
+						for (int c = 0; c < srcChannels; ++c)
+						{
+							const double ref = src[size_t(i) * srcChannels + c];
+							const double d = std::fabs(double(unpacked[size_t(i) * 4 + c]) - ref);
+							const double rel = d / std::max(std::fabs(ref), floorV);
+							e.MaxAbs = std::max(e.MaxAbs, d);
+							e.MaxRel = std::max(e.MaxRel, rel);
+							e.SumSqRel += rel * rel;
+						}
+					}
+				}
+			});
+
+		if (!sink(staging.data(), size_t(chunkRows) * rowBytes))
+		{
+			return false;
+		}
+	}
+
+	if (outError)
+	{
+		*outError = AtmosLutPackError{};
+		double sumSq = 0.0;
+		for (const RowError& e : rowErrors)
+		{
+			outError->MaxAbs = std::max(outError->MaxAbs, e.MaxAbs);
+			outError->MaxRel = std::max(outError->MaxRel, e.MaxRel);
+			sumSq += e.SumSqRel;
+		}
+		outError->NumValues = size_t(numRows) * W * srcChannels;
+		outError->RmsRel = outError->NumValues ? std::sqrt(sumSq / double(outError->NumValues)) : 0.0;
+	}
+	return true;
+}
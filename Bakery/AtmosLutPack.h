@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <functional>
+#include <cstdint>
+#include "DDSWriter.h"
+
+// ===============================================================
+// 대기 LUT 저장 포맷 변환 (float → half / R11G11B10 / RGB9E5)
+// - 고정 크기 staging 버퍼 한 묶음씩 행 단위로 병렬 변환해 넘긴다 (볼륨 전체 사본을 만들지 않는다)
+// - 행 안은 8 texel씩 AVX2 (+F16C). 실행 경로는 첫 호출 때 CPUID로 정한다
+// - 스칼라 경로와 AVX2 경로는 비트 단위로 같은 결과 (모두 round-to-nearest-even, half의 NaN payload만 다를 수 있다)
+// - 변환 후 float 원본과 비교한 오차를 돌려준다
+// - DDSWriter와 함께 표준 라이브러리만 쓴다 (Windows 헤더 없이 빌드된다)
+// ===============================================================
+
+enum EAtmosLutFormat : int
+{
+	ATMOS_LUT_FORMAT_RGBA32F = 0,	// 16 B/texel, 무손실
+	ATMOS_LUT_FORMAT_RGBA16F = 1,	// 8 B/texel, 상대오차 <= 2^-11. A 유지 (Scattering은 이것까지만 가능)
+	ATMOS_LUT_FORMAT_R11G11B10F = 2,// 4 B/texel, A 없음. 채널마다 상대오차 <= 2^-7 (B는 2^-6)
+	ATMOS_LUT_FORMAT_RGB9E5 = 3,	// 4 B/texel, A 없음. 세 채널이 지수를 공유해 절대오차 <= texel 최대 채널 * 2^-9
+};
+
+struct AtmosLutPackError
+{
+	double MaxAbs = 0.0;
+	double MaxRel = 0.0;	// |packed - float| / max(|float|, LUT 최대값 * 1e-3)
+	double RmsRel = 0.0;
+	size_t NumValues = 0;	// 비교한 값 수 (소스 채널 전부)
+};
+
+EDDSFormat GetAtmosLutDDSFormat(EAtmosLutFormat fmt);
+uint32_t GetAtmosLutTexelBytes(EAtmosLutFormat fmt);
+const char* GetAtmosLutFormatName(EAtmosLutFormat fmt);
+bool AtmosLutFormatHasAlpha(EAtmosLutFormat fmt);
+
+// 출력 행 row의 소스 = texel W개가 연속 (채널 수 srcChannels = 3이면 A = 1로 채운다)
+using AtmosLutRowSource = std::function<const float*(int row)>;
+
+// 변환된 행 묶음 (연속, bytes = 행 수 * W * texel 크기)을 받는다. false면 중단
+using AtmosLutRowSink = std::function<bool(const void* data, size_t bytes)>;
+
+// 행 [0, numRows)를 stagingBytes 안에 들어가는 묶음으로 나눠 병렬 변환하고, 묶음마다 행 순서대로 sink에 넘긴다.
+// outError가 있으면 변환 결과를 다시 풀어 float 원본과 비교한다. numThreads 0 = 하드웨어 스레드 전부
+bool PackAtmosLutRows(EAtmosLutFormat fmt, int W, int numRows, int srcChannels, const AtmosLutRowSource& rowSrc,
+	int numThreads, size_t stagingBytes, const AtmosLutRowSink& sink, AtmosLutPackError* outError);
+
+// count texel 변환 / 역변환 (역변환 결과는 RGBA, A가 없는 포맷은 A = 1)
+void PackAtmosTexels(EAtmosLutFormat fmt, const float* src, int srcChannels, int count, void* dst);
+void UnpackAtmosTexels(EAtmosLutFormat fmt, const void* src, int count, float* dstRGBA);
+
+// 선택된 실행 경로 이름 ("AVX2+F16C", "scalar")
+const char* GetAtmosLutPackPathName();
@@ -0,0 +1,540 @@
+﻿#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <cinttypes>
+#include <algorithm>
+#include <filesystem>
+
+#include "Common/Common.h"
+#include "Interface/IPrelight.h"
+
+#include "Atmos.h"
+#include "AtmosCache.h"
+
+// ===============================================================
+// 대기 bake 회귀 / 성능 측정 (헤드리스)
+// - Earth 프리셋 (MakeEarthLikeParams)과 빠른 경로 변형을 굽고, 변형마다 Golden/<이름>.golden 기준과 비교한다
+//   기준 파일이 없으면 실패. 결과를 의도적으로 바꾼 뒤에는 Bakery --atmos-regression --record-golden 으로 다시 기록해 커밋할 것
+// - 빠른 경로 변형은 Balanced 변형과의 오차 (경로 자체의 근사 오차)도 보고한다 (layout이 같을 때만)
+// - 모든 변형을 batch 한 번으로 다시 구워 개별 bake와 비트 단위로 같은지 확인한다
+// - 단계별 시간과 texel/s는 Golden/perf.csv에 실행마다 한 줄씩 덧붙인다
+// ===============================================================
+
+namespace
+{
+	// 기준 파일은 저장소에 넣으므로 LUT 전체 대신 LUT별 요약만 담는다 (텍스트, 변형 하나에 수십 KB):
+	//   비트 해시 + 합계 + 최댓값 + 고정 위치 표본 GOLDEN_SAMPLES_PER_LUT개
+	// 해시가 같으면 비트 단위 일치. 다르면 합계/최댓값/표본을 GOLDEN_MAX_REL_ERR 안에서 비교한다
+	// 기록한 빌드의 컴파일러 / FP 설정 (GetGoldenBuildInfo)도 함께 적는다. 비교하는 빌드와 다르면 알리기만 한다
+	constexpr int GOLDEN_FILE_VERSION = 2;
+	constexpr int GOLDEN_SAMPLES_PER_LUT = 256;
+
+	// 기준 대비 허용 상대오차. 같은 빌드에서는 스레드 수와 무관하게 비트 단위로 같지만, 빌드가 다르면
+	// FMA 축약 여부와 scalar/AVX2 커널 차이로 마지막 비트가 달라지고 적응형 적분은 그 차이로 구간 분할이 바뀐다.
+	// 측정한 빌드 간 차이 (GCC -ffp-contract=off / -march=native / scalar 커널 / 기본 설정):
+	//   Fast 산란 4.0e-3, Balanced/Spectral 1.1e-3, 고정 스텝 5e-5, 투과율/복사조도 1e-5 이하
+	// 가장 큰 값의 2.5배를 허용한다. 이보다 큰 차이는 bake 결과가 실제로 바뀐 것
+	constexpr double GOLDEN_MAX_REL_ERR = 1e-2;
+
+	// 상대오차 분모 바닥값 = LUT 최대값 * 이 값 (어두운 texel에서 상대오차가 튀지 않게)
+	constexpr double REL_ERR_FLOOR = 1e-3;
+
+	struct LutError
+	{
+		double MaxAbs = 0.0;
+		double MaxRel = 0.0;
+		double RmsRel = 0.0;
+		size_t NumOverTol = 0;	// 상대오차 > GOLDEN_MAX_REL_ERR 인 값 수
+	};
+
+	struct AtmosVariant
+	{
+		const char* Name;
+		AtmosParams Params;
+	};
+
+	LutError CompareLut(const float* a, const float* ref, size_t n)
+	{
+		LutError e;
+		float peak = 0.0f;
+		for (size_t i = 0; i < n; ++i)
+		{
+			peak = std::max(peak, std::fabs(ref[i]));
+		}
+		const double floorV = std::max(double(peak) * REL_ERR_FLOOR, 1e-30);
+
+		double sumSq = 0.0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double d = std::fabs(double(a[i]) - double(ref[i]));
+			const double rel = d / std::max(double(std::fabs(ref[i])), floorV);
+			e.MaxAbs = std::max(e.MaxAbs, d);
+			e.MaxRel = std::max(e.MaxRel, rel);
+			sumSq += rel * rel;
+			e.NumOverTol += rel > GOLDEN_MAX_REL_ERR ? 1 : 0;
+		}
+		e.RmsRel = n ? std::sqrt(sumSq / double(n)) : 0.0;
+		return e;
+	}
+
+	bool SameLayout(const AtmosResult& a, const AtmosResult& b)
+	{
+		return a.TransmittanceW == b.TransmittanceW && a.TransmittanceH == b.TransmittanceH
+			&& a.ScatteringR == b.ScatteringR && a.ScatteringMu == b.ScatteringMu && a.ScatteringMuS == b.ScatteringMuS && a.ScatteringNu == b.ScatteringNu
+			&& a.IrradianceW == b.IrradianceW && a.IrradianceH == b.IrradianceH
+			&& a.LutMapping == b.LutMapping && a.ScatteringLayout == b.ScatteringLayout;
+	}
+
+	size_t ScatteringTexels(const AtmosResult& r)
+	{
+		return size_t(r.ScatteringR) * r.ScatteringMu * r.ScatteringMuS * r.ScatteringNu;
+	}
+
+	// 세 LUT 오차를 출력하고 최대 상대오차 (세 LUT 중 최대)를 돌려준다
+	double ReportLutErrors(const char* label, const AtmosResult& a, const AtmosResult& ref)
+	{
+		const LutError eT = CompareLut(a.TransmittanceRGB, ref.TransmittanceRGB, size_t(ref.TransmittanceW) * ref.TransmittanceH * 3);
+		const LutError eS = CompareLut(a.ScatteringRGBA, ref.ScatteringRGBA, ScatteringTexels(ref) * 4);
+		const LutError eE = CompareLut(a.IrradianceRGB, ref.IrradianceRGB, size_t(ref.IrradianceW) * ref.IrradianceH * 3);
+
+		auto print = [label](const char* lut, const LutError& e)
+		{
+			std::cout << "[Regression]   " << label << " " << lut
+				<< ": max abs " << e.MaxAbs << ", max rel " << e.MaxRel << ", rms rel " << e.RmsRel
+				<< ", over tol " << e.NumOverTol << std::endl;
+		};
+		print("T", eT);
+		print("S", eS);
+		print("E", eE);
+		return std::max({ eT.MaxRel, eS.MaxRel, eE.MaxRel });
+	}
+
+	// ---------------- Golden ----------------
+	const char* const GOLDEN_LUT_NAMES[3] = { "T", "S", "E" };
+
+	struct GoldenLut
+	{
+		size_t Count = 0;
+		uint64_t Hash = 0;
+		double Sum = 0.0;
+		double Peak = 0.0;
+		std::vector<size_t> SampleIndex;
+		std::vector<float> SampleValue;
+	};
+
+	struct GoldenRecord
+	{
+		std::string Build;		// 기록한 빌드 (GetGoldenBuildInfo)
+		uint64_t ParamsHash = 0;
+		int Layout[10] = {};	// TW TH / SR SMU SMUS SNU / EW EH / LutMapping ScatteringLayout
+		GoldenLut Luts[3];		// GOLDEN_LUT_NAMES 순서
+	};
+
+	void GetGoldenLayout(const AtmosResult& r, int* out)
+	{
+		const int layout[10] = { r.TransmittanceW, r.TransmittanceH, r.ScatteringR, r.ScatteringMu, r.ScatteringMuS, r.ScatteringNu,
+			r.IrradianceW, r.IrradianceH, (int)r.LutMapping, (int)r.ScatteringLayout };
+		std::copy(layout, layout + 10, out);
+	}
+
+	void GetGoldenLuts(const AtmosResult& r, const float** outData, size_t* outCount)
+	{
+		outData[0] = r.TransmittanceRGB;	outCount[0] = size_t(r.TransmittanceW) * r.TransmittanceH * 3;
+		outData[1] = r.ScatteringRGBA;		outCount[1] = ScatteringTexels(r) * 4;
+		outData[2] = r.IrradianceRGB;		outCount[2] = size_t(r.IrradianceW) * r.IrradianceH * 3;
+	}
+
+	// 이 빌드의 컴파일러와 FP 설정. GCC/Clang은 -ffp-contract를 매크로로 알려주지 않으므로 FMA 대상인지 (기본값이면 축약한다)를 적는다
+	// Prelight는 같은 솔루션 설정 (common.props)으로 빌드되므로 Bakery 쪽 값으로 대신한다
+	std::string GetGoldenBuildInfo()
+	{
+		std::string info;
+#if defined(_MSC_VER) && !defined(__clang__)
+		info = "msvc " + std::to_string(_MSC_FULL_VER);
+#  if defined(_M_FP_FAST)
+		info += " fp:fast";
+#  elif defined(_M_FP_STRICT)
+		info += " fp:strict";
+#  else
+		info += " fp:precise";
+#  endif
+#  if defined(_M_FP_CONTRACT)
+		info += " fp:contract";
+#  endif
+#elif defined(__clang__)
+		info = "clang " + std::to_string(__clang_major__) + "." + std::to_string(__clang_minor__) + "." + std::to_string(__clang_patchlevel__);
+#elif defined(__GNUC__)
+		info = "gcc " + std::to_string(__GNUC__) + "." + std::to_string(__GNUC_MINOR__) + "." + std::to_string(__GNUC_PATCHLEVEL__);
+#else
+		info = "unknown";
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#  if defined(__FAST_MATH__)
+		info += " fast-math";
+#  endif
+#  if defined(__FMA__)
+		info += " fma";
+#  else
+		info += " no-fma";
+#  endif
+#endif
+#if defined(__AVX2__)
+		info += " avx2";
+#endif
+		return info;
+	}
+
+	// 해시 / 합계 / 최댓값. 표본 위치는 기록할 때만 정한다 (채널과 texel 축에 고르게 퍼지도록 황금비 해시)
+	GoldenLut SummarizeLut(const float* data, size_t n, bool bPickSamples)
+	{
+		GoldenLut g;
+		g.Count = n;
+		g.Hash = HashAtmosLutBits(data, n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			g.Sum += data[i];
+			g.Peak = std::max(g.Peak, double(std::fabs(data[i])));
+		}
+		if (bPickSamples && n > 0)
+		{
+			for (int k = 0; k < GOLDEN_SAMPLES_PER_LUT; ++k)
+			{
+				const size_t i = size_t((uint64_t(k + 1) * 0x9E3779B97F4A7C15ull >> 16) % n);
+				g.SampleIndex.push_back(i);
+				g.SampleValue.push_back(data[i]);
+			}
+		}
+		return g;
+	}
+
+	GoldenRecord MakeGoldenRecord(const AtmosParams& p, const AtmosResult& r)
+	{
+		GoldenRecord rec;
+		rec.Build = GetGoldenBuildInfo();
+		rec.ParamsHash = HashAtmosParamFields(p);
+		GetGoldenLayout(r, rec.Layout);
+		const float* data[3];
+		size_t count[3];
+		GetGoldenLuts(r, data, count);
+		for (int l = 0; l < 3; ++l)
+		{
+			rec.Luts[l] = SummarizeLut(data[l], count[l], /*bPickSamples*/true);
+		}
+		return rec;
+	}
+
+	bool WriteGoldenRecord(const std::filesystem::path& path, const char* variantName, const GoldenRecord& rec)
+	{
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+		{
+			return false;
+		}
+		char line[128];
+		file << "# Atmosphere bake golden: " << variantName << ". Re-record with Bakery --atmos-regression --record-golden\n";
+		file << "version " << GOLDEN_FILE_VERSION << "\n";
+		file << "build " << rec.Build << "\n";
+		snprintf(line, sizeof(line), "params %016" PRIx64 "\n", rec.ParamsHash);
+		file << line << "layout";
+		for (int v : rec.Layout)
+		{
+			file << " " << v;
+		}
+		file << "\n";
+		for (int l = 0; l < 3; ++l)
+		{
+			const GoldenLut& g = rec.Luts[l];
+			snprintf(line, sizeof(line), "lut %s %zu %016" PRIx64 " %.17g %.17g %zu\n",
+				GOLDEN_LUT_NAMES[l], g.Count, g.Hash, g.Sum, g.Peak, g.SampleIndex.size());
+			file << line;
+			for (size_t k = 0; k < g.SampleIndex.size(); ++k)
+			{
+				snprintf(line, sizeof(line), "%zu %.9g\n", g.SampleIndex[k], g.SampleValue[k]);
+				file << line;
+			}
+		}
+		return bool(file);
+	}
+
+	bool ReadGoldenRecord(const std::filesystem::path& path, GoldenRecord* out)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			return false;
+		}
+		std::string token;
+		int version = 0;
+		while (file >> token && token == "#")
+		{
+			std::getline(file, token);
+		}
+		if (token != "version" || !(file >> version) || version != GOLDEN_FILE_VERSION)
+		{
+			return false;
+		}
+		if (!(file >> token) || token != "build" || !std::getline(file >> std::ws, out->Build))
+		{
+			return false;
+		}
+		if (!(file >> token) || token != "params" || !(file >> token))
+		{
+			return false;
+		}
+		out->ParamsHash = std::stoull(token, nullptr, 16);
+		if (!(file >> token) || token != "layout")
+		{
+			return false;
+		}
+		for (int& v : out->Layout)
+		{
+			file >> v;
+		}
+		for (int l = 0; l < 3; ++l)
+		{
+			GoldenLut& g = out->Luts[l];
+			std::string name, hash;
+			size_t numSamples = 0;
+			if (!(file >> token >> name >> g.Count >> hash >> g.Sum >> g.Peak >> numSamples) || token != "lut" || name != GOLDEN_LUT_NAMES[l])
+			{
+				return false;
+			}
+			g.Hash = std::stoull(hash, nullptr, 16);
+			g.SampleIndex.resize(numSamples);
+			g.SampleValue.resize(numSamples);
+			for (size_t k = 0; k < numSamples; ++k)
+			{
+				file >> g.SampleIndex[k] >> g.SampleValue[k];
+				if (g.SampleIndex[k] >= g.Count)
+				{
+					return false;
+				}
+			}
+		}
+		return bool(file);
+	}
+
+	// 세 LUT를 기준과 비교해 출력하고 최대 상대오차를 돌려준다 (비트 단위 일치면 0)
+	double ReportGoldenErrors(const AtmosResult& r, const GoldenRecord& golden)
+	{
+		const float* data[3];
+		size_t count[3];
+		GetGoldenLuts(r, data, count);
+
+		double maxRelAll = 0.0;
+		for (int l = 0; l < 3; ++l)
+		{
+			const GoldenLut& ref = golden.Luts[l];
+			const GoldenLut cur = SummarizeLut(data[l], count[l], /*bPickSamples*/false);
+			std::cout << "[Regression]   vs golden " << GOLDEN_LUT_NAMES[l] << ": ";
+			if (cur.Hash == ref.Hash)
+			{
+				std::cout << "bit-exact" << std::endl;
+				continue;
+			}
+
+			auto rel = [](double a, double b, double floorV) { return std::fabs(a - b) / std::max(std::fabs(b), floorV); };
+			const double floorV = std::max(ref.Peak * REL_ERR_FLOOR, 1e-30);
+			double maxRel = std::max(rel(cur.Sum, ref.Sum, 1e-30), rel(cur.Peak, ref.Peak, 1e-30));
+			size_t numOverTol = 0;
+			for (size_t k = 0; k < ref.SampleIndex.size(); ++k)
+			{
+				const double e = rel(data[l][ref.SampleIndex[k]], ref.SampleValue[k], floorV);
+				maxRel = std::max(maxRel, e);
+				numOverTol += e > GOLDEN_MAX_REL_ERR ? 1 : 0;
+			}
+			std::cout << "hash differs, sum " << cur.Sum << " (golden " << ref.Sum << "), max rel " << maxRel
+				<< ", samples over tol " << numOverTol << "/" << ref.SampleIndex.size() << std::endl;
+			maxRelAll = std::max(maxRelAll, maxRel);
+		}
+		return maxRelAll;
+	}
+
+	void FreeAtmosResult(AtmosResult* r)
+	{
+		delete[] r->TransmittanceRGB; r->TransmittanceRGB = nullptr;
+		delete[] r->ScatteringRGBA;   r->ScatteringRGBA = nullptr;
+		delete[] r->IrradianceRGB;    r->IrradianceRGB = nullptr;
+	}
+
+	// 단계 시간 → texel/s. 다중산란은 차수마다 산란 LUT 전체를 한 번 도는 것으로 센다
+	void ReportTimings(const char* name, const AtmosParams& p, const AtmosResult& r, std::ofstream& csv)
+	{
+		const AtmosBakeTimings& t = r.Timings;
+		const double texT = double(r.TransmittanceW) * r.TransmittanceH;
+		const double texS = double(ScatteringTexels(r));
+		const double texE = double(r.IrradianceW) * r.IrradianceH;
+		const double texMS = texS * std::max(p.MultipleScatteringOrders - 1, 0);
+		auto rate = [](double texels, double ms) { return ms > 0.0 ? texels / (ms * 1e-3) : 0.0; };
+
+		std::cout << "[Regression]   time: T " << t.TransmittanceMs << "ms, S " << t.SingleScatteringMs << "ms, E " << t.DirectIrradianceMs
+			<< "ms, MS " << t.MultipleScatteringMs << "ms, check " << t.ValidationMs << "ms, total " << t.TotalMs << "ms" << std::endl;
+		std::cout << "[Regression]   texel/s: T " << rate(texT, t.TransmittanceMs) << ", S " << rate(texS, t.SingleScatteringMs)
+			<< ", E " << rate(texE, t.DirectIrradianceMs) << ", MS " << rate(texMS, t.MultipleScatteringMs) << std::endl;
+
+		if (csv)
+		{
+			csv << std::time(nullptr) << "," << name << "," << p.NumThreads
+				<< "," << t.TransmittanceMs << "," << t.SingleScatteringMs << "," << t.DirectIrradianceMs
+				<< "," << t.MultipleScatteringMs << "," << t.ValidationMs << "," << t.TotalMs
+				<< "," << rate(texT, t.TransmittanceMs) << "," << rate(texS, t.SingleScatteringMs)
+				<< "," << rate(texE, t.DirectIrradianceMs) << "," << rate(texMS, t.MultipleScatteringMs) << "\n";
+		}
+	}
+}
+
+bool RunAtmosRegression(const std::wstring& goldenDir, bool bRecordGolden)
+{
+	// [0]이 경로 오차의 기준. 나머지는 같은 대기를 더 싸게 굽는 경로
+	std::vector<AtmosVariant> variants;
+	{
+		AtmosParams p = MakeEarthLikeParams();
+		variants.push_back({ "Balanced", p });
+
+		p.Quality = ATMOS_QUALITY_FAST;
+		variants.push_back({ "Fast", p });
+
+		p.Quality = ATMOS_QUALITY_FIXED;
+		variants.push_back({ "Fixed", p });
+
+		p = MakeEarthLikeParams();
+		p.MultipleScatteringOrders = 1;
+		p.bCompactScattering = true;
+		variants.push_back({ "SingleCompact", p });
+
+		// 분광 lane 경로 (파장 12개 = RGB 묶음 4개)
+		p = MakeEarthLikeParams();
+		p.MultipleScatteringOrders = 1;
+		p.SpectralWavelengths = 12;
+		variants.push_back({ "Spectral", p });
+	}
+	const int numVariants = int(variants.size());
+
+	std::error_code ec;
+	std::filesystem::create_directories(goldenDir, ec);
+	const std::filesystem::path perfPath = std::filesystem::path(goldenDir) / L"perf.csv";
+	const bool bNewPerf = !std::filesystem::exists(perfPath, ec);
+	std::ofstream csv(perfPath, std::ios::app);
+	if (csv && bNewPerf)
+	{
+		csv << "time,variant,threads,transmittance_ms,single_ms,irradiance_ms,multiple_ms,validation_ms,total_ms,"
+			"transmittance_texel_s,single_texel_s,irradiance_texel_s,multiple_texel_s\n";
+	}
+
+	bool bPass = true;
+	std::vector<AtmosResult> results(numVariants);
+	for (int v = 0; v < numVariants; ++v)
+	{
+		const AtmosVariant& var = variants[v];
+		std::cout << "[Regression] " << var.Name << std::endl;
+		if (!prl::PrecomputeAtmos(var.Params, &results[v]))
+		{
+			std::cerr << "[Regression] " << var.Name << ": PrecomputeAtmos failed.\n";
+			bPass = false;
+			continue;
+		}
+		const AtmosResult& r = results[v];
+		ReportTimings(var.Name, var.Params, r, csv);
+
+		// 기준 비교. 기준이 없거나 읽을 수 없으면 실패 (기록은 --record-golden 일 때만)
+		const std::filesystem::path goldenPath = std::filesystem::path(goldenDir) / (std::string(var.Name) + ".golden");
+		GoldenRecord golden;
+		if (bRecordGolden)
+		{
+			const bool bStored = WriteGoldenRecord(goldenPath, var.Name, MakeGoldenRecord(var.Params, r));
+			std::cout << "[Regression]   golden: " << (bStored ? "recorded" : "record FAILED") << std::endl;
+			bPass = bPass && bStored;
+		}
+		else if (!ReadGoldenRecord(goldenPath, &golden))
+		{
+			std::cerr << "[Regression]   golden: FAIL (missing or unreadable " << goldenPath.string() << "; record with --record-golden)\n";
+			bPass = false;
+		}
+		else
+		{
+			int layout[10];
+			GetGoldenLayout(r, layout);
+			if (golden.ParamsHash != HashAtmosParamFields(var.Params))
+			{
+				std::cerr << "[Regression]   golden: FAIL (variant parameters changed; re-record with --record-golden)\n";
+				bPass = false;
+			}
+			else if (!std::equal(layout, layout + 10, golden.Layout))
+			{
+				std::cerr << "[Regression]   golden: FAIL (LUT size/mapping changed; re-record with --record-golden)\n";
+				bPass = false;
+			}
+			else
+			{
+				const std::string build = GetGoldenBuildInfo();
+				if (golden.Build != build)
+				{
+					std::cout << "[Regression]   golden recorded by " << golden.Build << ", this build " << build << std::endl;
+				}
+				const double maxRel = ReportGoldenErrors(r, golden);
+				const bool bOk = maxRel <= GOLDEN_MAX_REL_ERR;
+				std::cout << "[Regression]   golden: " << (bOk ? "PASS" : "FAIL") << std::endl;
+				bPass = bPass && bOk;
+			}
+		}
+
+		// 빠른 경로의 근사 오차 (참고용, 합격 판정에는 넣지 않는다)
+		if (v > 0 && results[0].TransmittanceRGB && SameLayout(r, results[0]))
+		{
+			ReportLutErrors("vs Balanced", r, results[0]);
+		}
+	}
+
+	// batch 경로: 개별 bake와 비트 단위로 같아야 한다
+	if (bPass)
+	{
+		std::vector<AtmosParams> batchParams(numVariants);
+		for (int v = 0; v < numVariants; ++v)
+		{
+			batchParams[v] = variants[v].Params;
+		}
+		std::vector<AtmosResult> batch(numVariants);
+		std::cout << "[Regression] Batch (" << numVariants << " variants)" << std::endl;
+		if (prl::PrecomputeAtmosBatch(batchParams.data(), numVariants, batch.data()))
+		{
+			ReportTimings("Batch", batchParams[0], batch[0], csv);
+			double sumMs = 0.0;
+			for (const AtmosResult& r : results)
+			{
+				sumMs += r.Timings.TotalMs;
+			}
+			std::cout << "[Regression]   batch " << batch[0].Timings.TotalMs << "ms vs separate " << sumMs << "ms" << std::endl;
+
+			for (int v = 0; v < numVariants; ++v)
+			{
+				const double maxRel = ReportLutErrors(variants[v].Name, batch[v], results[v]);
+				if (maxRel != 0.0)
+				{
+					std::cerr << "[Regression]   batch " << variants[v].Name << ": FAIL (differs from the separate bake)\n";
+					bPass = false;
+				}
+			}
+		}
+		else
+		{
+			std::cerr << "[Regression] PrecomputeAtmosBatch failed.\n";
+			bPass = false;
+		}
+		for (AtmosResult& r : batch)
+		{
+			FreeAtmosResult(&r);
+		}
+	}
+
+	for (AtmosResult& r : results)
+	{
+		FreeAtmosResult(&r);
+	}
+
+	std::cout << "[Regression] " << (bPass ? "PASS" : "FAIL") << std::endl;
+	return bPass;
+}
@@ -0,0 +1,146 @@
+﻿#include <cstring>
+#include <filesystem>
+
+#include "DDSWriter.h"
+
+// DDS 파일 구조 (Microsoft DDS 문서 / DDSTextureLoader와 같은 정의)
+namespace
+{
+	constexpr uint32_t DDS_MAGIC = 0x20534444;	// "DDS "
+
+	constexpr uint32_t DDSD_CAPS = 0x1;
+	constexpr uint32_t DDSD_HEIGHT = 0x2;
+	constexpr uint32_t DDSD_WIDTH = 0x4;
+	constexpr uint32_t DDSD_PITCH = 0x8;
+	constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDSD_DEPTH = 0x800000;
+
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t FOURCC_DX10 = 0x30315844;	// "DX10"
+
+	constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+	constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+	constexpr uint32_t DDS_DIMENSION_TEXTURE3D = 4;
+	constexpr uint32_t DDS_ALPHA_MODE_UNKNOWN = 0;
+
+	struct DDSPixelFormat
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DDSHeader
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		DDSPixelFormat PixelFormat;
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+
+	struct DDSHeaderDX10
+	{
+		uint32_t DXGIFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+
+	static_assert(sizeof(DDSPixelFormat) == 32, "DDS_PIXELFORMAT size");
+	static_assert(sizeof(DDSHeader) == 124, "DDS_HEADER size");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DDS_HEADER_DXT10 size");
+}
+
+bool DDSStreamWriter::Open(const std::wstring& path, const DDSTextureDesc& desc)
+{
+	Close();
+
+	const bool bVolume = desc.Depth > 0;
+	if (desc.Width == 0 || desc.Height == 0 || desc.BytesPerTexel == 0 || desc.ArraySize == 0 || (bVolume && desc.ArraySize != 1))
+	{
+		return false;
+	}
+
+	DDSHeader header = {};
+	header.Size = sizeof(DDSHeader);
+	header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | (bVolume ? DDSD_DEPTH : 0);
+	header.Height = desc.Height;
+	header.Width = desc.Width;
+	header.PitchOrLinearSize = desc.Width * desc.BytesPerTexel;
+	header.Depth = bVolume ? desc.Depth : 0;
+	header.MipMapCount = 1;
+	header.PixelFormat.Size = sizeof(DDSPixelFormat);
+	header.PixelFormat.Flags = DDPF_FOURCC;
+	header.PixelFormat.FourCC = FOURCC_DX10;
+	header.Caps = DDSCAPS_TEXTURE;
+	header.Caps2 = bVolume ? DDSCAPS2_VOLUME : 0;
+
+	DDSHeaderDX10 dx10 = {};
+	dx10.DXGIFormat = desc.Format;
+	dx10.ResourceDimension = bVolume ? DDS_DIMENSION_TEXTURE3D : DDS_DIMENSION_TEXTURE2D;
+	dx10.ArraySize = desc.ArraySize;
+	dx10.MiscFlags2 = DDS_ALPHA_MODE_UNKNOWN;
+
+	m_File.open(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+	if (!m_File)
+	{
+		return false;
+	}
+	m_File.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_File.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+
+	m_Path = path;
+	m_ExpectedBytes = uint64_t(desc.Width) * desc.Height * (bVolume ? desc.Depth : 1) * desc.ArraySize * desc.BytesPerTexel;
+	m_WrittenBytes = 0;
+	m_bOpen = true;
+	return bool(m_File);
+}
+
+bool DDSStreamWriter::Write(const void* data, size_t bytes)
+{
+	if (!m_bOpen || m_WrittenBytes + bytes > m_ExpectedBytes)
+	{
+		return false;
+	}
+	m_File.write(static_cast<const char*>(data), std::streamsize(bytes));
+	m_WrittenBytes += bytes;
+	return bool(m_File);
+}
+
+bool DDSStreamWriter::Close()
+{
+	if (!m_bOpen)
+	{
+		return false;
+	}
+	m_bOpen = false;
+
+	m_File.close();
+	const bool bOk = !m_File.fail() && m_WrittenBytes == m_ExpectedBytes;
+	if (!bOk)
+	{
+		std::error_code ec;
+		std::filesystem::remove(std::filesystem::path(m_Path), ec);
+	}
+	return bOk;
+}
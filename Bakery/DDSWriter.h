@@ -0,0 +1,57 @@
+﻿#pragma once
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+// ===============================================================
+// 스트리밍 DDS writer (DirectXTex 없이, 표준 라이브러리만)
+// - Open에서 헤더 (DDS_HEADER + DX10 확장 헤더)를 쓰고, Write로 받은 texel 데이터를 그대로 파일에 흘려보낸다
+//   볼륨 전체를 메모리에 만들지 않으므로 호출자는 고정 크기 staging 버퍼 하나로 행을 나눠 넘기면 된다
+// - 밉 1단계만. 2D / 2D 배열 / 3D (데이터 순서: 배열 원소 → 깊이 slice → 행, 행 사이 패딩 없음)
+// ===============================================================
+
+// DXGI_FORMAT 값 (dxgiformat.h와 같은 번호, Windows 헤더 없이 쓰려고 필요한 것만)
+enum EDDSFormat : uint32_t
+{
+	DDS_FORMAT_R32G32B32A32_FLOAT = 2,
+	DDS_FORMAT_R16G16B16A16_FLOAT = 10,
+	DDS_FORMAT_R11G11B10_FLOAT = 26,
+	DDS_FORMAT_R9G9B9E5_SHAREDEXP = 67,
+};
+
+struct DDSTextureDesc
+{
+	EDDSFormat Format;
+	uint32_t BytesPerTexel;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Depth;			// 0 = 2D 텍스처, 1 이상 = 3D 볼륨
+	uint32_t ArraySize;		// 2D 배열 원소 수 (3D면 1이어야 한다)
+};
+
+class DDSStreamWriter
+{
+public:
+	DDSStreamWriter() = default;
+	DDSStreamWriter(const DDSStreamWriter&) = delete;
+	DDSStreamWriter& operator=(const DDSStreamWriter&) = delete;
+	~DDSStreamWriter() { Close(); }
+
+	// 헤더까지 쓴다. 경로 디렉터리는 미리 있어야 한다
+	bool Open(const std::wstring& path, const DDSTextureDesc& desc);
+
+	// texel 데이터를 이어서 쓴다 (행 경계와 무관한 크기여도 된다)
+	bool Write(const void* data, size_t bytes);
+
+	// 쓴 양이 desc 크기와 맞고 쓰기 오류가 없었으면 true. 맞지 않는 파일은 지운다
+	bool Close();
+
+	uint64_t GetDataBytes() const { return m_ExpectedBytes; }
+
+private:
+	std::ofstream m_File;
+	std::wstring m_Path;
+	uint64_t m_ExpectedBytes = 0;
+	uint64_t m_WrittenBytes = 0;
+	bool m_bOpen = false;
+};
@@ -0,0 +1,5 @@
+﻿#pragma once
+
+// 복셀 레이 쿼리 (prl::RayFirstHitBatch / SegmentOccupancyBatch / VisibilityBatch) 회귀 (VoxelRayRegression.cpp)
+// meshPath 메쉬를 솔리드 그리드로 만들고, 계층 DDA 결과를 복셀 한 칸씩 밟는 brute-force 결과와 비교한다. 어긋나면 false
+bool RunVoxelRayRegression(const char* meshPath);
\ No newline at end of file
@@ -0,0 +1,244 @@
+﻿#include <iostream>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cfloat>
+
+#include "Common/Common.h"
+#include "Common/StaticMesh.h"
+#include "Interface/IPrelight.h"
+
+#include "Voxel.h"
+
+// ===============================================================
+// 복셀 레이 쿼리 회귀 (헤드리스)
+// - 계층 DDA는 빈 타일 / 빈 64비트 워드 / FULL 타일을 박스째 건너뛴다
+// - 기준은 그리드 박스 안의 복셀을 한 칸씩 밟는 Amanatides-Woo 순회 + 복셀별 점유 조회 (GetVoxelOccupancy)
+// - 축에 평행한 레이, 그리드 안에서 출발하는 레이, TMin > 0 인 레이를 섞는다
+// ===============================================================
+
+namespace
+{
+	constexpr int NUM_RAYS = 20000;
+	// 다른 복셀을 보고했을 때의 t 허용치 (복셀 길이 대비). 모서리를 스치는 레이의 반올림 차이만 허용한다
+	constexpr float VOXEL_T_TOLERANCE = 1e-3f;
+	constexpr float OCCUPANCY_TOLERANCE = 1e-4f;
+
+	// 레이가 지나는 복셀 하나와 그 안에 있는 t 구간
+	struct VoxelSpan
+	{
+		int3 Voxel;
+		float T0, T1;
+	};
+
+	// [tStart, tEnd]를 그리드 박스 [0, N)로 자른 뒤 복셀을 한 칸씩 밟으며 구간을 기록한다
+	void WalkVoxels(const VoxelGridInfo& info, const FLOAT3& origin, const FLOAT3& direction, float tStart, float tEnd, std::vector<VoxelSpan>* outSpans)
+	{
+		outSpans->clear();
+		const int n[3] = { info.Nx, info.Ny, info.Nz };
+		float o[3], d[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			o[k] = (origin[k] - info.Origin[k]) / info.Cell;
+			d[k] = direction[k] / info.Cell;
+		}
+
+		float t0 = tStart, t1 = tEnd;
+		for (int k = 0; k < 3; ++k)
+		{
+			if (d[k] == 0.0f)
+			{
+				if (o[k] < 0.0f || o[k] >= (float)n[k]) return;
+				continue;
+			}
+			float ta = (0.0f - o[k]) / d[k];
+			float tb = ((float)n[k] - o[k]) / d[k];
+			if (ta > tb) std::swap(ta, tb);
+			t0 = std::max(t0, ta);
+			t1 = std::min(t1, tb);
+		}
+		if (!(t0 < t1)) return;
+
+		int v[3];
+		float tNext[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			v[k] = std::clamp((int)std::floor(o[k] + d[k] * t0), 0, n[k] - 1);
+		}
+		float t = t0;
+		while (t < t1)
+		{
+			int axis = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				tNext[k] = (d[k] > 0.0f) ? ((float)(v[k] + 1) - o[k]) / d[k]
+					: (d[k] < 0.0f) ? ((float)v[k] - o[k]) / d[k]
+					: FLT_MAX;
+				if (tNext[k] < tNext[axis]) axis = k;
+			}
+			const float tExit = std::min(std::max(tNext[axis], t), t1);
+			outSpans->push_back({ { v[0], v[1], v[2] }, t, tExit });
+			t = tExit;
+			v[axis] += (d[axis] > 0.0f) ? 1 : -1;
+			if (v[axis] < 0 || v[axis] >= n[axis]) break;
+		}
+	}
+
+	// 레이를 brute-force로 밟은 결과 (점유 여부는 구간마다 한 번에 조회)
+	struct BruteRay
+	{
+		std::vector<VoxelSpan> Spans;
+		std::vector<int3> Voxels;
+		std::vector<uint8_t> Occupied;
+
+		void Walk(const void* pGrid, const VoxelGridInfo& info, const FLOAT3& origin, const FLOAT3& direction, float tStart, float tEnd)
+		{
+			WalkVoxels(info, origin, direction, tStart, tEnd, &Spans);
+			Voxels.resize(Spans.size());
+			Occupied.resize(Spans.size());
+			for (size_t i = 0; i < Spans.size(); ++i)
+			{
+				Voxels[i] = Spans[i].Voxel;
+			}
+			if (!Spans.empty())
+			{
+				prl::GetVoxelOccupancy(pGrid, Voxels.data(), (int)Voxels.size(), Occupied.data());
+			}
+		}
+	};
+
+	double ElapsedMs(std::chrono::steady_clock::time_point t0)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+	}
+}
+
+bool RunVoxelRayRegression(const char* meshPath)
+{
+	StaticMesh mesh;
+	if (!mesh.LoadFromFile(meshPath, 10.0f))
+	{
+		std::cerr << "[VoxelRay] Fail to load " << meshPath << std::endl;
+		return false;
+	}
+
+	VoxelBudget budget = {};
+	budget.TargetVoxelCount = 1'000'000;
+	VoxelGridInfo info = {};
+	void* pGrid = prl::CreateVoxelGrid(mesh, budget, &info);
+	if (!pGrid)
+	{
+		std::cerr << "[VoxelRay] CreateVoxelGrid failed." << std::endl;
+		return false;
+	}
+	std::cout << "[VoxelRay] grid " << info.Nx << "x" << info.Ny << "x" << info.Nz << " cell " << info.Cell
+		<< ", " << info.OccupiedVoxels << " occupied voxels" << std::endl;
+
+	// 그리드 박스를 감싸는 영역에서 출발해 안쪽 영역을 지나는 레이
+	const FLOAT3 extent{ info.Nx * info.Cell, info.Ny * info.Cell, info.Nz * info.Cell };
+	const FLOAT3 center = info.Origin + extent * 0.5f;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+	auto randomPoint = [&](float scale)
+		{
+			return FLOAT3{ center.x + uniform(rng) * extent.x * scale, center.y + uniform(rng) * extent.y * scale, center.z + uniform(rng) * extent.z * scale };
+		};
+
+	std::vector<VoxelRay> rays(NUM_RAYS);
+	std::vector<FLOAT3> from(NUM_RAYS), to(NUM_RAYS);
+	for (int i = 0; i < NUM_RAYS; ++i)
+	{
+		FLOAT3 a = randomPoint((i % 5 == 0) ? 0.4f : 0.9f);
+		FLOAT3 b = randomPoint(0.3f);
+		if (i % 7 == 0) b.x = a.x;
+		if (i % 11 == 0) b.y = a.y;
+		if (i % 13 == 0) { b.x = a.x; b.z = a.z; }
+		from[i] = a;
+		to[i] = b;
+		rays[i] = { a, b - a, (i % 3 == 0) ? 0.25f : 0.0f, 2.0f };
+	}
+	const float endBias = info.Cell;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<VoxelRayHit> hits(NUM_RAYS);
+	prl::RayFirstHitBatch(pGrid, rays.data(), NUM_RAYS, hits.data());
+	std::vector<float> occupancy(NUM_RAYS);
+	prl::SegmentOccupancyBatch(pGrid, from.data(), to.data(), NUM_RAYS, occupancy.data());
+	std::vector<uint8_t> visible(NUM_RAYS);
+	prl::VisibilityBatch(pGrid, from.data(), to.data(), NUM_RAYS, endBias, visible.data());
+	const double ddaMs = ElapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	int badHit = 0, badOccupancy = 0, badVisible = 0;
+	BruteRay brute;
+	for (int i = 0; i < NUM_RAYS; ++i)
+	{
+		const VoxelRay& ray = rays[i];
+		const float voxelT = info.Cell / std::max(ray.Direction.Magnitude(), 1e-20f);
+		const float tolT = VOXEL_T_TOLERANCE * voxelT;
+
+		// 첫 점유 복셀
+		brute.Walk(pGrid, info, ray.Origin, ray.Direction, ray.TMin, ray.TMax);
+		const VoxelSpan* pFirst = nullptr;
+		for (size_t s = 0; s < brute.Spans.size() && !pFirst; ++s)
+		{
+			if (brute.Occupied[s]) pFirst = &brute.Spans[s];
+		}
+		// 같은 복셀이면 t는 그 복셀 구간 안에만 있으면 된다 (면에 거의 평행하게 들어가면 진입 t의 반올림 오차가 커진다)
+		const VoxelRayHit& hit = hits[i];
+		bool bHitOk = (pFirst != nullptr) == hit.bHit;
+		if (bHitOk && pFirst)
+		{
+			const bool bSameVoxel = hit.Voxel.x == pFirst->Voxel.x && hit.Voxel.y == pFirst->Voxel.y && hit.Voxel.z == pFirst->Voxel.z;
+			bHitOk = bSameVoxel
+				? (hit.T >= pFirst->T0 - tolT && hit.T <= pFirst->T1 + tolT)
+				: std::fabs(pFirst->T0 - hit.T) <= tolT;
+		}
+		if (!bHitOk)
+		{
+			if (badHit < 5)
+			{
+				std::cerr << "[VoxelRay]   ray " << i << ": DDA " << (hit.bHit ? "hit" : "miss") << " t=" << hit.T
+					<< ", brute force " << (pFirst ? "hit" : "miss") << " t=" << (pFirst ? pFirst->T0 : 0.0f) << std::endl;
+			}
+			++badHit;
+		}
+
+		// 선분 점유율 / 가시성 (t ∈ [0, 1])
+		brute.Walk(pGrid, info, from[i], to[i] - from[i], 0.0f, 1.0f);
+		const float len = (to[i] - from[i]).Magnitude();
+		const float tb = (len > 0.0f) ? endBias / len : 1.0f;
+		float occupied = 0.0f;
+		bool bVisible = true;
+		for (size_t s = 0; s < brute.Spans.size(); ++s)
+		{
+			if (!brute.Occupied[s]) continue;
+			const VoxelSpan& span = brute.Spans[s];
+			occupied += span.T1 - span.T0;
+			if (tb < 0.5f && std::min(span.T1, 1.0f - tb) > std::max(span.T0, tb)) bVisible = false;
+		}
+		if (std::fabs(std::min(occupied, 1.0f) - occupancy[i]) > OCCUPANCY_TOLERANCE)
+		{
+			if (badOccupancy < 5)
+			{
+				std::cerr << "[VoxelRay]   segment " << i << ": DDA occupancy " << occupancy[i] << ", brute force " << occupied << std::endl;
+			}
+			++badOccupancy;
+		}
+		if (bVisible != (visible[i] != 0))
+		{
+			++badVisible;
+		}
+	}
+	const double bruteMs = ElapsedMs(start);
+	prl::DeleteVoxelGrid(pGrid);
+
+	std::cout << "[VoxelRay]   " << NUM_RAYS << " rays: first hit " << badHit << ", occupancy " << badOccupancy
+		<< ", visibility " << badVisible << " mismatches" << std::endl;
+	std::cout << "[VoxelRay]   time: DDA " << ddaMs << "ms, brute force " << bruteMs << "ms" << std::endl;
+	const bool bPass = (badHit == 0 && badOccupancy == 0 && badVisible == 0);
+	std::cout << "[VoxelRay] " << (bPass ? "PASS" : "FAIL") << std::endl;
+	return bPass;
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 ﻿// Bakery main.cpp : Defines the entry point for the application.
 #include <iostream>
+#include <string>
+#include <filesystem>
 #include <Windows.h>
 
 #if defined(_MSC_VER) && defined(_DEBUG)
@@ -9,10 +11,12 @@
 
 #include "Common/Common.h"
 #include "Common/StaticMesh.h"
+#include "Common/CookedMesh.h"
 #include "Interface/IPrelight.h"
 #include "Interface/IGeometry.h"
 
 #include "Atmos.h"
+#include "Voxel.h"
 
 HMODULE m_hPrelightDLL = nullptr;
 IPrelight* m_pPrelight = nullptr;
@@ -20,8 +24,44 @@ IPrelight* m_pPrelight = nullptr;
 HMODULE m_hGeometryDLL = nullptr;
 IGeometry* m_pGeometry = nullptr;
 
-int main()
+// Command line (CI):
+//   Bakery --atmos-regression [--record-golden] [--golden-dir <dir>]
+// runs only the atmosphere regression and returns 0 on PASS, 1 on FAIL.
+//   Bakery --voxel-ray-regression
+// does the same for the voxel ray queries (hierarchical DDA vs. a brute-force walk).
+int main(int argc, char* argv[])
 {
+	bool bAtmosRegression = false;
+	bool bVoxelRayRegression = false;
+	bool bRecordGolden = false;
+	std::wstring goldenDir = L"../../Resources/Atmos/Golden";
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg == "--atmos-regression")
+		{
+			bAtmosRegression = true;
+		}
+		else if (arg == "--voxel-ray-regression")
+		{
+			bVoxelRayRegression = true;
+		}
+		else if (arg == "--record-golden")
+		{
+			bRecordGolden = true;
+		}
+		else if (arg == "--golden-dir" && i + 1 < argc)
+		{
+			goldenDir = std::filesystem::path(argv[++i]).wstring();
+		}
+		else
+		{
+			std::cerr << "Unknown argument: " << arg << "\n"
+				<< "Usage: Bakery [--atmos-regression [--record-golden] [--golden-dir <dir>]] [--voxel-ray-regression]" << std::endl;
+			return 2;
+		}
+	}
+
 	// Load Prelight DLL
 	{
 		const WCHAR* wchPrelightFileName = nullptr;
@@ -104,6 +144,30 @@ int main()
 		RunAtmosPrecomputeAndSave();
 	}
 
+	// Weather preset sweep -> preset-stacked LUTs
+	if (false)
+	{
+		RunAtmosPresetSweepAndSave();
+	}
+
+	// Atmosphere bake regression (golden LUT summaries) + per-stage timings
+	if (bAtmosRegression)
+	{
+		const bool bPass = RunAtmosRegression(goldenDir, bRecordGolden);
+		prl::ShutDown();
+		m_pPrelight->Cleanup();
+		return bPass ? 0 : 1;
+	}
+
+	// Voxel ray query regression (hierarchical DDA vs. brute-force walk)
+	if (bVoxelRayRegression)
+	{
+		const bool bPass = RunVoxelRayRegression("../../Resources/Decomp/bunny.off");
+		prl::ShutDown();
+		m_pPrelight->Cleanup();
+		return bPass ? 0 : 1;
+	}
+
 	if (true)
 	{
 		StaticMesh mesh;
@@ -114,7 +178,32 @@ int main()
 			return -1;
 		}
 
-		prl::DecomposeToConvex(mesh);
+		VoxelBudget voxelBudget = {};
+		voxelBudget.TargetVoxelCount = 2'000'000;
+		voxelBudget.MaxBytes = 1ull << 30; // 1GB
+
+		prl::DecomposeToConvex(mesh, voxelBudget);
+	}
+
+	// Cook source meshes to .hmesh (runtime maps them: IRenderer::CreateBasicMeshObject(MappedStaticMesh::GetView()))
+	if (false)
+	{
+		StaticMesh mesh;
+		if (!mesh.LoadFromFile("../../Resources/Decomp/bunny.off", 10.0f) || !CookStaticMesh(L"../../Resources/Decomp/bunny.hmesh", mesh))
+		{
+			ASSERT(false, "Fail to cook mesh file");
+			return -1;
+		}
+	}
+
+	// Out-of-core voxelization of a large scan (binary STL)
+	if (false)
+	{
+		StreamingVoxelDesc streamDesc = {};
+		streamDesc.Cell = 0.005f;
+		streamDesc.MaxResidentBytes = 512ull << 20; // 512MB
+
+		prl::VoxelizeStreaming(L"../../Resources/Decomp/scan.stl", L"../../Resources/Decomp/scan.hvox", streamDesc);
 	}
 
 	// Cleanup
@@ -0,0 +1,288 @@
+﻿#pragma once
+#include <cmath>
+
+// Texel <-> (r, mu, mu_s, nu) mappings of the atmosphere LUTs.
+// Shared by the CPU bake (Prelight/ComputeAtmos.cpp); Shaders/AtmosphericSky.hlsl mirrors the same math.
+// Texel coordinates are continuous indices: integers are texel centers, valid range is [0, n - 1].
+// Differences of squared radii are factored ((r - Rg) * (r + Rg), never r * r - Rg * Rg): at km scale the expanded
+// float form cancels, Rho(Rg) comes out ~1 km instead of 0 and depends on whether the compiler fuses it into an FMA.
+
+enum EAtmosLutMapping : int
+{
+	ATMOS_LUT_MAPPING_UNIFORM = 0,	// r, mu, mu_s, nu linear in [Rg, Rt] / [-1, 1], texel i at (i + 0.5) / n
+	ATMOS_LUT_MAPPING_BRUNETON = 1,	// Bruneton 2017 non-linear mapping, texel i at i / (n - 1)
+};
+
+// Lowest sun zenith cosine stored by the Bruneton mapping (~cos 102 deg). Darker suns clamp to it.
+constexpr float ATMOS_LUT_MU_S_MIN = -0.2f;
+
+struct AtmosLutMapping
+{
+	EAtmosLutMapping Mode;
+	float Rg;		// ground radius
+	float Rt;		// top-of-atmosphere radius
+	float H;		// sqrt(Rt^2 - Rg^2): length of the horizontal ray from the ground to the top boundary
+	float MuSA;		// Bruneton mu_s mapping: unit distance reached at ATMOS_LUT_MU_S_MIN
+
+	AtmosLutMapping(EAtmosLutMapping mode, float rg, float rt) : Mode(mode), Rg(rg), Rt(rt)
+	{
+		H = std::sqrt((Rt - Rg) * (Rt + Rg));
+		MuSA = (DistanceToTop(Rg, ATMOS_LUT_MU_S_MIN) - (Rt - Rg)) / (H - (Rt - Rg));
+	}
+
+	// ---------------- Unit range [0, 1] <-> texel coordinate ----------------
+	inline float ToTexel(float x, int n) const
+	{
+		const float c = (Mode == ATMOS_LUT_MAPPING_BRUNETON) ? x * float(n - 1) : x * float(n) - 0.5f;
+		return Clamp(c, 0.0f, float(n - 1));
+	}
+
+	inline float FromTexel(int i, int n) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			return n > 1 ? float(i) / float(n - 1) : 0.0f;
+		}
+		return (i + 0.5f) / float(n);
+	}
+
+	// ---------------- Ray geometry ----------------
+	inline float DistanceToTop(float r, float mu) const
+	{
+		const float rmu = r * mu;
+		const float disc = rmu * rmu + (Rt - r) * (Rt + r);
+		return Max0(-rmu + std::sqrt(Max0(disc)));
+	}
+
+	inline float DistanceToGround(float r, float mu) const
+	{
+		const float rmu = r * mu;
+		const float disc = rmu * rmu - RhoSq(r);
+		return Max0(-rmu - std::sqrt(Max0(disc)));
+	}
+
+	inline bool RayIntersectsGround(float r, float mu) const
+	{
+		const float rmu = r * mu;
+		return mu < 0.0f && rmu * rmu >= RhoSq(r);
+	}
+
+	// ---------------- Transmittance (x: mu, y: r) ----------------
+	// Bruneton: only rays that reach the top boundary are stored (mu >= horizon).
+	inline void TransmittanceTexelToParams(int i, int j, int w, int h, float* r, float* mu) const
+	{
+		const float xMu = FromTexel(i, w), xR = FromTexel(j, h);
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const float rho = H * xR;
+			*r = RadiusFromRho(rho);
+			const float dMin = Rt - *r, dMax = rho + H;
+			const float d = dMin + xMu * (dMax - dMin);
+			*mu = (d == 0.0f) ? 1.0f : Clamp(((H - rho) * (H + rho) - d * d) / (2.0f * *r * d), -1.0f, 1.0f);
+			return;
+		}
+		*r = Rg + (Rt - Rg) * xR;
+		*mu = -1.0f + 2.0f * xMu;
+	}
+
+	inline void TransmittanceParamsToTexel(float r, float mu, int w, int h, float* x, float* y) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const float rho = Rho(r);
+			const float dMin = Rt - r, dMax = rho + H;
+			*x = ToTexel((DistanceToTop(r, mu) - dMin) / (dMax - dMin), w);
+			*y = ToTexel(rho / H, h);
+			return;
+		}
+		*x = ToTexel((mu + 1.0f) * 0.5f, w);
+		*y = ToTexel((r - Rg) / (Rt - Rg), h);
+	}
+
+	// ---------------- Scattering (r, mu, mu_s, nu) ----------------
+	inline float ScatteringR(int i, int n) const
+	{
+		const float x = FromTexel(i, n);
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			return RadiusFromRho(H * x);
+		}
+		return Rg + (Rt - Rg) * x;
+	}
+
+	inline float ScatteringRToTexel(float r, int n) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			return ToTexel(Rho(r) / H, n);
+		}
+		return ToTexel((r - Rg) / (Rt - Rg), n);
+	}
+
+	// Bruneton: texels [0, n/2) hold rays hitting the ground (horizon -> straight down),
+	// [n/2, n) rays reaching the top boundary (straight up -> horizon).
+	// Both horizon texels share the same mu, so the ray side is returned explicitly.
+	inline float ScatteringMu(float r, int i, int n, bool* rayHitsGround) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const int nGround = n / 2, nSky = n - nGround;
+			const float rho = Rho(r);
+			if (i < nGround)
+			{
+				const float x = nGround > 1 ? float(nGround - 1 - i) / float(nGround - 1) : 0.0f;
+				const float dMin = r - Rg, dMax = rho;
+				const float d = dMin + x * (dMax - dMin);
+				*rayHitsGround = true;
+				return (d == 0.0f) ? -1.0f : Clamp(-(rho * rho + d * d) / (2.0f * r * d), -1.0f, 1.0f);
+			}
+			const float x = nSky > 1 ? float(i - nGround) / float(nSky - 1) : 0.0f;
+			const float dMin = Rt - r, dMax = rho + H;
+			const float d = dMin + x * (dMax - dMin);
+			*rayHitsGround = false;
+			return (d == 0.0f) ? 1.0f : Clamp(((H - rho) * (H + rho) - d * d) / (2.0f * r * d), -1.0f, 1.0f);
+		}
+		const float mu = -1.0f + 2.0f * FromTexel(i, n);
+		*rayHitsGround = RayIntersectsGround(r, mu);
+		return mu;
+	}
+
+	inline float ScatteringMuToTexel(float r, float mu, bool rayHitsGround, int n) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const int nGround = n / 2, nSky = n - nGround;
+			const float rho = Rho(r);
+			const float rmu = r * mu;
+			const float disc = rmu * rmu - RhoSq(r);
+			if (rayHitsGround)
+			{
+				const float d = -rmu - std::sqrt(Max0(disc));
+				const float dMin = r - Rg, dMax = rho;
+				const float x = (dMax == dMin) ? 0.0f : Clamp((d - dMin) / (dMax - dMin), 0.0f, 1.0f);
+				return float(nGround - 1) * (1.0f - x);
+			}
+			const float d = -rmu + std::sqrt(Max0(rmu * rmu + (Rt - r) * (Rt + r)));
+			const float dMin = Rt - r, dMax = rho + H;
+			const float x = Clamp((d - dMin) / (dMax - dMin), 0.0f, 1.0f);
+			return float(nGround) + float(nSky - 1) * x;
+		}
+		return ToTexel((mu + 1.0f) * 0.5f, n);
+	}
+
+	inline float ScatteringMuS(int i, int n) const
+	{
+		const float x = FromTexel(i, n);
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const float dMin = Rt - Rg, dMax = H;
+			const float a = (MuSA - x * MuSA) / (1.0f + x * MuSA);
+			const float d = dMin + (a < MuSA ? a : MuSA) * (dMax - dMin);
+			return (d == 0.0f) ? 1.0f : Clamp((H - d) * (H + d) / (2.0f * Rg * d), -1.0f, 1.0f);
+		}
+		return -1.0f + 2.0f * x;
+	}
+
+	inline float ScatteringMuSToTexel(float muS, int n) const
+	{
+		if (Mode == ATMOS_LUT_MAPPING_BRUNETON)
+		{
+			const float dMin = Rt - Rg, dMax = H;
+			const float a = (DistanceToTop(Rg, muS) - dMin) / (dMax - dMin);
+			return ToTexel(Max0(1.0f - a / MuSA) / (1.0f + a), n);
+		}
+		return ToTexel((muS + 1.0f) * 0.5f, n);
+	}
+
+	inline float ScatteringNu(int i, int n) const { return -1.0f + 2.0f * FromTexel(i, n); }
+	inline float ScatteringNuToTexel(float nu, int n) const { return ToTexel((nu + 1.0f) * 0.5f, n); }
+
+	// ---------------- Irradiance (x: mu_s, y: r), linear in both modes ----------------
+	inline void IrradianceTexelToParams(int i, int j, int w, int h, float* r, float* muS) const
+	{
+		*r = Rg + (Rt - Rg) * FromTexel(j, h);
+		*muS = -1.0f + 2.0f * FromTexel(i, w);
+	}
+
+	inline void IrradianceParamsToTexel(float r, float muS, int w, int h, float* x, float* y) const
+	{
+		*x = ToTexel((muS + 1.0f) * 0.5f, w);
+		*y = ToTexel((r - Rg) / (Rt - Rg), h);
+	}
+
+private:
+	static inline float Clamp(float x, float a, float b) { return x < a ? a : (x > b ? b : x); }
+	static inline float Max0(float x) { return x > 0.0f ? x : 0.0f; }
+	inline float RhoSq(float r) const { return (r - Rg) * (r + Rg); }
+	inline float Rho(float r) const { return std::sqrt(Max0(RhoSq(r))); }
+	// Inverse of Rho in double so that the float radius of a texel rounds the same way on every build
+	inline float RadiusFromRho(float rho) const { return float(std::sqrt(double(rho) * rho + double(Rg) * Rg)); }
+};
+
+// Per-frame sky-view LUT and aerial-perspective volume (Hillaire 2020), built for one camera radius r and sun zenith.
+// Shared by Prelight/AtmosSkyView.cpp; Shaders/AtmosphericSky.hlsl mirrors the same math.
+//  - u: azimuth between view and sun (projected on the horizontal plane), texels packed toward the sun
+//  - v: view zenith, [0, 0.5) sky from zenith to the horizon, [0.5, 1] ground from the horizon to nadir,
+//       texels packed quadratically toward the horizon on both sides
+//  - aerial slices: slice k ends at distance MaxDistance * ((k + 1) / D)^2 (dense near the camera)
+// Unit coordinates map to texels as i / (n - 1).
+struct AtmosSkyViewMapping
+{
+	float Beta;					// angle between the horizon and nadir: acos(sqrt(r^2 - Rg^2) / r)
+	float ZenithHorizonAngle;	// view zenith angle of the horizon: pi - Beta
+
+	AtmosSkyViewMapping(float rg, float r)
+	{
+		const float rr = r > rg ? r : rg;
+		Beta = std::acos(Clamp(std::sqrt((rr - rg) * (rr + rg)) / rr, -1.0f, 1.0f));
+		ZenithHorizonAngle = 3.14159265358979f - Beta;
+	}
+
+	inline void UVToView(float u, float v, float* viewZenithCos, float* lightViewCos) const
+	{
+		float zenith;
+		if (v < 0.5f)
+		{
+			const float c = 1.0f - 2.0f * v;
+			zenith = ZenithHorizonAngle * (1.0f - c * c);
+		}
+		else
+		{
+			const float c = 2.0f * v - 1.0f;
+			zenith = ZenithHorizonAngle + Beta * c * c;
+		}
+		*viewZenithCos = std::cos(zenith);
+		*lightViewCos = 1.0f - 2.0f * u * u;
+	}
+
+	inline void ViewToUV(float viewZenithCos, float lightViewCos, bool rayHitsGround, float* u, float* v) const
+	{
+		const float zenith = std::acos(Clamp(viewZenithCos, -1.0f, 1.0f));
+		if (!rayHitsGround)
+		{
+			const float c = Clamp(zenith / ZenithHorizonAngle, 0.0f, 1.0f);
+			*v = 0.5f * (1.0f - std::sqrt(1.0f - c));
+		}
+		else
+		{
+			const float c = Clamp((zenith - ZenithHorizonAngle) / Beta, 0.0f, 1.0f);
+			*v = 0.5f + 0.5f * std::sqrt(c);
+		}
+		*u = std::sqrt(Clamp(0.5f - 0.5f * lightViewCos, 0.0f, 1.0f));
+	}
+
+	static inline float AerialSliceDistance(int k, int numSlices, float maxDistance)
+	{
+		const float x = float(k + 1) / float(numSlices);
+		return maxDistance * x * x;
+	}
+
+	// Continuous slice coordinate of a distance (slice k ends at k). Distances before the first slice end are < 0.
+	static inline float AerialDistanceToSlice(float d, int numSlices, float maxDistance)
+	{
+		return float(numSlices) * std::sqrt(Clamp(d / maxDistance, 0.0f, 1.0f)) - 1.0f;
+	}
+
+private:
+	static inline float Clamp(float x, float a, float b) { return x < a ? a : (x > b ? b : x); }
+};
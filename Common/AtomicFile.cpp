@@ -0,0 +1,74 @@
+﻿#include "AtomicFile.h"
+
+bool AtomicFileWriter::Open(const std::filesystem::path& target)
+{
+	Discard();
+
+	std::error_code ec;
+	std::filesystem::create_directories(target.parent_path(), ec);
+
+	m_Target = target;
+	m_Temp = target;
+	m_Temp += L".tmp" + std::to_wstring(GetCurrentProcessId());
+	m_File.open(m_Temp, std::ios::binary | std::ios::trunc);
+	if (!m_File)
+	{
+		Discard();
+		return false;
+	}
+	return true;
+}
+
+void AtomicFileWriter::Write(const void* data, size_t bytes)
+{
+	m_File.write(reinterpret_cast<const char*>(data), (std::streamsize)bytes);
+}
+
+void AtomicFileWriter::WriteAt(uint64_t offset, const void* data, size_t bytes)
+{
+	static const char zeros[16] = {};
+	const uint64_t pos = (uint64_t)m_File.tellp();
+	ASSERT(offset >= pos, "WriteAt cannot move backwards.");
+	for (uint64_t pad = offset - pos; pad > 0; )
+	{
+		const uint64_t n = pad < sizeof(zeros) ? pad : sizeof(zeros);
+		m_File.write(zeros, (std::streamsize)n);
+		pad -= n;
+	}
+	Write(data, bytes);
+}
+
+bool AtomicFileWriter::Commit()
+{
+	if (m_Temp.empty())
+	{
+		return false;
+	}
+	m_File.flush();
+	const bool bWritten = bool(m_File);
+	m_File.close();
+	if (!bWritten || !MoveFileExW(m_Temp.wstring().c_str(), m_Target.wstring().c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		Discard();
+		return false;
+	}
+	m_Temp.clear();
+	m_Target.clear();
+	return true;
+}
+
+void AtomicFileWriter::Discard()
+{
+	if (m_File.is_open())
+	{
+		m_File.close();
+	}
+	m_File.clear();
+	if (!m_Temp.empty())
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_Temp, ec);
+		m_Temp.clear();
+	}
+	m_Target.clear();
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include "Common/Common.h"
+
+// Writes a file under a per-process temp name next to the target and swaps it in on Commit(),
+// so a reader (or a memory mapping of the old file) never sees a half-written file.
+// Two processes building the same file each write their own temp file; the last Commit() wins.
+class AtomicFileWriter
+{
+public:
+	AtomicFileWriter() = default;
+	AtomicFileWriter(const AtomicFileWriter&) = delete;
+	AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+	~AtomicFileWriter() { Discard(); }
+
+	// Creates the parent directory when missing.
+	bool Open(const std::filesystem::path& target);
+
+	void Write(const void* data, size_t bytes);
+
+	// Zero-fills from the current position up to offset, then writes. offset must not be behind the current position.
+	void WriteAt(uint64_t offset, const void* data, size_t bytes);
+
+	// Replaces the target with everything written so far. On any write or rename failure the temp file is removed,
+	// the target is left as it was and false is returned.
+	bool Commit();
+	void Discard();
+
+private:
+	std::ofstream m_File;
+	std::filesystem::path m_Target;
+	std::filesystem::path m_Temp;
+};
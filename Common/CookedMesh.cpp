@@ -0,0 +1,296 @@
+﻿#include <cstring>
+#include <limits>
+#include <string>
+
+#include "StaticMesh.h"
+#include "CookedMesh.h"
+#include "AtomicFile.h"
+
+namespace
+{
+	constexpr uint64_t AlignUp16(uint64_t x) { return (x + 15) & ~15ull; }
+
+	// EHMeshTexture order
+	Image* GetTextureSlot(Material& material, int slot)
+	{
+		Image* images[HMESH_TEXTURE_COUNT] = { &material.Diffuse, &material.Normal, &material.Specular, &material.Metallic, &material.Roughness };
+		return images[slot];
+	}
+	const Image* GetTextureSlot(const Material& material, int slot) { return GetTextureSlot(const_cast<Material&>(material), slot); }
+
+	HMeshBounds ToFileBounds(const Bounds& b)
+	{
+		return { { b.Min.x, b.Min.y, b.Min.z }, { b.Max.x, b.Max.y, b.Max.z } };
+	}
+
+	Bounds FromFileBounds(const HMeshBounds& b)
+	{
+		return Bounds(FVector3(b.Min[0], b.Min[1], b.Min[2]), FVector3(b.Max[0], b.Max[1], b.Max[2]));
+	}
+
+	// Array at [offset, offset + bytes) lies inside the file after the header and keeps the 16-byte alignment
+	bool IsValidBlock(uint64_t offset, uint64_t bytes, uint64_t fileSize)
+	{
+		return offset >= sizeof(HMeshFileHeader) && offset % 16 == 0 && offset <= fileSize && bytes <= fileSize - offset;
+	}
+}
+
+// ---------------- Cook ----------------
+bool CookStaticMesh(const std::filesystem::path& path, const StaticMesh& mesh)
+{
+	const size_t numVertices = mesh.Positions.size();
+	if (numVertices > std::numeric_limits<uint32_t>::max() || mesh.Sections.size() > std::numeric_limits<uint32_t>::max())
+	{
+		return false;
+	}
+
+	std::error_code ec;
+	const std::filesystem::path target = std::filesystem::absolute(path, ec);
+	if (ec)
+	{
+		return false;
+	}
+	const std::filesystem::path baseDir = target.parent_path();
+
+	HMeshFileHeader header = {};
+	header.Magic = HMeshFileHeader::MAGIC;
+	header.Version = HMeshFileHeader::VERSION;
+	header.NumVertices = (uint32_t)numVertices;
+	header.NumSections = (uint32_t)mesh.Sections.size();
+	header.MeshBounds = ToFileBounds(mesh.MeshBounds);
+
+	// Optional arrays are cooked only when they cover every vertex
+	auto hasArray = [numVertices](size_t count) { return numVertices > 0 && count == numVertices; };
+	uint64_t cursor = AlignUp16(sizeof(HMeshFileHeader));
+	header.SectionsOffset = cursor;
+	cursor = AlignUp16(cursor + mesh.Sections.size() * sizeof(HMeshSection));
+	auto place = [&cursor](bool bPresent, uint64_t bytes) -> uint64_t
+	{
+		if (!bPresent)
+		{
+			return 0;
+		}
+		const uint64_t offset = cursor;
+		cursor = AlignUp16(cursor + bytes);
+		return offset;
+	};
+	header.PositionsOffset = place(numVertices > 0, numVertices * sizeof(FVector3));
+	header.NormalsOffset = place(hasArray(mesh.Normals.size()), numVertices * sizeof(FVector3));
+	header.TangentsOffset = place(hasArray(mesh.Tangents.size()), numVertices * sizeof(FVector3));
+	header.UVsOffset = place(hasArray(mesh.UVs.size()), numVertices * sizeof(FVector2));
+	header.ColorsOffset = place(hasArray(mesh.Colors.size()), numVertices * sizeof(FVector3));
+
+	std::vector<HMeshSection> sections(mesh.Sections.size(), HMeshSection{});
+	std::vector<std::vector<uint16_t>> narrowedIndices(mesh.Sections.size());
+	std::string strings;
+	for (size_t i = 0; i < mesh.Sections.size(); ++i)
+	{
+		const MeshSection& src = mesh.Sections[i];
+		HMeshSection& dst = sections[i];
+		if (src.Indices.size() > std::numeric_limits<uint32_t>::max())
+		{
+			return false;
+		}
+		dst.NumIndices = (uint32_t)src.Indices.size();
+		dst.IndexSizeInBytes = src.GetIndexSizeInBytes();
+		dst.LocalBounds = ToFileBounds(src.LocalBounds);
+		dst.IndicesOffset = place(true, uint64_t(dst.NumIndices) * dst.IndexSizeInBytes);
+		if (dst.IndexSizeInBytes == sizeof(uint16_t))
+		{
+			narrowedIndices[i].assign(src.Indices.begin(), src.Indices.end());
+		}
+
+		for (int t = 0; t < HMESH_TEXTURE_COUNT; ++t)
+		{
+			dst.Textures[t] = HMeshSection::NO_TEXTURE;
+			const std::filesystem::path& sourcePath = GetTextureSlot(src.Material, t)->SourcePath;
+			if (sourcePath.empty())
+			{
+				continue;
+			}
+			const std::filesystem::path relPath = std::filesystem::proximate(std::filesystem::absolute(sourcePath, ec), baseDir, ec);
+			const std::u8string utf8 = (ec ? sourcePath : relPath).generic_u8string();
+			dst.Textures[t] = (uint32_t)strings.size();
+			strings.append(reinterpret_cast<const char*>(utf8.data()), utf8.size());
+			strings.push_back('\0');
+		}
+	}
+	header.StringsSize = strings.size();
+	header.StringsOffset = place(!strings.empty(), strings.size());
+	header.FileSize = cursor;
+
+	// Readers may be mapping the previous cook; swap the new file in only once it is complete
+	AtomicFileWriter file;
+	if (!file.Open(target))
+	{
+		return false;
+	}
+	file.Write(&header, sizeof(header));
+	file.WriteAt(header.SectionsOffset, sections.data(), sections.size() * sizeof(HMeshSection));
+	if (header.PositionsOffset) file.WriteAt(header.PositionsOffset, mesh.Positions.data(), numVertices * sizeof(FVector3));
+	if (header.NormalsOffset) file.WriteAt(header.NormalsOffset, mesh.Normals.data(), numVertices * sizeof(FVector3));
+	if (header.TangentsOffset) file.WriteAt(header.TangentsOffset, mesh.Tangents.data(), numVertices * sizeof(FVector3));
+	if (header.UVsOffset) file.WriteAt(header.UVsOffset, mesh.UVs.data(), numVertices * sizeof(FVector2));
+	if (header.ColorsOffset) file.WriteAt(header.ColorsOffset, mesh.Colors.data(), numVertices * sizeof(FVector3));
+	for (size_t i = 0; i < sections.size(); ++i)
+	{
+		const void* indices = sections[i].IndexSizeInBytes == sizeof(uint16_t) ? (const void*)narrowedIndices[i].data() : (const void*)mesh.Sections[i].Indices.data();
+		file.WriteAt(sections[i].IndicesOffset, indices, size_t(sections[i].NumIndices) * sections[i].IndexSizeInBytes);
+	}
+	if (header.StringsOffset) file.WriteAt(header.StringsOffset, strings.data(), strings.size());
+	// Trailing padding so FileSize matches the 16-byte aligned cursor
+	file.WriteAt(header.FileSize, nullptr, 0);
+	return file.Commit();
+}
+
+// ---------------- Load (mapped) ----------------
+bool MappedStaticMesh::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	if (!m_File.Open(path))
+	{
+		return false;
+	}
+	const uint8_t* base = m_File.GetData();
+	const uint64_t fileSize = m_File.GetSize();
+
+	HMeshFileHeader h = {};
+	bool bValid = fileSize >= sizeof(HMeshFileHeader);
+	if (bValid)
+	{
+		memcpy(&h, base, sizeof(h));
+		const uint64_t v = h.NumVertices;
+		auto isValidArray = [&](uint64_t offset, uint64_t elementSize) { return offset == 0 || IsValidBlock(offset, v * elementSize, fileSize); };
+		bValid = h.Magic == HMeshFileHeader::MAGIC && h.Version == HMeshFileHeader::VERSION && h.FileSize == fileSize
+			&& (h.PositionsOffset != 0 || v == 0)
+			&& isValidArray(h.PositionsOffset, sizeof(FVector3))
+			&& isValidArray(h.NormalsOffset, sizeof(FVector3))
+			&& isValidArray(h.TangentsOffset, sizeof(FVector3))
+			&& isValidArray(h.UVsOffset, sizeof(FVector2))
+			&& isValidArray(h.ColorsOffset, sizeof(FVector3))
+			&& IsValidBlock(h.SectionsOffset, uint64_t(h.NumSections) * sizeof(HMeshSection), fileSize)
+			&& (h.StringsSize == 0 || (IsValidBlock(h.StringsOffset, h.StringsSize, fileSize) && base[h.StringsOffset + h.StringsSize - 1] == '\0'));
+	}
+	if (bValid)
+	{
+		const std::filesystem::path baseDir = path.parent_path();
+		const HMeshSection* sections = reinterpret_cast<const HMeshSection*>(base + h.SectionsOffset);
+		m_View.Sections.resize(h.NumSections);
+		for (uint32_t i = 0; i < h.NumSections && bValid; ++i)
+		{
+			const HMeshSection& src = sections[i];
+			bValid = (src.IndexSizeInBytes == sizeof(uint16_t) || src.IndexSizeInBytes == sizeof(uint32_t)) && src.NumIndices % 3 == 0
+				&& IsValidBlock(src.IndicesOffset, uint64_t(src.NumIndices) * src.IndexSizeInBytes, fileSize);
+
+			StaticMeshViewSection& dst = m_View.Sections[i];
+			dst.Indices = base + src.IndicesOffset;
+			dst.NumIndices = src.NumIndices;
+			dst.IndexSizeInBytes = src.IndexSizeInBytes;
+			dst.LocalBounds = FromFileBounds(src.LocalBounds);
+			for (int t = 0; t < HMESH_TEXTURE_COUNT && bValid; ++t)
+			{
+				if (src.Textures[t] == HMeshSection::NO_TEXTURE)
+				{
+					continue;
+				}
+				bValid = src.Textures[t] < h.StringsSize;
+				if (bValid)
+				{
+					const char* utf8 = reinterpret_cast<const char*>(base + h.StringsOffset + src.Textures[t]);
+					dst.Textures[t] = baseDir / std::filesystem::path(std::u8string(reinterpret_cast<const char8_t*>(utf8)));
+				}
+			}
+		}
+	}
+	if (!bValid)
+	{
+		std::fprintf(stderr, "[StaticMesh] Cooked mesh: ignoring stale or damaged file: %s\n", path.string().c_str());
+		Close();
+		return false;
+	}
+
+	// Index values are not range-checked against NumVertices; the cooker is trusted like any other baked asset
+	auto arrayAt = [base](uint64_t offset) { return offset ? base + offset : nullptr; };
+	m_View.NumVertices = h.NumVertices;
+	m_View.Positions = reinterpret_cast<const FVector3*>(arrayAt(h.PositionsOffset));
+	m_View.Normals = reinterpret_cast<const FVector3*>(arrayAt(h.NormalsOffset));
+	m_View.Tangents = reinterpret_cast<const FVector3*>(arrayAt(h.TangentsOffset));
+	m_View.UVs = reinterpret_cast<const FVector2*>(arrayAt(h.UVsOffset));
+	m_View.Colors = reinterpret_cast<const FVector3*>(arrayAt(h.ColorsOffset));
+	m_View.MeshBounds = FromFileBounds(h.MeshBounds);
+	return true;
+}
+
+void MappedStaticMesh::Close()
+{
+	m_File.Close();
+	m_View = {};
+}
+
+// ---------------- View ----------------
+std::vector<Vertex> StaticMeshView::GetVertexArray() const
+{
+	std::vector<Vertex> out(NumVertices);
+	for (uint32_t i = 0; i < NumVertices; i++)
+	{
+		out[i].Position = Positions[i];
+		out[i].Normal = Normals ? Normals[i] : FLOAT3(0.0f, 0.0f, 0.0f);
+		out[i].TexCoord = UVs ? UVs[i] : FLOAT2(0.0f, 0.0f);
+		out[i].Tangent = Tangents ? Tangents[i] : FLOAT3(0.0f, 0.0f, 0.0f);
+	}
+	return out;
+}
+
+void StaticMeshView::CopyTo(StaticMesh* outMesh) const
+{
+	ASSERT(outMesh, "Output mesh is null.");
+
+	auto copyArray = [this](const auto* src, auto& dst)
+	{
+		if (src)
+		{
+			dst.assign(src, src + NumVertices);
+		}
+		else
+		{
+			dst.clear();
+		}
+	};
+	copyArray(Positions, outMesh->Positions);
+	copyArray(Normals, outMesh->Normals);
+	copyArray(Tangents, outMesh->Tangents);
+	copyArray(UVs, outMesh->UVs);
+	copyArray(Colors, outMesh->Colors);
+	outMesh->MeshBounds = MeshBounds;
+
+	outMesh->Sections.clear();
+	outMesh->Sections.resize(Sections.size());
+	for (size_t i = 0; i < Sections.size(); ++i)
+	{
+		const StaticMeshViewSection& src = Sections[i];
+		MeshSection& dst = outMesh->Sections[i];
+		if (src.IndexSizeInBytes == sizeof(uint16_t))
+		{
+			const uint16_t* indices = static_cast<const uint16_t*>(src.Indices);
+			dst.Indices.assign(indices, indices + src.NumIndices);
+		}
+		else
+		{
+			const uint32_t* indices = static_cast<const uint32_t*>(src.Indices);
+			dst.Indices.assign(indices, indices + src.NumIndices);
+		}
+		dst.LocalBounds = src.LocalBounds;
+		for (int t = 0; t < HMESH_TEXTURE_COUNT; ++t)
+		{
+			Image* image = GetTextureSlot(dst.Material, t);
+			if (src.Textures[t].empty())
+			{
+				continue;
+			}
+			// The path is kept even when decoding fails so a re-cook still references the texture
+			LoadExternalTexture({}, src.Textures[t].string(), *image);
+			image->SourcePath = src.Textures[t];
+		}
+	}
+}
@@ -0,0 +1,127 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <type_traits>
+#include <vector>
+#include "Common/Common.h"
+#include "Common/Vertex.h"
+#include "Common/MappedFile.h"
+
+struct StaticMesh;
+
+// Cooked StaticMesh (.hmesh). Bakery imports a source asset once and writes this; the runtime maps the file
+// and points straight into it, so loading is an open + header check instead of an Assimp / stb_image import.
+// [HMeshFileHeader][HMeshSection x NumSections][Positions][Normals][Tangents][UVs][Colors][indices of each section][strings]
+// Arrays are stored exactly as they sit in memory (little endian, FVector3 = 3 floats) and start on 16-byte boundaries.
+// The file structs are plain data (no member initializers, no Bounds/FVector3 members) so they can be memcpy'd from the
+// mapping; writers zero-initialize them.
+enum EHMeshTexture
+{
+	HMESH_TEXTURE_DIFFUSE = 0,
+	HMESH_TEXTURE_NORMAL,
+	HMESH_TEXTURE_SPECULAR,
+	HMESH_TEXTURE_METALLIC,
+	HMESH_TEXTURE_ROUGHNESS,
+	HMESH_TEXTURE_COUNT
+};
+
+// Same layout as Bounds
+struct HMeshBounds
+{
+	float Min[3];
+	float Max[3];
+};
+
+struct HMeshFileHeader
+{
+	static constexpr uint32_t MAGIC = 0x48534D48; // 'HMSH'
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t NumVertices;
+	uint32_t NumSections;
+	HMeshBounds MeshBounds;
+
+	uint64_t PositionsOffset;	// Byte offsets from the start of the file. 0 = the mesh has no such array
+	uint64_t NormalsOffset;
+	uint64_t TangentsOffset;
+	uint64_t UVsOffset;
+	uint64_t ColorsOffset;
+	uint64_t SectionsOffset;
+	uint64_t StringsOffset;		// Zero-terminated UTF-8 strings referenced by HMeshSection::Textures
+	uint64_t StringsSize;
+	uint64_t FileSize;
+};
+static_assert(sizeof(HMeshFileHeader) == 112, "HMeshFileHeader layout changed. Bump VERSION.");
+static_assert(std::is_trivially_copyable_v<HMeshFileHeader>, "HMeshFileHeader is memcpy'd from the mapping.");
+
+struct HMeshSection
+{
+	static constexpr uint32_t NO_TEXTURE = 0xFFFFFFFF;
+
+	uint64_t IndicesOffset;
+	uint32_t NumIndices;
+	uint32_t IndexSizeInBytes;	// 2 when every index of the section fits uint16_t, otherwise 4
+	HMeshBounds LocalBounds;
+	uint32_t Textures[HMESH_TEXTURE_COUNT];	// String table offsets of texture paths relative to the .hmesh, or NO_TEXTURE
+	uint32_t _pad0;
+};
+static_assert(sizeof(HMeshSection) == 64, "HMeshSection layout changed. Bump VERSION.");
+static_assert(std::is_trivially_copyable_v<HMeshSection>, "HMeshSection is read in place from the mapping.");
+
+// Materials are stored by reference: external textures keep their source path (Image::SourcePath) and are loaded
+// by the consumer. Embedded or generated images have no file to point at and are not cooked.
+bool CookStaticMesh(const std::filesystem::path& path, const StaticMesh& mesh);
+
+struct StaticMeshViewSection
+{
+	const void* Indices = nullptr;	// uint16_t or uint32_t, see IndexSizeInBytes
+	uint32_t NumIndices = 0;
+	uint32_t IndexSizeInBytes = 0;
+	Bounds LocalBounds;
+	std::filesystem::path Textures[HMESH_TEXTURE_COUNT];	// Resolved against the .hmesh directory. Empty when none
+
+	uint32_t GetIndex(size_t i) const { return IndexSizeInBytes == sizeof(uint16_t) ? ((const uint16_t*)Indices)[i] : ((const uint32_t*)Indices)[i]; }
+};
+
+// Non-owning view of a mesh. Pointers are null for arrays the mesh does not have.
+struct StaticMeshView
+{
+	uint32_t NumVertices = 0;
+	const FVector3* Positions = nullptr;
+	const FVector3* Normals = nullptr;
+	const FVector3* Tangents = nullptr;
+	const FVector2* UVs = nullptr;
+	const FVector3* Colors = nullptr;
+	Bounds MeshBounds;
+
+	std::vector<StaticMeshViewSection> Sections;
+
+	std::vector<Vertex> GetVertexArray() const;
+
+	// Deep copy for code that needs an owning StaticMesh (Prelight, editing). Textures are decoded from their paths
+	// (LoadExternalTexture); a missing texture warns and leaves an empty Image that still carries SourcePath.
+	// For drawing, pass the view to IRenderer::CreateBasicMeshObject instead; it loads textures on its own.
+	void CopyTo(StaticMesh* outMesh) const;
+};
+
+// Read-only mapping of a .hmesh. GetView() points into the mapping and stays valid until Close() or destruction.
+class MappedStaticMesh
+{
+public:
+	MappedStaticMesh() = default;
+	MappedStaticMesh(const MappedStaticMesh&) = delete;
+	MappedStaticMesh& operator=(const MappedStaticMesh&) = delete;
+	~MappedStaticMesh() { Close(); }
+
+	// False for missing files and for files from another VERSION or with a damaged layout.
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	const StaticMeshView& GetView() const { return m_View; }
+
+private:
+	MappedFile m_File;
+	StaticMeshView m_View;
+};
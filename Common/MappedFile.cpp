@@ -0,0 +1,36 @@
+﻿#include "MappedFile.h"
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	m_File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+	m_Size = (uint64_t)size.QuadPart;
+
+	m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	m_View = m_Mapping ? MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!m_View)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_View) { UnmapViewOfFile(m_View); m_View = nullptr; }
+	if (m_Mapping) { CloseHandle(m_Mapping); m_Mapping = nullptr; }
+	if (m_File != INVALID_HANDLE_VALUE) { CloseHandle(m_File); m_File = INVALID_HANDLE_VALUE; }
+	m_Size = 0;
+}
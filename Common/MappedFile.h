@@ -0,0 +1,29 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include "Common/Common.h"
+
+// Read-only mapping of a whole file (Win32 file mapping).
+// The view stays valid until Close() or destruction; callers can parse or point into it without copying.
+// Opened with FILE_SHARE_DELETE so AtomicFileWriter can swap in a new version while a reader still maps the old one.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { Close(); }
+
+	// Fails for missing or empty files (an empty file cannot be mapped).
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	const uint8_t* GetData() const { return static_cast<const uint8_t*>(m_View); }
+	uint64_t GetSize() const { return m_Size; }
+
+private:
+	HANDLE m_File = INVALID_HANDLE_VALUE;
+	HANDLE m_Mapping = nullptr;
+	const void* m_View = nullptr;
+	uint64_t m_Size = 0;
+};
@@ -0,0 +1,989 @@
+﻿#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <limits>
+
+#include "MeshFileParser.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "StaticMesh.h"
+
+// Text bodies are cut into line-aligned chunks of at least MIN_CHUNK_BYTES, a few per thread so that
+// chunks with long face lines do not leave the other workers idle.
+static constexpr size_t MIN_CHUNK_BYTES = 256 * 1024;
+static constexpr int CHUNKS_PER_THREAD = 4;
+static constexpr size_t PLY_BINARY_VERTICES_PER_JOB = 64 * 1024;
+
+struct TextRange
+{
+	const char* Begin;
+	const char* End;
+};
+
+// Per-chunk output. Each chunk writes only its own entry; chunks are merged in file order afterwards,
+// so the triangle order does not depend on the thread count.
+struct ChunkResult
+{
+	size_t NumRecords = 0;		// data lines (OFF / ascii PLY)
+	size_t NumVertices = 0;		// 'v' lines (OBJ)
+	std::vector<uint32_t> Triangles;
+	EMeshParseResult Result = MESH_PARSE_OK;
+};
+
+// -----------------------------
+// Scanning helpers
+// -----------------------------
+static inline bool IsBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool IsDelimiter(const char* p, const char* end)
+{
+	return p >= end || IsBlank(*p) || *p == '\n';
+}
+
+static inline const char* SkipBlanks(const char* p, const char* end)
+{
+	while (p < end && IsBlank(*p))
+	{
+		++p;
+	}
+	return p;
+}
+
+static inline const char* SkipToken(const char* p, const char* end)
+{
+	while (!IsDelimiter(p, end))
+	{
+		++p;
+	}
+	return p;
+}
+
+static inline const char* FindLineEnd(const char* p, const char* end)
+{
+	const void* nl = std::memchr(p, '\n', size_t(end - p));
+	return nl ? static_cast<const char*>(nl) : end;
+}
+
+// Blank lines and '#' comments carry no record
+static inline bool IsDataLine(const char* lineBegin, const char* lineEnd)
+{
+	const char* p = SkipBlanks(lineBegin, lineEnd);
+	return p < lineEnd && *p != '#';
+}
+
+static std::vector<TextRange> SplitLines(const char* begin, const char* end, int numThreads)
+{
+	const size_t size = size_t(end - begin);
+	const size_t target = std::max(MIN_CHUNK_BYTES, size / (size_t(numThreads) * CHUNKS_PER_THREAD) + 1);
+
+	std::vector<TextRange> chunks;
+	for (const char* p = begin; p < end;)
+	{
+		const char* q = end;
+		if (size_t(end - p) > target)
+		{
+			q = FindLineEnd(p + target, end);
+			q = (q < end) ? q + 1 : end;
+		}
+		chunks.push_back({ p, q });
+		p = q;
+	}
+	return chunks;
+}
+
+// Reads the next non-empty, non-comment line and advances p past it (header parsing only)
+static bool NextDataLine(const char*& p, const char* end, TextRange& outLine)
+{
+	while (p < end)
+	{
+		const char* lineEnd = FindLineEnd(p, end);
+		const bool bData = IsDataLine(p, lineEnd);
+		outLine = { SkipBlanks(p, lineEnd), lineEnd };
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+		if (bData)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static std::string_view NextWord(const char*& p, const char* end)
+{
+	p = SkipBlanks(p, end);
+	const char* begin = p;
+	p = SkipToken(p, end);
+	return std::string_view(begin, size_t(p - begin));
+}
+
+// -----------------------------
+// Number parsing
+// -----------------------------
+static const float POW10F[11] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+// Decimal → float, correctly rounded (same bits as strtof).
+// Fast path: a mantissa of at most 2^24 and a power of ten up to 1e10 are both exact floats,
+// so one multiply / divide gives the correctly rounded result. Everything else goes through std::from_chars.
+static bool ParseFloat(const char*& p, const char* end, float& out)
+{
+	p = SkipBlanks(p, end);
+	const char* start = p;
+
+	bool bNegative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		bNegative = (*p == '-');
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int numDigits = 0;
+	int exp10 = 0;
+	bool bExact = true;
+	bool bAnyDigit = false;
+	for (; p < end && unsigned(*p - '0') < 10u; ++p)
+	{
+		bAnyDigit = true;
+		if (numDigits < 19)
+		{
+			mantissa = mantissa * 10 + unsigned(*p - '0');
+			numDigits += (mantissa != 0);
+		}
+		else
+		{
+			bExact = false;
+		}
+	}
+	if (p < end && *p == '.')
+	{
+		for (++p; p < end && unsigned(*p - '0') < 10u; ++p)
+		{
+			bAnyDigit = true;
+			if (numDigits < 19)
+			{
+				mantissa = mantissa * 10 + unsigned(*p - '0');
+				numDigits += (mantissa != 0);
+				--exp10;
+			}
+			else
+			{
+				bExact = false;
+			}
+		}
+	}
+	if (bAnyDigit && p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* e = p + 1;
+		bool bNegativeExp = false;
+		if (e < end && (*e == '-' || *e == '+'))
+		{
+			bNegativeExp = (*e == '-');
+			++e;
+		}
+		if (e < end && unsigned(*e - '0') < 10u)
+		{
+			int value = 0;
+			for (; e < end && unsigned(*e - '0') < 10u; ++e)
+			{
+				value = std::min(value * 10 + int(*e - '0'), 100000);
+			}
+			exp10 += bNegativeExp ? -value : value;
+			p = e;
+		}
+	}
+
+	if (bAnyDigit && bExact && IsDelimiter(p, end) && mantissa <= (1u << 24) && exp10 >= -10 && exp10 <= 10)
+	{
+		float value = float(mantissa);
+		value = (exp10 < 0) ? value / POW10F[-exp10] : value * POW10F[exp10];
+		out = bNegative ? -value : value;
+		return true;
+	}
+
+	// from_chars does not take a leading '+'
+	const char* first = (start < end && *start == '+') ? start + 1 : start;
+	const std::from_chars_result result = std::from_chars(first, end, out);
+	p = result.ptr;
+	return result.ec == std::errc() && IsDelimiter(p, end);
+}
+
+static bool ParseInt(const char*& p, const char* end, int64_t& out)
+{
+	p = SkipBlanks(p, end);
+	bool bNegative = false;
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		bNegative = (*p == '-');
+		++p;
+	}
+	if (p >= end || unsigned(*p - '0') >= 10u)
+	{
+		return false;
+	}
+	int64_t value = 0;
+	for (; p < end && unsigned(*p - '0') < 10u; ++p)
+	{
+		if (value > (std::numeric_limits<int64_t>::max() - 9) / 10)
+		{
+			return false;
+		}
+		value = value * 10 + int64_t(*p - '0');
+	}
+	out = bNegative ? -value : value;
+	return true;
+}
+
+// Fan triangulation (v0, v[k-1], v[k]) one corner at a time, no per-polygon buffer
+struct FanBuilder
+{
+	int64_t First = -1;
+	int64_t Previous = -1;
+	int NumCorners = 0;
+
+	bool Add(int64_t index, int64_t numVertices, std::vector<uint32_t>& triangles)
+	{
+		if (index < 0 || index >= numVertices)
+		{
+			return false;
+		}
+		if (NumCorners == 0)
+		{
+			First = index;
+		}
+		else if (NumCorners >= 2)
+		{
+			triangles.push_back(uint32_t(First));
+			triangles.push_back(uint32_t(Previous));
+			triangles.push_back(uint32_t(index));
+		}
+		Previous = index;
+		++NumCorners;
+		return true;
+	}
+};
+
+// -----------------------------
+// Record-per-line bodies (OFF, ascii PLY): numVertices vertex lines followed by numFaces face lines
+// -----------------------------
+template<class VertexFn, class FaceFn>
+static EMeshParseResult ParseTextRecords(
+	const char* begin, const char* end,
+	size_t numVertices, size_t numFaces, int numThreads,
+	const VertexFn& parseVertex, const FaceFn& parseFace,
+	std::vector<FVector3>& outPositions, std::vector<ChunkResult>& outChunks)
+{
+	const std::vector<TextRange> chunks = SplitLines(begin, end, numThreads);
+	const int numChunks = int(chunks.size());
+	outChunks.assign(chunks.size(), ChunkResult());
+
+	// Pass 1: records per chunk → global record index of each chunk's first line
+	ParallelFor(numChunks, numThreads, [&](int c)
+		{
+			size_t count = 0;
+			for (const char* p = chunks[c].Begin; p < chunks[c].End;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunks[c].End);
+				count += IsDataLine(p, lineEnd);
+				p = lineEnd + 1;
+			}
+			outChunks[c].NumRecords = count;
+		});
+
+	std::vector<size_t> firstRecord(chunks.size());
+	size_t numRecords = 0;
+	for (int c = 0; c < numChunks; ++c)
+	{
+		firstRecord[c] = numRecords;
+		numRecords += outChunks[c].NumRecords;
+	}
+	if (numRecords < numVertices + numFaces)
+	{
+		std::fprintf(stderr, "[StaticMesh] Truncated mesh file: %zu of %zu records\n", numRecords, numVertices + numFaces);
+		return MESH_PARSE_FAILED;
+	}
+
+	outPositions.resize(numVertices);
+
+	// Pass 2: vertices straight into the position array, faces into the chunk's triangle list
+	ParallelFor(numChunks, numThreads, [&](int c)
+		{
+			ChunkResult& chunk = outChunks[c];
+			size_t record = firstRecord[c];
+			for (const char* p = chunks[c].Begin; p < chunks[c].End && record < numVertices + numFaces;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunks[c].End);
+				if (IsDataLine(p, lineEnd))
+				{
+					const bool bOk = (record < numVertices)
+						? parseVertex(p, lineEnd, outPositions[record])
+						: parseFace(p, lineEnd, chunk.Triangles);
+					if (!bOk)
+					{
+						chunk.Result = MESH_PARSE_FAILED;
+						return;
+					}
+					++record;
+				}
+				p = lineEnd + 1;
+			}
+		});
+	return MESH_PARSE_OK;
+}
+
+// -----------------------------
+// OFF
+// -----------------------------
+static EMeshParseResult ParseOFF(const char* begin, const char* end, int numThreads,
+	std::vector<FVector3>& outPositions, std::vector<ChunkResult>& outChunks)
+{
+	const char* p = begin;
+	TextRange line;
+	if (!NextDataLine(p, end, line))
+	{
+		return MESH_PARSE_FAILED;
+	}
+
+	// [ST][C][N]OFF. 4OFF / nOFF (other dimensions) and "OFF BINARY" are left to Assimp
+	const char* cursor = line.Begin;
+	const std::string_view keyword = NextWord(cursor, line.End);
+	if (keyword.size() < 3 || keyword.substr(keyword.size() - 3) != "OFF" ||
+		keyword.substr(0, keyword.size() - 3).find_first_not_of("STCN") != std::string_view::npos)
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+
+	const char* rest = SkipBlanks(cursor, line.End);
+	if (std::string_view(rest, size_t(line.End - rest)).starts_with("BINARY"))
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+
+	// Counts may follow the keyword on the same line
+	if (rest >= line.End || *rest == '#')
+	{
+		if (!NextDataLine(p, end, line))
+		{
+			return MESH_PARSE_FAILED;
+		}
+		rest = line.Begin;
+	}
+	int64_t counts[3] = {};
+	for (int64_t& count : counts)
+	{
+		if (!ParseInt(rest, line.End, count) || count < 0)
+		{
+			return MESH_PARSE_FAILED;
+		}
+	}
+	// Every vertex line takes at least 6 bytes; rejects absurd counts before allocating
+	const size_t numVertices = size_t(counts[0]);
+	const size_t numFaces = size_t(counts[1]);
+	if (numVertices > size_t(end - p) / 6 || numFaces > size_t(end - p) / 6)
+	{
+		return MESH_PARSE_FAILED;
+	}
+
+	auto parseVertex = [](const char* s, const char* e, FVector3& outPosition)
+		{
+			return ParseFloat(s, e, outPosition.x) && ParseFloat(s, e, outPosition.y) && ParseFloat(s, e, outPosition.z);
+		};
+	auto parseFace = [numVertices](const char* s, const char* e, std::vector<uint32_t>& triangles)
+		{
+			int64_t numCorners = 0;
+			if (!ParseInt(s, e, numCorners) || numCorners < 0)
+			{
+				return false;
+			}
+			FanBuilder fan;
+			for (int64_t k = 0; k < numCorners; ++k)
+			{
+				int64_t index = 0;
+				if (!ParseInt(s, e, index) || !fan.Add(index, int64_t(numVertices), triangles))
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+	return ParseTextRecords(p, end, numVertices, numFaces, numThreads, parseVertex, parseFace, outPositions, outChunks);
+}
+
+// -----------------------------
+// PLY
+// -----------------------------
+enum EPlyType
+{
+	PLY_INT8,
+	PLY_UINT8,
+	PLY_INT16,
+	PLY_UINT16,
+	PLY_INT32,
+	PLY_UINT32,
+	PLY_FLOAT32,
+	PLY_FLOAT64,
+	PLY_INVALID,
+};
+
+struct PlyProperty
+{
+	std::string_view Name;
+	EPlyType Type = PLY_INVALID;
+	EPlyType CountType = PLY_INVALID;	// list properties only
+	bool bList = false;
+};
+
+struct PlyElement
+{
+	std::string_view Name;
+	size_t Count = 0;
+	std::vector<PlyProperty> Properties;
+};
+
+static EPlyType ParsePlyType(std::string_view name)
+{
+	if (name == "char" || name == "int8") return PLY_INT8;
+	if (name == "uchar" || name == "uint8") return PLY_UINT8;
+	if (name == "short" || name == "int16") return PLY_INT16;
+	if (name == "ushort" || name == "uint16") return PLY_UINT16;
+	if (name == "int" || name == "int32") return PLY_INT32;
+	if (name == "uint" || name == "uint32") return PLY_UINT32;
+	if (name == "float" || name == "float32") return PLY_FLOAT32;
+	if (name == "double" || name == "float64") return PLY_FLOAT64;
+	return PLY_INVALID;
+}
+
+static size_t PlyTypeSize(EPlyType type)
+{
+	static const size_t SIZES[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+	return SIZES[type];
+}
+
+// Little-endian value at an arbitrary (unaligned) address
+static double ReadPlyValue(const uint8_t* p, EPlyType type)
+{
+	switch (type)
+	{
+	case PLY_INT8: { int8_t v; std::memcpy(&v, p, 1); return v; }
+	case PLY_UINT8: { uint8_t v; std::memcpy(&v, p, 1); return v; }
+	case PLY_INT16: { int16_t v; std::memcpy(&v, p, 2); return v; }
+	case PLY_UINT16: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+	case PLY_INT32: { int32_t v; std::memcpy(&v, p, 4); return v; }
+	case PLY_UINT32: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+	case PLY_FLOAT32: { float v; std::memcpy(&v, p, 4); return v; }
+	case PLY_FLOAT64: { double v; std::memcpy(&v, p, 8); return v; }
+	default: return 0.0;
+	}
+}
+
+static bool IsPlyIndexList(const PlyProperty& prop)
+{
+	return prop.bList && (prop.Name == "vertex_indices" || prop.Name == "vertex_index");
+}
+
+static EMeshParseResult ParsePLY(const char* begin, const char* end, int numThreads,
+	std::vector<FVector3>& outPositions, std::vector<ChunkResult>& outChunks)
+{
+	// Header
+	const char* p = begin;
+	std::vector<PlyElement> elements;
+	bool bAscii = false;
+	bool bHeaderEnd = false;
+	bool bFirstLine = true;
+	while (p < end && !bHeaderEnd)
+	{
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* cursor = p;
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+
+		const std::string_view word = NextWord(cursor, lineEnd);
+		if (bFirstLine)
+		{
+			if (word != "ply")
+			{
+				return MESH_PARSE_FAILED;
+			}
+			bFirstLine = false;
+		}
+		else if (word == "format")
+		{
+			const std::string_view format = NextWord(cursor, lineEnd);
+			if (format == "ascii")
+			{
+				bAscii = true;
+			}
+			else if (format != "binary_little_endian")
+			{
+				return MESH_PARSE_UNSUPPORTED;
+			}
+		}
+		else if (word == "element")
+		{
+			PlyElement element;
+			element.Name = NextWord(cursor, lineEnd);
+			int64_t count = 0;
+			if (!ParseInt(cursor, lineEnd, count) || count < 0)
+			{
+				return MESH_PARSE_FAILED;
+			}
+			element.Count = size_t(count);
+			elements.push_back(element);
+		}
+		else if (word == "property")
+		{
+			if (elements.empty())
+			{
+				return MESH_PARSE_FAILED;
+			}
+			PlyProperty prop;
+			std::string_view type = NextWord(cursor, lineEnd);
+			if (type == "list")
+			{
+				prop.bList = true;
+				prop.CountType = ParsePlyType(NextWord(cursor, lineEnd));
+				type = NextWord(cursor, lineEnd);
+				if (prop.CountType == PLY_INVALID || prop.CountType >= PLY_FLOAT32)
+				{
+					return MESH_PARSE_FAILED;
+				}
+			}
+			prop.Type = ParsePlyType(type);
+			prop.Name = NextWord(cursor, lineEnd);
+			if (prop.Type == PLY_INVALID)
+			{
+				return MESH_PARSE_FAILED;
+			}
+			elements.back().Properties.push_back(prop);
+		}
+		else if (word == "end_header")
+		{
+			bHeaderEnd = true;
+		}
+		else if (word != "comment" && word != "obj_info" && !word.empty())
+		{
+			return MESH_PARSE_FAILED;
+		}
+	}
+	if (!bHeaderEnd)
+	{
+		return MESH_PARSE_FAILED;
+	}
+
+	// Only "vertex" (scalar x, y, z) followed by "face" (an index list); trailing elements such as edges are ignored
+	if (elements.size() < 2 || elements[0].Name != "vertex" || elements[1].Name != "face")
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+	const PlyElement& vertexElement = elements[0];
+	const PlyElement& faceElement = elements[1];
+
+	int xyz[3] = { -1, -1, -1 };
+	for (int i = 0; i < int(vertexElement.Properties.size()); ++i)
+	{
+		const PlyProperty& prop = vertexElement.Properties[i];
+		if (prop.bList)
+		{
+			return MESH_PARSE_UNSUPPORTED;
+		}
+		if (prop.Name.size() == 1 && prop.Name[0] >= 'x' && prop.Name[0] <= 'z')
+		{
+			xyz[prop.Name[0] - 'x'] = i;
+		}
+	}
+	int indexList = -1;
+	for (int i = 0; i < int(faceElement.Properties.size()); ++i)
+	{
+		if (IsPlyIndexList(faceElement.Properties[i]))
+		{
+			indexList = i;
+		}
+	}
+	if (xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0 || indexList < 0)
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+
+	const size_t numVertices = vertexElement.Count;
+	const size_t numFaces = faceElement.Count;
+
+	if (bAscii)
+	{
+		if (numVertices > size_t(end - p) / 6 || numFaces > size_t(end - p) / 6)
+		{
+			return MESH_PARSE_FAILED;
+		}
+
+		auto parseVertex = [&](const char* s, const char* e, FVector3& outPosition)
+			{
+				for (int i = 0; i < int(vertexElement.Properties.size()); ++i)
+				{
+					float value = 0.0f;
+					if (!ParseFloat(s, e, value))
+					{
+						return false;
+					}
+					if (i == xyz[0]) outPosition.x = value;
+					if (i == xyz[1]) outPosition.y = value;
+					if (i == xyz[2]) outPosition.z = value;
+				}
+				return true;
+			};
+		auto parseFace = [&](const char* s, const char* e, std::vector<uint32_t>& triangles)
+			{
+				for (int i = 0; i < int(faceElement.Properties.size()); ++i)
+				{
+					if (!faceElement.Properties[i].bList)
+					{
+						float ignored = 0.0f;
+						if (!ParseFloat(s, e, ignored))
+						{
+							return false;
+						}
+						continue;
+					}
+					int64_t numItems = 0;
+					if (!ParseInt(s, e, numItems) || numItems < 0)
+					{
+						return false;
+					}
+					FanBuilder fan;
+					for (int64_t k = 0; k < numItems; ++k)
+					{
+						if (i != indexList)
+						{
+							float ignored = 0.0f;
+							if (!ParseFloat(s, e, ignored))
+							{
+								return false;
+							}
+							continue;
+						}
+						int64_t index = 0;
+						if (!ParseInt(s, e, index) || !fan.Add(index, int64_t(numVertices), triangles))
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			};
+		return ParseTextRecords(p, end, numVertices, numFaces, numThreads, parseVertex, parseFace, outPositions, outChunks);
+	}
+
+	// binary_little_endian: vertices have a fixed stride and are converted in parallel blocks
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(p);
+	const size_t dataSize = size_t(end - p);
+
+	size_t stride = 0;
+	size_t offsets[3] = {};
+	for (int i = 0; i < int(vertexElement.Properties.size()); ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			if (i == xyz[c]) offsets[c] = stride;
+		}
+		stride += PlyTypeSize(vertexElement.Properties[i].Type);
+	}
+	if (numVertices > dataSize / stride)
+	{
+		std::fprintf(stderr, "[StaticMesh] Truncated PLY vertex data\n");
+		return MESH_PARSE_FAILED;
+	}
+
+	outPositions.resize(numVertices);
+	const EPlyType types[3] = { vertexElement.Properties[xyz[0]].Type, vertexElement.Properties[xyz[1]].Type, vertexElement.Properties[xyz[2]].Type };
+	const int numJobs = int((numVertices + PLY_BINARY_VERTICES_PER_JOB - 1) / PLY_BINARY_VERTICES_PER_JOB);
+	ParallelFor(numJobs, numThreads, [&](int job)
+		{
+			const size_t first = size_t(job) * PLY_BINARY_VERTICES_PER_JOB;
+			const size_t last = std::min(first + PLY_BINARY_VERTICES_PER_JOB, numVertices);
+			for (size_t v = first; v < last; ++v)
+			{
+				const uint8_t* record = data + v * stride;
+				outPositions[v] = FVector3(
+					float(ReadPlyValue(record + offsets[0], types[0])),
+					float(ReadPlyValue(record + offsets[1], types[1])),
+					float(ReadPlyValue(record + offsets[2], types[2])));
+			}
+		});
+
+	// Faces are variable-length records; their start offsets are only known after reading the previous one
+	outChunks.assign(1, ChunkResult());
+	std::vector<uint32_t>& triangles = outChunks[0].Triangles;
+	triangles.reserve(numFaces * 3);
+	size_t offset = numVertices * stride;
+	for (size_t f = 0; f < numFaces; ++f)
+	{
+		for (int i = 0; i < int(faceElement.Properties.size()); ++i)
+		{
+			const PlyProperty& prop = faceElement.Properties[i];
+			if (!prop.bList)
+			{
+				offset += PlyTypeSize(prop.Type);
+				continue;
+			}
+			const size_t countSize = PlyTypeSize(prop.CountType);
+			if (offset + countSize > dataSize)
+			{
+				std::fprintf(stderr, "[StaticMesh] Truncated PLY face data\n");
+				return MESH_PARSE_FAILED;
+			}
+			const size_t numItems = size_t(ReadPlyValue(data + offset, prop.CountType));
+			const size_t itemSize = PlyTypeSize(prop.Type);
+			offset += countSize;
+			if (numItems > (dataSize - offset) / itemSize)
+			{
+				std::fprintf(stderr, "[StaticMesh] Truncated PLY face data\n");
+				return MESH_PARSE_FAILED;
+			}
+			if (i == indexList)
+			{
+				FanBuilder fan;
+				for (size_t k = 0; k < numItems; ++k)
+				{
+					if (!fan.Add(int64_t(ReadPlyValue(data + offset + k * itemSize, prop.Type)), int64_t(numVertices), triangles))
+					{
+						return MESH_PARSE_FAILED;
+					}
+				}
+			}
+			offset += numItems * itemSize;
+		}
+	}
+	if (offset > dataSize)
+	{
+		std::fprintf(stderr, "[StaticMesh] Truncated PLY face data\n");
+		return MESH_PARSE_FAILED;
+	}
+	return MESH_PARSE_OK;
+}
+
+// -----------------------------
+// OBJ (positions and faces only)
+// -----------------------------
+enum EObjLine
+{
+	OBJ_LINE_IGNORED,
+	OBJ_LINE_VERTEX,
+	OBJ_LINE_FACE,
+	OBJ_LINE_UNSUPPORTED,
+};
+
+// Groups, objects and smoothing groups do not change a single-section, position-only mesh.
+// Anything carrying attributes or materials (vt, vn, usemtl, mtllib, ...) or other primitives goes to Assimp.
+static EObjLine ClassifyObjLine(const char*& p, const char* lineEnd)
+{
+	p = SkipBlanks(p, lineEnd);
+	if (p >= lineEnd || *p == '#')
+	{
+		return OBJ_LINE_IGNORED;
+	}
+	const std::string_view word = NextWord(p, lineEnd);
+	if (word == "v") return OBJ_LINE_VERTEX;
+	if (word == "f") return OBJ_LINE_FACE;
+	if (word == "o" || word == "g" || word == "s") return OBJ_LINE_IGNORED;
+	return OBJ_LINE_UNSUPPORTED;
+}
+
+static EMeshParseResult ParseOBJ(const char* begin, const char* end, int numThreads,
+	std::vector<FVector3>& outPositions, std::vector<ChunkResult>& outChunks)
+{
+	const std::vector<TextRange> chunks = SplitLines(begin, end, numThreads);
+	const int numChunks = int(chunks.size());
+	outChunks.assign(chunks.size(), ChunkResult());
+
+	// Pass 1: 'v' lines per chunk (negative face indices are relative to the vertices defined so far)
+	ParallelFor(numChunks, numThreads, [&](int c)
+		{
+			ChunkResult& chunk = outChunks[c];
+			for (const char* p = chunks[c].Begin; p < chunks[c].End;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunks[c].End);
+				const EObjLine type = ClassifyObjLine(p, lineEnd);
+				if (type == OBJ_LINE_UNSUPPORTED)
+				{
+					chunk.Result = MESH_PARSE_UNSUPPORTED;
+					return;
+				}
+				chunk.NumVertices += (type == OBJ_LINE_VERTEX);
+				p = lineEnd + 1;
+			}
+		});
+
+	std::vector<size_t> firstVertex(chunks.size());
+	size_t numVertices = 0;
+	for (int c = 0; c < numChunks; ++c)
+	{
+		if (outChunks[c].Result != MESH_PARSE_OK)
+		{
+			return outChunks[c].Result;
+		}
+		firstVertex[c] = numVertices;
+		numVertices += outChunks[c].NumVertices;
+	}
+	outPositions.resize(numVertices);
+
+	// Pass 2
+	ParallelFor(numChunks, numThreads, [&](int c)
+		{
+			ChunkResult& chunk = outChunks[c];
+			size_t vertex = firstVertex[c];
+			for (const char* p = chunks[c].Begin; p < chunks[c].End;)
+			{
+				const char* lineEnd = FindLineEnd(p, chunks[c].End);
+				const EObjLine type = ClassifyObjLine(p, lineEnd);
+				bool bOk = true;
+				if (type == OBJ_LINE_VERTEX)
+				{
+					// Optional w / vertex color components after x y z are ignored
+					FVector3& position = outPositions[vertex++];
+					bOk = ParseFloat(p, lineEnd, position.x) && ParseFloat(p, lineEnd, position.y) && ParseFloat(p, lineEnd, position.z);
+				}
+				else if (type == OBJ_LINE_FACE)
+				{
+					FanBuilder fan;
+					for (p = SkipBlanks(p, lineEnd); bOk && p < lineEnd && *p != '#'; p = SkipBlanks(p, lineEnd))
+					{
+						// "v", "v/vt", "v//vn", "v/vt/vn": only the position index is used
+						int64_t index = 0;
+						bOk = ParseInt(p, lineEnd, index) && index != 0;
+						index = (index > 0) ? index - 1 : int64_t(vertex) + index;
+						bOk = bOk && fan.Add(index, int64_t(numVertices), chunk.Triangles);
+						p = SkipToken(p, lineEnd);
+					}
+				}
+				if (!bOk)
+				{
+					chunk.Result = MESH_PARSE_FAILED;
+					return;
+				}
+				p = lineEnd + 1;
+			}
+		});
+	return MESH_PARSE_OK;
+}
+
+// -----------------------------
+// Mesh assembly
+// -----------------------------
+static EMeshParseResult BuildMesh(std::vector<FVector3>& positions, const std::vector<ChunkResult>& chunks, float scale, StaticMesh* outMesh)
+{
+	size_t numIndices = 0;
+	for (const ChunkResult& chunk : chunks)
+	{
+		if (chunk.Result != MESH_PARSE_OK)
+		{
+			return chunk.Result;
+		}
+		numIndices += chunk.Triangles.size();
+	}
+	if (numIndices == 0)
+	{
+		std::fprintf(stderr, "[StaticMesh] Mesh file has no triangles\n");
+		return MESH_PARSE_FAILED;
+	}
+	if (positions.size() >= std::numeric_limits<uint32_t>::max())
+	{
+		std::fprintf(stderr, "[StaticMesh] Too many vertices for uint32 indices: %zu\n", positions.size());
+		return MESH_PARSE_FAILED;
+	}
+
+	// Drop vertices no triangle references (EndCreate cannot give them a normal), keeping the file order
+	const uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> remap(positions.size(), UNUSED);
+	for (const ChunkResult& chunk : chunks)
+	{
+		for (uint32_t index : chunk.Triangles)
+		{
+			remap[index] = 0;
+		}
+	}
+	uint32_t numUsed = 0;
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		if (remap[i] != UNUSED)
+		{
+			remap[i] = numUsed;
+			positions[numUsed++] = positions[i] * scale;
+		}
+	}
+	positions.resize(numUsed);
+
+	MeshSection section = {};
+	section.Indices.resize(numIndices);
+	size_t w = 0;
+	for (const ChunkResult& chunk : chunks)
+	{
+		for (uint32_t index : chunk.Triangles)
+		{
+			section.Indices[w++] = remap[index];
+		}
+	}
+	for (const FVector3& position : positions)
+	{
+		section.LocalBounds.Encapsulate(position);
+	}
+
+	outMesh->Positions = std::move(positions);
+	outMesh->Normals.clear();
+	outMesh->Tangents.clear();
+	outMesh->UVs.clear();
+	outMesh->Colors.clear();
+	outMesh->Sections.clear();
+	outMesh->MeshBounds = section.LocalBounds;
+	outMesh->Sections.emplace_back(std::move(section));
+
+	outMesh->EndCreate();
+	return MESH_PARSE_OK;
+}
+
+EMeshParseResult LoadMeshFileNative(const std::filesystem::path& path, float scale, int numThreads, StaticMesh* outMesh)
+{
+	ASSERT(outMesh, "Output mesh is null.");
+
+	std::wstring ext = path.extension().wstring();
+	for (wchar_t& ch : ext)
+	{
+		ch = (ch >= L'A' && ch <= L'Z') ? wchar_t(ch - L'A' + L'a') : ch;
+	}
+	if (ext != L".off" && ext != L".obj" && ext != L".ply")
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		return MESH_PARSE_UNSUPPORTED;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.GetData());
+	const char* end = begin + file.GetSize();
+	numThreads = ResolveThreadCount(numThreads);
+
+	std::vector<FVector3> positions;
+	std::vector<ChunkResult> chunks;
+	EMeshParseResult result;
+	if (ext == L".off")
+	{
+		result = ParseOFF(begin, end, numThreads, positions, chunks);
+	}
+	else if (ext == L".ply")
+	{
+		result = ParsePLY(begin, end, numThreads, positions, chunks);
+	}
+	else
+	{
+		result = ParseOBJ(begin, end, numThreads, positions, chunks);
+	}
+	if (result != MESH_PARSE_OK)
+	{
+		return result;
+	}
+	return BuildMesh(positions, chunks, scale, outMesh);
+}
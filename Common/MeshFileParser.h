@@ -0,0 +1,21 @@
+﻿#pragma once
+#include <filesystem>
+
+struct StaticMesh;
+
+// Native loaders for plain scan formats, bypassing Assimp:
+//  - OFF / COFF / NOFF (per-vertex colors and normals are ignored)
+//  - OBJ with positions and faces only (files with vt / vn / materials are left to Assimp)
+//  - PLY, ascii or binary_little_endian, with x/y/z vertices and a vertex_indices face list
+// The file is memory-mapped. Text bodies are split into line-aligned chunks that are parsed in parallel straight
+// into the mesh arrays (binary PLY vertices are split by record instead).
+// Polygons are fan-triangulated, unreferenced vertices are dropped and the result is a single section without material.
+enum EMeshParseResult
+{
+	MESH_PARSE_OK = 0,
+	MESH_PARSE_UNSUPPORTED,	// Not a format / feature set handled here. Fall back to Assimp.
+	MESH_PARSE_FAILED,		// Malformed file or a mesh StaticMesh cannot hold.
+};
+
+// numThreads: 0 = all hardware threads. On MESH_PARSE_OK the mesh is complete (EndCreate has run).
+EMeshParseResult LoadMeshFileNative(const std::filesystem::path& path, float scale, int numThreads, StaticMesh* outMesh);
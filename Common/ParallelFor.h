@@ -0,0 +1,165 @@
+﻿#pragma once
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// Workers pull jobs [0, count) one at a time from an atomic counter.
+// Each job writes only its own output, so results are bit-identical regardless of thread count or schedule order.
+// Threads are created and joined per call (meant for coarse units such as one bake stage). Work that runs every
+// frame should use a WorkerPool instead: thread creation alone costs on the order of a millisecond per call.
+template<class Fn>
+inline void ParallelFor(int count, int numThreads, const Fn& fn)
+{
+	numThreads = (numThreads < count ? numThreads : count);
+	if (numThreads <= 1)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			fn(i);
+		}
+		return;
+	}
+
+	std::atomic<int> next{ 0 };
+	auto worker = [&]()
+		{
+			for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+			{
+				fn(i);
+			}
+		};
+
+	std::vector<std::thread> threads;
+	threads.reserve((size_t)numThreads - 1);
+	for (int t = 1; t < numThreads; ++t)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& th : threads)
+	{
+		th.join();
+	}
+}
+
+// Persistent workers with the same contract as ParallelFor: Run() hands out jobs [0, count) from an atomic counter,
+// the calling thread takes jobs as well, and Run() returns when every job is done. Workers sleep between calls.
+// One Run() at a time; fn must not call Run() on the same pool.
+class WorkerPool
+{
+public:
+	// numThreads includes the calling thread, so numThreads - 1 workers are created.
+	explicit WorkerPool(int numThreads)
+	{
+		for (int t = 1; t < numThreads; ++t)
+		{
+			m_Threads.emplace_back([this]() { workerLoop(); });
+		}
+	}
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_bQuit = true;
+		}
+		m_WakeCV.notify_all();
+		for (std::thread& th : m_Threads)
+		{
+			th.join();
+		}
+	}
+
+	int GetNumThreads() const { return (int)m_Threads.size() + 1; }
+
+	template<class Fn>
+	void Run(int count, const Fn& fn)
+	{
+		if (m_Threads.empty() || count <= 1)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				fn(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_pFn = &fn;
+			m_pInvoke = [](const void* pFn, int i) { (*(const Fn*)pFn)(i); };
+			m_Count = count;
+			m_Next.store(0);
+			m_Busy = (int)m_Threads.size();
+			++m_Generation;
+		}
+		m_WakeCV.notify_all();
+		drain();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCV.wait(lock, [this]() { return m_Busy == 0; });
+		m_pFn = nullptr;
+	}
+
+private:
+	void drain()
+	{
+		for (int i = m_Next.fetch_add(1); i < m_Count; i = m_Next.fetch_add(1))
+		{
+			m_pInvoke(m_pFn, i);
+		}
+	}
+
+	void workerLoop()
+	{
+		uint64_t seen = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WakeCV.wait(lock, [&]() { return m_bQuit || m_Generation != seen; });
+				if (m_bQuit)
+				{
+					return;
+				}
+				seen = m_Generation;
+			}
+			drain();
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (--m_Busy == 0)
+				{
+					m_DoneCV.notify_one();
+				}
+			}
+		}
+	}
+
+	std::vector<std::thread> m_Threads;
+	std::mutex m_Mutex;
+	std::condition_variable m_WakeCV;
+	std::condition_variable m_DoneCV;
+	uint64_t m_Generation = 0;
+	bool m_bQuit = false;
+	int m_Busy = 0;
+
+	const void* m_pFn = nullptr;
+	void (*m_pInvoke)(const void*, int) = nullptr;
+	int m_Count = 0;
+	std::atomic<int> m_Next{ 0 };
+};
+
+// 0 (or negative) = all hardware threads
+inline int ResolveThreadCount(int requested)
+{
+	if (requested > 0)
+	{
+		return requested;
+	}
+	const unsigned int hw = std::thread::hardware_concurrency();
+	return hw > 0 ? (int)hw : 1;
+}
@@ -12,6 +12,20 @@
 #include <assimp/postprocess.h>
 
 #include "StaticMesh.h"
+#include "MeshFileParser.h"
+#include "CookedMesh.h"
+
+uint32_t GetIndexSizeInBytes(const uint32_t* indices, size_t numIndices)
+{
+	for (size_t i = 0; i < numIndices; ++i)
+	{
+		if (indices[i] > std::numeric_limits<uint16_t>::max())
+		{
+			return sizeof(uint32_t);
+		}
+	}
+	return sizeof(uint16_t);
+}
 
 void StaticMesh::BeginCreate(
 	const std::vector<FVector3>& vertices,
@@ -40,12 +54,12 @@ void StaticMesh::BeginCreate(
 	}
 }
 
-void StaticMesh::InsertSection(const std::vector<uint16_t> indices, const Material&& material)
+void StaticMesh::InsertSection(const std::vector<uint32_t> indices, const Material&& material)
 {
 	MeshSection section;
 	section.Indices = indices;
 	section.Material = material;
-	for (uint16_t index : indices)
+	for (uint32_t index : indices)
 	{
 		if (index < Positions.size())
 		{
@@ -66,9 +80,9 @@ void StaticMesh::EndCreate()
 		{
 			for (size_t i = 0; i < section.Indices.size(); i += 3)
 			{
-				uint16_t i0 = section.Indices[i];
-				uint16_t i1 = section.Indices[i + 1];
-				uint16_t i2 = section.Indices[i + 2];
+				uint32_t i0 = section.Indices[i];
+				uint32_t i1 = section.Indices[i + 1];
+				uint32_t i2 = section.Indices[i + 2];
 				if (i0 < Positions.size() && i1 < Positions.size() && i2 < Positions.size())
 				{
 					FVector3 v0 = Positions[i0];
@@ -97,9 +111,9 @@ void StaticMesh::EndCreate()
 		{
 			for (size_t i = 0; i < section.Indices.size(); i += 3)
 			{
-				uint16_t i0 = section.Indices[i];
-				uint16_t i1 = section.Indices[i + 1];
-				uint16_t i2 = section.Indices[i + 2];
+				uint32_t i0 = section.Indices[i];
+				uint32_t i1 = section.Indices[i + 1];
+				uint32_t i2 = section.Indices[i + 2];
 				if (i0 < Positions.size() && i1 < Positions.size() && i2 < Positions.size() &&
 					i0 < UVs.size() && i1 < UVs.size() && i2 < UVs.size())
 				{
@@ -189,6 +203,7 @@ bool LoadExternalTexture(
 
 	FillImageRGBA(outImg, w, h, pixels);
 	stbi_image_free(pixels);
+	outImg.SourcePath = full;
 
 	return true;
 }
@@ -313,6 +328,41 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 		return false;
 	}
 
+	// 쿠킹된 메시는 매핑해서 그대로 복사 (임포트 / 후처리 없음). 텍스처는 CopyTo가 SourcePath에서 디코딩한다
+	if (std::filesystem::path(filename).extension() == ".hmesh")
+	{
+		MappedStaticMesh cooked;
+		if (!cooked.Open(filename))
+		{
+			return false;
+		}
+		cooked.GetView().CopyTo(this);
+		if (scale != 1.0f)
+		{
+			for (FVector3& p : Positions)
+			{
+				p = p * scale;
+			}
+			MeshBounds = Bounds(MeshBounds.Min * scale, MeshBounds.Max * scale);
+			for (MeshSection& section : Sections)
+			{
+				section.LocalBounds = Bounds(section.LocalBounds.Min * scale, section.LocalBounds.Max * scale);
+			}
+		}
+		return true;
+	}
+
+	// 위치와 면만 있는 OFF / OBJ / PLY는 Assimp 없이 직접 파싱 (mmap + 멀티스레드)
+	const EMeshParseResult nativeResult = LoadMeshFileNative(filename, scale, 0, this);
+	if (nativeResult == MESH_PARSE_OK)
+	{
+		return true;
+	}
+	if (nativeResult == MESH_PARSE_FAILED)
+	{
+		std::fprintf(stderr, "[StaticMesh] Native parser failed, falling back to Assimp: %s\n", filename);
+	}
+
 	Assimp::Importer importer;
 
 	// 기본 파이프라인: 삼각형화, 중복 정점 머지, (필요시) UV flip 등
@@ -328,7 +378,7 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 		return false;
 	}
 
-	// 정점/면 수 합산 및 16bit 인덱스 가드
+	// 정점/면 수 합산 및 32bit 인덱스 가드 (GPU 인덱스 버퍼는 섹션마다 16bit에 들어가면 16bit로 만든다)
 	size_t totalVerts = 0;
 	size_t totalFaces = 0;
 	for (unsigned mi = 0; mi < scene->mNumMeshes; ++mi)
@@ -337,9 +387,9 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 		totalVerts += m->mNumVertices;
 		totalFaces += m->mNumFaces; // triangles
 	}
-	if (totalVerts > std::numeric_limits<uint16_t>::max())
+	if (totalVerts > std::numeric_limits<uint32_t>::max())
 	{
-		std::fprintf(stderr, "[StaticMesh] Too many vertices for uint16 indices: %zu\n", totalVerts);
+		std::fprintf(stderr, "[StaticMesh] Too many vertices for uint32 indices: %zu\n", totalVerts);
 		return false;
 	}
 
@@ -360,7 +410,7 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 	const std::filesystem::path modelPath(filename);
 	const std::filesystem::path modelDir = modelPath.parent_path();
 
-	uint16_t base = 0;
+	uint32_t base = 0;
 	Sections.reserve(scene->mNumMeshes);
 
 	// 미리 normals/tangents/uv/colors 벡터 사이즈는 “필요해지면” 한번만 잡는다
@@ -436,9 +486,9 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 			const aiFace& f = m->mFaces[fi]; // Triangulate → 3
 			const uint32_t w = fi * 3u;
 
-			uint16_t i0 = static_cast<uint16_t>(base + f.mIndices[0]);
-			uint16_t i1 = static_cast<uint16_t>(base + f.mIndices[1]);
-			uint16_t i2 = static_cast<uint16_t>(base + f.mIndices[2]);
+			uint32_t i0 = base + f.mIndices[0];
+			uint32_t i1 = base + f.mIndices[1];
+			uint32_t i2 = base + f.mIndices[2];
 
 			sec.Indices[w + 0] = i0;
 			sec.Indices[w + 1] = i1;
@@ -467,7 +517,7 @@ bool StaticMesh::LoadFromFile(const char* filename, float scale)
 
 		Sections.emplace_back(std::move(sec));
 
-		base = static_cast<uint16_t>(base + nv);
+		base += nv;
 	}
 
 	MeshBounds = totalBounds;
@@ -550,7 +600,7 @@ StaticMesh StaticMesh::CreateBoxMesh(float width, float height, float depth)
 	positions[23] = { +ex,-ey,+ez }; uvs[23] = { 1,0 }; normals[23] = { 0,-1,0 }; tangents[23] = { +1,0,0 };
 
 	// 36 indices
-	std::vector<uint16_t> indices(36);
+	std::vector<uint32_t> indices(36);
 	// Front
 	indices[0] = 0;  indices[1] = 1;  indices[2] = 2;
 	indices[3] = 0;  indices[4] = 2;  indices[5] = 3;
@@ -614,16 +664,16 @@ StaticMesh StaticMesh::CreateSphereMesh(float radius, int segments, int rings)
 	}
 
 	const int I = segments * rings * 6;
-	std::vector<uint16_t> indices(I);
+	std::vector<uint32_t> indices(I);
 	int w = 0;
 	for (int r = 0; r < rings; ++r)
 	{
 		for (int c = 0; c < segments; ++c)
 		{
-			uint16_t i0 = uint16_t(r * ncols + c);
-			uint16_t i1 = uint16_t(r * ncols + (c + 1));
-			uint16_t i2 = uint16_t((r + 1) * ncols + (c + 1));
-			uint16_t i3 = uint16_t((r + 1) * ncols + c);
+			uint32_t i0 = uint32_t(r * ncols + c);
+			uint32_t i1 = uint32_t(r * ncols + (c + 1));
+			uint32_t i2 = uint32_t((r + 1) * ncols + (c + 1));
+			uint32_t i3 = uint32_t((r + 1) * ncols + c);
 			indices[w++] = i0; indices[w++] = i1; indices[w++] = i2;
 			indices[w++] = i0; indices[w++] = i2; indices[w++] = i3;
 		}
@@ -672,16 +722,16 @@ StaticMesh StaticMesh::CreateGridMesh(float width, float height, int rows, int c
 	}
 
 	const int I = rows * columns * 6;
-	std::vector<uint16_t> indices(I);
+	std::vector<uint32_t> indices(I);
 	int w = 0;
 	for (int z = 0; z < rows; ++z)
 	{
 		for (int x = 0; x < columns; ++x)
 		{
-			uint16_t i0 = uint16_t(z * nx + x);
-			uint16_t i1 = uint16_t(z * nx + (x + 1));
-			uint16_t i2 = uint16_t((z + 1) * nx + (x + 1));
-			uint16_t i3 = uint16_t((z + 1) * nx + x);
+			uint32_t i0 = uint32_t(z * nx + x);
+			uint32_t i1 = uint32_t(z * nx + (x + 1));
+			uint32_t i2 = uint32_t((z + 1) * nx + (x + 1));
+			uint32_t i3 = uint32_t((z + 1) * nx + x);
 
 			indices[w++] = i0; indices[w++] = i2; indices[w++] = i1;
 			indices[w++] = i0; indices[w++] = i3; indices[w++] = i2;
@@ -781,34 +831,34 @@ StaticMesh StaticMesh::CreateCylinderMesh(float radius, float height, int segmen
 	const int sideI = segments * 6;
 	const int topI = segments * 3;
 	const int bottomI = segments * 3;
-	std::vector<uint16_t> indices(sideI + topI + bottomI);
+	std::vector<uint32_t> indices(sideI + topI + bottomI);
 
 	int w = 0;
 	// Sides
 	for (int s = 0; s < segments; ++s)
 	{
-		uint16_t i0 = uint16_t(0 * cols + s);
-		uint16_t i1 = uint16_t(0 * cols + (s + 1));
-		uint16_t i2 = uint16_t(1 * cols + (s + 1));
-		uint16_t i3 = uint16_t(1 * cols + s);
+		uint32_t i0 = uint32_t(0 * cols + s);
+		uint32_t i1 = uint32_t(0 * cols + (s + 1));
+		uint32_t i2 = uint32_t(1 * cols + (s + 1));
+		uint32_t i3 = uint32_t(1 * cols + s);
 		indices[w++] = i0; indices[w++] = i2; indices[w++] = i1;
 		indices[w++] = i0; indices[w++] = i3; indices[w++] = i2;
 	}
 	// Top fan
 	for (int s = 0; s < segments; ++s)
 	{
-		uint16_t curr = uint16_t(topRingStart + s);
-		uint16_t next = uint16_t(topRingStart + ((s + 1) % (segments + 1)));
-		indices[w++] = uint16_t(topCenterIdx);
+		uint32_t curr = uint32_t(topRingStart + s);
+		uint32_t next = uint32_t(topRingStart + ((s + 1) % (segments + 1)));
+		indices[w++] = uint32_t(topCenterIdx);
 		indices[w++] = next;
 		indices[w++] = curr;
 	}
 	// Bottom fan
 	for (int s = 0; s < segments; ++s)
 	{
-		uint16_t curr = uint16_t(bottomRingStart + s);
-		uint16_t next = uint16_t(bottomRingStart + ((s + 1) % (segments + 1)));
-		indices[w++] = uint16_t(bottomCenterIdx);
+		uint32_t curr = uint32_t(bottomRingStart + s);
+		uint32_t next = uint32_t(bottomRingStart + ((s + 1) % (segments + 1)));
+		indices[w++] = uint32_t(bottomCenterIdx);
 		indices[w++] = curr;
 		indices[w++] = next;
 	}
@@ -891,24 +941,24 @@ StaticMesh StaticMesh::CreateConeMesh(float radius, float height, int segments)
 	// Indices: side(2*segments tris) + bottom(segments tris)
 	const int sideI = segments * 6;
 	const int bottomI = segments * 3;
-	std::vector<uint16_t> indices(sideI + bottomI);
+	std::vector<uint32_t> indices(sideI + bottomI);
 
 	int w = 0;
 	// Sides
 	for (int s = 0; s < segments; ++s)
 	{
-		uint16_t i0 = uint16_t(baseRingStart + s);
-		uint16_t i1 = uint16_t(baseRingStart + (s + 1));
-		uint16_t i2 = uint16_t(apexStart + (s + 1));
-		uint16_t i3 = uint16_t(apexStart + s);
+		uint32_t i0 = uint32_t(baseRingStart + s);
+		uint32_t i1 = uint32_t(baseRingStart + (s + 1));
+		uint32_t i2 = uint32_t(apexStart + (s + 1));
+		uint32_t i3 = uint32_t(apexStart + s);
 		indices[w++] = i0; indices[w++] = i2; indices[w++] = i1;
 		indices[w++] = i0; indices[w++] = i3; indices[w++] = i2;
 	}
 	// Bottom cap (fan)
 	for (int s = 0; s < segments; ++s) {
-		uint16_t i0 = uint16_t(bottomCenter);
-		uint16_t i1 = uint16_t(bottomRing + s);
-		uint16_t i2 = uint16_t(bottomRing + (s + 1));
+		uint32_t i0 = uint32_t(bottomCenter);
+		uint32_t i1 = uint32_t(bottomRing + s);
+		uint32_t i2 = uint32_t(bottomRing + (s + 1));
 		indices[w++] = i0; indices[w++] = i1; indices[w++] = i2;
 	}
 
@@ -937,7 +987,7 @@ StaticMesh StaticMesh::CreatePlaneMesh(float width, float height)
 	positions[3] = { +halfW, 0, -halfH }; uvs[3] = { 1,0 };
 	for (int i = 0; i < 4; ++i) { normals[i] = { 0,1,0 }; tangents[i] = { 1,0,0 }; }
 
-	std::vector<uint16_t> indices(6);
+	std::vector<uint32_t> indices(6);
 	indices[0] = 0; indices[1] = 1; indices[2] = 2;
 	indices[3] = 0; indices[4] = 2; indices[5] = 3;
 
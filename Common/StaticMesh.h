@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include <vector>
+#include <string>
+#include <filesystem>
 #include "Common/Common.h"
 
 struct Color
@@ -16,9 +18,14 @@ struct Image
 	int Height = 0;
 	int Channels = 0;
 	std::vector<Color> Data; // RGBA format
+	std::filesystem::path SourcePath; // File the image was decoded from. Empty for embedded / generated images
 };
 
 
+// Decodes an image file to RGBA (stb_image) and sets SourcePath. relPath is tried against modelDir first, then as given.
+// Prints a warning and returns false when the file is missing or cannot be decoded.
+bool LoadExternalTexture(const std::filesystem::path& modelDir, const std::string& relPath, Image& outImg);
+
 struct Material
 {
 	Image Diffuse;
@@ -28,11 +35,16 @@ struct Material
 	Image Roughness;
 };
 
+// 2 when every index fits uint16_t, otherwise 4. GPU index buffers pick the smaller format per section.
+uint32_t GetIndexSizeInBytes(const uint32_t* indices, size_t numIndices);
+
 struct MeshSection
 {
-	std::vector<uint16_t> Indices;
+	std::vector<uint32_t> Indices;
 	Material Material;
 	Bounds LocalBounds;
+
+	uint32_t GetIndexSizeInBytes() const { return ::GetIndexSizeInBytes(Indices.data(), Indices.size()); }
 };
 
 struct StaticMesh
@@ -53,9 +65,10 @@ struct StaticMesh
 		const std::vector<FVector3>& tangents = {},
 		const std::vector<FVector2>& uvs = {},
 		const std::vector<FVector3>& colors = {});
-	void InsertSection(const std::vector<uint16_t> indices, const Material&& material = {});
+	void InsertSection(const std::vector<uint32_t> indices, const Material&& material = {});
 	void EndCreate();
 
+	// .hmesh files (CookStaticMesh) are copied from the mapping and their textures decoded; anything else is imported
 	bool LoadFromFile(const char* filename, float scale = 1.0f);
 
 	std::vector<Vertex> GetVertexArray() const;
@@ -1,4 +1,5 @@
 ﻿#include <iostream>
+#include <cmath>
 #include <format>
 #include <filesystem>
 #include <Windows.h>
@@ -149,6 +150,32 @@ static IMeshObject* createGridMeshObject(IRenderer* pRenderer, IGeometry* /*pGeo
 	return pMeshObj;
 }
 
+// Earth-like atmosphere. initAtmosSky hands it to both the sky-view bake and the renderer's sky shader.
+static AtmosParams createEarthAtmosParams()
+{
+	AtmosParams p{};
+	p.PlanetRadius = 6'360'000.0f;
+	p.AtmosphereHeight = 60'000.0f;
+
+	p.RayleighScattering = FLOAT3{ 5.802e-6f, 13.558e-6f, 33.1e-6f };
+	p.Rayleigh.Layers[0] = DensityLayer{ p.AtmosphereHeight, 1.0f, 0.0f, 0.0f, 8'000.0f };
+
+	p.MieScattering = FLOAT3{ 3.996e-6f, 3.996e-6f, 3.996e-6f };
+	p.MieExtinction = FLOAT3{ 4.4e-6f, 4.4e-6f, 4.4e-6f };
+	p.Mie.Layers[0] = DensityLayer{ p.AtmosphereHeight, 1.0f, 0.0f, 0.0f, 1'200.0f };
+	p.MieG = 0.8f;
+
+	p.GroundAlbedo = FLOAT3{ 0.1f, 0.1f, 0.1f };
+	p.SolarIrradiance = FLOAT3{ 1.0f, 1.0f, 1.0f };
+	p.SunAngularRadius = 0.004675f;
+
+	// 스카이뷰 컨텍스트는 transmittance LUT만 쓴다 (매핑은 내부에서 Bruneton으로 고정)
+	p.TransmittanceW = 256; p.TransmittanceH = 64;
+	p.Quality = ATMOS_QUALITY_FIXED;
+	p.NumThreads = 0;
+	return p;
+}
+
 bool Game::Initialize(
 	HWND hWnd,
 	bool bEnableRayTracing,
@@ -230,6 +257,44 @@ bool Game::Initialize(
 		pCreateFunc(&m_pGeometry);
 	}
 
+	// Load Prelight DLL (sky-view LUT for dynamic time of day)
+	{
+		const WCHAR* wchPrelightFileName = nullptr;
+#if defined(_M_ARM64EC) || defined(_M_ARM64)
+#ifdef _DEBUG
+		wchPrelightFileName = L"Prelight_arm64_debug.dll";
+#else
+		wchPrelightFileName = L"Prelight_arm64_release.dll";
+#endif
+#elif defined(_M_AMD64)
+#ifdef _DEBUG
+		wchPrelightFileName = L"Prelight.dll"; // TODO : arm64_debug.dll";
+#else
+		wchPrelightFileName = L"Prelight.dll";
+#endif
+#elif defined(_M_IX86)
+#ifdef _DEBUG
+		wchPrelightFileName = L"Prelight_x86_debug.dll";
+#else
+		wchPrelightFileName = L"Prelight_x86_release.dll";
+#endif
+#endif
+		WCHAR wchErrTxt[128] = {};
+		int	errCode = 0;
+
+		m_hPrelightDLL = LoadLibrary(wchPrelightFileName);
+		if (!m_hPrelightDLL)
+		{
+			errCode = GetLastError();
+			swprintf_s(wchErrTxt, L"Fail to LoadLibrary(%s) - Error Code: %u", wchPrelightFileName, errCode);
+			MessageBox(hWnd, wchErrTxt, L"Error", MB_OK);
+			ASSERT(false, "Fail to load Prelight DLL");
+		}
+		CREATE_INSTANCE_FUNC pCreateFunc = (CREATE_INSTANCE_FUNC)GetProcAddress(m_hPrelightDLL, "DllCreateInstance");
+		pCreateFunc(&m_pPrelight);
+		m_pPrelight->Initialize();
+	}
+
 	// Get App Path and Set Shader Path
 	//WCHAR exePath[_MAX_PATH] = {};
 	WCHAR wchShaderPath[_MAX_PATH] = L"./Shaders";
@@ -250,6 +315,8 @@ bool Game::Initialize(
 	m_pRenderer->Initialize(hWnd, bEnableRayTracing, bEnableDebugLayer, bEnableGBV, bEnableShaderDebug, bUseGpuUploadHeaps, wchShaderPath);
 	m_hWnd = hWnd;
 
+	initAtmosSky();
+
 	// Initialize flecs
 	m_ECSWorld = flecs::world();
 
@@ -336,6 +403,7 @@ bool Game::Initialize(
 			.each([this]()
 				{
 					float dt = m_ECSWorld.delta_time();
+					updateAtmosSky(dt);
 					m_pRenderer->Update(dt);	// TODO: 빼도 되나?
 					m_pRenderer->BeginRender();
 				});
@@ -611,6 +679,18 @@ void Game::Cleanup()
 	SAFE_RELEASE(m_pGeometry);
 	SAFE_FREE_LIBRARY(m_hGeometryDLL);
 
+	if (m_pPrelight)
+	{
+		if (m_pSkyViewContext)
+		{
+			m_pPrelight->DeleteSkyViewContext(m_pSkyViewContext);
+			m_pSkyViewContext = nullptr;
+		}
+		m_pPrelight->Cleanup();
+		m_pPrelight = nullptr;
+	}
+	SAFE_FREE_LIBRARY(m_hPrelightDLL);
+
 	SAFE_RELEASE(m_pRenderer);
 	SAFE_FREE_LIBRARY(m_hRendererDLL);
 }
@@ -739,6 +819,52 @@ void Game::OnMouseHWheel(int x, int y, int iWheel)
 {
 }
 
+void Game::initAtmosSky()
+{
+	const AtmosParams atmosParams = createEarthAtmosParams();
+	m_PlanetRadius = atmosParams.PlanetRadius;
+	m_pSkyViewContext = m_pPrelight->CreateSkyViewContext(atmosParams);
+	ASSERT(m_pSkyViewContext, "Fail to create sky-view context");
+	m_pRenderer->SetAtmosParams(atmosParams);
+}
+
+void Game::updateAtmosSky(float dt)
+{
+	if (!m_pSkyViewContext)
+	{
+		return;
+	}
+
+	// 하루 = DAY_LENGTH_SEC초. 태양은 -Z에서 떠서 +Z로 지고, 정오 고도는 약 70도
+	constexpr float DAY_LENGTH_SEC = 120.0f;
+	constexpr float PI = 3.14159265f;
+	m_TimeOfDay = std::fmod(m_TimeOfDay + dt * (24.0f / DAY_LENGTH_SEC), 24.0f);
+	const float a = (m_TimeOfDay - 6.0f) / 12.0f * PI;
+	const FLOAT3 toSun = { 0.0f, std::sin(a) * 0.94f, -std::cos(a) };
+
+	// 월드 원점 = 행성 표면, +Y = 위
+	FLOAT3 camPos = m_pRenderer->GetCameraPos();
+
+	AtmosSkyViewParams params = {};
+	params.CameraPosPlanetCoord = { camPos.x, m_PlanetRadius + 2.0f + (camPos.y > 0.0f ? camPos.y : 0.0f), camPos.z };
+	params.SunDir = { -toSun.x, -toSun.y, -toSun.z };	// Sun -> Ground
+	params.SkyViewW = 96;
+	params.SkyViewH = 64;
+	params.AerialW = 32;
+	params.AerialH = 32;
+	params.AerialD = 32;
+	params.AerialMaxDistance = 32'000.0f;
+	params.NumThreads = 0;
+	params.RefreshAltitude = 10.0f;
+	params.RefreshAngle = 0.005f;	// 약 0.3도. 태양이 초당 3도 움직이므로 10프레임에 한 번꼴로 재계산
+
+	AtmosSkyViewResult result = {};
+	if (m_pPrelight->UpdateSkyView(m_pSkyViewContext, params, &result) && result.bRefreshed)
+	{
+		m_pRenderer->UpdateAtmosSky(params, result);
+	}
+}
+
 bool Game::UpdateWindowSize(uint backBufferWidth, uint backBufferHeight)
 {
 	bool bResult = false;
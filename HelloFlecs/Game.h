@@ -9,6 +9,7 @@
 #include "Common/Common.h"
 #include "Interface/IRenderer.h"
 #include "Interface/IGeometry.h"
+#include "Interface/IPrelight.h"
 #include "Common/QueryPerfCounter.h"
 
 class GameObject;
@@ -39,6 +40,10 @@ public:
 	IRenderer* GetRenderer() const { return m_pRenderer; }
 	IGeometry* GetGeometry() const { return m_pGeometry; }
 
+private:
+	void initAtmosSky();
+	void updateAtmosSky(float dt);
+
 private:
 	HMODULE m_hRendererDLL = nullptr;
 	IRenderer* m_pRenderer = nullptr;
@@ -47,6 +52,14 @@ private:
 	HMODULE m_hGeometryDLL = nullptr;
 	IGeometry* m_pGeometry = nullptr;
 
+	HMODULE m_hPrelightDLL = nullptr;
+	IPrelight* m_pPrelight = nullptr;
+
+	// Dynamic time of day (sky-view LUT를 매 프레임 CPU에서 갱신)
+	void* m_pSkyViewContext = nullptr;
+	float m_PlanetRadius = 0.0f;
+	float m_TimeOfDay = 10.0f;	// [h], 6시 일출 (-Z) ~ 18시 일몰 (+Z)
+
 	bool m_bShiftKeyDown = false;
 
 	float m_CamOffsetX = 0.0f;
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Common/Common.h"
+#include "Common/AtmosLutMapping.h"
 
 /**
  * Density layer used to describe how a gas concentration varies with altitude.
@@ -28,6 +29,38 @@ struct DensityProfile
 	DensityLayer Layers[2]; // Two layers are generally sufficient for Earth-like atmospheres.
 };
 
+/**
+ * Version of the bake code (ComputeAtmosCPU and what it links).
+ * Bump whenever the output changes for the same AtmosParams; LUT caches are keyed on it.
+ * 2: analytic transmittance for exponential profiles. 3: adaptive integration. 4: spectral lanes.
+ * 5: factored radius differences in the LUT mapping.
+ * Batch baking (PrecomputeAtmosBatch) did not bump it: the restructured bake writes the same bytes as before.
+ * Neither did the sky irradiance SH: it is projected at run time from the baked or sky-view LUTs, not cached.
+ */
+constexpr uint32_t ATMOS_BAKE_CODE_VERSION = 5;
+
+/**
+ * Memory layout of AtmosResult::ScatteringRGBA.
+ */
+enum EAtmosScatteringLayout : int
+{
+	ATMOS_SCATTERING_LAYOUT_R_MU_MUS_NU = 0,	// Full 4D table. Needed once multiple scattering (nu-dependent) is baked.
+	ATMOS_SCATTERING_LAYOUT_R_MU_MUS = 1,	// No nu axis (ScatteringNu = 1). Phase-free single scattering only.
+};
+
+/**
+ * Quadrature used for the ray integrals of the bake (transmittance, single scattering, direct irradiance).
+ * Adaptive modes place samples densely near the lowest-altitude point of each ray (start, perigee or ground hit),
+ * within about one scale height, and double the sample count until every channel changes by less than the target.
+ */
+enum EAtmosQuality : int
+{
+	ATMOS_QUALITY_FIXED = 0,		// Fixed uniform step counts per integral (previous behaviour).
+	ATMOS_QUALITY_FAST = 1,			// Adaptive, ~1e-2 relative error. For runtime rebakes.
+	ATMOS_QUALITY_BALANCED = 2,		// Adaptive, ~1e-3 relative error.
+	ATMOS_QUALITY_REFERENCE = 3,	// Adaptive, ~1e-5 relative error, up to thousands of samples per ray. Offline reference output.
+};
+
 /**
  * Input parameters for precomputing atmospheric scattering LUTs.
  * UNITS: lengths in meters, angles in radians, spectral quantities in RGB per meter unless stated.
@@ -76,8 +109,62 @@ struct AtmosParams
 	int IrradianceW;
 	int IrradianceH;
 
-	/// Number of multiple-scattering orders to accumulate (≥2; 4 is a good default).
+	/// Texel <-> (r, mu, mu_s, nu) mapping used by all three LUTs (see Common/AtmosLutMapping.h).
+	/// ATMOS_LUT_MAPPING_BRUNETON concentrates texels near the ground and the horizon, where radiance changes fastest,
+	/// and matches the uniform mapping with about a quarter of the scattering texels (e.g. R=16, Mu=64 instead of 32x128).
+	/// With it the transmittance LUT only stores rays that reach the top boundary, and Mu must be even.
+	EAtmosLutMapping LutMapping;
+
+	/// Total number of scattering orders to bake (1 = single scattering only; 4 is a good default).
+	/// Orders ≥ 2 follow Bruneton 2017 (scattering density, indirect irradiance, per-order accumulation).
 	int MultipleScatteringOrders;
+
+	/// Store single scattering without the nu axis (ATMOS_SCATTERING_LAYOUT_R_MU_MUS), ScatteringNu times smaller.
+	/// Single scattering is baked without a phase function and does not depend on nu, so this is lossless.
+	/// Only honored when MultipleScatteringOrders <= 1; check AtmosResult::ScatteringLayout for the layout produced.
+	bool bCompactScattering;
+
+	// ---------------------- Bake options ----------------------
+	/// Look up sun transmittance from the transmittance LUT (bilinear) inside the scattering integral
+	/// instead of integrating optical depth toward the sun at every view sample.
+	/// Turns each scattering texel from O(view x sun) into O(view) density evaluations.
+	bool bUseTransmittanceLUT;
+
+	/// Always integrate transmittance numerically.
+	/// By default, when every density profile is a single pure exponential layer (ExpTerm in (0, 1], no linear/constant
+	/// term, covering the whole atmosphere), optical depth is evaluated in closed form with a Chapman-function
+	/// approximation instead of ~100 density samples per ray. Profiles with other layers (e.g. an ozone tent) always integrate.
+	bool bForceNumericTransmittance;
+
+	/// Quality/speed trade-off of the ray integrals (see EAtmosQuality). The multiple-scattering gather keeps its own fixed sampling.
+	EAtmosQuality Quality;
+
+	/// Spectral bake: integrate this many wavelengths over 380-730 nm instead of three RGB channels, then convert the LUTs
+	/// to linear sRGB with the CIE 1931 2-degree matching functions (gives the right sunset hues). 0 = RGB bake; otherwise 3..48.
+	/// The RGB coefficients above are read as samples at 680/550/440 nm: Rayleigh and Mie follow a power law through them,
+	/// ozone, solar irradiance and ground albedo are interpolated linearly. Costs about SpectralWavelengths / 3 RGB bakes.
+	/// Only PrecomputeAtmos/PrecomputeAtmosBatch honor it; the per-frame sky-view context stays RGB.
+	int SpectralWavelengths;
+
+	/// Worker threads used for the LUT loops. 0 = all hardware threads, 1 = single-threaded.
+	/// Every texel is computed independently, so the output does not depend on this value.
+	int NumThreads;
+};
+
+/**
+ * Wall-clock time of each bake stage in milliseconds, filled by PrecomputeAtmos/PrecomputeAtmosBatch.
+ * A batch runs every stage for all presets on one pool, so each preset of a batch reports the batch-wide times.
+ * All zero when the result did not come from a bake in this process (e.g. a disk cache hit).
+ */
+struct AtmosBakeTimings
+{
+	double TransmittanceMs;
+	double SingleScatteringMs;
+	double DirectIrradianceMs;
+	double MultipleScatteringMs;	// All orders >= 2.
+	double ValidationMs;			// Brute-force spot check of the LUT path (bUseTransmittanceLUT only).
+	double SpectralResolveMs;		// Wavelength groups -> RGB (SpectralWavelengths > 0 only).
+	double TotalMs;
 };
 
 /**
@@ -98,23 +185,127 @@ struct AtmosResult
 
 	// ---------------------- Scattering (4D packed) ----------------------
 	/// Scattering logical dimensions: radius, view μ, sun μ_s, and phase ν bins.
+	/// ScatteringNu is 1 for ATMOS_SCATTERING_LAYOUT_R_MU_MUS.
 	int ScatteringR;
 	int ScatteringMu;
 	int ScatteringMuS;
 	int ScatteringNu;
 
 	/// RGBA scattering values. Size = R * Mu * MuS * Nu * 4.
-	/// Convention: RGB = Rayleigh, A = single Mie (additional MS orders are accumulated in RGB/A).
+	/// Convention: RGB = single Rayleigh + orders ≥ 2 divided by RayleighPhase(nu), A = single Mie (scalar).
+	/// Single scattering does not depend on nu; the multiple-scattering part does.
 	/// Linear index example:
 	///   idx4 = (((r * ScatteringMu + mu) * ScatteringMuS + mus) * ScatteringNu + nu);
 	///   idx  = idx4 * 4 + channel;  // channel ∈ {0..3}
 	float* ScatteringRGBA;
 
+	/// Which axes ScatteringRGBA stores. With ATMOS_SCATTERING_LAYOUT_R_MU_MUS the value holds for every ν
+	/// and the index formula above still applies with ScatteringNu = 1.
+	EAtmosScatteringLayout ScatteringLayout;
+
+	/// Texel mapping the LUTs were baked with (copied from AtmosParams::LutMapping). The sampler must use the same one.
+	EAtmosLutMapping LutMapping;
+
 	// ---------------------- Irradiance (2D) ----------------------
 	/// Irradiance texture size.
 	int IrradianceW;
 	int IrradianceH;
 
-	/// RGB irradiance values at ground/TOA. Size = IrradianceW * IrradianceH * 3.
+	/// RGB irradiance values at ground/TOA (direct sun + indirect sky from orders ≥ 2). Size = IrradianceW * IrradianceH * 3.
 	float* IrradianceRGB;
+
+	/// Per-stage bake times (see AtmosBakeTimings).
+	AtmosBakeTimings Timings;
+};
+
+/**
+ * L2 spherical-harmonics irradiance of the sky around one position (9 coefficients per channel).
+ * Already convolved with the clamped cosine lobe, so irradiance on a surface with normal n is sum(Coeffs[i] * Y_i(n)).
+ * Real SH basis in the planet/world frame, order: Y00, Y1-1 (y), Y10 (z), Y11 (x), Y2-2 (xy), Y2-1 (yz),
+ * Y20 (3z^2 - 1), Y21 (xz), Y22 (x^2 - y^2).
+ * Includes sky light and an approximate ground bounce (GroundAlbedo). Excludes the direct sun.
+ */
+struct AtmosSkySH
+{
+	FLOAT3 Coeffs[9];
+};
+
+/**
+ * Per-frame sky-view LUT and aerial-perspective volume request (Hillaire 2020).
+ * Built from a context created once per AtmosParams (transmittance LUT + multiple-scattering LUT), cheap enough
+ * to rebuild on the CPU every frame so the sun can move continuously. Texel mapping: AtmosSkyViewMapping.
+ */
+struct AtmosSkyViewParams
+{
+	FLOAT3 CameraPosPlanetCoord;	// Camera position relative to the planet center [m]. Clamped into [Rg, Rt].
+	FLOAT3 SunDir;					// Direction the sunlight travels (sun -> ground), as in the sky shader. Need not be normalized.
+
+	/// Sky-view LUT size. x: azimuth relative to the sun, y: view zenith. Commonly 96x64.
+	int SkyViewW;
+	int SkyViewH;
+
+	/// Aerial-perspective volume: x/y directions with the sky-view mapping, z distance slices. AerialD = 0 skips it.
+	int AerialW;
+	int AerialH;
+	int AerialD;
+	float AerialMaxDistance;	// Distance at the end of the last slice [m].
+
+	/// Worker threads for the update. 0 = all hardware threads, 1 = single-threaded.
+	int NumThreads;
+
+	/// Refresh thresholds. The update keeps the previous LUTs while the camera altitude moved less than RefreshAltitude [m]
+	/// and the sun / camera up directions turned less than RefreshAngle [rad] since the last rebuild. 0 = rebuild every update.
+	float RefreshAltitude;
+	float RefreshAngle;
+};
+
+/**
+ * Per-frame LUTs produced by UpdateSkyView. Radiance has the phase functions and SolarIrradiance applied.
+ * The buffers are owned by the sky-view context and stay valid until the next update or until the context is deleted.
+ */
+struct AtmosSkyViewResult
+{
+	/// Camera radius and sun zenith cosine the LUTs were built for (the sampler must use the same ones).
+	float CameraRadius;
+	float SunZenithCos;
+
+	/// Sky radiance toward each direction: RGB, A = 1. Size = SkyViewW * SkyViewH * 4, index = (y * SkyViewW + x) * 4 + c.
+	int SkyViewW;
+	int SkyViewH;
+	const float* SkyViewRGBA;
+
+	/// Camera-centered froxels: RGB = radiance scattered between the camera and the end of slice z,
+	/// A = mean RGB transmittance over the same segment. Size = W * H * D * 4, index = ((z * H + y) * W + x) * 4 + c.
+	int AerialW;
+	int AerialH;
+	int AerialD;
+	float AerialMaxDistance;
+	const float* AerialRGBA;
+
+	/// Ambient irradiance at the camera, projected from the sky-view LUT (same units as SkyViewRGBA).
+	/// Follows the sun every update, so it can replace a constant ambient term.
+	AtmosSkySH AmbientSH;
+
+	/// False when the refresh thresholds skipped the rebuild. Every field then describes the previous rebuild.
+	bool bRefreshed;
+};
+
+/**
+ * One CPU atmosphere query for IPrelight::SampleAtmos.
+ * The sun direction is shared by the whole batch and passed separately.
+ */
+struct AtmosSampleQuery
+{
+	FLOAT3 PosPlanetCoord;	// Position relative to the planet center [m]. The radius is clamped into [Rg, Rt] like the sky shader.
+	FLOAT3 ViewDir;			// Direction the sky radiance is looked up toward. Need not be normalized.
+};
+
+/**
+ * Result of one query, in the same units as the baked LUTs (SolarIrradiance applied, no exposure or tonemapping).
+ */
+struct AtmosSample
+{
+	FLOAT3 SkyRadiance;			// Sky radiance arriving from ViewDir, phase functions applied. Excludes the sun disc and ground reflection.
+	FLOAT3 SunTransmittance;	// Transmittance toward the sun. Zero once the planet blocks the sun. Sun color = SolarIrradiance * this.
+	FLOAT3 Irradiance;			// Irradiance on a horizontal surface at the query radius (IrradianceRGB LUT).
 };
@@ -6,8 +6,9 @@
 interface IMeshObject : public IUnknown
 {
 	virtual bool ENGINECALL BeginCreateMesh(const Vertex * vertices, uint numVertices, uint numTriGroups) = 0;
-	virtual bool ENGINECALL InsertTriGroup(const uint16_t* indices, uint numTriangles, const WCHAR* wchTexFileName) = 0;
-	virtual bool ENGINECALL InsertTriGroup(const uint16_t* indices, uint numTriangles, const Material& material) = 0;
+	// The GPU index buffer is 16-bit when every index of the group fits, 32-bit otherwise.
+	virtual bool ENGINECALL InsertTriGroup(const uint32_t* indices, uint numTriangles, const WCHAR* wchTexFileName) = 0;
+	virtual bool ENGINECALL InsertTriGroup(const uint32_t* indices, uint numTriangles, const Material& material) = 0;
 	virtual void ENGINECALL EndCreateMesh(bool bOpaque = true, bool bUseRayTracingIfSupported = true) = 0;
 
 	virtual uint ENGINECALL GetRenderPass() = 0;
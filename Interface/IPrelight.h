@@ -2,6 +2,7 @@
 #include <Windows.h>
 #include "Common/Common.h"
 #include "AtmosStruct.h"
+#include "VoxelStruct.h"
 
 struct StaticMesh;
 
@@ -11,7 +12,28 @@ struct IPrelight
 	virtual void ENGINECALL Cleanup() = 0;
 
 	virtual bool ENGINECALL PrecomputeAtmos(const AtmosParams& in, AtmosResult* out) const = 0;
-	virtual bool ENGINECALL DecomposeToConvex(const StaticMesh& m) const = 0;
+	virtual bool ENGINECALL PrecomputeAtmosBatch(const AtmosParams* in, int count, AtmosResult* out) const = 0;
+	virtual void* ENGINECALL CreateSkyViewContext(const AtmosParams& in) const = 0;
+	virtual bool ENGINECALL UpdateSkyView(void* pSkyViewContext, const AtmosSkyViewParams& in, AtmosSkyViewResult* out) const = 0;
+	virtual void ENGINECALL DeleteSkyViewContext(void* pSkyViewContext) const = 0;
+	virtual void* ENGINECALL CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut) const = 0;
+	virtual void ENGINECALL SampleAtmos(const void* pSampler, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* outSamples) const = 0;
+	virtual void ENGINECALL ProjectSkyIrradianceSH(const void* pSampler, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* outSH) const = 0;
+	virtual void ENGINECALL DeleteAtmosSampler(void* pSampler) const = 0;
+	virtual bool ENGINECALL PlanVoxelization(const StaticMesh& m, const VoxelBudget& budget, VoxelPlan* outPlan) const = 0;
+	virtual bool ENGINECALL DecomposeToConvex(const StaticMesh& m, const VoxelBudget& budget) const = 0;
+	virtual bool ENGINECALL VoxelizeStreaming(const wchar_t* stlPath, const wchar_t* outGridPath, const StreamingVoxelDesc& desc, StreamingVoxelStats* outStats) const = 0;
+	virtual void* ENGINECALL CreateIncrementalVoxelizer(const StaticMesh& m, const VoxelBudget& budget, IncrementalVoxelStats* outStats) const = 0;
+	virtual bool ENGINECALL UpdateIncrementalVoxelizer(void* pVoxelizer, const StaticMesh& m, int firstTriangle, int numTriangles, IncrementalVoxelStats* outStats) const = 0;
+	virtual bool ENGINECALL SaveIncrementalVoxelGrid(const void* pVoxelizer, const wchar_t* outGridPath) const = 0;
+	virtual void ENGINECALL DeleteIncrementalVoxelizer(void* pVoxelizer) const = 0;
+	virtual void* ENGINECALL CreateVoxelGrid(const StaticMesh& m, const VoxelBudget& budget, VoxelGridInfo* outInfo) const = 0;
+	virtual void* ENGINECALL LoadVoxelGrid(const wchar_t* gridPath, VoxelGridInfo* outInfo) const = 0;
+	virtual void ENGINECALL GetVoxelOccupancy(const void* pGrid, const int3* voxels, int count, uint8_t* outOccupied) const = 0;
+	virtual void ENGINECALL RayFirstHitBatch(const void* pGrid, const VoxelRay* rays, int numRays, VoxelRayHit* outHits) const = 0;
+	virtual void ENGINECALL SegmentOccupancyBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numSegments, float* outOccupancy) const = 0;
+	virtual void ENGINECALL VisibilityBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numPairs, float endBias, uint8_t* outVisible) const = 0;
+	virtual void ENGINECALL DeleteVoxelGrid(void* pGrid) const = 0;
 };
 
 namespace prl
@@ -34,9 +56,151 @@ namespace prl
 		return g_pBackend->PrecomputeAtmos(in, out);
 	}
 
-	inline bool DecomposeToConvex(const StaticMesh& meshData)
+	// Bakes count presets in one pass (out[i] from in[i]); every stage schedules all presets' work on one thread pool
+	// sized by in[0].NumThreads. Each result is identical to a separate PrecomputeAtmos call and is freed the same way.
+	inline bool PrecomputeAtmosBatch(const AtmosParams* in, int count, AtmosResult* out)
 	{
 		ASSERT(g_pBackend, "Prelight backend is not set.");
-		return g_pBackend->DecomposeToConvex(meshData);
+		return g_pBackend->PrecomputeAtmosBatch(in, count, out);
+	}
+
+	// Sky-view context: built once per AtmosParams (weather change), updated every frame (sun/camera move).
+	inline void* CreateSkyViewContext(const AtmosParams& in)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->CreateSkyViewContext(in);
+	}
+
+	inline bool UpdateSkyView(void* pSkyViewContext, const AtmosSkyViewParams& in, AtmosSkyViewResult* out)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->UpdateSkyView(pSkyViewContext, in, out);
+	}
+
+	inline void DeleteSkyViewContext(void* pSkyViewContext)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->DeleteSkyViewContext(pSkyViewContext);
+	}
+
+	// CPU sampler over baked LUTs. It references lut's buffers (no copy), so they must outlive the sampler.
+	// sunDir is the direction sunlight travels (sun -> ground), as in AtmosSkyViewParams.
+	inline void* CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->CreateAtmosSampler(in, lut);
+	}
+
+	inline void SampleAtmos(const void* pSampler, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* outSamples)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->SampleAtmos(pSampler, sunDir, queries, count, outSamples);
+	}
+
+	inline void ProjectSkyIrradianceSH(const void* pSampler, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* outSH)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->ProjectSkyIrradianceSH(pSampler, sunDir, posPlanetCoord, outSH);
+	}
+
+	inline void DeleteAtmosSampler(void* pSampler)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->DeleteAtmosSampler(pSampler);
+	}
+
+	inline bool PlanVoxelization(const StaticMesh& meshData, const VoxelBudget& budget, VoxelPlan* outPlan)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->PlanVoxelization(meshData, budget, outPlan);
+	}
+
+	inline bool DecomposeToConvex(const StaticMesh& meshData, const VoxelBudget& budget = {})
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->DecomposeToConvex(meshData, budget);
+	}
+
+	inline bool VoxelizeStreaming(const wchar_t* stlPath, const wchar_t* outGridPath, const StreamingVoxelDesc& desc, StreamingVoxelStats* outStats = nullptr)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->VoxelizeStreaming(stlPath, outGridPath, desc, outStats);
+	}
+
+	// Incremental voxelizer for a mesh being edited: built once (cell from PlanVoxelization), then updated per edit.
+	// Triangles are numbered across all sections in order. numTriangles = 0 diffs the whole mesh by triangle hash;
+	// otherwise only [firstTriangle, firstTriangle + numTriangles) changed and the triangle count must be unchanged.
+	inline void* CreateIncrementalVoxelizer(const StaticMesh& meshData, const VoxelBudget& budget = {}, IncrementalVoxelStats* outStats = nullptr)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->CreateIncrementalVoxelizer(meshData, budget, outStats);
+	}
+
+	inline bool UpdateIncrementalVoxelizer(void* pVoxelizer, const StaticMesh& meshData, int firstTriangle = 0, int numTriangles = 0, IncrementalVoxelStats* outStats = nullptr)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->UpdateIncrementalVoxelizer(pVoxelizer, meshData, firstTriangle, numTriangles, outStats);
+	}
+
+	// Writes the current solid grid in the HVOX sparse grid format.
+	inline bool SaveIncrementalVoxelGrid(const void* pVoxelizer, const wchar_t* outGridPath)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->SaveIncrementalVoxelGrid(pVoxelizer, outGridPath);
+	}
+
+	inline void DeleteIncrementalVoxelizer(void* pVoxelizer)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->DeleteIncrementalVoxelizer(pVoxelizer);
+	}
+
+	// Voxel grid for ray queries: the solid grid of a mesh (all sections, cell from PlanVoxelization), or an HVOX file
+	// (SaveIncrementalVoxelGrid writes the solid grid, VoxelizeStreaming only the surface voxels).
+	inline void* CreateVoxelGrid(const StaticMesh& meshData, const VoxelBudget& budget = {}, VoxelGridInfo* outInfo = nullptr)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->CreateVoxelGrid(meshData, budget, outInfo);
+	}
+
+	inline void* LoadVoxelGrid(const wchar_t* gridPath, VoxelGridInfo* outInfo = nullptr)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		return g_pBackend->LoadVoxelGrid(gridPath, outInfo);
+	}
+
+	// outOccupied[i] = 1 if voxels[i] (grid index space) is occupied.
+	inline void GetVoxelOccupancy(const void* pGrid, const int3* voxels, int count, uint8_t* outOccupied)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->GetVoxelOccupancy(pGrid, voxels, count, outOccupied);
+	}
+
+	// First occupied voxel along each ray (hierarchical DDA that skips empty tiles and 64-bit words).
+	inline void RayFirstHitBatch(const void* pGrid, const VoxelRay* rays, int numRays, VoxelRayHit* outHits)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->RayFirstHitBatch(pGrid, rays, numRays, outHits);
+	}
+
+	// Fraction (0~1) of each segment [from, to] that lies inside occupied voxels.
+	inline void SegmentOccupancyBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numSegments, float* outOccupancy)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->SegmentOccupancyBatch(pGrid, from, to, numSegments, outOccupancy);
+	}
+
+	// outVisible[i] = 1 if nothing occupied lies between from[i] and to[i].
+	// endBias (world length) is skipped at both ends so points on a surface do not shadow themselves.
+	inline void VisibilityBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numPairs, float endBias, uint8_t* outVisible)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->VisibilityBatch(pGrid, from, to, numPairs, endBias, outVisible);
+	}
+
+	inline void DeleteVoxelGrid(void* pGrid)
+	{
+		ASSERT(g_pBackend, "Prelight backend is not set.");
+		g_pBackend->DeleteVoxelGrid(pGrid);
 	}
 } // namespace hfx
\ No newline at end of file
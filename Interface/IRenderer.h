@@ -3,7 +3,9 @@
 #include <combaseapi.h>
 #include "Common/Common.h"
 #include "Common/StaticMesh.h"
+#include "Common/CookedMesh.h"
 
+#include "AtmosStruct.h"
 #include "IMeshObject.h"
 #include "ISpriteObject.h"
 
@@ -21,8 +23,20 @@ interface IRenderer : public IUnknown
 	virtual void ENGINECALL RenderSpriteWithTex(void* pSprObjHandle, int posX, int posY, float scaleX, float scaleY, const RECT* pRect, float z, void* pTexHandle) = 0;
 	virtual void ENGINECALL RenderSprite(void* pSprObjHandle, int posX, int posY, float scaleX, float scaleY, float z) = 0;
 
+	/// Per-frame sky-view / aerial-perspective LUTs from IPrelight::UpdateSkyView. Call before Update and BeginRender.
+	/// The sky and the directional light then follow params.SunDir / params.CameraPosPlanetCoord,
+	/// and the ambient term of lit meshes uses result.AmbientSH instead of a constant.
+	virtual void ENGINECALL UpdateAtmosSky(const AtmosSkyViewParams& params, const AtmosSkyViewResult& result) = 0;
+	/// Atmosphere the sky shader draws (planet and top-of-atmosphere radii). Pass the same AtmosParams as
+	/// IPrelight::CreateSkyViewContext so the sky-view LUT and the shader use one parameterization.
+	/// Until called, the sky uses the Earth radii the precomputed Resources/Atmos LUTs were baked with.
+	virtual void ENGINECALL SetAtmosParams(const AtmosParams& params) = 0;
+
 	virtual IMeshObject* ENGINECALL CreateBasicMeshObject(bool bOpaque = true, bool bUseRayTracingIfSupported = true) = 0;
 	virtual IMeshObject* ENGINECALL CreateBasicMeshObject(const StaticMesh& staticMesh, bool bOpaque = true, bool bUseRayTracingIfSupported = true) = 0;
+	/// Uploads straight from a mapped .hmesh (MappedStaticMesh::GetView). Section indices keep their cooked 16/32-bit size
+	/// and each section's diffuse texture is loaded from its file. The view only has to outlive this call.
+	virtual IMeshObject* ENGINECALL CreateBasicMeshObject(const StaticMeshView& meshView, bool bOpaque = true, bool bUseRayTracingIfSupported = true) = 0;
 	virtual ISprite* ENGINECALL CreateSpriteObject() = 0;
 	virtual ISprite* ENGINECALL CreateSpriteObject(const WCHAR* wchTexFileName) = 0;
 	virtual ISprite* ENGINECALL CreateSpriteObject(const WCHAR* wchTexFileName, int posX, int posY, int width, int height) = 0;
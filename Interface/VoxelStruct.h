@@ -0,0 +1,123 @@
+﻿#pragma once
+#include "Common/Common.h"
+#include <cfloat>
+
+/**
+ * Optional per-voxel attribute channels of a surface voxel grid. Channels are recorded only
+ * when requested, and storage is allocated lazily per 32^3 tile.
+ */
+enum EVoxelAttribute : uint32_t
+{
+	VOXEL_ATTR_NONE = 0,
+	VOXEL_ATTR_NORMAL = 1 << 0,		// Octahedral 8:8 normal, area-weighted average of the triangles in the voxel.
+	VOXEL_ATTR_MATERIAL = 1 << 1,	// Section / material id covering the most area in the voxel.
+	VOXEL_ATTR_COVERAGE = 1 << 2,	// Triangle area inside the voxel / voxel face area (0~1, 8 bit).
+	VOXEL_ATTR_ALL = VOXEL_ATTR_NORMAL | VOXEL_ATTR_MATERIAL | VOXEL_ATTR_COVERAGE,
+};
+
+/**
+ * Budget used to pick the voxel cell size for a mesh.
+ * Either limit may be left at 0 to disable it. When both are 0 the planner falls back to
+ * a default voxel count target. The chosen cell is the smallest one that satisfies every
+ * active limit, clamped to [MinCell, MaxCell] when those are set.
+ */
+struct VoxelBudget
+{
+	uint64_t TargetVoxelCount;	// Occupied voxels to aim for (solid grid, which includes the surface shell), summed over all sections.
+	uint64_t MaxBytes;			// Predicted peak memory of the voxelization + solid fill, in bytes.
+	float MinCell;				// Lower clamp for the cell size in mesh units (0 = none).
+	float MaxCell;				// Upper clamp for the cell size in mesh units (0 = none).
+	uint32_t AttributeMask;		// EVoxelAttribute channels to record on the surface grids (0 = none).
+								// Each section then keeps its surface grid, which the planner budgets for.
+};
+
+/**
+ * Result of the voxel size planner. Everything except Cell and the grid dimensions is a
+ * prediction extrapolated from a coarse pre-voxelization of the mesh, reported before the
+ * real run so the caller can bail out or adjust the budget.
+ */
+struct VoxelPlan
+{
+	float Cell;					// Chosen voxel size in mesh units.
+	int Nx, Ny, Nz;				// Dense grid dimensions covering the mesh bounds at Cell.
+
+	float SurfaceArea;			// Total triangle area of all sections.
+	float SolidVolume;			// Estimated enclosed volume (from the coarse pass).
+
+	uint64_t PredictedSurfaceVoxels;
+	uint64_t PredictedSolidVoxels;	// Includes the surface shell; this is what TargetVoxelCount is compared against.
+	uint64_t PredictedTiles;	// 32^3 tiles allocated for surface + solid grids.
+	uint64_t PredictedBytes;	// Peak memory estimate (dense fill mask + tiles + hash tables).
+	double PredictedMs;			// Wall time estimate for voxelization + solid fill of all sections.
+};
+
+/**
+ * Out-of-core surface voxelization of a binary STL file.
+ * Triangles are streamed through a sliding mapped view, binned into on-disk region buckets
+ * and voxelized one region at a time, so peak memory is bounded by MaxResidentBytes rather
+ * than by the triangle count. The result is written in the HVOX sparse grid format.
+ */
+struct StreamingVoxelDesc
+{
+	float Cell;						// Voxel size in mesh units.
+	uint64_t MaxResidentBytes;		// Peak memory for mapped views, bucket buffers and region tiles (0 = 256MB).
+	const wchar_t* TempPath;		// Spill file for the buckets (nullptr = "<output>.bins"). Deleted on completion.
+};
+
+/**
+ * State of an incremental voxelizer after its last Create/Update call (see prl::CreateIncrementalVoxelizer).
+ */
+struct IncrementalVoxelStats
+{
+	int Nx, Ny, Nz;					// Dense grid dimensions covering the mesh bounds at Cell.
+	float Cell;
+	int DirtyTiles;					// Surface tiles re-voxelized by the last update.
+	uint64_t RefilledVoxels;		// Voxels covered by the solid re-fill of the last update.
+	bool bFullRebuild;				// The edit could not be applied locally (left the grid, opened or sealed a cavity).
+	uint64_t SolidVoxels;			// Occupied voxels of the current solid grid, surface shell included.
+};
+
+struct StreamingVoxelStats
+{
+	int Nx, Ny, Nz;					// Dense grid dimensions covering the mesh bounds at Cell.
+	int RegionTiles;				// Region edge length in 32^3 tiles.
+	uint64_t Triangles;				// Triangles read from the input file.
+	uint64_t BinnedTriangles;		// Triangle copies written to buckets (a triangle can straddle regions).
+	uint64_t Regions;				// Non-empty regions voxelized.
+	uint64_t Tiles;					// Tiles written to the output grid.
+	uint64_t SurfaceVoxels;
+	uint64_t PeakResidentBytes;		// Measured peak of the bounded buffers above.
+	double BoundsMs, BinMs, VoxelizeMs;
+};
+
+/**
+ * Voxel grid opened for ray queries (see prl::CreateVoxelGrid / prl::LoadVoxelGrid).
+ * Voxel (x, y, z) covers Origin + [x, x + 1) * Cell on each axis; occupied voxels lie in [0, Nx) x [0, Ny) x [0, Nz).
+ */
+struct VoxelGridInfo
+{
+	int Nx, Ny, Nz;
+	float Cell;
+	FLOAT3 Origin;
+	uint64_t OccupiedVoxels;
+};
+
+/**
+ * Ray in the world space of a voxel grid: points are Origin + Direction * t for t in [TMin, TMax].
+ * Direction does not need to be normalized; t is in units of its length.
+ */
+struct VoxelRay
+{
+	FLOAT3 Origin;
+	FLOAT3 Direction;
+	float TMin = 0.0f;
+	float TMax = FLT_MAX;
+};
+
+struct VoxelRayHit
+{
+	bool bHit = false;
+	float T = 0.0f;					// t where the ray enters the first occupied voxel (TMin if it starts inside one).
+	int3 Voxel{ 0,0,0 };			// First occupied voxel. For a FULL tile this is the voxel the ray enters it through.
+	FLOAT3 Normal{ 0,0,0 };			// Normal of the entered face (zero if the ray starts inside an occupied voxel).
+};
@@ -0,0 +1,736 @@
+﻿#include "pch.h"
+#include "AtmosKernels.h"
+#include <cfloat>
+#include <cstring>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+// MSVC는 /arch 없이도 intrinsic을 쓸 수 있다. GCC/Clang은 함수 단위 target 지정이 필요.
+#if defined(_MSC_VER) && !defined(__clang__)
+#  define ATMOS_TARGET_AVX2
+#else
+#  define ATMOS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+// Cephes expf 상수
+static constexpr float EXP_LO = -87.3365478515625f;	// ln(FLT_MIN)
+static constexpr float EXP_LOG2E = 1.44269504088896341f;
+static constexpr float EXP_C1 = 0.693359375f;			// ln2 상위 비트
+static constexpr float EXP_C2 = -2.12194440e-4f;		// ln2 - C1
+static constexpr float EXP_P0 = 1.9875691500e-4f;
+static constexpr float EXP_P1 = 1.3981999507e-3f;
+static constexpr float EXP_P2 = 8.3334519073e-3f;
+static constexpr float EXP_P3 = 4.1665795894e-2f;
+static constexpr float EXP_P4 = 1.6666665459e-1f;
+static constexpr float EXP_P5 = 5.0000001201e-1f;
+
+static constexpr float HG_PI = 3.14159265358979f;
+
+void BuildAtmosMedium(const AtmosParams& in, AtmosMedium* out)
+{
+	ASSERT(out, "Output pointer is null.");
+
+	// SampleDensity 규칙을 그대로 옮긴다:
+	//   Scale == 0 && ExpTerm != 0 인 레이어는 통째로 무시, Width > 0 이면 h > Width 에서 0, Scale <= 0 이면 exp 항 0
+	auto buildSpecies = [](const DensityProfile& prof, AtmosMediumSpecies* s)
+		{
+			s->NumLayers = 0;
+			for (int i = 0; i < 2; ++i)
+			{
+				const DensityLayer& L = prof.Layers[i];
+				if (L.Scale == 0.0f && L.ExpTerm != 0.0f)
+				{
+					continue;
+				}
+				const bool bHasExp = (L.Scale > 0.0f) && (L.ExpTerm != 0.0f);
+				if (!bHasExp && L.LinearTerm == 0.0f && L.ConstantTerm == 0.0f)
+				{
+					continue;
+				}
+
+				AtmosMediumLayer& dst = s->Layers[s->NumLayers++];
+				dst.Width = (L.Width > 0.0f) ? L.Width : FLT_MAX;
+				dst.ExpTerm = bHasExp ? L.ExpTerm : 0.0f;
+				dst.InvScale = bHasExp ? 1.0f / L.Scale : 0.0f;
+				dst.LinearTerm = L.LinearTerm;
+				dst.ConstantTerm = L.ConstantTerm;
+			}
+		};
+
+	buildSpecies(in.Rayleigh, &out->Rayleigh);
+	buildSpecies(in.Mie, &out->Mie);
+	buildSpecies(in.Ozone, &out->Ozone);
+
+	// 밀도 clamp [0, 1]과 Width 경계가 대기 안에서 걸리지 않아야 exp(-h/H) 하나로 닫힌다
+	auto isPureExponential = [&](const AtmosMediumSpecies& s)
+		{
+			if (s.NumLayers == 0)
+			{
+				return true;
+			}
+			const AtmosMediumLayer& L = s.Layers[0];
+			return s.NumLayers == 1 && L.ExpTerm > 0.0f && L.ExpTerm <= 1.0f
+				&& L.LinearTerm == 0.0f && L.ConstantTerm == 0.0f && L.Width >= in.AtmosphereHeight;
+		};
+	out->MinScaleHeight = in.AtmosphereHeight / 8.0f;
+	for (const AtmosMediumSpecies* s : { &out->Rayleigh, &out->Mie, &out->Ozone })
+	{
+		for (int l = 0; l < s->NumLayers; ++l)
+		{
+			if (s->Layers[l].ExpTerm != 0.0f)
+			{
+				out->MinScaleHeight = std::min(out->MinScaleHeight, 1.0f / s->Layers[l].InvScale);
+			}
+		}
+	}
+
+	out->bAnalyticOpticalDepth = !in.bForceNumericTransmittance
+		&& isPureExponential(out->Rayleigh) && isPureExponential(out->Mie) && isPureExponential(out->Ozone);
+
+	out->RayleighScattering[0] = in.RayleighScattering.x; out->RayleighScattering[1] = in.RayleighScattering.y; out->RayleighScattering[2] = in.RayleighScattering.z;
+	out->MieExtinction[0] = in.MieExtinction.x; out->MieExtinction[1] = in.MieExtinction.y; out->MieExtinction[2] = in.MieExtinction.z;
+	out->OzoneAbsorption[0] = in.OzoneAbsorption.x; out->OzoneAbsorption[1] = in.OzoneAbsorption.y; out->OzoneAbsorption[2] = in.OzoneAbsorption.z;
+	out->MieScattering[0] = in.MieScattering.x; out->MieScattering[1] = in.MieScattering.y; out->MieScattering[2] = in.MieScattering.z;
+	out->MieScatteringAvg = (in.MieScattering.x + in.MieScattering.y + in.MieScattering.z) / 3.0f;
+	out->SolarIrradiance[0] = in.SolarIrradiance.x; out->SolarIrradiance[1] = in.SolarIrradiance.y; out->SolarIrradiance[2] = in.SolarIrradiance.z;
+}
+
+// ---------------------------- scalar ----------------------------
+
+static inline float FastExpNegScalar(float x)
+{
+	float v = -x;
+	v = (v < EXP_LO) ? EXP_LO : v;
+	v = (v > 0.0f) ? 0.0f : v;
+
+	// v = n*ln2 + r, |r| <= ln2/2
+	const float n = std::floor(v * EXP_LOG2E + 0.5f);
+	float r = v - n * EXP_C1;
+	r = r - n * EXP_C2;
+
+	float p = EXP_P0;
+	p = p * r + EXP_P1;
+	p = p * r + EXP_P2;
+	p = p * r + EXP_P3;
+	p = p * r + EXP_P4;
+	p = p * r + EXP_P5;
+	p = p * (r * r) + (r + 1.0f);
+
+	// 2^n 은 지수 비트에 직접 넣는다 (n ∈ [-126, 0])
+	const int32_t bits = ((int32_t)n + 127) << 23;
+	float scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+
+static inline float SpeciesDensityScalar(const AtmosMediumSpecies& s, float h)
+{
+	float rho = 0.0f;
+	for (int l = 0; l < s.NumLayers; ++l)
+	{
+		const AtmosMediumLayer& L = s.Layers[l];
+		if (h > L.Width)
+		{
+			continue;
+		}
+		float term = L.LinearTerm * h + L.ConstantTerm;
+		if (L.ExpTerm != 0.0f)
+		{
+			term += L.ExpTerm * FastExpNegScalar(h * L.InvScale);
+		}
+		rho += term;
+	}
+	return (rho < 0.0f) ? 0.0f : ((rho > 1.0f) ? 1.0f : rho);
+}
+
+static void EvaluateMediumScalar(const AtmosMedium& m, const float* h, int n,
+	float* outRhoR, float* outRhoM, float* outExtR, float* outExtG, float* outExtB)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		const float rhoR = SpeciesDensityScalar(m.Rayleigh, h[i]);
+		const float rhoM = SpeciesDensityScalar(m.Mie, h[i]);
+		const float rhoO = SpeciesDensityScalar(m.Ozone, h[i]);
+		if (outRhoR) outRhoR[i] = rhoR;
+		if (outRhoM) outRhoM[i] = rhoM;
+		outExtR[i] = m.RayleighScattering[0] * rhoR + m.MieExtinction[0] * rhoM + m.OzoneAbsorption[0] * rhoO;
+		outExtG[i] = m.RayleighScattering[1] * rhoR + m.MieExtinction[1] * rhoM + m.OzoneAbsorption[1] * rhoO;
+		outExtB[i] = m.RayleighScattering[2] * rhoR + m.MieExtinction[2] * rhoM + m.OzoneAbsorption[2] * rhoO;
+	}
+}
+
+static void ExpNegScalar(const float* x, int n, float* out)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		out[i] = FastExpNegScalar(x[i]);
+	}
+}
+
+static float CompensatedSumScalar(const float* x, int n)
+{
+	KahanSum sum;
+	for (int i = 0; i < n; ++i)
+	{
+		sum.Add(x[i]);
+	}
+	return sum.Sum;
+}
+
+// (1 - g^2) / (4π x^1.5), x = 1 + g^2 - 2g cosθ. ComputeAtmos.cpp의 HenyeyGreensteinPhase와 연산 순서가 같다
+static void HenyeyGreensteinScalar(float wx, float wy, float wz,
+	const float* dirX, const float* dirY, const float* dirZ, int n, float g, float* out)
+{
+	const float gg = g * g;
+	for (int i = 0; i < n; ++i)
+	{
+		const float cosTheta = wx * dirX[i] + wy * dirY[i] + wz * dirZ[i];
+		float x = 1.0f + gg - 2.0f * g * cosTheta;
+		x = (x > 1e-6f) ? x : 1e-6f;
+		out[i] = (1.0f - gg) / (4.0f * HG_PI * x * std::sqrt(x));
+	}
+}
+
+static void LutCoordsScalar(const AtmosLutMapping& map, const AtmosLutDims& dims,
+	const float* r, const float* mu, const float* muS, const float* nu, int n, AtmosLutCoords* out)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		const bool bRayHitsGround = map.RayIntersectsGround(r[i], mu[i]);
+		out->ScatR[i] = map.ScatteringRToTexel(r[i], dims.ScatteringR);
+		out->ScatMu[i] = map.ScatteringMuToTexel(r[i], mu[i], bRayHitsGround, dims.ScatteringMu);
+		out->ScatMuS[i] = map.ScatteringMuSToTexel(muS[i], dims.ScatteringMuS);
+		out->ScatNu[i] = map.ScatteringNuToTexel(nu[i], dims.ScatteringNu);
+		map.TransmittanceParamsToTexel(r[i], muS[i], dims.TransmittanceW, dims.TransmittanceH, &out->SunTrX[i], &out->SunTrY[i]);
+		out->SunVisible[i] = map.RayIntersectsGround(r[i], muS[i]) ? 0.0f : 1.0f;
+		map.IrradianceParamsToTexel(r[i], muS[i], dims.IrradianceW, dims.IrradianceH, &out->IrrX[i], &out->IrrY[i]);
+	}
+}
+
+static void SH9AccumulateScalar(const float* dirX, const float* dirY, const float* dirZ,
+	const float* radianceR, const float* radianceG, const float* radianceB, const float* weight, int n, float* inOutCoeffs)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		float Y[9];
+		EvalSH9(dirX[i], dirY[i], dirZ[i], Y);
+		const float wL[3] = { weight[i] * radianceR[i], weight[i] * radianceG[i], weight[i] * radianceB[i] };
+		for (int k = 0; k < 9; ++k)
+		{
+			inOutCoeffs[k * 3 + 0] += Y[k] * wL[0];
+			inOutCoeffs[k * 3 + 1] += Y[k] * wL[1];
+			inOutCoeffs[k * 3 + 2] += Y[k] * wL[2];
+		}
+	}
+}
+
+static void SpectralTransmittanceScalar(const AtmosSpectralLanes& lanes, const float* tau, float* out)
+{
+	for (int i = 0; i < lanes.NumLanes; ++i)
+	{
+		const float x = lanes.Extinction[0][i] * tau[0] + lanes.Extinction[1][i] * tau[1] + lanes.Extinction[2][i] * tau[2];
+		out[i] = FastExpNegScalar(x);
+	}
+}
+
+static void SpectralScatteringScalar(const AtmosSpectralLanes& lanes, const float* tau, float wR, float wM, AtmosSpectralSums* inOut)
+{
+	auto kahan = [](float* sum, float* comp, float v)
+		{
+			const float y = v - *comp;
+			const float t = *sum + y;
+			*comp = (t - *sum) - y;
+			*sum = t;
+		};
+	for (int i = 0; i < lanes.NumLanes; ++i)
+	{
+		const float x = lanes.Extinction[0][i] * tau[0] + lanes.Extinction[1][i] * tau[1] + lanes.Extinction[2][i] * tau[2];
+		const float T = FastExpNegScalar(x);
+		kahan(&inOut->R[i], &inOut->CompR[i], T * wR);
+		kahan(&inOut->M[i], &inOut->CompM[i], T * wM);
+	}
+}
+
+// ---------------------------- AVX2 (8 lane) ----------------------------
+
+ATMOS_TARGET_AVX2 static inline __m256i TailMaskAVX2(int remaining)
+{
+	return _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+ATMOS_TARGET_AVX2 static inline __m256 FastExpNegAVX2(__m256 x)
+{
+	__m256 v = _mm256_sub_ps(_mm256_setzero_ps(), x);
+	v = _mm256_max_ps(v, _mm256_set1_ps(EXP_LO));
+	v = _mm256_min_ps(v, _mm256_setzero_ps());
+
+	const __m256 n = _mm256_floor_ps(_mm256_fmadd_ps(v, _mm256_set1_ps(EXP_LOG2E), _mm256_set1_ps(0.5f)));
+	__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(EXP_C1), v);
+	r = _mm256_fnmadd_ps(n, _mm256_set1_ps(EXP_C2), r);
+
+	__m256 p = _mm256_set1_ps(EXP_P0);
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P1));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P2));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P3));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P4));
+	p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(EXP_P5));
+	p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+	const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+ATMOS_TARGET_AVX2 static inline __m256 SpeciesDensityAVX2(const AtmosMediumSpecies& s, __m256 h)
+{
+	__m256 rho = _mm256_setzero_ps();
+	for (int l = 0; l < s.NumLayers; ++l)
+	{
+		const AtmosMediumLayer& L = s.Layers[l];
+		__m256 term = _mm256_fmadd_ps(_mm256_set1_ps(L.LinearTerm), h, _mm256_set1_ps(L.ConstantTerm));
+		if (L.ExpTerm != 0.0f)
+		{
+			const __m256 e = FastExpNegAVX2(_mm256_mul_ps(h, _mm256_set1_ps(L.InvScale)));
+			term = _mm256_fmadd_ps(_mm256_set1_ps(L.ExpTerm), e, term);
+		}
+		const __m256 inside = _mm256_cmp_ps(h, _mm256_set1_ps(L.Width), _CMP_LE_OQ);
+		rho = _mm256_add_ps(rho, _mm256_and_ps(inside, term));
+	}
+	return _mm256_min_ps(_mm256_max_ps(rho, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+ATMOS_TARGET_AVX2 static void EvaluateMediumAVX2(const AtmosMedium& m, const float* h, int n,
+	float* outRhoR, float* outRhoM, float* outExtR, float* outExtG, float* outExtB)
+{
+	float* outExt[3] = { outExtR, outExtG, outExtB };
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256i mask = TailMaskAVX2(n - i);
+		const __m256 vh = _mm256_maskload_ps(h + i, mask);
+		const __m256 rhoR = SpeciesDensityAVX2(m.Rayleigh, vh);
+		const __m256 rhoM = SpeciesDensityAVX2(m.Mie, vh);
+		const __m256 rhoO = SpeciesDensityAVX2(m.Ozone, vh);
+		if (outRhoR) _mm256_maskstore_ps(outRhoR + i, mask, rhoR);
+		if (outRhoM) _mm256_maskstore_ps(outRhoM + i, mask, rhoM);
+		for (int c = 0; c < 3; ++c)
+		{
+			__m256 ext = _mm256_mul_ps(_mm256_set1_ps(m.OzoneAbsorption[c]), rhoO);
+			ext = _mm256_fmadd_ps(_mm256_set1_ps(m.MieExtinction[c]), rhoM, ext);
+			ext = _mm256_fmadd_ps(_mm256_set1_ps(m.RayleighScattering[c]), rhoR, ext);
+			_mm256_maskstore_ps(outExt[c] + i, mask, ext);
+		}
+	}
+}
+
+ATMOS_TARGET_AVX2 static void ExpNegAVX2(const float* x, int n, float* out)
+{
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256i mask = TailMaskAVX2(n - i);
+		_mm256_maskstore_ps(out + i, mask, FastExpNegAVX2(_mm256_maskload_ps(x + i, mask)));
+	}
+}
+
+ATMOS_TARGET_AVX2 static float CompensatedSumAVX2(const float* x, int n)
+{
+	__m256 sum = _mm256_setzero_ps();
+	__m256 comp = _mm256_setzero_ps();
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256 y = _mm256_sub_ps(_mm256_maskload_ps(x + i, TailMaskAVX2(n - i)), comp);
+		const __m256 t = _mm256_add_ps(sum, y);
+		comp = _mm256_sub_ps(_mm256_sub_ps(t, sum), y);
+		sum = t;
+	}
+
+	// lane 합 - lane 보정값
+	alignas(32) float lanes[8], comps[8];
+	_mm256_store_ps(lanes, sum);
+	_mm256_store_ps(comps, comp);
+	KahanSum total;
+	for (int l = 0; l < 8; ++l)
+	{
+		total.Add(lanes[l]);
+	}
+	for (int l = 0; l < 8; ++l)
+	{
+		total.Add(-comps[l]);
+	}
+	return total.Sum;
+}
+
+// FMA 없이 scalar와 같은 순서로 계산해서 결과가 비트 단위로 같다
+ATMOS_TARGET_AVX2 static void HenyeyGreensteinAVX2(float wx, float wy, float wz,
+	const float* dirX, const float* dirY, const float* dirZ, int n, float g, float* out)
+{
+	const float gg = g * g;
+	const __m256 vwx = _mm256_set1_ps(wx), vwy = _mm256_set1_ps(wy), vwz = _mm256_set1_ps(wz);
+	const __m256 onePlusGG = _mm256_set1_ps(1.0f + gg), twoG = _mm256_set1_ps(2.0f * g);
+	const __m256 numer = _mm256_set1_ps(1.0f - gg), fourPi = _mm256_set1_ps(4.0f * HG_PI);
+	const __m256 minX = _mm256_set1_ps(1e-6f);
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256i mask = TailMaskAVX2(n - i);
+		const __m256 dx = _mm256_maskload_ps(dirX + i, mask);
+		const __m256 dy = _mm256_maskload_ps(dirY + i, mask);
+		const __m256 dz = _mm256_maskload_ps(dirZ + i, mask);
+		const __m256 cosTheta = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vwx, dx), _mm256_mul_ps(vwy, dy)), _mm256_mul_ps(vwz, dz));
+		const __m256 x = _mm256_max_ps(_mm256_sub_ps(onePlusGG, _mm256_mul_ps(twoG, cosTheta)), minX);
+		const __m256 denom = _mm256_mul_ps(_mm256_mul_ps(fourPi, x), _mm256_sqrt_ps(x));
+		_mm256_maskstore_ps(out + i, mask, _mm256_div_ps(numer, denom));
+	}
+}
+
+// 계수 27개를 lane별로 누적하고 끝에서 한 번 모은다. 꼬리 lane은 maskload로 가중치가 0이 되어 기여하지 않는다
+ATMOS_TARGET_AVX2 static void SH9AccumulateAVX2(const float* dirX, const float* dirY, const float* dirZ,
+	const float* radianceR, const float* radianceG, const float* radianceB, const float* weight, int n, float* inOutCoeffs)
+{
+	__m256 acc[27];
+	for (int k = 0; k < 27; ++k)
+	{
+		acc[k] = _mm256_setzero_ps();
+	}
+
+	const __m256 c0 = _mm256_set1_ps(0.282095f), c1 = _mm256_set1_ps(0.488603f), c2 = _mm256_set1_ps(1.092548f);
+	const __m256 c20 = _mm256_set1_ps(0.315392f), c22 = _mm256_set1_ps(0.546274f);
+	const __m256 three = _mm256_set1_ps(3.0f), one = _mm256_set1_ps(1.0f);
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256i mask = TailMaskAVX2(n - i);
+		const __m256 x = _mm256_maskload_ps(dirX + i, mask);
+		const __m256 y = _mm256_maskload_ps(dirY + i, mask);
+		const __m256 z = _mm256_maskload_ps(dirZ + i, mask);
+		const __m256 w = _mm256_maskload_ps(weight + i, mask);
+		const __m256 wL[3] = {
+			_mm256_mul_ps(w, _mm256_maskload_ps(radianceR + i, mask)),
+			_mm256_mul_ps(w, _mm256_maskload_ps(radianceG + i, mask)),
+			_mm256_mul_ps(w, _mm256_maskload_ps(radianceB + i, mask)) };
+
+		const __m256 Y[9] = {
+			c0,
+			_mm256_mul_ps(c1, y),
+			_mm256_mul_ps(c1, z),
+			_mm256_mul_ps(c1, x),
+			_mm256_mul_ps(c2, _mm256_mul_ps(x, y)),
+			_mm256_mul_ps(c2, _mm256_mul_ps(y, z)),
+			_mm256_mul_ps(c20, _mm256_fmsub_ps(three, _mm256_mul_ps(z, z), one)),
+			_mm256_mul_ps(c2, _mm256_mul_ps(x, z)),
+			_mm256_mul_ps(c22, _mm256_fmsub_ps(x, x, _mm256_mul_ps(y, y))) };
+		for (int k = 0; k < 9; ++k)
+		{
+			acc[k * 3 + 0] = _mm256_fmadd_ps(Y[k], wL[0], acc[k * 3 + 0]);
+			acc[k * 3 + 1] = _mm256_fmadd_ps(Y[k], wL[1], acc[k * 3 + 1]);
+			acc[k * 3 + 2] = _mm256_fmadd_ps(Y[k], wL[2], acc[k * 3 + 2]);
+		}
+	}
+
+	for (int k = 0; k < 27; ++k)
+	{
+		alignas(32) float lanes[8];
+		_mm256_store_ps(lanes, acc[k]);
+		inOutCoeffs[k] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+	}
+}
+
+// AtmosLutMapping의 식을 lane 단위로 옮긴 것. 분기 (지면/하늘, 매핑 모드)는 blend와 batch 밖 분기로 바꿨다
+struct LutMappingAVX2
+{
+	__m256 Rg, Rt, H, MuSA, Zero, One, Half;
+	bool bBruneton;
+
+	ATMOS_TARGET_AVX2 explicit LutMappingAVX2(const AtmosLutMapping& map)
+	{
+		Rg = _mm256_set1_ps(map.Rg);
+		Rt = _mm256_set1_ps(map.Rt);
+		H = _mm256_set1_ps(map.H);
+		MuSA = _mm256_set1_ps(map.MuSA);
+		Zero = _mm256_setzero_ps();
+		One = _mm256_set1_ps(1.0f);
+		Half = _mm256_set1_ps(0.5f);
+		bBruneton = map.Mode == ATMOS_LUT_MAPPING_BRUNETON;
+	}
+
+	ATMOS_TARGET_AVX2 inline __m256 Clamp(__m256 x, __m256 a, __m256 b) const { return _mm256_min_ps(_mm256_max_ps(x, a), b); }
+
+	ATMOS_TARGET_AVX2 inline __m256 ToTexel(__m256 x, int n) const
+	{
+		const __m256 c = bBruneton ? _mm256_mul_ps(x, _mm256_set1_ps(float(n - 1)))
+			: _mm256_sub_ps(_mm256_mul_ps(x, _mm256_set1_ps(float(n))), Half);
+		return Clamp(c, Zero, _mm256_set1_ps(float(n - 1)));
+	}
+
+	// [-1, 1] → [0, 1]
+	ATMOS_TARGET_AVX2 inline __m256 SignedToUnit(__m256 x) const { return _mm256_mul_ps(_mm256_add_ps(x, One), Half); }
+
+	// 반지름 제곱의 차는 AtmosLutMapping과 같이 인수분해한 꼴로 계산한다 (km 단위 r * r - Rg * Rg는 상쇄된다)
+	ATMOS_TARGET_AVX2 inline __m256 RhoSq(__m256 r) const { return _mm256_mul_ps(_mm256_sub_ps(r, Rg), _mm256_add_ps(r, Rg)); }
+	ATMOS_TARGET_AVX2 inline __m256 TopSq(__m256 r) const { return _mm256_mul_ps(_mm256_sub_ps(Rt, r), _mm256_add_ps(Rt, r)); }
+
+	ATMOS_TARGET_AVX2 inline __m256 DistanceToTop(__m256 r, __m256 mu) const
+	{
+		const __m256 rmu = _mm256_mul_ps(r, mu);
+		const __m256 disc = _mm256_add_ps(_mm256_mul_ps(rmu, rmu), TopSq(r));
+		const __m256 d = _mm256_add_ps(_mm256_sub_ps(Zero, rmu), _mm256_sqrt_ps(_mm256_max_ps(disc, Zero)));
+		return _mm256_max_ps(d, Zero);
+	}
+
+	ATMOS_TARGET_AVX2 inline __m256 RayIntersectsGround(__m256 r, __m256 mu) const
+	{
+		const __m256 rmu = _mm256_mul_ps(r, mu);
+		return _mm256_and_ps(_mm256_cmp_ps(mu, Zero, _CMP_LT_OQ), _mm256_cmp_ps(_mm256_mul_ps(rmu, rmu), RhoSq(r), _CMP_GE_OQ));
+	}
+
+	ATMOS_TARGET_AVX2 inline __m256 Rho(__m256 r) const
+	{
+		return _mm256_sqrt_ps(_mm256_max_ps(RhoSq(r), Zero));
+	}
+};
+
+ATMOS_TARGET_AVX2 static void LutCoordsAVX2(const AtmosLutMapping& map, const AtmosLutDims& dims,
+	const float* r, const float* mu, const float* muS, const float* nu, int n, AtmosLutCoords* out)
+{
+	const LutMappingAVX2 m(map);
+	const __m256 RtMinusRg = _mm256_sub_ps(m.Rt, m.Rg);
+	const int nGround = dims.ScatteringMu / 2, nSky = dims.ScatteringMu - nGround;
+
+	for (int i = 0; i < n; i += 8)
+	{
+		const __m256i mask = TailMaskAVX2(n - i);
+		// 남는 lane은 r = Rt, 각도 0으로 채워 sqrt/나눗셈이 유효한 값만 보게 한다
+		const __m256 vr = _mm256_blendv_ps(m.Rt, _mm256_maskload_ps(r + i, mask), _mm256_castsi256_ps(mask));
+		const __m256 vmu = _mm256_maskload_ps(mu + i, mask);
+		const __m256 vmuS = _mm256_maskload_ps(muS + i, mask);
+		const __m256 vnu = _mm256_maskload_ps(nu + i, mask);
+
+		const __m256 unitR = _mm256_div_ps(_mm256_sub_ps(vr, m.Rg), RtMinusRg);
+		__m256 scatR, scatMu, scatMuS, sunTrX, sunTrY;
+		if (m.bBruneton)
+		{
+			const __m256 rho = m.Rho(vr);
+			const __m256 rhoOverH = _mm256_div_ps(rho, m.H);
+			scatR = m.ToTexel(rhoOverH, dims.ScatteringR);
+
+			// mu: 지면에 닿는 ray [0, n/2), 대기 끝에 닿는 ray [n/2, n)
+			const __m256 rmu = _mm256_mul_ps(vr, vmu);
+			const __m256 rmu2 = _mm256_mul_ps(rmu, rmu);
+			const __m256 disc = _mm256_sub_ps(rmu2, m.RhoSq(vr));
+			const __m256 bGround = m.RayIntersectsGround(vr, vmu);
+
+			const __m256 dGround = _mm256_sub_ps(_mm256_sub_ps(m.Zero, rmu), _mm256_sqrt_ps(_mm256_max_ps(disc, m.Zero)));
+			const __m256 dMinG = _mm256_sub_ps(vr, m.Rg);
+			const __m256 rangeG = _mm256_sub_ps(rho, dMinG);
+			const __m256 bDegenerate = _mm256_cmp_ps(rangeG, m.Zero, _CMP_EQ_OQ);
+			__m256 xG = _mm256_div_ps(_mm256_sub_ps(dGround, dMinG), _mm256_blendv_ps(rangeG, m.One, bDegenerate));
+			xG = _mm256_andnot_ps(bDegenerate, m.Clamp(xG, m.Zero, m.One));
+			const __m256 texG = _mm256_mul_ps(_mm256_set1_ps(float(nGround - 1)), _mm256_sub_ps(m.One, xG));
+
+			const __m256 dSky = _mm256_add_ps(_mm256_sub_ps(m.Zero, rmu), _mm256_sqrt_ps(_mm256_max_ps(_mm256_add_ps(rmu2, m.TopSq(vr)), m.Zero)));
+			const __m256 dMinS = _mm256_sub_ps(m.Rt, vr);
+			const __m256 dMaxS = _mm256_add_ps(rho, m.H);
+			const __m256 xS = m.Clamp(_mm256_div_ps(_mm256_sub_ps(dSky, dMinS), _mm256_sub_ps(dMaxS, dMinS)), m.Zero, m.One);
+			const __m256 texS = _mm256_add_ps(_mm256_set1_ps(float(nGround)), _mm256_mul_ps(_mm256_set1_ps(float(nSky - 1)), xS));
+			scatMu = _mm256_blendv_ps(texS, texG, bGround);
+
+			// mu_s: 지면 기준 대기 끝까지 거리
+			const __m256 dMinMuS = RtMinusRg;
+			const __m256 a = _mm256_div_ps(_mm256_sub_ps(m.DistanceToTop(m.Rg, vmuS), dMinMuS), _mm256_sub_ps(m.H, dMinMuS));
+			const __m256 xMuS = _mm256_div_ps(_mm256_max_ps(_mm256_sub_ps(m.One, _mm256_div_ps(a, m.MuSA)), m.Zero), _mm256_add_ps(m.One, a));
+			scatMuS = m.ToTexel(xMuS, dims.ScatteringMuS);
+
+			// Transmittance(r, mu_s)
+			sunTrX = m.ToTexel(_mm256_div_ps(_mm256_sub_ps(m.DistanceToTop(vr, vmuS), dMinS), _mm256_sub_ps(dMaxS, dMinS)), dims.TransmittanceW);
+			sunTrY = m.ToTexel(rhoOverH, dims.TransmittanceH);
+		}
+		else
+		{
+			scatR = m.ToTexel(unitR, dims.ScatteringR);
+			scatMu = m.ToTexel(m.SignedToUnit(vmu), dims.ScatteringMu);
+			scatMuS = m.ToTexel(m.SignedToUnit(vmuS), dims.ScatteringMuS);
+			sunTrX = m.ToTexel(m.SignedToUnit(vmuS), dims.TransmittanceW);
+			sunTrY = m.ToTexel(unitR, dims.TransmittanceH);
+		}
+
+		_mm256_maskstore_ps(out->ScatR + i, mask, scatR);
+		_mm256_maskstore_ps(out->ScatMu + i, mask, scatMu);
+		_mm256_maskstore_ps(out->ScatMuS + i, mask, scatMuS);
+		_mm256_maskstore_ps(out->ScatNu + i, mask, m.ToTexel(m.SignedToUnit(vnu), dims.ScatteringNu));
+		_mm256_maskstore_ps(out->SunTrX + i, mask, sunTrX);
+		_mm256_maskstore_ps(out->SunTrY + i, mask, sunTrY);
+		_mm256_maskstore_ps(out->SunVisible + i, mask, _mm256_andnot_ps(m.RayIntersectsGround(vr, vmuS), m.One));
+
+		// Irradiance는 두 매핑 모두 선형
+		_mm256_maskstore_ps(out->IrrX + i, mask, m.ToTexel(m.SignedToUnit(vmuS), dims.IrradianceW));
+		_mm256_maskstore_ps(out->IrrY + i, mask, m.ToTexel(unitR, dims.IrradianceH));
+	}
+}
+
+ATMOS_TARGET_AVX2 static inline __m256 SpectralExtinctionAVX2(const AtmosSpectralLanes& lanes, const float* tau, int i)
+{
+	__m256 x = _mm256_mul_ps(_mm256_load_ps(&lanes.Extinction[2][i]), _mm256_set1_ps(tau[2]));
+	x = _mm256_fmadd_ps(_mm256_load_ps(&lanes.Extinction[1][i]), _mm256_set1_ps(tau[1]), x);
+	return _mm256_fmadd_ps(_mm256_load_ps(&lanes.Extinction[0][i]), _mm256_set1_ps(tau[0]), x);
+}
+
+ATMOS_TARGET_AVX2 static void SpectralTransmittanceAVX2(const AtmosSpectralLanes& lanes, const float* tau, float* out)
+{
+	for (int i = 0; i < lanes.NumLanes; i += 8)
+	{
+		_mm256_storeu_ps(out + i, FastExpNegAVX2(SpectralExtinctionAVX2(lanes, tau, i)));
+	}
+}
+
+ATMOS_TARGET_AVX2 static inline void KahanAddAVX2(float* sum, float* comp, __m256 v)
+{
+	const __m256 s = _mm256_load_ps(sum);
+	const __m256 y = _mm256_sub_ps(v, _mm256_load_ps(comp));
+	const __m256 t = _mm256_add_ps(s, y);
+	_mm256_store_ps(comp, _mm256_sub_ps(_mm256_sub_ps(t, s), y));
+	_mm256_store_ps(sum, t);
+}
+
+ATMOS_TARGET_AVX2 static void SpectralScatteringAVX2(const AtmosSpectralLanes& lanes, const float* tau, float wR, float wM, AtmosSpectralSums* inOut)
+{
+	const __m256 vwR = _mm256_set1_ps(wR), vwM = _mm256_set1_ps(wM);
+	for (int i = 0; i < lanes.NumLanes; i += 8)
+	{
+		const __m256 T = FastExpNegAVX2(SpectralExtinctionAVX2(lanes, tau, i));
+		KahanAddAVX2(&inOut->R[i], &inOut->CompR[i], _mm256_mul_ps(T, vwR));
+		KahanAddAVX2(&inOut->M[i], &inOut->CompM[i], _mm256_mul_ps(T, vwM));
+	}
+}
+
+// ---------------------------- dispatch ----------------------------
+
+struct AtmosKernelTable
+{
+	void (*EvaluateMedium)(const AtmosMedium&, const float*, int, float*, float*, float*, float*, float*);
+	void (*ExpNeg)(const float*, int, float*);
+	float (*Sum)(const float*, int);
+	void (*HenyeyGreenstein)(float, float, float, const float*, const float*, const float*, int, float, float*);
+	void (*LutCoords)(const AtmosLutMapping&, const AtmosLutDims&, const float*, const float*, const float*, const float*, int, AtmosLutCoords*);
+	void (*SH9Accumulate)(const float*, const float*, const float*, const float*, const float*, const float*, const float*, int, float*);
+	void (*SpectralTransmittance)(const AtmosSpectralLanes&, const float*, float*);
+	void (*SpectralScattering)(const AtmosSpectralLanes&, const float*, float, float, AtmosSpectralSums*);
+	const char* Name;
+};
+
+static void CpuId(int leaf, int subLeaf, uint32_t out[4])
+{
+#if defined(_MSC_VER)
+	int regs[4];
+	__cpuidex(regs, leaf, subLeaf);
+	for (int i = 0; i < 4; ++i) out[i] = (uint32_t)regs[i];
+#else
+	__cpuid_count(leaf, subLeaf, out[0], out[1], out[2], out[3]);
+#endif
+}
+
+static uint64_t ReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static AtmosKernelTable SelectAtmosKernels()
+{
+	const AtmosKernelTable scalar = { EvaluateMediumScalar, ExpNegScalar, CompensatedSumScalar, HenyeyGreensteinScalar, LutCoordsScalar, SH9AccumulateScalar,
+		SpectralTransmittanceScalar, SpectralScatteringScalar, "scalar" };
+	const AtmosKernelTable avx2 = { EvaluateMediumAVX2, ExpNegAVX2, CompensatedSumAVX2, HenyeyGreensteinAVX2, LutCoordsAVX2, SH9AccumulateAVX2,
+		SpectralTransmittanceAVX2, SpectralScatteringAVX2, "AVX2" };
+
+	uint32_t regs[4];
+	CpuId(0, 0, regs);
+	const uint32_t maxLeaf = regs[0];
+	if (maxLeaf < 7)
+	{
+		return scalar;
+	}
+
+	// leaf 1 ECX: FMA(12), OSXSAVE(27), AVX(28)
+	CpuId(1, 0, regs);
+	const bool bFMA = (regs[2] & (1u << 12)) != 0;
+	const bool bOSXSave = (regs[2] & (1u << 27)) != 0;
+	const bool bAVX = (regs[2] & (1u << 28)) != 0;
+	if (!bOSXSave || !bAVX || !bFMA)
+	{
+		return scalar;
+	}
+
+	// OS가 YMM 상태(XCR0 bit 1, 2)를 저장해야 쓸 수 있다
+	const uint64_t xcr0 = ReadXCR0();
+	CpuId(7, 0, regs);
+	const bool bAVX2 = (regs[1] & (1u << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+
+	// AVX-512는 커널 단독으로는 빠르지만, 스텝 수가 64~96인 적분에서는 주변 scalar 코드까지 클럭이 내려가
+	// 전체 bake가 AVX2보다 느렸다 (Xeon 측정). 그래서 AVX2까지만 쓴다.
+	return bAVX2 ? avx2 : scalar;
+}
+
+static const AtmosKernelTable& GetAtmosKernels()
+{
+	static const AtmosKernelTable s_Kernels = SelectAtmosKernels();
+	return s_Kernels;
+}
+
+void EvaluateMediumBatch(const AtmosMedium& m, const float* h, int n,
+	float* outRhoR, float* outRhoM, float* outExtR, float* outExtG, float* outExtB)
+{
+	ASSERT(n >= 0 && n <= ATMOS_STEP_BATCH, "Batch size out of range.");
+	GetAtmosKernels().EvaluateMedium(m, h, n, outRhoR, outRhoM, outExtR, outExtG, outExtB);
+}
+
+void ExpNegBatch(const float* x, int n, float* out)
+{
+	ASSERT(n >= 0 && n <= ATMOS_STEP_BATCH, "Batch size out of range.");
+	GetAtmosKernels().ExpNeg(x, n, out);
+}
+
+float CompensatedSum(const float* x, int n)
+{
+	ASSERT(n >= 0 && n <= ATMOS_STEP_BATCH, "Batch size out of range.");
+	return GetAtmosKernels().Sum(x, n);
+}
+
+void HenyeyGreensteinBatch(float wx, float wy, float wz,
+	const float* dirX, const float* dirY, const float* dirZ, int n, float g, float* out)
+{
+	GetAtmosKernels().HenyeyGreenstein(wx, wy, wz, dirX, dirY, dirZ, n, g, out);
+}
+
+void ComputeLutCoordsBatch(const AtmosLutMapping& map, const AtmosLutDims& dims,
+	const float* r, const float* mu, const float* muS, const float* nu, int n, AtmosLutCoords* out)
+{
+	ASSERT(n >= 0 && n <= ATMOS_STEP_BATCH, "Batch size out of range.");
+	GetAtmosKernels().LutCoords(map, dims, r, mu, muS, nu, n, out);
+}
+
+void AccumulateSH9Batch(const float* dirX, const float* dirY, const float* dirZ,
+	const float* radianceR, const float* radianceG, const float* radianceB, const float* weight, int n, float* inOutCoeffs)
+{
+	GetAtmosKernels().SH9Accumulate(dirX, dirY, dirZ, radianceR, radianceG, radianceB, weight, n, inOutCoeffs);
+}
+
+void SpectralTransmittanceBatch(const AtmosSpectralLanes& lanes, const float* tau, float* out)
+{
+	ASSERT(lanes.NumLanes % 8 == 0 && lanes.NumLanes <= ATMOS_SPECTRAL_MAX_LANES, "Spectral lane count out of range.");
+	GetAtmosKernels().SpectralTransmittance(lanes, tau, out);
+}
+
+void AccumulateSpectralScattering(const AtmosSpectralLanes& lanes, const float* tau, float wR, float wM, AtmosSpectralSums* inOut)
+{
+	ASSERT(lanes.NumLanes % 8 == 0 && lanes.NumLanes <= ATMOS_SPECTRAL_MAX_LANES, "Spectral lane count out of range.");
+	GetAtmosKernels().SpectralScattering(lanes, tau, wR, wM, inOut);
+}
+
+const char* GetAtmosKernelPathName()
+{
+	return GetAtmosKernels().Name;
+}
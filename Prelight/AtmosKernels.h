@@ -0,0 +1,159 @@
+﻿#pragma once
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// 대기 적분용 SoA 커널
+// - 적분 스텝 여러 개의 고도를 한 번에 받아 밀도/소광계수를 구한다 (AVX2+FMA 8 lane / scalar)
+// - exp는 다항 근사 (Cephes expf 계열, Cody-Waite 범위 축소 + 6차 다항식)
+//   [-87.33, 0] 구간 최대 상대오차 ATMOS_FAST_EXP_MAX_REL_ERR (전 구간 float 전수 비교로 측정)
+// - 합산은 float + Kahan 보상 합산
+// 실행 경로는 첫 호출 때 CPUID로 한 번 정한다.
+// ===============================================================
+
+// 적분기가 커널에 한 번에 넘기는 스텝 수 (8 lane의 배수)
+constexpr int ATMOS_STEP_BATCH = 64;
+
+// FastExp 근사의 최대 상대오차 (측정값 1.18e-7, scalar/AVX2 동일). 결과가 FLT_MIN 미만이 되는 인자는 FLT_MIN으로 고정
+constexpr float ATMOS_FAST_EXP_MAX_REL_ERR = 1.2e-7f;
+
+struct AtmosMediumLayer
+{
+	float Width;		// h > Width 이면 기여 0 (원본 Width <= 0 은 FLT_MAX로 풀어 둠)
+	float ExpTerm;		// Scale <= 0 인 레이어는 0
+	float InvScale;		// 1 / Scale
+	float LinearTerm;
+	float ConstantTerm;
+};
+
+struct AtmosMediumSpecies
+{
+	AtmosMediumLayer Layers[2];
+	int NumLayers;		// 기여가 있는 레이어 수 (0이면 밀도는 항상 0이고 exp도 돌지 않는다)
+};
+
+// AtmosParams를 커널용으로 풀어 둔 매질 정보. BuildAtmosMedium으로 한 번 만들어 모든 적분이 공유한다.
+struct AtmosMedium
+{
+	AtmosMediumSpecies Rayleigh;
+	AtmosMediumSpecies Mie;
+	AtmosMediumSpecies Ozone;
+
+	float RayleighScattering[3];	// Rayleigh는 extinction == scattering
+	float MieExtinction[3];
+	float OzoneAbsorption[3];
+	float MieScattering[3];
+	float MieScatteringAvg;			// 채널 평균 (Mie A 채널 스칼라 근사)
+	float SolarIrradiance[3];
+
+	// 모든 종이 비었거나 순수 지수 레이어 하나(0 < ExpTerm <= 1, Linear = Constant = 0, 대기 전체 폭)면 true.
+	// 이때 투과도의 광학 두께는 Chapman 근사로 닫힌 식 계산한다 (ozone 텐트 레이어 등이 있으면 수치 적분)
+	bool bAnalyticOpticalDepth;
+
+	// 지수 레이어 중 가장 얇은 scale height [m] (적응형 적분의 샘플 밀집 폭). 지수 레이어가 없으면 대기 두께 / 8
+	float MinScaleHeight;
+};
+
+// float 보상 합산 누적기
+struct KahanSum
+{
+	float Sum = 0.0f;
+	float C = 0.0f;
+
+	void Add(float v)
+	{
+		const float y = v - C;
+		const float t = Sum + y;
+		C = (t - Sum) - y;
+		Sum = t;
+	}
+};
+
+void BuildAtmosMedium(const AtmosParams& in, AtmosMedium* out);
+
+// h[0..n) (고도, m) → 밀도 rhoR/rhoM 과 채널별 소광계수 [1/m]. n <= ATMOS_STEP_BATCH
+// outRhoR/outRhoM 은 필요 없으면 nullptr
+void EvaluateMediumBatch(const AtmosMedium& m, const float* h, int n,
+	float* outRhoR, float* outRhoM, float* outExtR, float* outExtG, float* outExtB);
+
+// out[i] = exp(-x[i]), x >= 0. n <= ATMOS_STEP_BATCH
+void ExpNegBatch(const float* x, int n, float* out);
+
+// Σ x[i] (lane별 Kahan 누적 후 보상 합산으로 모음). n <= ATMOS_STEP_BATCH
+float CompensatedSum(const float* x, int n);
+
+// out[i] = Henyey-Greenstein 위상 (cosθ = w · dir_i). 다중산란 J의 Mie 적분용, n 제한 없음
+void HenyeyGreensteinBatch(float wx, float wy, float wz,
+	const float* dirX, const float* dirY, const float* dirZ, int n, float g, float* out);
+
+// 샘플러 (AtmosSampler.cpp) 한 batch의 LUT texel 좌표. AtmosLutMapping의 *ToTexel과 같은 식 (SoA)
+struct AtmosLutDims
+{
+	int TransmittanceW, TransmittanceH;
+	int ScatteringR, ScatteringMu, ScatteringMuS, ScatteringNu;
+	int IrradianceW, IrradianceH;
+};
+
+struct AtmosLutCoords
+{
+	float ScatR[ATMOS_STEP_BATCH];
+	float ScatMu[ATMOS_STEP_BATCH];
+	float ScatMuS[ATMOS_STEP_BATCH];
+	float ScatNu[ATMOS_STEP_BATCH];
+	float SunTrX[ATMOS_STEP_BATCH];		// Transmittance(r, mu_s)
+	float SunTrY[ATMOS_STEP_BATCH];
+	float SunVisible[ATMOS_STEP_BATCH];	// 1: 태양 방향 ray가 지면에 막히지 않음, 0: 막힘
+	float IrrX[ATMOS_STEP_BATCH];
+	float IrrY[ATMOS_STEP_BATCH];
+};
+
+// r[i] ∈ [Rg, Rt], mu/muS/nu ∈ [-1, 1] → texel 좌표. n <= ATMOS_STEP_BATCH
+void ComputeLutCoordsBatch(const AtmosLutMapping& map, const AtmosLutDims& dims,
+	const float* r, const float* mu, const float* muS, const float* nu, int n, AtmosLutCoords* out);
+
+// 실수 SH L2 기저 (AtmosSkySH 순서)
+inline void EvalSH9(float x, float y, float z, float* outY)
+{
+	outY[0] = 0.282095f;
+	outY[1] = 0.488603f * y;
+	outY[2] = 0.488603f * z;
+	outY[3] = 0.488603f * x;
+	outY[4] = 1.092548f * x * y;
+	outY[5] = 1.092548f * y * z;
+	outY[6] = 0.315392f * (3.0f * z * z - 1.0f);
+	outY[7] = 1.092548f * x * z;
+	outY[8] = 0.546274f * (x * x - y * y);
+}
+
+// 단위 방향 n개 (SoA)의 RGB radiance에 입체각 가중치를 곱해 SH 계수에 더한다: inOutCoeffs[k * 3 + c] += Σ w_i L_c,i Y_k(dir_i).
+// n 제한 없음. AVX2는 lane별 부분합을 마지막에 모으므로 scalar와 합산 순서가 달라 마지막 비트는 다를 수 있다
+void AccumulateSH9Batch(const float* dirX, const float* dirY, const float* dirZ,
+	const float* radianceR, const float* radianceG, const float* radianceB, const float* weight, int n, float* inOutCoeffs);
+
+// ---------------------------- 분광 bake (파장 = lane) ----------------------------
+// 파장 λ의 투과도는 exp(-Σ_s β_s(λ) τ_s)이고 종별 광학 두께 τ_s (Rayleigh, Mie, Ozone)는 파장과 무관하다.
+// 그래서 분광 적분기는 경로/고도/밀도/τ_s를 한 번만 구하고, 파장별 exp와 누적만 lane으로 돈다 (AVX2는 8 파장씩)
+constexpr int ATMOS_SPECTRAL_MAX_LANES = 48;
+
+struct AtmosSpectralLanes
+{
+	int NumLanes;	// 8의 배수. 남는 lane의 계수는 0
+	alignas(32) float Extinction[3][ATMOS_SPECTRAL_MAX_LANES];	// 종 s의 소광계수 / 종 기준값 (기준값으로 잰 광학 두께 tau[s]에 곱한다)
+};
+
+// 파장별 누적 (float + Kahan 보상)
+struct AtmosSpectralSums
+{
+	alignas(32) float R[ATMOS_SPECTRAL_MAX_LANES];
+	alignas(32) float M[ATMOS_SPECTRAL_MAX_LANES];
+	alignas(32) float CompR[ATMOS_SPECTRAL_MAX_LANES];
+	alignas(32) float CompM[ATMOS_SPECTRAL_MAX_LANES];
+};
+
+// out[i] = exp(-Σ_s Extinction[s][i] tau[s]), i < NumLanes
+void SpectralTransmittanceBatch(const AtmosSpectralLanes& lanes, const float* tau, float* out);
+
+// T_i = exp(-Σ_s Extinction[s][i] tau[s]) 로 R[i] += T_i wR, M[i] += T_i wM (단산란 한 샘플의 Rayleigh / Mie)
+void AccumulateSpectralScattering(const AtmosSpectralLanes& lanes, const float* tau, float wR, float wM, AtmosSpectralSums* inOut);
+
+// 선택된 실행 경로 이름 ("AVX2", "scalar")
+const char* GetAtmosKernelPathName();
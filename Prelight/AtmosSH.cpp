@@ -0,0 +1,98 @@
+﻿#include "pch.h"
+#include "AtmosSH.h"
+#include "AtmosKernels.h"
+
+static constexpr float SH_PI = 3.14159265358979f;
+
+static_assert(ATMOS_SH_BANDS >= 2, "Sky and ground need at least one band each.");
+
+void BuildAtmosSHDirections(const float up[3], const float toSun[3], float cosHorizon, AtmosSHDirections* out)
+{
+	ASSERT(out, "SH direction output is null.");
+
+	// 방위 0 = 태양의 수평 성분. 태양이 천정/천저에 가까우면 up과 가장 덜 평행한 축을 쓴다
+	float t[3];
+	const float sDotUp = toSun[0] * up[0] + toSun[1] * up[1] + toSun[2] * up[2];
+	for (int c = 0; c < 3; ++c)
+	{
+		t[c] = toSun[c] - sDotUp * up[c];
+	}
+	float tLen = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+	if (tLen < 1e-4f)
+	{
+		const int axis = (std::fabs(up[0]) < std::fabs(up[1])) ? (std::fabs(up[0]) < std::fabs(up[2]) ? 0 : 2) : (std::fabs(up[1]) < std::fabs(up[2]) ? 1 : 2);
+		for (int c = 0; c < 3; ++c)
+		{
+			t[c] = (c == axis ? 1.0f : 0.0f) - up[axis] * up[c];
+		}
+		tLen = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		t[c] /= tLen;
+	}
+	const float b[3] = { up[1] * t[2] - up[2] * t[1], up[2] * t[0] - up[0] * t[2], up[0] * t[1] - up[1] * t[0] };
+
+	// 하늘 구역 [cosHorizon, 1], 지면 구역 [-1, cosHorizon]. 띠 수는 구역 입체각 비례 (각 구역 최소 1)
+	const float cosH = std::min(std::max(cosHorizon, -1.0f), 0.0f);
+	const int skyBands = std::min(std::max(int(std::lround(ATMOS_SH_BANDS * 0.5f * (1.0f - cosH))), 1), ATMOS_SH_BANDS - 1);
+	const int groundBands = ATMOS_SH_BANDS - skyBands;
+
+	float cosAz[ATMOS_SH_AZIMUTHS], sinAz[ATMOS_SH_AZIMUTHS];
+	for (int a = 0; a < ATMOS_SH_AZIMUTHS; ++a)
+	{
+		const float phi = 2.0f * SH_PI * (a + 0.5f) / float(ATMOS_SH_AZIMUTHS);
+		cosAz[a] = std::cos(phi);
+		sinAz[a] = std::sin(phi);
+	}
+
+	int idx = 0;
+	for (int band = 0; band < ATMOS_SH_BANDS; ++band)
+	{
+		const bool bSky = band < skyBands;
+		const float top = bSky ? 1.0f : cosH;
+		const float span = bSky ? (1.0f - cosH) / float(skyBands) : (cosH + 1.0f) / float(groundBands);
+		const int k = bSky ? band : band - skyBands;
+
+		const float mu = top - (k + 0.5f) * span;
+		const float sinT = std::sqrt(std::max(0.0f, 1.0f - mu * mu));
+		const float weight = 2.0f * SH_PI * span / float(ATMOS_SH_AZIMUTHS);
+		for (int a = 0; a < ATMOS_SH_AZIMUTHS; ++a, ++idx)
+		{
+			const float ct = sinT * cosAz[a], cb = sinT * sinAz[a];
+			out->X[idx] = mu * up[0] + ct * t[0] + cb * b[0];
+			out->Y[idx] = mu * up[1] + ct * t[1] + cb * b[1];
+			out->Z[idx] = mu * up[2] + ct * t[2] + cb * b[2];
+			out->Mu[idx] = mu;
+			out->CosAzimuth[idx] = cosAz[a];
+			out->Weight[idx] = weight;
+		}
+	}
+	out->NumSky = skyBands * ATMOS_SH_AZIMUTHS;
+}
+
+// radiance SH L_lm → 조도 SH E_lm = Â_l L_lm (Â0 = π, Â1 = 2π/3, Â2 = π/4)
+void ConvolveIrradianceSH(const float* radianceCoeffs, AtmosSkySH* out)
+{
+	const float bandScale[3] = { SH_PI, 2.0f * SH_PI / 3.0f, SH_PI / 4.0f };
+	for (int k = 0; k < 9; ++k)
+	{
+		const int band = (k == 0) ? 0 : (k < 4 ? 1 : 2);
+		out->Coeffs[k].x = radianceCoeffs[k * 3 + 0] * bandScale[band];
+		out->Coeffs[k].y = radianceCoeffs[k * 3 + 1] * bandScale[band];
+		out->Coeffs[k].z = radianceCoeffs[k * 3 + 2] * bandScale[band];
+	}
+}
+
+void EvaluateIrradianceSH(const AtmosSkySH& sh, const float n[3], float outRGB[3])
+{
+	float Y[9];
+	EvalSH9(n[0], n[1], n[2], Y);
+	outRGB[0] = outRGB[1] = outRGB[2] = 0.0f;
+	for (int k = 0; k < 9; ++k)
+	{
+		outRGB[0] += sh.Coeffs[k].x * Y[k];
+		outRGB[1] += sh.Coeffs[k].y * Y[k];
+		outRGB[2] += sh.Coeffs[k].z * Y[k];
+	}
+}
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// 하늘 조도 L2 SH 투영 (AtmosSampler / AtmosSkyView 공용)
+// - 방향: up을 천정으로 하는 국소 좌표의 층화 샘플. 천정각 cos 축을 지평선에서 하늘 / 지면 두 구역으로 나누고
+//   구역마다 입체각에 비례한 수의 cos 균등 띠로, 띠 안은 방위 균등으로 나눈 층의 중심 한 점씩 쓴다
+//   (지평선이 층 경계라 하늘/지면 불연속이 층 하나 안에 섞이지 않는다. jitter가 없어 매 프레임 결과가 깜빡이지 않는다)
+// - 방위 0은 태양 방향의 수평 성분이라 태양 주변 Mie 산란이 좌우 대칭인 층에 나뉘어 들어간다
+// - 투영은 AccumulateSH9Batch (AVX2 / scalar), convolution은 Ramamoorthi & Hanrahan 2001
+// ===============================================================
+
+constexpr int ATMOS_SH_BANDS = 16;		// 천정각 띠 수 (하늘 + 지면)
+constexpr int ATMOS_SH_AZIMUTHS = 16;	// 띠 하나의 방위 층 수
+constexpr int ATMOS_SH_DIRS = ATMOS_SH_BANDS * ATMOS_SH_AZIMUTHS;
+
+struct AtmosSHDirections
+{
+	float X[ATMOS_SH_DIRS];				// 월드 (행성) 좌표 단위 방향
+	float Y[ATMOS_SH_DIRS];
+	float Z[ATMOS_SH_DIRS];
+	float Mu[ATMOS_SH_DIRS];			// up과의 cos
+	float CosAzimuth[ATMOS_SH_DIRS];	// 태양과의 방위각 cos
+	float Weight[ATMOS_SH_DIRS];		// 층의 입체각 [sr] (합 4π)
+	int NumSky;							// 앞의 NumSky개가 지평선 위, 나머지는 지면에 닿는 방향
+};
+
+// up: 단위 벡터, toSun: 태양 쪽 방향 (길이 무관, up과 평행하면 임의의 수평 방향을 방위 0으로),
+// cosHorizon: 지평선 방향의 cos (= -sqrt(1 - (Rg / r)^2))
+void BuildAtmosSHDirections(const float up[3], const float toSun[3], float cosHorizon, AtmosSHDirections* out);
+
+// AccumulateSH9Batch로 모은 radiance 투영 계수 (9 x RGB) → clamped cosine convolution한 조도 SH
+void ConvolveIrradianceSH(const float* radianceCoeffs, AtmosSkySH* out);
+
+// 법선 n (단위 벡터) 방향 조도
+void EvaluateIrradianceSH(const AtmosSkySH& sh, const float n[3], float outRGB[3]);
@@ -0,0 +1,262 @@
+﻿#include "pch.h"
+#include "AtmosSampler.h"
+#include "AtmosKernels.h"
+#include "AtmosSH.h"
+
+static constexpr float SAMPLER_PI = 3.14159265358979f;
+
+struct AtmosSampler
+{
+	AtmosLutMapping Mapping;
+	AtmosLutDims Dims;
+	const float* TransmittanceRGB;
+	const float* ScatteringRGBA;
+	const float* IrradianceRGB;
+
+	float MieG;
+	float MieTint[3];		// MieScattering / MieScatteringAvg (A 채널 → RGB Mie)
+	float GroundAlbedo[3];
+
+	AtmosSampler(const AtmosParams& in, const AtmosResult& lut)
+		: Mapping(lut.LutMapping, in.PlanetRadius, in.PlanetRadius + in.AtmosphereHeight), Dims{},
+		TransmittanceRGB(lut.TransmittanceRGB), ScatteringRGBA(lut.ScatteringRGBA), IrradianceRGB(lut.IrradianceRGB),
+		MieG(in.MieG), MieTint{}, GroundAlbedo{ in.GroundAlbedo.x, in.GroundAlbedo.y, in.GroundAlbedo.z }
+	{
+	}
+};
+
+static inline float SamplerClamp(float x, float a, float b)
+{
+	return x < a ? a : (x > b ? b : x);
+}
+
+static inline float RayleighPhaseSampler(float nu)
+{
+	return 3.0f / (16.0f * SAMPLER_PI) * (1.0f + nu * nu);
+}
+
+static inline float HenyeyGreensteinSampler(float nu, float g)
+{
+	const float gg = g * g;
+	const float denom = 1.0f + gg - 2.0f * g * nu;
+	return (1.0f - gg) / (4.0f * SAMPLER_PI * denom * std::sqrt(denom));
+}
+
+// 연속 texel 좌표 x ∈ [0, n - 1] → 양쪽 texel과 가중치
+static inline void SplitTexel(float x, int n, int* i0, int* i1, float* f)
+{
+	*i0 = (int)x;
+	*i1 = std::min(*i0 + 1, n - 1);
+	*f = x - float(*i0);
+}
+
+// RGB 2D LUT bilinear
+static void FetchBilinearRGB(const float* lut, int w, int h, float x, float y, float* out)
+{
+	int x0, x1, y0, y1;
+	float fx, fy;
+	SplitTexel(x, w, &x0, &x1, &fx);
+	SplitTexel(y, h, &y0, &y1, &fy);
+
+	const float* t00 = &lut[((size_t)y0 * w + x0) * 3];
+	const float* t10 = &lut[((size_t)y0 * w + x1) * 3];
+	const float* t01 = &lut[((size_t)y1 * w + x0) * 3];
+	const float* t11 = &lut[((size_t)y1 * w + x1) * 3];
+	for (int c = 0; c < 3; ++c)
+	{
+		const float a = t00[c] + (t10[c] - t00[c]) * fx;
+		const float b = t01[c] + (t11[c] - t01[c]) * fx;
+		out[c] = a + (b - a) * fy;
+	}
+}
+
+// 4D 산란 LUT quadrilinear (16 texel). 셰이더의 3D 텍스처 + nu 수동 보간과 같은 결과
+static void FetchScattering(const AtmosSampler& s, float xr, float xmu, float xmus, float xnu, float* outRGBA)
+{
+	const AtmosLutDims& d = s.Dims;
+	int r[2], mu[2], mus[2], nu[2];
+	float fr, fmu, fmus, fnu;
+	SplitTexel(xr, d.ScatteringR, &r[0], &r[1], &fr);
+	SplitTexel(xmu, d.ScatteringMu, &mu[0], &mu[1], &fmu);
+	SplitTexel(xmus, d.ScatteringMuS, &mus[0], &mus[1], &fmus);
+	SplitTexel(xnu, d.ScatteringNu, &nu[0], &nu[1], &fnu);
+
+	const float wr[2] = { 1.0f - fr, fr };
+	const float wmu[2] = { 1.0f - fmu, fmu };
+	const float wmus[2] = { 1.0f - fmus, fmus };
+	const float wnu[2] = { 1.0f - fnu, fnu };
+
+	float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int a = 0; a < 2; ++a)
+	{
+		for (int b = 0; b < 2; ++b)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				const size_t row = (((size_t)r[a] * d.ScatteringMu + mu[b]) * d.ScatteringMuS + mus[c]) * d.ScatteringNu;
+				const float w3 = wr[a] * wmu[b] * wmus[c];
+				for (int e = 0; e < 2; ++e)
+				{
+					const float w = w3 * wnu[e];
+					const float* t = &s.ScatteringRGBA[(row + nu[e]) * 4];
+					acc[0] += t[0] * w;
+					acc[1] += t[1] * w;
+					acc[2] += t[2] * w;
+					acc[3] += t[3] * w;
+				}
+			}
+		}
+	}
+	outRGBA[0] = acc[0]; outRGBA[1] = acc[1]; outRGBA[2] = acc[2]; outRGBA[3] = acc[3];
+}
+
+AtmosSampler* CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut)
+{
+	ASSERT(in.PlanetRadius > 0.0f && in.AtmosphereHeight > 0.0f, "Invalid planet/atmosphere radius.");
+	ASSERT(lut.TransmittanceRGB && lut.ScatteringRGBA && lut.IrradianceRGB, "AtmosResult has no LUT data.");
+
+	AtmosSampler* s = new AtmosSampler(in, lut);
+	s->Dims = { lut.TransmittanceW, lut.TransmittanceH,
+		lut.ScatteringR, lut.ScatteringMu, lut.ScatteringMuS, lut.ScatteringNu,
+		lut.IrradianceW, lut.IrradianceH };
+
+	// bake는 Mie를 채널 평균 산란계수로 A에 담았다 (ComputeAtmos.cpp)
+	const float mieAvg = (in.MieScattering.x + in.MieScattering.y + in.MieScattering.z) / 3.0f;
+	const float mie[3] = { in.MieScattering.x, in.MieScattering.y, in.MieScattering.z };
+	for (int c = 0; c < 3; ++c)
+	{
+		s->MieTint[c] = (mieAvg > 0.0f) ? mie[c] / mieAvg : 0.0f;
+	}
+	return s;
+}
+
+// 질의 n개 (n <= ATMOS_STEP_BATCH). sun은 정규화된 태양 쪽 방향 (햇빛 진행 방향의 반대)
+static void SampleChunk(const AtmosSampler& s, const float* sun, const AtmosSampleQuery* q, int n, AtmosSample* out)
+{
+	float r[ATMOS_STEP_BATCH], mu[ATMOS_STEP_BATCH], muS[ATMOS_STEP_BATCH], nu[ATMOS_STEP_BATCH];
+	for (int i = 0; i < n; ++i)
+	{
+		const FLOAT3& p = q[i].PosPlanetCoord;
+		const FLOAT3& v = q[i].ViewDir;
+
+		const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+		float up[3] = { 0.0f, 1.0f, 0.0f };
+		if (len > 0.0f)
+		{
+			up[0] = p.x / len; up[1] = p.y / len; up[2] = p.z / len;
+		}
+		const float vLen = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+		const float invV = (vLen > 0.0f) ? 1.0f / vLen : 0.0f;
+		const float vx = v.x * invV, vy = v.y * invV, vz = v.z * invV;
+
+		r[i] = SamplerClamp(len, s.Mapping.Rg, s.Mapping.Rt);
+		mu[i] = SamplerClamp(vx * up[0] + vy * up[1] + vz * up[2], -1.0f, 1.0f);
+		muS[i] = SamplerClamp(sun[0] * up[0] + sun[1] * up[1] + sun[2] * up[2], -1.0f, 1.0f);
+		nu[i] = SamplerClamp(vx * sun[0] + vy * sun[1] + vz * sun[2], -1.0f, 1.0f);
+	}
+
+	AtmosLutCoords coords;
+	ComputeLutCoordsBatch(s.Mapping, s.Dims, r, mu, muS, nu, n, &coords);
+
+	for (int i = 0; i < n; ++i)
+	{
+		float scat[4];
+		FetchScattering(s, coords.ScatR[i], coords.ScatMu[i], coords.ScatMuS[i], coords.ScatNu[i], scat);
+		const float phaseR = RayleighPhaseSampler(nu[i]);
+		const float phaseM = HenyeyGreensteinSampler(nu[i], s.MieG);
+		out[i].SkyRadiance.x = scat[0] * phaseR + scat[3] * s.MieTint[0] * phaseM;
+		out[i].SkyRadiance.y = scat[1] * phaseR + scat[3] * s.MieTint[1] * phaseM;
+		out[i].SkyRadiance.z = scat[2] * phaseR + scat[3] * s.MieTint[2] * phaseM;
+
+		float tr[3];
+		FetchBilinearRGB(s.TransmittanceRGB, s.Dims.TransmittanceW, s.Dims.TransmittanceH, coords.SunTrX[i], coords.SunTrY[i], tr);
+		out[i].SunTransmittance.x = tr[0] * coords.SunVisible[i];
+		out[i].SunTransmittance.y = tr[1] * coords.SunVisible[i];
+		out[i].SunTransmittance.z = tr[2] * coords.SunVisible[i];
+
+		float irr[3];
+		FetchBilinearRGB(s.IrradianceRGB, s.Dims.IrradianceW, s.Dims.IrradianceH, coords.IrrX[i], coords.IrrY[i], irr);
+		out[i].Irradiance.x = irr[0];
+		out[i].Irradiance.y = irr[1];
+		out[i].Irradiance.z = irr[2];
+	}
+}
+
+static inline void SunTowardDir(const FLOAT3& sunDir, float* out)
+{
+	const float len = std::sqrt(sunDir.x * sunDir.x + sunDir.y * sunDir.y + sunDir.z * sunDir.z);
+	const float inv = (len > 0.0f) ? -1.0f / len : 0.0f;
+	out[0] = sunDir.x * inv; out[1] = sunDir.y * inv; out[2] = sunDir.z * inv;
+}
+
+void SampleAtmosBatch(const AtmosSampler* s, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* out)
+{
+	ASSERT(s, "Sampler is null.");
+	ASSERT(count <= 0 || (queries && out), "Query/output buffer is null.");
+
+	float sun[3];
+	SunTowardDir(sunDir, sun);
+	for (int base = 0; base < count; base += ATMOS_STEP_BATCH)
+	{
+		const int n = std::min(ATMOS_STEP_BATCH, count - base);
+		SampleChunk(*s, sun, queries + base, n, out + base);
+	}
+}
+
+// radiance를 L2 SH로 투영 (AtmosSH.h의 지평선 기준 층화 방향, 가중치 = 층 입체각)한 뒤 clamped cosine convolution.
+// 지면에 닿는 방향은 대기 산란에 지면 반사 albedo/π * E(r)을 더한다 (지면까지 투과도와 지면 고도 차는 무시한 근사)
+void ProjectSkyIrradianceSH(const AtmosSampler* s, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* out)
+{
+	ASSERT(s && out, "Sampler/output is null.");
+
+	float sun[3];
+	SunTowardDir(sunDir, sun);
+
+	const float len = std::sqrt(posPlanetCoord.x * posPlanetCoord.x + posPlanetCoord.y * posPlanetCoord.y + posPlanetCoord.z * posPlanetCoord.z);
+	float up[3] = { 0.0f, 1.0f, 0.0f };
+	if (len > 0.0f)
+	{
+		up[0] = posPlanetCoord.x / len; up[1] = posPlanetCoord.y / len; up[2] = posPlanetCoord.z / len;
+	}
+	const float r = SamplerClamp(len, s->Mapping.Rg, s->Mapping.Rt);
+	const float rho = s->Mapping.Rg / r;
+	const float cosHorizon = -std::sqrt(std::max(0.0f, 1.0f - rho * rho));
+
+	AtmosSHDirections dirs;
+	BuildAtmosSHDirections(up, sun, cosHorizon, &dirs);
+
+	float coeffs[27] = {};
+	AtmosSampleQuery q[ATMOS_STEP_BATCH];
+	AtmosSample samples[ATMOS_STEP_BATCH];
+	float LR[ATMOS_STEP_BATCH], LG[ATMOS_STEP_BATCH], LB[ATMOS_STEP_BATCH];
+	for (int base = 0; base < ATMOS_SH_DIRS; base += ATMOS_STEP_BATCH)
+	{
+		const int n = std::min(ATMOS_STEP_BATCH, ATMOS_SH_DIRS - base);
+		for (int i = 0; i < n; ++i)
+		{
+			q[i].PosPlanetCoord = posPlanetCoord;
+			q[i].ViewDir = { dirs.X[base + i], dirs.Y[base + i], dirs.Z[base + i] };
+		}
+		SampleChunk(*s, sun, q, n, samples);
+
+		for (int i = 0; i < n; ++i)
+		{
+			LR[i] = samples[i].SkyRadiance.x;
+			LG[i] = samples[i].SkyRadiance.y;
+			LB[i] = samples[i].SkyRadiance.z;
+			if (base + i >= dirs.NumSky)
+			{
+				LR[i] += s->GroundAlbedo[0] / SAMPLER_PI * samples[i].Irradiance.x;
+				LG[i] += s->GroundAlbedo[1] / SAMPLER_PI * samples[i].Irradiance.y;
+				LB[i] += s->GroundAlbedo[2] / SAMPLER_PI * samples[i].Irradiance.z;
+			}
+		}
+		AccumulateSH9Batch(dirs.X + base, dirs.Y + base, dirs.Z + base, LR, LG, LB, dirs.Weight + base, n, coeffs);
+	}
+	ConvolveIrradianceSH(coeffs, out);
+}
+
+void DeleteAtmosSampler(AtmosSampler* s)
+{
+	delete s;
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// bake된 AtmosResult 위의 CPU 샘플러 (게임플레이 / 조명 질의용)
+// - 조회 식은 AtmosphericSky.hlsl의 SampleSky와 같다: 산란 4D quadrilinear, 투과도 / 조도 bilinear
+// - 질의는 ATMOS_STEP_BATCH개씩 SoA로 묶어 texel 좌표를 SIMD 커널 (ComputeLutCoordsBatch)로 구한다
+// - 하늘 조도 SH: 지평선 기준 층화 방향 (AtmosSH.h)의 radiance를 L2 SH로 투영한 뒤 cosine lobe와 convolution
+// 샘플러는 AtmosResult의 버퍼를 복사하지 않고 가리키기만 한다 (버퍼가 샘플러보다 오래 살아야 한다)
+// ===============================================================
+
+struct AtmosSampler;
+
+AtmosSampler* CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut);
+
+// sunDir: 햇빛 진행 방향 (태양 -> 지면). 길이 무관
+void SampleAtmosBatch(const AtmosSampler* s, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* out);
+
+// posPlanetCoord에서 본 하늘 (+ 지면 반사 근사)의 조도 SH. 직사광은 빠진다
+void ProjectSkyIrradianceSH(const AtmosSampler* s, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* out);
+
+void DeleteAtmosSampler(AtmosSampler* s);
@@ -0,0 +1,530 @@
+﻿#include "pch.h"
+#include "AtmosSkyView.h"
+#include "AtmosKernels.h"
+#include "AtmosSH.h"
+#include "ComputeAtmos.h"
+#include "Common/ParallelFor.h"
+#include <chrono>
+#include <memory>
+
+// 다중산란 LUT Ψms(r, mu_s): texel i ↔ (i + 0.5) / n, mu_s ∈ [-1, 1], r ∈ [Rg, Rt] 선형
+static constexpr int MS_LUT_W = 32;			// mu_s
+static constexpr int MS_LUT_H = 32;			// r
+static constexpr int MS_DIR_SQRT = 8;		// 구면 방향 8 x 8 = 64
+static constexpr int MS_STEPS = 20;			// 방향당 균등 스텝 (<= ATMOS_STEP_BATCH)
+static constexpr int SKY_VIEW_STEPS = 32;	// 스카이뷰 ray 스텝 (<= ATMOS_STEP_BATCH)
+static constexpr int AERIAL_SUBSTEPS = 2;	// aerial slice 하나당 스텝
+static constexpr float SKY_PI = 3.14159265358979f;
+static constexpr float SKY_GROUND_OFFSET = 1.0f;	// 카메라 고도 하한 [m] (float 반지름 ulp ~0.5m 보다 크게)
+
+static_assert(ATMOS_STEP_BATCH % AERIAL_SUBSTEPS == 0, "Aerial slices must not straddle step batches.");
+
+struct AtmosSkyViewContext
+{
+	float Rg;
+	float Rt;
+	float GroundAlbedo[3];
+	float MieG;
+	AtmosMedium Medium;
+
+	// 태양 투과도 조회용 (지평선 위 ray만 필요해서 Bruneton 매핑 고정)
+	AtmosLutMapping Mapping;
+	int TransmittanceW;
+	int TransmittanceH;
+	std::vector<float> TransmittanceRGB;
+
+	std::vector<float> MultiScatteringRGB;	// Ψms, MS_LUT_W x MS_LUT_H x 3 (태양 조도 1 기준)
+
+	// UpdateAtmosSkyView 결과 (AtmosSkyViewResult가 가리킨다)
+	std::vector<float> SkyViewRGBA;
+	std::vector<float> AerialRGBA;
+
+	// 매 프레임 갱신용 상주 워커 (첫 갱신이나 스레드 수가 바뀔 때 생성)
+	std::unique_ptr<WorkerPool> Pool;
+
+	// 마지막 재계산 시점의 입력과 결과 (갱신 임계값 비교용)
+	bool bHasResult = false;
+	AtmosSkyViewParams LastParams = {};
+	FLOAT3 LastUp = {};
+	FLOAT3 LastToSun = {};
+	AtmosSkyViewResult LastResult = {};
+
+	explicit AtmosSkyViewContext(const AtmosParams& in)
+		: Rg(in.PlanetRadius), Rt(in.PlanetRadius + in.AtmosphereHeight), GroundAlbedo{ in.GroundAlbedo.x, in.GroundAlbedo.y, in.GroundAlbedo.z },
+		MieG(in.MieG), Medium{}, Mapping(ATMOS_LUT_MAPPING_BRUNETON, Rg, Rt), TransmittanceW(in.TransmittanceW), TransmittanceH(in.TransmittanceH)
+	{
+	}
+
+	TransmittanceLUT GetTransmittanceLUT() const
+	{
+		return { TransmittanceRGB.data(), TransmittanceW, TransmittanceH, Mapping };
+	}
+};
+
+// view ray 하나의 누적 상태 (스텝 묶음 사이에 이어 간다)
+struct SkyRayAccum
+{
+	float L[3] = { 0.0f, 0.0f, 0.0f };	// 산란 radiance (태양 조도 1 기준)
+	float T[3] = { 1.0f, 1.0f, 1.0f };	// 시작점 → 현재 지점 투과도
+	float F[3] = { 0.0f, 0.0f, 0.0f };	// ∫ T σs dt (다중산란 LUT의 f_ms)
+};
+
+static inline float SkyClamp(float x, float a, float b)
+{
+	return x < a ? a : (x > b ? b : x);
+}
+
+static inline float RayleighPhaseSky(float nu)
+{
+	return 3.0f / (16.0f * SKY_PI) * (1.0f + nu * nu);
+}
+
+static inline float HenyeyGreensteinSky(float nu, float g)
+{
+	const float gg = g * g;
+	const float denom = 1.0f + gg - 2.0f * g * nu;
+	return (1.0f - gg) / (4.0f * SKY_PI * denom * std::sqrt(denom));
+}
+
+// 점 (r, mu_s)에서 태양 투과도. 태양이 지평선 아래면 0
+static inline void SunTransmittanceSky(const TransmittanceLUT& lut, float r, float muS, float* out)
+{
+	if (lut.Mapping.RayIntersectsGround(r, muS))
+	{
+		out[0] = out[1] = out[2] = 0.0f;
+		return;
+	}
+	LookupTransmittanceRGB(lut, r, muS, out);
+}
+
+static void LookupMultiScattering(const AtmosSkyViewContext& ctx, float r, float muS, float* out)
+{
+	const float x = SkyClamp((muS * 0.5f + 0.5f) * MS_LUT_W - 0.5f, 0.0f, float(MS_LUT_W - 1));
+	const float y = SkyClamp((r - ctx.Rg) / (ctx.Rt - ctx.Rg) * MS_LUT_H - 0.5f, 0.0f, float(MS_LUT_H - 1));
+	const int x0 = (int)x, y0 = (int)y;
+	const int x1 = std::min(x0 + 1, MS_LUT_W - 1), y1 = std::min(y0 + 1, MS_LUT_H - 1);
+	const float fx = x - x0, fy = y - y0;
+
+	const float* m = ctx.MultiScatteringRGB.data();
+	const float* t00 = &m[((size_t)y0 * MS_LUT_W + x0) * 3];
+	const float* t10 = &m[((size_t)y0 * MS_LUT_W + x1) * 3];
+	const float* t01 = &m[((size_t)y1 * MS_LUT_W + x0) * 3];
+	const float* t11 = &m[((size_t)y1 * MS_LUT_W + x1) * 3];
+	for (int c = 0; c < 3; ++c)
+	{
+		const float a = t00[c] + (t10[c] - t00[c]) * fx;
+		const float b = t01[c] + (t11[c] - t01[c]) * fx;
+		out[c] = a + (b - a) * fy;
+	}
+}
+
+// (r, mu)에서 지표나 대기 밖까지의 거리. 지표/하늘 쪽은 호출 쪽이 정한다 (지평선 texel이 반올림으로 뒤집히지 않게)
+static inline float SkyRayLength(const AtmosLutMapping& map, float r, float mu, bool bHitsGround)
+{
+	return bHitsGround ? map.DistanceToGround(r, mu) : map.DistanceToTop(r, mu);
+}
+
+// (r, mu, mu_s, nu) ray의 샘플 n개 (n <= ATMOS_STEP_BATCH)를 acc에 이어서 누적한다.
+//  t[k]: 샘플 거리, dt[k]: 샘플이 대표하는 구간 길이
+//  구간 안에서는 소광계수와 광원항 S가 일정하다고 보고 ∫ S T ds = S (1 - T_step) / σt 로 닫는다 (Hillaire 2020)
+//  phaseR/phaseM: 태양 단산란 위상 (ray 위에서 nu가 일정하므로 상수). bMultiScattering이면 σs Ψms 항을 더한다
+//  stepLT != nullptr 이면 샘플 k까지 누적한 L, T를 stepLT[k * 6 + (0..5)]에 남긴다 (aerial slice 기록용)
+static void MarchSkyRayBatch(
+	const AtmosSkyViewContext& ctx, const TransmittanceLUT& lut,
+	float r, float mu, float muS, float nu, float phaseR, float phaseM, bool bMultiScattering,
+	const float* t, const float* dt, int n, SkyRayAccum* acc, float* stepLT)
+{
+	const AtmosMedium& med = ctx.Medium;
+
+	float rs[ATMOS_STEP_BATCH], h[ATMOS_STEP_BATCH];
+	float rhoR[ATMOS_STEP_BATCH], rhoM[ATMOS_STEP_BATCH];
+	float ext[3][ATMOS_STEP_BATCH], od[3][ATMOS_STEP_BATCH], stepT[3][ATMOS_STEP_BATCH];
+	for (int k = 0; k < n; ++k)
+	{
+		rs[k] = std::sqrt(std::max(0.0f, r * r + t[k] * t[k] + 2.0f * r * t[k] * mu));
+		rs[k] = std::max(rs[k], ctx.Rg);
+		h[k] = rs[k] - ctx.Rg;
+	}
+	EvaluateMediumBatch(med, h, n, rhoR, rhoM, ext[0], ext[1], ext[2]);
+	for (int c = 0; c < 3; ++c)
+	{
+		for (int k = 0; k < n; ++k)
+		{
+			od[c][k] = ext[c][k] * dt[k];
+		}
+		ExpNegBatch(od[c], n, stepT[c]);
+	}
+
+	for (int k = 0; k < n; ++k)
+	{
+		const float muSk = SkyClamp((r * muS + t[k] * nu) / rs[k], -1.0f, 1.0f);
+		float trSun[3];
+		SunTransmittanceSky(lut, rs[k], muSk, trSun);
+		float psi[3] = { 0.0f, 0.0f, 0.0f };
+		if (bMultiScattering)
+		{
+			LookupMultiScattering(ctx, rs[k], muSk, psi);
+		}
+
+		for (int c = 0; c < 3; ++c)
+		{
+			const float sR = med.RayleighScattering[c] * rhoR[k];
+			const float sM = med.MieScattering[c] * rhoM[k];
+			const float S = sR * (trSun[c] * phaseR + psi[c]) + sM * (trSun[c] * phaseM + psi[c]);
+
+			// ∫ exp(-σt s) ds over dt. 광학 두께가 작으면 1 - exp(-x) 의 상쇄를 피해 급수로
+			const float x = od[c][k];
+			const float w = (x > 1e-4f) ? (1.0f - stepT[c][k]) / ext[c][k] : dt[k] * (1.0f - 0.5f * x);
+
+			acc->L[c] += acc->T[c] * S * w;
+			acc->F[c] += acc->T[c] * (sR + sM) * w;
+			acc->T[c] *= stepT[c][k];
+		}
+
+		if (stepLT)
+		{
+			float* o = &stepLT[k * 6];
+			o[0] = acc->L[0]; o[1] = acc->L[1]; o[2] = acc->L[2];
+			o[3] = acc->T[0]; o[4] = acc->T[1]; o[5] = acc->T[2];
+		}
+	}
+}
+
+// Ψms(r, mu_s) = L2 / (1 - f_ms) (Hillaire 2020 5.5절)
+//  점 하나에서 구면 64방향으로 ray를 쏴서 등방 위상 단산란 L2 (지표 반사 포함)와 재산란 비율 f_ms의 방향 평균을 구하고,
+//  이후 차수도 같은 비율로 줄어든다고 보고 기하급수로 합산한다
+static void BuildMultiScatteringLUT(AtmosSkyViewContext* ctx, int numThreads)
+{
+	const TransmittanceLUT lut = ctx->GetTransmittanceLUT();
+	const float isotropicPhase = 1.0f / (4.0f * SKY_PI);
+	const float invDirs = 1.0f / float(MS_DIR_SQRT * MS_DIR_SQRT);
+	ctx->MultiScatteringRGB.assign(size_t(MS_LUT_W) * MS_LUT_H * 3, 0.0f);
+
+	ParallelFor(MS_LUT_H, numThreads, [&](int j)
+	{
+		const float r = ctx->Rg + (ctx->Rt - ctx->Rg) * (j + 0.5f) / float(MS_LUT_H);
+		for (int i = 0; i < MS_LUT_W; ++i)
+		{
+			const float muS = -1.0f + 2.0f * (i + 0.5f) / float(MS_LUT_W);
+			const float sinS = std::sqrt(std::max(0.0f, 1.0f - muS * muS));
+
+			float L2[3] = { 0.0f, 0.0f, 0.0f };
+			float fms[3] = { 0.0f, 0.0f, 0.0f };
+			for (int dy = 0; dy < MS_DIR_SQRT; ++dy)
+			{
+				const float mu = 1.0f - 2.0f * (dy + 0.5f) / float(MS_DIR_SQRT);
+				const float sinT = std::sqrt(std::max(0.0f, 1.0f - mu * mu));
+				for (int dx = 0; dx < MS_DIR_SQRT; ++dx)
+				{
+					const float phi = 2.0f * SKY_PI * (dx + 0.5f) / float(MS_DIR_SQRT);
+					const float nu = sinT * std::cos(phi) * sinS + mu * muS;
+
+					const bool bHitsGround = ctx->Mapping.RayIntersectsGround(r, mu);
+					const float tMax = SkyRayLength(ctx->Mapping, r, mu, bHitsGround);
+
+					float t[MS_STEPS], dt[MS_STEPS];
+					for (int k = 0; k < MS_STEPS; ++k)
+					{
+						dt[k] = tMax / float(MS_STEPS);
+						t[k] = (k + 0.5f) * dt[k];
+					}
+					SkyRayAccum acc;
+					MarchSkyRayBatch(*ctx, lut, r, mu, muS, nu, isotropicPhase, isotropicPhase, false, t, dt, MS_STEPS, &acc, nullptr);
+
+					// 지표 Lambert 반사 (태양 직사광만)
+					if (bHitsGround)
+					{
+						const float muSGround = SkyClamp((r * muS + tMax * nu) / ctx->Rg, -1.0f, 1.0f);
+						if (muSGround > 0.0f)
+						{
+							float trSun[3];
+							SunTransmittanceSky(lut, ctx->Rg, muSGround, trSun);
+							for (int c = 0; c < 3; ++c)
+							{
+								acc.L[c] += acc.T[c] * trSun[c] * muSGround * ctx->GroundAlbedo[c] / SKY_PI;
+							}
+						}
+					}
+
+					for (int c = 0; c < 3; ++c)
+					{
+						L2[c] += acc.L[c];
+						fms[c] += acc.F[c];
+					}
+				}
+			}
+
+			float* dst = &ctx->MultiScatteringRGB[((size_t)j * MS_LUT_W + i) * 3];
+			for (int c = 0; c < 3; ++c)
+			{
+				const float f = std::min(fms[c] * invDirs, 0.99f);
+				dst[c] = L2[c] * invDirs / (1.0f - f);
+			}
+		}
+	});
+}
+
+AtmosSkyViewContext* CreateAtmosSkyViewContext(const AtmosParams& in)
+{
+	ASSERT(in.PlanetRadius > 0.0f && in.AtmosphereHeight > 0.0f, "Invalid planet/atmosphere radius.");
+	ASSERT(in.TransmittanceW > 1 && in.TransmittanceH > 1, "Invalid transmittance LUT dimensions.");
+
+	const auto begin = std::chrono::steady_clock::now();
+	const int numThreads = ResolveThreadCount(in.NumThreads);
+
+	AtmosSkyViewContext* ctx = new AtmosSkyViewContext(in);
+	BuildAtmosMedium(in, &ctx->Medium);
+
+	AtmosParams transmittanceParams = in;
+	transmittanceParams.LutMapping = ATMOS_LUT_MAPPING_BRUNETON;
+	ctx->TransmittanceRGB.resize(size_t(ctx->TransmittanceW) * ctx->TransmittanceH * 3);
+	ComputeTransmittanceLUT(transmittanceParams, ctx->Medium, numThreads, ctx->TransmittanceRGB.data());
+
+	BuildMultiScatteringLUT(ctx, numThreads);
+
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	std::cout << "[Prelight] Sky-view context: transmittance " << ctx->TransmittanceW << "x" << ctx->TransmittanceH
+		<< ", multiple scattering " << MS_LUT_W << "x" << MS_LUT_H << ", " << numThreads << " thread(s): " << ms << "ms" << std::endl;
+	return ctx;
+}
+
+// 스카이뷰 LUT (RGBA, texel i ↔ i / (W - 1)) bilinear
+static void SampleSkyViewLUT(const float* rgba, int W, int H, float u, float v, float* out)
+{
+	const float x = SkyClamp(u, 0.0f, 1.0f) * float(W - 1), y = SkyClamp(v, 0.0f, 1.0f) * float(H - 1);
+	const int x0 = std::min(int(x), W - 2), y0 = std::min(int(y), H - 2);
+	const float fx = x - float(x0), fy = y - float(y0);
+	const float* t00 = &rgba[((size_t)y0 * W + x0) * 4];
+	const float* t10 = t00 + 4;
+	const float* t01 = t00 + (size_t)W * 4;
+	const float* t11 = t01 + 4;
+	for (int c = 0; c < 3; ++c)
+	{
+		const float a = t00[c] + (t10[c] - t00[c]) * fx;
+		const float b = t01[c] + (t11[c] - t01[c]) * fx;
+		out[c] = a + (b - a) * fy;
+	}
+}
+
+// 카메라 위치의 ambient 조도 SH. 방향은 AtmosSH.h의 층화 샘플, radiance는 방금 만든 스카이뷰 LUT에서 읽는다.
+// 스카이뷰 LUT의 지면 방향은 대기 산란만 담으므로 지면 반사 albedo/π * (직사광 + 하늘 조도)를 더한다
+// (하늘 조도는 먼저 투영한 하늘 쪽 SH를 up으로 평가. 카메라 ↔ 지면 투과도와 지면 고도 차는 무시한 근사)
+static void ProjectAmbientSH(const AtmosSkyViewContext& ctx, const TransmittanceLUT& lut, const AtmosSkyViewMapping& svMap,
+	int W, int H, const float up[3], const float toSun[3], float r, float muS, const FLOAT3& solar, AtmosSkySH* out)
+{
+	const float rho = ctx.Rg / r;
+	AtmosSHDirections dirs;
+	BuildAtmosSHDirections(up, toSun, -std::sqrt(std::max(0.0f, 1.0f - rho * rho)), &dirs);
+
+	float LR[ATMOS_SH_DIRS], LG[ATMOS_SH_DIRS], LB[ATMOS_SH_DIRS];
+	for (int i = 0; i < ATMOS_SH_DIRS; ++i)
+	{
+		float u, v, L[3];
+		svMap.ViewToUV(dirs.Mu[i], dirs.CosAzimuth[i], i >= dirs.NumSky, &u, &v);
+		SampleSkyViewLUT(ctx.SkyViewRGBA.data(), W, H, u, v, L);
+		LR[i] = L[0];
+		LG[i] = L[1];
+		LB[i] = L[2];
+	}
+
+	float coeffs[27] = {};
+	AccumulateSH9Batch(dirs.X, dirs.Y, dirs.Z, LR, LG, LB, dirs.Weight, dirs.NumSky, coeffs);
+
+	AtmosSkySH skySH;
+	ConvolveIrradianceSH(coeffs, &skySH);
+	float skyE[3], trSun[3];
+	EvaluateIrradianceSH(skySH, up, skyE);
+	SunTransmittanceSky(lut, ctx.Rg, muS, trSun);
+
+	const float cosSun = std::max(muS, 0.0f);
+	const float sunE[3] = { solar.x * trSun[0] * cosSun, solar.y * trSun[1] * cosSun, solar.z * trSun[2] * cosSun };
+	float bounce[3];
+	for (int c = 0; c < 3; ++c)
+	{
+		bounce[c] = ctx.GroundAlbedo[c] / SKY_PI * (sunE[c] + std::max(skyE[c], 0.0f));
+	}
+	for (int i = dirs.NumSky; i < ATMOS_SH_DIRS; ++i)
+	{
+		LR[i] += bounce[0];
+		LG[i] += bounce[1];
+		LB[i] += bounce[2];
+	}
+	const int numGround = ATMOS_SH_DIRS - dirs.NumSky;
+	AccumulateSH9Batch(dirs.X + dirs.NumSky, dirs.Y + dirs.NumSky, dirs.Z + dirs.NumSky,
+		LR + dirs.NumSky, LG + dirs.NumSky, LB + dirs.NumSky, dirs.Weight + dirs.NumSky, numGround, coeffs);
+	ConvolveIrradianceSH(coeffs, out);
+}
+
+void UpdateAtmosSkyView(AtmosSkyViewContext* ctx, const AtmosSkyViewParams& in, AtmosSkyViewResult* out)
+{
+	ASSERT(ctx && out, "Sky-view context or output pointer is null.");
+	ASSERT(in.SkyViewW > 1 && in.SkyViewH > 1, "Invalid sky-view LUT dimensions.");
+	ASSERT(in.AerialD <= 0 || (in.AerialW > 1 && in.AerialH > 1 && in.AerialMaxDistance > 0.0f), "Invalid aerial-perspective volume.");
+
+	const int numThreads = ResolveThreadCount(in.NumThreads);
+	if (!ctx->Pool || ctx->Pool->GetNumThreads() != numThreads)
+	{
+		ctx->Pool = std::make_unique<WorkerPool>(numThreads);
+	}
+	WorkerPool& pool = *ctx->Pool;
+	const TransmittanceLUT lut = ctx->GetTransmittanceLUT();
+	const FLOAT3 solar = { ctx->Medium.SolarIrradiance[0], ctx->Medium.SolarIrradiance[1], ctx->Medium.SolarIrradiance[2] };
+
+	// 카메라 고도와 태양 천정각만 LUT에 들어간다 (방위는 태양 기준이라 카메라/태양 회전과 무관)
+	const FLOAT3& p = in.CameraPosPlanetCoord;
+	const float pLen = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+	const FLOAT3 up = (pLen > 0.0f) ? FLOAT3{ p.x / pLen, p.y / pLen, p.z / pLen } : FLOAT3{ 0.0f, 1.0f, 0.0f };
+	const float r = SkyClamp(pLen, ctx->Rg + SKY_GROUND_OFFSET, ctx->Rt);
+
+	const FLOAT3& s = in.SunDir;
+	const float sLen = std::sqrt(s.x * s.x + s.y * s.y + s.z * s.z);
+	const float muS = (sLen > 0.0f) ? SkyClamp(-(s.x * up.x + s.y * up.y + s.z * up.z) / sLen, -1.0f, 1.0f) : 1.0f;
+	const float sinS = std::sqrt(std::max(0.0f, 1.0f - muS * muS));
+	const FLOAT3 toSun = (sLen > 0.0f) ? FLOAT3{ -s.x / sLen, -s.y / sLen, -s.z / sLen } : up;
+
+	// 고도 / 태양 방향 / 카메라 up 변화가 임계값 안이고 해상도가 같으면 이전 LUT를 그대로 돌려준다
+	if (ctx->bHasResult)
+	{
+		const AtmosSkyViewParams& last = ctx->LastParams;
+		const bool bSameLayout = last.SkyViewW == in.SkyViewW && last.SkyViewH == in.SkyViewH
+			&& last.AerialW == in.AerialW && last.AerialH == in.AerialH && last.AerialD == in.AerialD
+			&& last.AerialMaxDistance == in.AerialMaxDistance;
+		const float minCos = std::cos(in.RefreshAngle);
+		const bool bSunStill = toSun.x * ctx->LastToSun.x + toSun.y * ctx->LastToSun.y + toSun.z * ctx->LastToSun.z >= minCos;
+		const bool bUpStill = up.x * ctx->LastUp.x + up.y * ctx->LastUp.y + up.z * ctx->LastUp.z >= minCos;
+		if (bSameLayout && in.RefreshAngle > 0.0f && bSunStill && bUpStill && std::fabs(r - ctx->LastResult.CameraRadius) < in.RefreshAltitude)
+		{
+			*out = ctx->LastResult;
+			out->bRefreshed = false;
+			return;
+		}
+	}
+
+	const AtmosSkyViewMapping svMap(ctx->Rg, r);
+	const float g = ctx->MieG;
+
+	// texel (u, v) → view ray. v < 0.5 하늘 쪽, v >= 0.5 지표 쪽
+	struct SkyViewRay
+	{
+		float Mu, Nu, Length;
+		bool bHitsGround;
+	};
+	auto makeRay = [&](float u, float v)
+		{
+			SkyViewRay ray;
+			float cosPhi;
+			svMap.UVToView(u, v, &ray.Mu, &cosPhi);
+			const float sinT = std::sqrt(std::max(0.0f, 1.0f - ray.Mu * ray.Mu));
+			ray.Nu = SkyClamp(sinT * cosPhi * sinS + ray.Mu * muS, -1.0f, 1.0f);
+			ray.bHitsGround = v >= 0.5f;
+			ray.Length = SkyRayLength(ctx->Mapping, r, ray.Mu, ray.bHitsGround);
+			return ray;
+		};
+
+	// ----------------------------- Sky-view LUT -----------------------------
+	// 스텝 경계 t_i = tMax (i / N)^2 : 밀도가 높은 카메라 근처에 샘플을 모은다
+	const int SW = in.SkyViewW, SH = in.SkyViewH;
+	ctx->SkyViewRGBA.resize(size_t(SW) * SH * 4);
+	pool.Run(SH, [&](int j)
+	{
+		const float v = float(j) / float(SH - 1);
+		for (int i = 0; i < SW; ++i)
+		{
+			const SkyViewRay ray = makeRay(float(i) / float(SW - 1), v);
+
+			float t[SKY_VIEW_STEPS], dt[SKY_VIEW_STEPS];
+			for (int k = 0; k < SKY_VIEW_STEPS; ++k)
+			{
+				const float a = float(k) / SKY_VIEW_STEPS, b = float(k + 1) / SKY_VIEW_STEPS;
+				const float t0 = ray.Length * a * a, t1 = ray.Length * b * b;
+				t[k] = 0.5f * (t0 + t1);
+				dt[k] = t1 - t0;
+			}
+			SkyRayAccum acc;
+			MarchSkyRayBatch(*ctx, lut, r, ray.Mu, muS, ray.Nu, RayleighPhaseSky(ray.Nu), HenyeyGreensteinSky(ray.Nu, g), true,
+				t, dt, SKY_VIEW_STEPS, &acc, nullptr);
+
+			float* dst = &ctx->SkyViewRGBA[((size_t)j * SW + i) * 4];
+			dst[0] = acc.L[0] * solar.x;
+			dst[1] = acc.L[1] * solar.y;
+			dst[2] = acc.L[2] * solar.z;
+			dst[3] = 1.0f;
+		}
+	});
+
+	// ----------------------------- Aerial perspective -----------------------------
+	// 방향은 스카이뷰 매핑, 깊이 slice k는 카메라에서 AerialSliceDistance(k)까지. slice마다 AERIAL_SUBSTEPS 스텝
+	// 지표/대기 경계 너머의 slice는 경계에서의 값을 그대로 유지한다
+	const int AW = in.AerialW, AH = in.AerialH, AD = std::max(in.AerialD, 0);
+	ctx->AerialRGBA.resize(size_t(AW) * AH * AD * 4);
+	if (AD > 0)
+	{
+		const int totalSteps = AD * AERIAL_SUBSTEPS;
+		pool.Run(AH, [&](int j)
+		{
+			const float v = float(j) / float(AH - 1);
+			for (int i = 0; i < AW; ++i)
+			{
+				const SkyViewRay ray = makeRay(float(i) / float(AW - 1), v);
+				const float phaseR = RayleighPhaseSky(ray.Nu), phaseM = HenyeyGreensteinSky(ray.Nu, g);
+
+				SkyRayAccum acc;
+				float t[ATMOS_STEP_BATCH], dt[ATMOS_STEP_BATCH], stepLT[ATMOS_STEP_BATCH * 6];
+				for (int s0 = 0; s0 < totalSteps; s0 += ATMOS_STEP_BATCH)
+				{
+					const int n = std::min(ATMOS_STEP_BATCH, totalSteps - s0);
+					for (int k = 0; k < n; ++k)
+					{
+						const int slice = (s0 + k) / AERIAL_SUBSTEPS, sub = (s0 + k) % AERIAL_SUBSTEPS;
+						const float d0 = slice > 0 ? AtmosSkyViewMapping::AerialSliceDistance(slice - 1, AD, in.AerialMaxDistance) : 0.0f;
+						const float d1 = AtmosSkyViewMapping::AerialSliceDistance(slice, AD, in.AerialMaxDistance);
+						const float a = std::min(d0 + (d1 - d0) * float(sub) / AERIAL_SUBSTEPS, ray.Length);
+						const float b = std::min(d0 + (d1 - d0) * float(sub + 1) / AERIAL_SUBSTEPS, ray.Length);
+						t[k] = 0.5f * (a + b);
+						dt[k] = b - a;
+					}
+					MarchSkyRayBatch(*ctx, lut, r, ray.Mu, muS, ray.Nu, phaseR, phaseM, true, t, dt, n, &acc, stepLT);
+
+					for (int k = AERIAL_SUBSTEPS - 1; k < n; k += AERIAL_SUBSTEPS)
+					{
+						const int slice = (s0 + k) / AERIAL_SUBSTEPS;
+						const float* src = &stepLT[k * 6];
+						float* dst = &ctx->AerialRGBA[(((size_t)slice * AH + j) * AW + i) * 4];
+						dst[0] = src[0] * solar.x;
+						dst[1] = src[1] * solar.y;
+						dst[2] = src[2] * solar.z;
+						dst[3] = (src[3] + src[4] + src[5]) / 3.0f;
+					}
+				}
+			}
+		});
+	}
+
+	out->CameraRadius = r;
+	out->SunZenithCos = muS;
+	out->SkyViewW = SW;
+	out->SkyViewH = SH;
+	out->SkyViewRGBA = ctx->SkyViewRGBA.data();
+	out->AerialW = AD > 0 ? AW : 0;
+	out->AerialH = AD > 0 ? AH : 0;
+	out->AerialD = AD;
+	out->AerialMaxDistance = in.AerialMaxDistance;
+	out->AerialRGBA = AD > 0 ? ctx->AerialRGBA.data() : nullptr;
+
+	// ----------------------------- Ambient SH -----------------------------
+	const float upArr[3] = { up.x, up.y, up.z };
+	const float toSunArr[3] = { toSun.x, toSun.y, toSun.z };
+	ProjectAmbientSH(*ctx, lut, svMap, SW, SH, upArr, toSunArr, r, muS, solar, &out->AmbientSH);
+	out->bRefreshed = true;
+
+	ctx->bHasResult = true;
+	ctx->LastParams = in;
+	ctx->LastUp = up;
+	ctx->LastToSun = toSun;
+	ctx->LastResult = *out;
+}
+
+void DeleteAtmosSkyViewContext(AtmosSkyViewContext* ctx)
+{
+	delete ctx;
+}
@@ -0,0 +1,21 @@
+﻿#pragma once
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// 매 프레임 스카이뷰 LUT / aerial perspective 볼륨 (Hillaire 2020)
+// - 컨텍스트 (AtmosParams마다 한 번): 매질 + Transmittance LUT (Bruneton 매핑) + 다중산란 LUT Ψms(r, mu_s)
+// - 갱신 (매 프레임): 카메라 고도 / 태양 천정각 기준으로 스카이뷰 LUT와 카메라 중심 froxel 볼륨을 ray marching
+//   컨텍스트의 상주 워커로 나눠 돌리고, 변화가 RefreshAltitude / RefreshAngle 안이면 재계산을 건너뛴다
+//   다중산란은 Ψms 근사 (등방 위상으로 2차 산란을 구해 기하급수로 합산)로 대신해 4D 산란 LUT 없이 계산한다
+// 텍셀 매핑은 Common/AtmosLutMapping.h의 AtmosSkyViewMapping (AtmosphericSky.hlsl과 같은 식)
+// ===============================================================
+
+struct AtmosSkyViewContext;
+
+// 컨텍스트 생성 (Earth 기준 수십 ms). 해제는 DeleteAtmosSkyViewContext
+AtmosSkyViewContext* CreateAtmosSkyViewContext(const AtmosParams& in);
+
+// out의 버퍼는 ctx 소유, 다음 갱신이나 해제 전까지 유효
+void UpdateAtmosSkyView(AtmosSkyViewContext* ctx, const AtmosSkyViewParams& in, AtmosSkyViewResult* out);
+
+void DeleteAtmosSkyViewContext(AtmosSkyViewContext* ctx);
@@ -0,0 +1,144 @@
+﻿#include "pch.h"
+#include "AtmosSpectral.h"
+
+// RGB 계수의 표본 파장 (B, G, R 순)
+static constexpr float SPECTRAL_ANCHOR_LAMBDA[3] = { 440.0f, 550.0f, 680.0f };
+
+// 좌우 폭이 다른 가우시안 (Wyman, Sloan, Shirley 2013)
+static inline float PiecewiseGaussian(float x, float mu, float sigmaLo, float sigmaHi)
+{
+	const float t = (x - mu) / (x < mu ? sigmaLo : sigmaHi);
+	return std::exp(-0.5f * t * t);
+}
+
+// CIE 1931 2° 등색함수 근사 (다중 가우시안 fit, 가시광 구간 오차는 원 표의 수 % 이내)
+static void CieColorMatching1931(float lambda, float* outXYZ)
+{
+	outXYZ[0] = 1.056f * PiecewiseGaussian(lambda, 599.8f, 37.9f, 31.0f)
+		+ 0.362f * PiecewiseGaussian(lambda, 442.0f, 16.0f, 26.7f)
+		- 0.065f * PiecewiseGaussian(lambda, 501.1f, 20.4f, 26.2f);
+	outXYZ[1] = 0.821f * PiecewiseGaussian(lambda, 568.8f, 46.9f, 40.5f)
+		+ 0.286f * PiecewiseGaussian(lambda, 530.9f, 16.3f, 31.1f);
+	outXYZ[2] = 1.217f * PiecewiseGaussian(lambda, 437.0f, 11.8f, 36.0f)
+		+ 0.681f * PiecewiseGaussian(lambda, 459.0f, 26.0f, 13.8f);
+}
+
+// XYZ → 선형 sRGB (D65)
+static constexpr float XYZ_TO_SRGB[3][3] =
+{
+	{  3.2406f, -1.5372f, -0.4986f },
+	{ -0.9689f,  1.8758f,  0.0415f },
+	{  0.0557f, -0.2040f,  1.0570f },
+};
+
+// RGB 표본 (x = R, y = G, z = B)을 파장 축 (B, G, R) 순으로
+static inline void AnchorValues(const FLOAT3& rgb, float* out)
+{
+	out[0] = rgb.z;
+	out[1] = rgb.y;
+	out[2] = rgb.x;
+}
+
+// 세 표본 선형 보간 (범위 밖은 끝 값)
+static float InterpolateAnchors(const FLOAT3& rgb, float lambda)
+{
+	float v[3];
+	AnchorValues(rgb, v);
+	if (lambda <= SPECTRAL_ANCHOR_LAMBDA[0])
+	{
+		return v[0];
+	}
+	if (lambda >= SPECTRAL_ANCHOR_LAMBDA[2])
+	{
+		return v[2];
+	}
+	const int i = (lambda < SPECTRAL_ANCHOR_LAMBDA[1]) ? 0 : 1;
+	const float f = (lambda - SPECTRAL_ANCHOR_LAMBDA[i]) / (SPECTRAL_ANCHOR_LAMBDA[i + 1] - SPECTRAL_ANCHOR_LAMBDA[i]);
+	return v[i] + (v[i + 1] - v[i]) * f;
+}
+
+// 세 표본을 지나는 멱법칙 β(λ) = exp(a) λ^k (log-log 최소제곱). 표본에 0 이하가 있으면 선형 보간
+static float PowerLawAnchors(const FLOAT3& rgb, float lambda)
+{
+	float v[3];
+	AnchorValues(rgb, v);
+	if (v[0] <= 0.0f || v[1] <= 0.0f || v[2] <= 0.0f)
+	{
+		return InterpolateAnchors(rgb, lambda);
+	}
+
+	double mx = 0.0, my = 0.0;
+	double lx[3], ly[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		lx[i] = std::log((double)SPECTRAL_ANCHOR_LAMBDA[i]);
+		ly[i] = std::log((double)v[i]);
+		mx += lx[i] / 3.0;
+		my += ly[i] / 3.0;
+	}
+	double sxy = 0.0, sxx = 0.0;
+	for (int i = 0; i < 3; ++i)
+	{
+		sxy += (lx[i] - mx) * (ly[i] - my);
+		sxx += (lx[i] - mx) * (lx[i] - mx);
+	}
+	const double k = sxy / sxx;
+	return (float)std::exp(my + k * (std::log((double)lambda) - mx));
+}
+
+void BuildAtmosSpectralGroups(const AtmosParams& in, AtmosSpectralSetup* outSetup, std::vector<AtmosParams>* outGroups)
+{
+	ASSERT(outSetup && outGroups, "Output pointer is null.");
+	ASSERT(in.SpectralWavelengths >= 3 && in.SpectralWavelengths <= ATMOS_SPECTRAL_MAX_WAVELENGTHS, "SpectralWavelengths must be in [3, 48].");
+
+	AtmosSpectralSetup& s = *outSetup;
+	const int N = in.SpectralWavelengths;
+	s.NumWavelengths = N;
+	s.NumGroups = (N + 2) / 3;
+
+	// 파장 칸 중심 + 색 변환 가중치
+	const float dLambda = (ATMOS_SPECTRAL_LAMBDA_MAX - ATMOS_SPECTRAL_LAMBDA_MIN) / float(N);
+	double weightSum[3] = {};
+	for (int i = 0; i < N; ++i)
+	{
+		s.Lambda[i] = ATMOS_SPECTRAL_LAMBDA_MIN + (i + 0.5f) * dLambda;
+		float xyz[3];
+		CieColorMatching1931(s.Lambda[i], xyz);
+		for (int c = 0; c < 3; ++c)
+		{
+			s.Weight[c][i] = XYZ_TO_SRGB[c][0] * xyz[0] + XYZ_TO_SRGB[c][1] * xyz[1] + XYZ_TO_SRGB[c][2] * xyz[2];
+			weightSum[c] += s.Weight[c][i];
+		}
+		s.SolarIrradiance[i] = InterpolateAnchors(in.SolarIrradiance, s.Lambda[i]);
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		ASSERT(weightSum[c] > 0.0, "Degenerate spectral sampling.");
+		for (int i = 0; i < N; ++i)
+		{
+			s.Weight[c][i] = float(s.Weight[c][i] / weightSum[c]);
+		}
+	}
+
+	outGroups->assign(s.NumGroups, in);
+	for (int g = 0; g < s.NumGroups; ++g)
+	{
+		AtmosParams& p = (*outGroups)[g];
+		p.SpectralWavelengths = 0;
+
+		float lambda[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			lambda[c] = s.Lambda[std::min(3 * g + c, N - 1)];
+		}
+		auto powerLaw = [&](const FLOAT3& rgb) { return FLOAT3{ PowerLawAnchors(rgb, lambda[0]), PowerLawAnchors(rgb, lambda[1]), PowerLawAnchors(rgb, lambda[2]) }; };
+		auto linear = [&](const FLOAT3& rgb) { return FLOAT3{ InterpolateAnchors(rgb, lambda[0]), InterpolateAnchors(rgb, lambda[1]), InterpolateAnchors(rgb, lambda[2]) }; };
+
+		p.RayleighScattering = powerLaw(in.RayleighScattering);
+		p.MieScattering = powerLaw(in.MieScattering);
+		p.MieExtinction = powerLaw(in.MieExtinction);
+		p.OzoneAbsorption = linear(in.OzoneAbsorption);
+		p.GroundAlbedo = linear(in.GroundAlbedo);
+		p.SolarIrradiance = linear(in.SolarIrradiance);
+	}
+}
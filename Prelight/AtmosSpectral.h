@@ -0,0 +1,30 @@
+﻿#pragma once
+#include "Interface/AtmosStruct.h"
+
+// ===============================================================
+// 분광 bake (AtmosParams::SpectralWavelengths > 0)
+// - [ATMOS_SPECTRAL_LAMBDA_MIN, MAX] nm를 N칸으로 나눈 중심 파장에서 계수를 구해 파장 3개씩 RGB 프리셋 하나로 묶는다
+//   (Bruneton 2017 데모와 같은 방식: RGB 파이프라인을 파장 묶음마다 돌리고 끝에서 색 변환)
+// - RGB 계수는 R/G/B = 680/550/440 nm 표본으로 본다
+//   Rayleigh / Mie 산란·소광: 세 표본을 지나는 멱법칙 (log-log 최소제곱, Earth Rayleigh는 λ^-4에 가깝다)
+//   Ozone 흡수, 태양 조도, 지면 albedo: 선형 보간 (440 nm 아래 / 680 nm 위는 끝 값 유지)
+// - 파장 → 선형 sRGB: CIE 1931 2° 등색함수 (Wyman 2013 다중 가우시안 근사) → XYZ → sRGB(D65) 행렬.
+//   채널마다 가중치 합이 1이 되게 정규화해 평탄한 스펙트럼 1이 RGB (1, 1, 1)이 된다
+// ===============================================================
+
+constexpr float ATMOS_SPECTRAL_LAMBDA_MIN = 380.0f;
+constexpr float ATMOS_SPECTRAL_LAMBDA_MAX = 730.0f;
+constexpr int ATMOS_SPECTRAL_MAX_WAVELENGTHS = 48;
+
+struct AtmosSpectralSetup
+{
+	int NumWavelengths;		// N
+	int NumGroups;			// ceil(N / 3). 마지막 묶음의 빈 칸은 마지막 파장을 가중치 0으로 채운다
+	float Lambda[ATMOS_SPECTRAL_MAX_WAVELENGTHS];
+	float Weight[3][ATMOS_SPECTRAL_MAX_WAVELENGTHS];	// 파장 i → 선형 sRGB 채널 c 가중치 (채널마다 합 1, 음수 가능)
+	float SolarIrradiance[ATMOS_SPECTRAL_MAX_WAVELENGTHS];
+};
+
+// in.SpectralWavelengths 파장으로 묶음 프리셋 NumGroups개를 만든다 (SpectralWavelengths = 0, 나머지 필드는 in 그대로)
+// 묶음 g의 채널 c는 파장 3g + c
+void BuildAtmosSpectralGroups(const AtmosParams& in, AtmosSpectralSetup* outSetup, std::vector<AtmosParams>* outGroups);
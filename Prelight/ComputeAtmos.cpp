@@ -1,5 +1,11 @@
 ﻿#include "pch.h"
 #include "ComputeAtmos.h"
+#include "AtmosKernels.h"
+#include "Common/ParallelFor.h"
+#include "AtmosSpectral.h"
+#include <chrono>
+#include <memory>
+#include <cfloat>
 
 // Planet geometry
 struct PlanetGeom
@@ -8,29 +14,470 @@ struct PlanetGeom
 	float Rt; // top-of-atmosphere radius
 };
 
+// ray 적분 하나의 샘플링 설정 (AtmosParams::Quality에서 만든다)
+//  - 고정: 균등 midpoint FixedSteps 스텝
+//  - 적응형: 고도가 가장 낮은 점 쪽에 몰린 격자에서 사다리꼴 적분, 구간 수를 MinSegments부터 두 배씩 늘려
+//    채널별 변화가 Tolerance 이하가 되거나 MaxSegments에 닿으면 멈춘다
+struct AtmosQuadrature
+{
+	bool bAdaptive;
+	float Tolerance;
+	int MinSegments;
+	int MaxSegments;	// ray 조각 하나당
+	int FixedSteps;
+};
+
+// 적분 종류별 설정
+struct AtmosQuadratureSet
+{
+	AtmosQuadrature Transmittance;	// Transmittance LUT, 다중산란 지표 투과도
+	AtmosQuadrature View;			// 단산란 view ray
+	AtmosQuadrature Sun;			// 단산란 샘플 → 태양 (LUT 미사용 시)
+	AtmosQuadrature IrradianceSun;	// 직접 조도의 태양 투과도
+};
+
+static AtmosQuadratureSet MakeAtmosQuadratureSet(EAtmosQuality quality);
+
+static void FixedOpticalDepthRGB(float r0, float mu, float tEnd, const PlanetGeom& pg, const AtmosMedium& med, const AtmosQuadrature& quad, float* outTau);
+
 static void IntegrateTransmittanceRGB(
 	float r0, float mu, 
-	const PlanetGeom& pg, const AtmosParams& in, 
-	float* outTrRGB, int numSteps = 64);
+	const PlanetGeom& pg, const AtmosMedium& med, 
+	float* outTrRGB, const AtmosQuadrature& quad, const bool* rayHitsGround = nullptr);
 static void IntegrateSingleScatteringUnphased(
 	float r0, float mu, float muS, 
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outRGBA, int numViewSteps = 64, int numSunSteps = 48);
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outRGBA, const AtmosQuadrature& viewQuad, const AtmosQuadrature& sunQuad,
+	const TransmittanceLUT* sunLUT = nullptr, float* outMieRGB = nullptr, const bool* rayHitsGround = nullptr);
 static void ComputeDirectIrradianceRGB(
 	float r0, float muS,
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outRGB, int numStepsSun = 64);
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outRGB, const AtmosQuadrature& sunQuad);
+static void ReportScatteringLUTError(const PlanetGeom& pg, const AtmosLutMapping& map, const AtmosMedium& med, const AtmosQuadratureSet& quad, const AtmosResult* out);
+
+// 프리셋 하나의 bake 상태. ComputeAtmosBatchCPU의 단계들이 공유한다
+struct AtmosBakePreset
+{
+	const AtmosParams* In;
+	AtmosResult* Out;
+	PlanetGeom Pg;
+	AtmosLutMapping Map;	// 세 LUT 공통 texel <-> 파라미터 매핑 (AtmosphericSky.hlsl과 같은 식)
+	AtmosMedium Med;		// 밀도 프로파일/계수를 SIMD 커널용으로 풀어 둔 것 (모든 적분이 공유)
+	AtmosQuadratureSet Quad;
+	TransmittanceLUT TLUT;	// 구운 Transmittance LUT (bUseTransmittanceLUT이면 태양 방향 감쇠에 쓴다)
+	int StoredNU;
+	bool bCompactScattering;
+	bool bMultipleScattering;
+	bool bKeepSingleMie;					// 다중산란이 없어도 SingleM을 채운다 (분광 묶음의 채널별 Mie)
+	bool bSpectralLanes;					// 분광 묶음: Transmittance / 단산란 / 직접 조도는 AtmosSpectralBake가 채운다
+	std::vector<float> SingleR, SingleM;	// 다중산란 입력용 단산란 Rayleigh/Mie RGB (nu 없는 (r, mu, mu_s) 3D)
+
+	AtmosBakePreset(const AtmosParams& in, AtmosResult* out)
+		: In(&in), Out(out), Pg{ in.PlanetRadius, in.PlanetRadius + in.AtmosphereHeight }, Map(in.LutMapping, Pg.Rg, Pg.Rt),
+		Med{}, Quad(MakeAtmosQuadratureSet(in.Quality)), TLUT{ nullptr, 0, 0, Map }, StoredNU(0), bCompactScattering(false), bMultipleScattering(false), bKeepSingleMie(false), bSpectralLanes(false)
+	{
+	}
+};
+
+// 분광 프리셋 하나의 파장 lane bake. 묶음 프리셋 Groups[0..NumGroups)의 Transmittance / 단산란 / 직접 조도를
+// 파장 전체에 대해 한 번의 적분으로 채운다 (묶음 g의 채널 c = lane 3g + c).
+// 적분기는 종별 광학 두께 (SpeciesMed: 채널 = 종, 계수 = 종 기준값)만 구하고 파장별 exp / 누적은 AtmosKernels의 lane 커널이 한다.
+// 다중산란은 묶음마다 RGB 경로 그대로 돈다 (차수마다 4D 표 전체를 다시 도는 구조라 lane화 범위 밖)
+struct AtmosSpectralBake
+{
+	AtmosBakePreset* Groups;
+	int NumGroups;
+	AtmosMedium SpeciesMed;
+	AtmosSpectralLanes Lanes;
+	float RayleighScattering[ATMOS_SPECTRAL_MAX_LANES];
+	float MieScattering[ATMOS_SPECTRAL_MAX_LANES];
+	float SolarIrradiance[ATMOS_SPECTRAL_MAX_LANES];
+	std::vector<float> ColumnRGB;	// Transmittance 해상도의 종별 광학 두께 (SpeciesMed 기준값 단위). 태양 방향 조회용
+	TransmittanceLUT ColumnLUT;		// ColumnRGB를 TransmittanceLUT처럼 bilinear로 읽는다 (투과도 대신 광학 두께)
+
+	AtmosSpectralBake(AtmosBakePreset* groups, int numGroups);
+};
+
+// 프리셋마다 작업 count(p)개를 이어 붙여 한 ParallelFor로 돌린다: 전역 작업 번호 → run(p, 프리셋 안 작업 번호).
+// 작업마다 자기 프리셋의 texel만 쓰므로 결과는 프리셋을 하나씩 구운 것과 비트 단위로 같다.
+template<class T, class CountFn, class RunFn>
+static void ParallelForPresets(std::vector<T>& items, int numThreads, const CountFn& count, const RunFn& run)
+{
+	std::vector<int> begin(items.size() + 1, 0);
+	for (size_t p = 0; p < items.size(); ++p)
+	{
+		begin[p + 1] = begin[p] + count(items[p]);
+	}
+	ParallelFor(begin.back(), numThreads, [&](int job)
+	{
+		const size_t p = size_t(std::upper_bound(begin.begin(), begin.end(), job) - begin.begin()) - 1;
+		run(items[p], job - begin[p]);
+	});
+}
+
+// 분광 프리셋 하나가 풀어 쓴 batch에서 차지하는 묶음 프리셋 범위
+struct AtmosSpectralSpan
+{
+	int FirstSlot;
+	int NumGroups;
+};
+
+static bool PrepareAtmosBakePreset(AtmosBakePreset* b);
+static void ComputeTransmittanceRow(const PlanetGeom& pg, const AtmosLutMapping& lutMap, const AtmosMedium& med, const AtmosQuadrature& quad, int TW, int TH, int j, float* outRGB);
+static void ComputeSingleScatteringJob(AtmosBakePreset& b, int job);
+static void ComputeDirectIrradianceRow(AtmosBakePreset& b, int j);
+static void AccumulateMultipleScatteringBatch(std::vector<AtmosBakePreset>& presets, int numThreads);
+static void BakeAtmosPresets(const AtmosParams* in, int count, AtmosResult* out, const std::vector<AtmosSpectralSpan>* spectralSpans, std::vector<float>* outSingleMie);
+static void ResolveSpectralPreset(const AtmosParams& in, const AtmosSpectralSetup& setup,
+	AtmosResult* groups, const std::vector<float>* groupSingleMie, AtmosResult* out);
+static void ComputeSpectralTransmittanceRow(AtmosSpectralBake& s, int j);
+static void ComputeSpectralSingleScatteringJob(AtmosSpectralBake& s, int job);
+static void ComputeSpectralDirectIrradianceRow(AtmosSpectralBake& s, int j);
 
 void ComputeAtmosCPU(const AtmosParams& in, AtmosResult* out)
 {
-	std::cout << "Prelight::ComputeAtmos (CPU, single-scattering only)..." << std::endl;
-	ASSERT(out, "Output pointer is null.");
+	ComputeAtmosBatchCPU(&in, 1, out);
+}
 
-	// Planet geometry
-	PlanetGeom pg = {};
-	pg.Rg = in.PlanetRadius;
-	pg.Rt = in.PlanetRadius + in.AtmosphereHeight;
-	ASSERT(pg.Rg > 0.0f && pg.Rt > pg.Rg, "Invalid planet/atmosphere radius.");
+// 분광 프리셋은 파장 묶음 프리셋들로 풀어 RGB 프리셋과 같은 batch에 넣고, 다 구운 뒤 묶음들을 RGB LUT 하나로 모은다
+void ComputeAtmosBatchCPU(const AtmosParams* in, int count, AtmosResult* out)
+{
+	ASSERT(in && out && count > 0, "Invalid batch.");
+
+	bool bAnySpectral = false;
+	for (int p = 0; p < count; ++p)
+	{
+		bAnySpectral = bAnySpectral || in[p].SpectralWavelengths > 0;
+	}
+	if (!bAnySpectral)
+	{
+		BakeAtmosPresets(in, count, out, nullptr, nullptr);
+		return;
+	}
+
+	// 풀어 쓴 batch: RGB 프리셋은 out[p]에 바로, 분광 프리셋은 묶음마다 임시 결과에
+	std::vector<AtmosSpectralSetup> setups(count);
+	std::vector<AtmosParams> expanded;
+	std::vector<int> firstSlot(count);
+	for (int p = 0; p < count; ++p)
+	{
+		firstSlot[p] = int(expanded.size());
+		if (in[p].SpectralWavelengths > 0)
+		{
+			std::vector<AtmosParams> groups;
+			BuildAtmosSpectralGroups(in[p], &setups[p], &groups);
+			expanded.insert(expanded.end(), groups.begin(), groups.end());
+			std::cout << "[Prelight] Spectral preset " << p << ": " << setups[p].NumWavelengths << " wavelengths ("
+				<< ATMOS_SPECTRAL_LAMBDA_MIN << "-" << ATMOS_SPECTRAL_LAMBDA_MAX << "nm) in " << setups[p].NumGroups << " group(s)" << std::endl;
+		}
+		else
+		{
+			expanded.push_back(in[p]);
+		}
+	}
+
+	const int numExpanded = int(expanded.size());
+	std::vector<AtmosResult> expandedOut(numExpanded);
+	std::vector<AtmosSpectralSpan> spectralSpans;
+	for (int p = 0; p < count; ++p)
+	{
+		if (in[p].SpectralWavelengths > 0)
+		{
+			spectralSpans.push_back({ firstSlot[p], setups[p].NumGroups });
+		}
+	}
+	std::vector<std::vector<float>> singleMie(numExpanded);
+	BakeAtmosPresets(expanded.data(), numExpanded, expandedOut.data(), &spectralSpans, singleMie.data());
+
+	for (int p = 0; p < count; ++p)
+	{
+		AtmosResult* slot = &expandedOut[firstSlot[p]];
+		if (in[p].SpectralWavelengths > 0)
+		{
+			const auto resolveBegin = std::chrono::steady_clock::now();
+			ResolveSpectralPreset(in[p], setups[p], slot, &singleMie[firstSlot[p]], &out[p]);	// Timings는 묶음 batch 것을 그대로
+			out[p].Timings.SpectralResolveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - resolveBegin).count();
+			out[p].Timings.TotalMs += out[p].Timings.SpectralResolveMs;
+		}
+		else
+		{
+			out[p] = *slot;
+		}
+	}
+}
+
+// 단계 (Transmittance → 단산란 → 직접 조도 → 다중산란 차수별 하위 단계) 마다 모든 프리셋의 작업을 한 풀에 넣는다.
+// 프리셋이 적거나 LUT가 작아도 단계 하나의 작업 수가 worker 수보다 충분히 많아 부하가 고르게 나뉘고, 동기화 지점도 프리셋 수와 무관하다.
+// spectralSpans의 묶음 프리셋은 단산란까지 파장 lane bake (AtmosSpectralBake)로 굽고, 단산란 Mie RGB (nu 없는 (r, mu, mu_s) 3D)를
+// outSingleMie[p]로 넘긴다
+static void BakeAtmosPresets(const AtmosParams* in, int count, AtmosResult* out, const std::vector<AtmosSpectralSpan>* spectralSpans, std::vector<float>* outSingleMie)
+{
+	int maxOrders = 1;
+	for (int p = 0; p < count; ++p)
+	{
+		maxOrders = std::max(maxOrders, in[p].MultipleScatteringOrders);
+	}
+	if (count == 1)
+	{
+		std::cout << "Prelight::ComputeAtmos (CPU, " << maxOrders << " scattering order(s))..." << std::endl;
+	}
+	else
+	{
+		std::cout << "Prelight::ComputeAtmos batch (CPU, " << count << " preset(s), up to " << maxOrders << " scattering order(s))..." << std::endl;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto elapsedMs = [](Clock::time_point begin) { return std::chrono::duration<double, std::milli>(Clock::now() - begin).count(); };
+	const auto bakeBegin = Clock::now();
+	AtmosBakeTimings timings{};
+
+	std::unique_ptr<bool[]> spectralSlot(new bool[count]());
+	if (spectralSpans)
+	{
+		for (const AtmosSpectralSpan& span : *spectralSpans)
+		{
+			std::fill(&spectralSlot[span.FirstSlot], &spectralSlot[span.FirstSlot] + span.NumGroups, true);
+		}
+	}
+
+	std::vector<AtmosBakePreset> presets;
+	presets.reserve(count);
+	for (int p = 0; p < count; ++p)
+	{
+		presets.emplace_back(in[p], &out[p]);
+		presets.back().bKeepSingleMie = spectralSlot[p];
+		presets.back().bSpectralLanes = spectralSlot[p];
+		if (!PrepareAtmosBakePreset(&presets.back()))
+		{
+			for (AtmosBakePreset& b : presets)
+			{
+				delete[] b.Out->TransmittanceRGB; b.Out->TransmittanceRGB = nullptr;
+				delete[] b.Out->ScatteringRGBA;   b.Out->ScatteringRGBA = nullptr;
+				delete[] b.Out->IrradianceRGB;    b.Out->IrradianceRGB = nullptr;
+			}
+			return;
+		}
+	}
+
+	const int numThreads = ResolveThreadCount(in[0].NumThreads);
+	std::cout << "[Prelight] Atmosphere kernels: " << GetAtmosKernelPathName() << std::endl;
+
+	// 분광 프리셋마다 묶음들을 lane으로 묶는다 (presets는 더 늘지 않으므로 포인터가 유지된다)
+	std::vector<AtmosSpectralBake> spectral;
+	if (spectralSpans)
+	{
+		spectral.reserve(spectralSpans->size());
+		for (const AtmosSpectralSpan& span : *spectralSpans)
+		{
+			spectral.emplace_back(&presets[span.FirstSlot], span.NumGroups);
+		}
+	}
+	auto rgbOnly = [](const AtmosBakePreset& b, int n) { return b.bSpectralLanes ? 0 : n; };
+
+	// ----------------------------- Transmittance 2D -----------------------------
+	// (r, mu). 매핑별 저장 범위는 ComputeTransmittanceLUT 참조. 작업 단위는 행 (r)
+	const auto transBegin = Clock::now();
+	ParallelForPresets(presets, numThreads,
+		[&](const AtmosBakePreset& b) { return rgbOnly(b, b.In->TransmittanceH); },
+		[](AtmosBakePreset& b, int j) { ComputeTransmittanceRow(b.Pg, b.Map, b.Med, b.Quad.Transmittance, b.In->TransmittanceW, b.In->TransmittanceH, j, b.Out->TransmittanceRGB); });
+	ParallelForPresets(spectral, numThreads,
+		[](const AtmosSpectralBake& s) { return s.Groups[0].In->TransmittanceH; },
+		[](AtmosSpectralBake& s, int j) { ComputeSpectralTransmittanceRow(s, j); });
+	timings.TransmittanceMs = elapsedMs(transBegin);
+
+	// ----------------------------- Scattering 4D (packed) -----------------------
+	// 작업 단위는 (r, mu) 한 쌍 → mu_s 전체
+	const auto scatterBegin = Clock::now();
+	ParallelForPresets(presets, numThreads,
+		[&](const AtmosBakePreset& b) { return rgbOnly(b, b.In->ScatteringR * b.In->ScatteringMu); },
+		[](AtmosBakePreset& b, int job) { ComputeSingleScatteringJob(b, job); });
+	ParallelForPresets(spectral, numThreads,
+		[](const AtmosSpectralBake& s) { return s.Groups[0].In->ScatteringR * s.Groups[0].In->ScatteringMu; },
+		[](AtmosSpectralBake& s, int job) { ComputeSpectralSingleScatteringJob(s, job); });
+
+	const double scatterMs = elapsedMs(scatterBegin);
+	timings.SingleScatteringMs = scatterMs;
+	for (const AtmosBakePreset& b : presets)
+	{
+		std::cout << "[Prelight] Scattering " << b.In->ScatteringR << "x" << b.In->ScatteringMu << "x" << b.In->ScatteringMuS
+			<< (b.Map.Mode == ATMOS_LUT_MAPPING_BRUNETON ? " Bruneton" : " uniform")
+			<< (b.bCompactScattering ? " no-nu" : "")
+			<< (b.Quad.View.bAdaptive ? " adaptive" : "")
+			<< (b.In->bUseTransmittanceLUT ? " (transmittance LUT)" : " (brute force)");
+		if (count == 1)
+		{
+			std::cout << ", " << numThreads << " thread(s): " << scatterMs << "ms" << std::endl;
+		}
+		else
+		{
+			std::cout << std::endl;
+		}
+	}
+	if (count > 1)
+	{
+		std::cout << "[Prelight] Scattering " << count << " preset(s), " << numThreads << " thread(s): " << scatterMs << "ms" << std::endl;
+	}
+
+	// LUT 경로 정확도 확인: 일부 texel을 brute force로 다시 적분해서 비교
+	const auto validationBegin = Clock::now();
+	for (const AtmosBakePreset& b : presets)
+	{
+		if (b.In->bUseTransmittanceLUT && !b.bSpectralLanes)	// 분광 묶음의 A 채널은 Resolve에서 다시 구하므로 RGB 적분과 비교하지 않는다
+		{
+			ReportScatteringLUTError(b.Pg, b.Map, b.Med, b.Quad, b.Out);
+		}
+	}
+	timings.ValidationMs = elapsedMs(validationBegin);
+
+	// ----------------------------- Irradiance 2D --------------------------------
+	// (r, mu_s). j→r, i→mu_s
+	const auto irradianceBegin = Clock::now();
+	ParallelForPresets(presets, numThreads,
+		[&](const AtmosBakePreset& b) { return rgbOnly(b, b.In->IrradianceH); },
+		[](AtmosBakePreset& b, int j) { ComputeDirectIrradianceRow(b, j); });
+	ParallelForPresets(spectral, numThreads,
+		[](const AtmosSpectralBake& s) { return s.Groups[0].In->IrradianceH; },
+		[](AtmosSpectralBake& s, int j) { ComputeSpectralDirectIrradianceRow(s, j); });
+	timings.DirectIrradianceMs = elapsedMs(irradianceBegin);
+
+	// ----------------------------- Multiple scattering ---------------------------
+	// 2차 이상 산란을 Scattering RGB(Rayleigh 위상으로 나눠서)와 Irradiance에 누적
+	if (maxOrders > 1)
+	{
+		const auto msBegin = Clock::now();
+		AccumulateMultipleScatteringBatch(presets, numThreads);
+		timings.MultipleScatteringMs = elapsedMs(msBegin);
+	}
+
+	for (int p = 0; p < count; ++p)
+	{
+		if (presets[p].bKeepSingleMie)
+		{
+			outSingleMie[p].swap(presets[p].SingleM);
+		}
+	}
+
+	timings.TotalMs = elapsedMs(bakeBegin);
+	for (int p = 0; p < count; ++p)
+	{
+		out[p].Timings = timings;
+	}
+
+	std::cout << "Prelight::ComputeAtmos done (no phase in LUT; orders >= 2 stored in RGB / RayleighPhase(nu))." << std::endl;
+}
+
+// 파장 묶음 결과 → 선형 sRGB LUT (groups[g]의 채널 c = 파장 3g + c). 묶음 결과 버퍼는 여기서 해제한다
+//  Scattering RGB / Irradiance: 복사량이라 채널 가중치로 그대로 합친다
+//  Transmittance: 태양 스펙트럼으로 가중한 평균 (햇빛이 경로를 지나며 남는 비율)
+//  Scattering A: 파장별 단산란 Mie를 RGB로 모은 뒤 런타임 복원식 A * MieScattering[c] / 평균 에 최소제곱으로 맞춘다
+// 색역 밖 (음수) 성분은 0으로 자른다
+static void ResolveSpectralPreset(const AtmosParams& in, const AtmosSpectralSetup& setup,
+	AtmosResult* groups, const std::vector<float>* groupSingleMie, AtmosResult* out)
+{
+	const int G = setup.NumGroups, N = setup.NumWavelengths;
+	const int numSlots = G * 3;
+
+	bool bBaked = true;
+	for (int g = 0; g < G; ++g)
+	{
+		bBaked = bBaked && groups[g].TransmittanceRGB && groups[g].ScatteringRGBA && groups[g].IrradianceRGB;
+	}
+
+	*out = groups[0];	// 크기 / 매핑 / layout
+	out->TransmittanceRGB = nullptr;
+	out->ScatteringRGBA = nullptr;
+	out->IrradianceRGB = nullptr;
+
+	if (bBaked)
+	{
+		// 파장 칸별 가중치 (마지막 묶음의 빈 칸은 0)
+		std::vector<float> wRad(size_t(3) * numSlots, 0.0f), wTr(size_t(3) * numSlots, 0.0f);
+		for (int ch = 0; ch < 3; ++ch)
+		{
+			double sunSum = 0.0;
+			for (int i = 0; i < N; ++i)
+			{
+				wRad[size_t(ch) * numSlots + i] = setup.Weight[ch][i];
+				sunSum += (double)setup.Weight[ch][i] * setup.SolarIrradiance[i];
+			}
+			for (int i = 0; i < N; ++i)
+			{
+				wTr[size_t(ch) * numSlots + i] = (sunSum > 0.0) ? float(setup.Weight[ch][i] * setup.SolarIrradiance[i] / sunSum) : setup.Weight[ch][i];
+			}
+		}
+
+		// RGB 3채널 버퍼 합성: dst[t * 3 + ch] = Σ w[ch][3g + c] * groups[g].src[t * 3 + c]
+		auto resolveRGB = [&](float* const AtmosResult::* buffer, const std::vector<float>& w, size_t numTexels, float maxValue, float* dst)
+			{
+				for (size_t t = 0; t < numTexels; ++t)
+				{
+					for (int ch = 0; ch < 3; ++ch)
+					{
+						const float* wc = &w[size_t(ch) * numSlots];
+						float sum = 0.0f;
+						for (int g = 0; g < G; ++g)
+						{
+							const float* src = &(groups[g].*buffer)[t * 3];
+							sum += wc[3 * g + 0] * src[0] + wc[3 * g + 1] * src[1] + wc[3 * g + 2] * src[2];
+						}
+						dst[t * 3 + ch] = std::clamp(sum, 0.0f, maxValue);
+					}
+				}
+			};
+
+		const size_t numT = size_t(out->TransmittanceW) * out->TransmittanceH;
+		const size_t numE = size_t(out->IrradianceW) * out->IrradianceH;
+		const size_t numS = size_t(out->ScatteringR) * out->ScatteringMu * out->ScatteringMuS * out->ScatteringNu;
+		out->TransmittanceRGB = new float[numT * 3];
+		out->IrradianceRGB = new float[numE * 3];
+		out->ScatteringRGBA = new float[numS * 4];
+		resolveRGB(&AtmosResult::TransmittanceRGB, wTr, numT, 1.0f, out->TransmittanceRGB);
+		resolveRGB(&AtmosResult::IrradianceRGB, wRad, numE, FLT_MAX, out->IrradianceRGB);
+
+		// 런타임 Mie 색 (AtmosphericSky.hlsl g_MieTint, AtmosSampler MieTint)
+		const float mieAvg = (in.MieScattering.x + in.MieScattering.y + in.MieScattering.z) / 3.0f;
+		const float invAvg = (mieAvg > 0.0f) ? 1.0f / mieAvg : 0.0f;
+		const float tint[3] = { in.MieScattering.x * invAvg, in.MieScattering.y * invAvg, in.MieScattering.z * invAvg };
+		const float tintNorm = tint[0] * tint[0] + tint[1] * tint[1] + tint[2] * tint[2];
+
+		const int storedNU = out->ScatteringNu;
+		for (size_t t = 0; t < numS; ++t)
+		{
+			const size_t idx3 = t / storedNU;	// 단산란 Mie는 nu와 무관
+			float mieRGB[3];
+			for (int ch = 0; ch < 3; ++ch)
+			{
+				const float* wc = &wRad[size_t(ch) * numSlots];
+				float rgb = 0.0f, mie = 0.0f;
+				for (int g = 0; g < G; ++g)
+				{
+					const float* src = &groups[g].ScatteringRGBA[t * 4];
+					const float* m = &groupSingleMie[g][idx3 * 3];
+					rgb += wc[3 * g + 0] * src[0] + wc[3 * g + 1] * src[1] + wc[3 * g + 2] * src[2];
+					mie += wc[3 * g + 0] * m[0] + wc[3 * g + 1] * m[1] + wc[3 * g + 2] * m[2];
+				}
+				out->ScatteringRGBA[t * 4 + ch] = std::max(rgb, 0.0f);
+				mieRGB[ch] = std::max(mie, 0.0f);
+			}
+			const float A = (tintNorm > 0.0f) ? (mieRGB[0] * tint[0] + mieRGB[1] * tint[1] + mieRGB[2] * tint[2]) / tintNorm : 0.0f;
+			out->ScatteringRGBA[t * 4 + 3] = A;
+		}
+	}
+
+	for (int g = 0; g < G; ++g)
+	{
+		delete[] groups[g].TransmittanceRGB; groups[g].TransmittanceRGB = nullptr;
+		delete[] groups[g].ScatteringRGBA;   groups[g].ScatteringRGBA = nullptr;
+		delete[] groups[g].IrradianceRGB;    groups[g].IrradianceRGB = nullptr;
+	}
+}
+
+// 검증 + 출력 버퍼 할당 + 매질 준비. 할당 실패면 false
+static bool PrepareAtmosBakePreset(AtmosBakePreset* b)
+{
+	const AtmosParams& in = *b->In;
+	AtmosResult* out = b->Out;
+	ASSERT(b->Pg.Rg > 0.0f && b->Pg.Rt > b->Pg.Rg, "Invalid planet/atmosphere radius.");
 
 	// Resolutions
 	const int TW = in.TransmittanceW, TH = in.TransmittanceH;
@@ -39,14 +486,23 @@ void ComputeAtmosCPU(const AtmosParams& in, AtmosResult* out)
 
 	ASSERT(TW > 0 && TH > 0 && SR > 0 && SMU > 0 && SMUS > 0 && SNU > 0 && EW > 0 && EH > 0,
 		"Invalid LUT dimensions.");
+	ASSERT(in.LutMapping != ATMOS_LUT_MAPPING_BRUNETON || (SMU >= 4 && SMU % 2 == 0),
+		"Bruneton mapping needs an even ScatteringMu (>= 4).");
+
+	// 단산란만 구우면 phase가 없어 nu와 무관하다 → 요청 시 nu 축 없이 저장 (NU = 1)
+	b->bCompactScattering = in.bCompactScattering && in.MultipleScatteringOrders <= 1;
+	b->StoredNU = b->bCompactScattering ? 1 : SNU;
+	b->bMultipleScattering = in.MultipleScatteringOrders > 1;
 
 	// Prepare output buffers.
 	out->TransmittanceW = TW; out->TransmittanceH = TH;
-	out->ScatteringR = SR; out->ScatteringMu = SMU; out->ScatteringMuS = SMUS; out->ScatteringNu = SNU;
+	out->ScatteringR = SR; out->ScatteringMu = SMU; out->ScatteringMuS = SMUS; out->ScatteringNu = b->StoredNU;
+	out->ScatteringLayout = b->bCompactScattering ? ATMOS_SCATTERING_LAYOUT_R_MU_MUS : ATMOS_SCATTERING_LAYOUT_R_MU_MUS_NU;
 	out->IrradianceW = EW; out->IrradianceH = EH;
+	out->LutMapping = in.LutMapping;
 
 	size_t Tsize = size_t(TW) * size_t(TH) * 3;
-	size_t Ssize = size_t(SR) * size_t(SMU) * size_t(SMUS) * size_t(SNU) * 4;
+	size_t Ssize = size_t(SR) * size_t(SMU) * size_t(SMUS) * size_t(b->StoredNU) * 4;
 	size_t Esize = size_t(EW) * size_t(EH) * 3;
 
 	out->TransmittanceRGB = new float[Tsize];
@@ -56,91 +512,125 @@ void ComputeAtmosCPU(const AtmosParams& in, AtmosResult* out)
 	if (!out->TransmittanceRGB || !out->ScatteringRGBA || !out->IrradianceRGB)
 	{
 		std::cerr << "[Prelight] Allocation failed." << std::endl;
-		delete[] out->TransmittanceRGB; out->TransmittanceRGB = nullptr;
-		delete[] out->ScatteringRGBA;   out->ScatteringRGBA = nullptr;
-		delete[] out->IrradianceRGB;    out->IrradianceRGB = nullptr;
-		return;
+		return false;
 	}
 
-	// ----------------------------- Transmittance 2D -----------------------------
-	// Simplified version : r ∈ [Rg, Rt], mu ∈ [-1, 1] uniform sample
-	for (int j = 0; j < TH; ++j)
-	{
-		float v = (j + 0.5f) / float(TH);
-		float r = pg.Rg + (pg.Rt - pg.Rg) * v; // 균등 고도 (추후 Bruneton 매핑으로 교체 권장)
+	BuildAtmosMedium(in, &b->Med);
+	b->TLUT = { out->TransmittanceRGB, TW, TH, b->Map };
 
-		for (int i = 0; i < TW; ++i)
-		{
-			float u = (i + 0.5f) / float(TW);
-			float mu = -1.0f + 2.0f * u;       // 균등 코사인
+	if (b->bMultipleScattering)
+	{
+		b->SingleR.resize(size_t(SR) * SMU * SMUS * 3);
+	}
+	if (b->bMultipleScattering || b->bKeepSingleMie)
+	{
+		b->SingleM.resize(size_t(SR) * SMU * SMUS * 3);
+	}
+	return true;
+}
 
-			float Tr[3];
-			IntegrateTransmittanceRGB(r, mu, pg, in, Tr, /*steps*/96);
+// Dim : (r, mu, mu_s, nu). 단산란은 위상 미적용이라 nu에 무관 → 모든 nu slice 동일 (다중산란이 더해지면서 nu 의존성이 생긴다).
+// bUseTransmittanceLUT: 태양 방향 감쇠를 먼저 구운 Transmittance LUT에서 bilinear로 읽는다.
+static void ComputeSingleScatteringJob(AtmosBakePreset& b, int job)
+{
+	const int SMU = b.In->ScatteringMu, SMUS = b.In->ScatteringMuS;
+	const int storedNU = b.StoredNU;
+	const int ir = job / SMU;
+	const int imu = job % SMU;
+	const TransmittanceLUT* sunLUT = b.In->bUseTransmittanceLUT ? &b.TLUT : nullptr;
+	float* scattering = b.Out->ScatteringRGBA;
 
-			size_t idx = (size_t(j) * TW + i) * 3;
-			out->TransmittanceRGB[idx + 0] = Tr[0];
-			out->TransmittanceRGB[idx + 1] = Tr[1];
-			out->TransmittanceRGB[idx + 2] = Tr[2];
-		}
-	}
+	bool bRayHitsGround = false;
+	const float r = b.Map.ScatteringR(ir, b.In->ScatteringR);
+	const float mu = b.Map.ScatteringMu(r, imu, SMU, &bRayHitsGround);
 
-	// ----------------------------- Scattering 4D (packed) -----------------------
-	// Dim : (r, mu, mu_s, nu). 현재 구현은 "단산란 & 위상 미적용" → nu에 무관, 모든 nu slice 동일.
-	for (int ir = 0; ir < SR; ++ir)
+	for (int imus = 0; imus < SMUS; ++imus)
 	{
-		float fr = (ir + 0.5f) / float(SR);
-		float r = pg.Rg + (pg.Rt - pg.Rg) * fr;
+		const float muS = b.Map.ScatteringMuS(imus, SMUS);
 
-		for (int imu = 0; imu < SMU; ++imu)
+		// 단산란 적분 (phase 미적용)
+		float RGBA[4], mieRGB[3];
+		const bool bKeepMie = !b.SingleM.empty();
+		IntegrateSingleScatteringUnphased(r, mu, muS, b.Pg, b.Med, RGBA, b.Quad.View, b.Quad.Sun, sunLUT,
+			bKeepMie ? mieRGB : nullptr, &bRayHitsGround);
+		const size_t idx3 = (((size_t)ir * SMU + imu) * SMUS + imus) * 3;
+		for (int c = 0; c < 3; ++c)
 		{
-			float fmu = (imu + 0.5f) / float(SMU);
-			float mu = -1.0f + 2.0f * fmu;
-
-			for (int imus = 0; imus < SMUS; ++imus)
+			if (b.bMultipleScattering)
 			{
-				float fmus = (imus + 0.5f) / float(SMUS);
-				float muS = -1.0f + 2.0f * fmus;
-
-				// 단산란 적분 (phase 미적용)
-				float RGBA[4];
-				IntegrateSingleScatteringUnphased(r, mu, muS, pg, in, RGBA, /*viewSteps*/80, /*sunSteps*/64);
-
-				for (int inu = 0; inu < SNU; ++inu)
-				{
-					size_t linear4 = (((size_t)ir * SMU + imu) * SMUS + imus) * SNU + inu;
-					size_t base = linear4 * 4;
-					out->ScatteringRGBA[base + 0] = RGBA[0]; // Rayleigh R
-					out->ScatteringRGBA[base + 1] = RGBA[1]; // Rayleigh G
-					out->ScatteringRGBA[base + 2] = RGBA[2]; // Rayleigh B
-					out->ScatteringRGBA[base + 3] = RGBA[3]; // Mie (scalar)
-				}
+				b.SingleR[idx3 + c] = RGBA[c];
 			}
+			if (bKeepMie)
+			{
+				b.SingleM[idx3 + c] = mieRGB[c];
+			}
+		}
+
+		for (int inu = 0; inu < storedNU; ++inu)
+		{
+			size_t linear4 = (((size_t)ir * SMU + imu) * SMUS + imus) * storedNU + inu;
+			size_t base = linear4 * 4;
+			scattering[base + 0] = RGBA[0]; // Rayleigh R
+			scattering[base + 1] = RGBA[1]; // Rayleigh G
+			scattering[base + 2] = RGBA[2]; // Rayleigh B
+			scattering[base + 3] = RGBA[3]; // Mie (scalar)
 		}
 	}
+}
 
-	// ----------------------------- Irradiance 2D --------------------------------
-	// (r, mu_s). j→r, i→mu_s
-	for (int j = 0; j < EH; ++j) 
+static void ComputeDirectIrradianceRow(AtmosBakePreset& b, int j)
+{
+	const int EW = b.In->IrradianceW, EH = b.In->IrradianceH;
+	for (int i = 0; i < EW; ++i) 
 	{
-		float fr = (j + 0.5f) / float(EH);
-		float r = pg.Rg + (pg.Rt - pg.Rg) * fr;
-
-		for (int i = 0; i < EW; ++i) 
-		{
-			float fmus = (i + 0.5f) / float(EW);
-			float muS = -1.0f + 2.0f * fmus;
+		float r, muS;
+		b.Map.IrradianceTexelToParams(i, j, EW, EH, &r, &muS);
 
-			float E[3];
-			ComputeDirectIrradianceRGB(r, muS, pg, in, E, /*sunSteps*/96);
+		float E[3];
+		ComputeDirectIrradianceRGB(r, muS, b.Pg, b.Med, E, b.Quad.IrradianceSun);
 
-			size_t idx = (size_t(j) * EW + i) * 3;
-			out->IrradianceRGB[idx + 0] = E[0];
-			out->IrradianceRGB[idx + 1] = E[1];
-			out->IrradianceRGB[idx + 2] = E[2];
-		}
+		size_t idx = (size_t(j) * EW + i) * 3;
+		b.Out->IrradianceRGB[idx + 0] = E[0];
+		b.Out->IrradianceRGB[idx + 1] = E[1];
+		b.Out->IrradianceRGB[idx + 2] = E[2];
 	}
+}
+
+// Uniform : r ∈ [Rg, Rt], mu ∈ [-1, 1] 균등
+// Bruneton: 지평선 위 ray만 저장 (mu는 top 경계까지 거리로 매핑) → 지평선 texel도 지표를 지나지 않게 적분
+// 행(r) 단위로 병렬 처리
+void ComputeTransmittanceLUT(const AtmosParams& in, const AtmosMedium& med, int numThreads, float* outRGB)
+{
+	PlanetGeom pg = {};
+	pg.Rg = in.PlanetRadius;
+	pg.Rt = in.PlanetRadius + in.AtmosphereHeight;
+	const AtmosLutMapping lutMap(in.LutMapping, pg.Rg, pg.Rt);
+	const AtmosQuadratureSet quad = MakeAtmosQuadratureSet(in.Quality);
+	const int TW = in.TransmittanceW, TH = in.TransmittanceH;
 
-	std::cout << "Prelight::ComputeAtmos done (CPU reference: single scattering, no phase in LUT)." << std::endl;
+	ParallelFor(TH, numThreads, [&](int j)
+	{
+		ComputeTransmittanceRow(pg, lutMap, med, quad.Transmittance, TW, TH, j, outRGB);
+	});
+}
+
+static void ComputeTransmittanceRow(const PlanetGeom& pg, const AtmosLutMapping& lutMap, const AtmosMedium& med, const AtmosQuadrature& quad, int TW, int TH, int j, float* outRGB)
+{
+	const bool bTransmittanceToTop = false;
+	const bool* transmittanceSide = (lutMap.Mode == ATMOS_LUT_MAPPING_BRUNETON) ? &bTransmittanceToTop : nullptr;
+	for (int i = 0; i < TW; ++i)
+	{
+		float r, mu;
+		lutMap.TransmittanceTexelToParams(i, j, TW, TH, &r, &mu);
+
+		float Tr[3];
+		IntegrateTransmittanceRGB(r, mu, pg, med, Tr, quad, transmittanceSide);
+
+		size_t idx = (size_t(j) * TW + i) * 3;
+		outRGB[idx + 0] = Tr[0];
+		outRGB[idx + 1] = Tr[1];
+		outRGB[idx + 2] = Tr[2];
+	}
 }
 
 // ---------------------------- Internal helpers ----------------------------
@@ -166,50 +656,30 @@ static inline float length3(float x, float y, float z)
 	return std::sqrt(x * x + y * y + z * z);
 }
 
-// DensityProfile: rho(h) = clamp( Σ (expTerm * exp(-h/scale) + linearTerm*h + constantTerm), 0..1 )
-// Width > 0 인 레이어는 h > Width 구간에서 기여 0.
-static float SampleDensity(const DensityProfile& prof, float h /* altitude meters */)
-{
-	float rho = 0.0f;
-	for (int i = 0; i < 2; ++i)
-	{
-		const DensityLayer& L = prof.Layers[i];
-		if (L.Scale == 0.0f && L.ExpTerm != 0.0f)
-		{
-			continue;
-		}
-		if (L.Width > 0.0f && h > L.Width)
-		{
-			continue;
-		}
-		float e = (L.Scale > 0.0f) ? std::exp(-h / L.Scale) : 0.0f;
-		rho += L.ExpTerm * e + L.LinearTerm * h + L.ConstantTerm;
-	}
-	return HFX_CLAMP(rho, 0.0f, 1.0f);
-}
-
 // 반지름 r0(행성중심), 방향 코사인 mu 에 대해 구 위와의 교차 t(>0) 계산
 // r(t)^2 = r0^2 + t^2 + 2 t r0 mu
+// t^2 + 2 r0 mu t + (r0^2 - R^2) = 0
+// km 단위의 r0^2 - R^2는 float로 전개하면 상쇄되고 FMA 축약 여부에 따라 값이 달라지므로 판별식은 인수분해해 double로 계산한다
 static bool RaySphereIntersectT(float r0, float mu, float R, float& t0, float& t1)
 {
-	// t^2 + 2 r0 mu t + (r0^2 - R^2) = 0
-	float B = 2.0f * r0 * mu;
-	float C = r0 * r0 - R * R;
-	float D = B * B - 4.0f * C;
-	if (D < 0.0f)
+	const double rmu = double(r0) * mu;
+	const double D = rmu * rmu - (double(r0) - R) * (double(r0) + R);
+	if (D < 0.0)
 	{
 		return false;
 	}
-	float sD = std::sqrt(D);
+	const double sD = std::sqrt(D);
 	// 두 해 (작은 t가 입사, 큰 t가 출사)
-	t0 = (-B - sD) * 0.5f;
-	t1 = (-B + sD) * 0.5f;
+	t0 = float(-rmu - sD);
+	t1 = float(-rmu + sD);
 	return true;
 }
 
 // 주어진 r0, mu 에서 상부 경계/지표로 향하는 유효 적분 구간 길이 tEnd를 결정
 // down ray가 지표에 먼저 닿으면 그 지점까지만 적분 (지표는 불투명 가정)
-static float PathLengthToBoundary(float r0, float mu, const PlanetGeom& pg, bool towardSun, bool* sunHitsGround = nullptr)
+// rayHitsGround != nullptr 이면 교차 판정 대신 그 값을 따른다.
+// (Bruneton 매핑의 지평선 texel 두 개는 mu가 같고 지표 쪽/하늘 쪽만 달라서, 접선에서 반올림으로 판정이 뒤집히면 안 된다)
+static float PathLengthToBoundary(float r0, float mu, const PlanetGeom& pg, bool* outHitsGround = nullptr, const bool* rayHitsGround = nullptr)
 {
 	float tTop0 = 0, tTop1 = 0, tG0 = 0, tG1 = 0;
 	bool hitTop = RaySphereIntersectT(r0, mu, pg.Rt, tTop0, tTop1);
@@ -217,200 +687,1792 @@ static float PathLengthToBoundary(float r0, float mu, const PlanetGeom& pg, bool
 
 	float tExitTop = hitTop ? HFX_MAX(tTop0, tTop1) : -1.0f;
 	float tEnterG = hitGnd ? HFX_MIN(tG0, tG1) : -1.0f;
-	float tExitG = hitGnd ? HFX_MAX(tG0, tG1) : -1.0f;
 
 	// 시작점은 대기 내부(r0∈[Rg, Rt])라고 가정.
-	// view/sun 공통: 앞으로 진행(t>0)만 고려.
-	float tEnd = 0.0f;
+	// view/sun 공통: 앞으로 진행(t>0)만 고려. 아래로 향하는 ray만 지표에 먼저 닿을 수 있다.
+	// 지표 위 (r0 = Rg)에서 출발하면 tEnterG = 0 이므로 출사점 기준으로 본다
+	bool bHitsGround = (mu < 0.0f && hitGnd && HFX_MAX(tG0, tG1) > 0.0f);
+	if (rayHitsGround)
+	{
+		bHitsGround = *rayHitsGround;
+	}
+	if (outHitsGround) *outHitsGround = bHitsGround;
 
-	if (mu >= 0.0f)
+	float tEnd = 0.0f;
+	if (bHitsGround)
 	{
-		// 위로 향함: top 경계로 나감
-		tEnd = (tExitTop > 0.0f) ? tExitTop : 0.0f;
-		if (sunHitsGround) *sunHitsGround = false;
+		// 지표까지. 접선 ray는 판별식이 반올림으로 음수일 수 있어 접점까지 거리로 대신한다
+		// 지표 위에서 아래로 향하는 ray (Bruneton 매핑 r = Rg 행의 지표 쪽 texel)는 길이 0
+		tEnd = hitGnd ? HFX_MAX(0.0f, tEnterG) : -r0 * mu;
 	}
 	else
 	{
-		// 아래로 향함: 지표에 먼저 닿는지 확인
-		if (tEnterG > 0.0f)
-		{
-			tEnd = tEnterG; // 지표까지
-			if (sunHitsGround) *sunHitsGround = true;
-		}
-		else
-		{
-			// 지표 미교차 → 곧바로 top에서 나감
-			tEnd = (tExitTop > 0.0f) ? tExitTop : 0.0f;
-			if (sunHitsGround) *sunHitsGround = false;
-		}
+		// 지표 미교차 → top 경계로 나감
+		tEnd = (tExitTop > 0.0f) ? tExitTop : 0.0f;
 	}
-	(void)tExitG; (void)tG1; // 경고 억제
 	return (tEnd > 0.0f) ? tEnd : 0.0f;
 }
 
-// 고도 r(행성중심거리)에서 주어진 mu 방향으로의 광학두께 적분 → 채널별 Transmittance 반환
-// extinction = RayleighScattering + MieExtinction + OzoneAbsorption (각각 밀도 가중)
-static void IntegrateTransmittanceRGB(
-	float r0, float mu,
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outTrRGB, int numSteps)
+// 밀도 exp(-(r - Rg) / H) 를 (r, mu)에서 무한대까지 적분한 값 [m] (Chapman 함수 x H x exp(-h/H)).
+// mu >= 0: 고도를 ray를 따라 2차 근사 h(t) ≈ h + mu t + (1 - mu^2) t^2 / 2r 로 두면 닫힌 식이 된다
+//   H √π z erfcx(mu z) exp(-h/H),  z = sqrt(r / (2 (1 - mu^2) H))
+// 근사 오차는 r/H (지구 규모 ~10^3)에 반비례해 작다.
+// mu < 0: 근지점에서 2차 근사가 가장 정확하므로 근지점 양쪽 (2 x 근지점 수평 ray - 시작점 반대 방향)으로 푼다.
+// 근지점이 지표 위일 때만 의미가 있다 (지표 교차 ray는 호출 쪽에서 뒤집어 mu >= 0으로 푼다)
+static double ExpColumnToInfinity(double r, double mu, double Rg, double H)
 {
-	float tEnd = PathLengthToBoundary(r0, mu, pg, /*towardSun*/false, nullptr);
-	if (tEnd <= 0.0f)
+	static constexpr double SQRT_PI = 1.7724538509055160;
+	if (mu < 0.0)
 	{
-		outTrRGB[0] = outTrRGB[1] = outTrRGB[2] = 1.0f;
-		return;
+		// 접선 근처에서 반올림으로 지표 미교차 판정된 ray는 근지점이 지표 아래일 수 있다 → 지표로 올린다 (수치 적분의 h >= 0 clamp와 같은 취급)
+		const double rp = HFX_MAX(Rg, r * std::sqrt(HFX_MAX(0.0, 1.0 - mu * mu)));
+		return 2.0 * ExpColumnToInfinity(rp, 0.0, Rg, H) - ExpColumnToInfinity(r, -mu, Rg, H);
 	}
 
-	// 누적 광학두께
-	double tauR = 0.0, tauG = 0.0, tauB = 0.0;
+	const double h = (r - Rg) / H;
+	const double z = std::sqrt(r / (2.0 * HFX_MAX(1.0 - mu * mu, 1e-300) * H));
+	const double y = mu * z;
+	if (y > 25.0)
+	{
+		// erfcx 점근 전개 (천정 근처: 평면 대기 H / mu 로 수렴)
+		const double iy2 = 1.0 / (y * y);
+		return std::exp(-h) * (H / mu) * (1.0 - iy2 * (0.5 - iy2 * (0.75 - iy2 * 1.875)));
+	}
+	return H * SQRT_PI * z * std::exp(y * y - h) * std::erfc(y);
+}
 
-	const float ds = tEnd / float(numSteps);
-	const float Rg = pg.Rg;
+// 순수 지수 매질(med.bAnalyticOpticalDepth)의 (r0, mu) → 경계 광학 두께 [채널별, 무차원]
+// 시작점과 끝점에서 각각 무한대까지의 적분을 구해 빼서 구간 [0, tEnd]만 남긴다.
+// 지표 교차 ray는 지표에서 r0 쪽으로 거꾸로 올라가는 ray로 푼다.
+static void AnalyticOpticalDepthRGB(float r0, float mu, float tEnd, bool bHitsGround, const PlanetGeom& pg, const AtmosMedium& med, double* outTau)
+{
+	const double r = r0, rEnd = bHitsGround ? pg.Rg : pg.Rt;
+	const double muEnd = HFX_CLAMP((r * mu + tEnd) / rEnd, -1.0, 1.0);
 
-	for (int i = 0; i < numSteps; ++i)
+	auto column = [&](const AtmosMediumSpecies& s)
+		{
+			if (s.NumLayers == 0)
+			{
+				return 0.0;
+			}
+			const double H = 1.0 / s.Layers[0].InvScale;
+			const double col = bHitsGround
+				? ExpColumnToInfinity(rEnd, -muEnd, pg.Rg, H) - ExpColumnToInfinity(r, -mu, pg.Rg, H)
+				: ExpColumnToInfinity(r, mu, pg.Rg, H) - ExpColumnToInfinity(rEnd, muEnd, pg.Rg, H);
+			return HFX_MAX(0.0, col) * s.Layers[0].ExpTerm;
+		};
+	const double colR = column(med.Rayleigh), colM = column(med.Mie), colO = column(med.Ozone);
+	for (int c = 0; c < 3; ++c)
 	{
-		float t = (i + 0.5f) * ds;
-		// r(t) = sqrt(r0^2 + t^2 + 2 t r0 mu)
-		float r = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
-		float h = HFX_MAX(0.0f, r - Rg);
-
-		float rhoR = SampleDensity(in.Rayleigh, h);
-		float rhoM = SampleDensity(in.Mie, h);
-		float rhoO = SampleDensity(in.Ozone, h);
+		outTau[c] = med.RayleighScattering[c] * colR + med.MieExtinction[c] * colM + med.OzoneAbsorption[c] * colO;
+	}
+}
 
-		// channel별 extinction [1/m]
-		tauR += (in.RayleighScattering.x * rhoR
-			+ in.MieExtinction.x * rhoM
-			+ in.OzoneAbsorption.x * rhoO) * ds;
-		tauG += (in.RayleighScattering.y * rhoR
-			+ in.MieExtinction.y * rhoM
-			+ in.OzoneAbsorption.y * rhoO) * ds;
-		tauB += (in.RayleighScattering.z * rhoR
-			+ in.MieExtinction.z * rhoM
-			+ in.OzoneAbsorption.z * rhoO) * ds;
+static AtmosQuadratureSet MakeAtmosQuadratureSet(EAtmosQuality quality)
+{
+	AtmosQuadrature q = { /*bAdaptive*/false, /*Tolerance*/0.0f, /*MinSegments*/0, /*MaxSegments*/0, /*FixedSteps*/0 };
+	switch (quality)
+	{
+	case ATMOS_QUALITY_FAST:		q = { true, 1e-2f, 8, 64, 0 }; break;
+	case ATMOS_QUALITY_BALANCED:	q = { true, 1e-3f, 16, 256, 0 }; break;
+	case ATMOS_QUALITY_REFERENCE:	q = { true, 1e-5f, 32, 4096, 0 }; break;
+	default: break;
 	}
 
-	outTrRGB[0] = float(std::exp(-tauR));
-	outTrRGB[1] = float(std::exp(-tauG));
-	outTrRGB[2] = float(std::exp(-tauB));
+	// 고정 모드 스텝 수 (적응형에서는 쓰지 않는다)
+	AtmosQuadratureSet set;
+	set.Transmittance = q;	set.Transmittance.FixedSteps = 96;
+	set.View = q;			set.View.FixedSteps = 80;
+	set.Sun = q;			set.Sun.FixedSteps = 64;
+	set.IrradianceSun = q;	set.IrradianceSun.FixedSteps = 96;
+	return set;
 }
 
-// 샘플 지점 r0에서 태양 방향(muS)으로의 태양 투과도(직달광) 계산.
-// 태양이 지평선 아래이면 0.
-static void TransmittanceToSunRGB(
+// 적응형 적분의 ray 조각. 고도가 가장 낮은 점 TLow에서 u ∈ [0, 1] → t = TLow + Sign W (exp(K u) - 1)
+// 낮은 점 근처 간격은 ~W (scale height 하나를 올라가는 거리), 멀어지면 거리에 비례해 넓어진다: dt/du = K (W + |t - TLow|)
+struct AdaptiveRayPiece
+{
+	float TLow;
+	float TFar;
+	float Sign;		// +1: t가 u와 같이 증가, -1: 반대
+	float W;
+	float K;		// ln(1 + 길이 / W)
+};
+
+struct AdaptiveRay
+{
+	AdaptiveRayPiece Pieces[4];	// t 순서 (근지점 두 조각 + 그림자 경계 분할 두 번)
+	int NumPieces;
+};
+
+// rLow, muLow: 낮은 점의 반지름과 (먼 끝 쪽으로 향하는) 방향 코사인
+static AdaptiveRayPiece MakeAdaptiveRayPiece(float tLow, float tFar, float rLow, float muLow, float hMin)
+{
+	// muLow s + s^2 / 2 rLow = hMin 의 양의 해
+	muLow = HFX_MAX(0.0f, muLow);
+	const float W = 2.0f * hMin / (std::sqrt(muLow * muLow + 2.0f * hMin / rLow) + muLow);
+	return { tLow, tFar, (tFar >= tLow) ? 1.0f : -1.0f, W, std::log1p(std::fabs(tFar - tLow) / W) };
+}
+
+// tSplit을 지나는 조각을 둘로 나눈다. 낮은 점 쪽은 그대로 줄이고, 먼 쪽은 tSplit을 새 낮은 점으로 삼는다.
+// 피적분 함수가 끊기는 곳 (행성 그림자 경계)을 격자 점에 맞추려고 쓴다
+static void SplitAdaptiveRay(AdaptiveRay* ray, float tSplit, float r0, float mu, float hMin)
+{
+	for (int p = 0; p < ray->NumPieces; ++p)
+	{
+		const AdaptiveRayPiece piece = ray->Pieces[p];
+		if (tSplit <= HFX_MIN(piece.TLow, piece.TFar) || tSplit >= HFX_MAX(piece.TLow, piece.TFar))
+		{
+			continue;
+		}
+		const float rSplit = std::sqrt(r0 * r0 + tSplit * tSplit + 2.0f * tSplit * r0 * mu);
+		const float muSplit = piece.Sign * (r0 * mu + tSplit) / rSplit;
+
+		AdaptiveRayPiece nearPart = piece;
+		nearPart.TFar = tSplit;
+		nearPart.K = std::log1p(std::fabs(tSplit - piece.TLow) / piece.W);
+		const AdaptiveRayPiece farPart = MakeAdaptiveRayPiece(tSplit, piece.TFar, rSplit, muSplit, hMin);
+
+		for (int q = ray->NumPieces; q > p + 1; --q)
+		{
+			ray->Pieces[q] = ray->Pieces[q - 1];
+		}
+		ray->Pieces[p] = (piece.Sign > 0.0f) ? nearPart : farPart;
+		ray->Pieces[p + 1] = (piece.Sign > 0.0f) ? farPart : nearPart;
+		++ray->NumPieces;
+		return;
+	}
+}
+
+// 가장 낮은 점: 위로 향하는 ray는 시작점, 지표 교차 ray는 지표, 그 밖의 아래 ray는 근지점 (양쪽 두 조각)
+static void BuildAdaptiveRay(float r0, float mu, float tEnd, bool bHitsGround, const PlanetGeom& pg, const AtmosMedium& med, AdaptiveRay* out)
+{
+	const float hMin = med.MinScaleHeight;
+	if (bHitsGround)
+	{
+		out->Pieces[0] = MakeAdaptiveRayPiece(tEnd, 0.0f, pg.Rg, -(r0 * mu + tEnd) / pg.Rg, hMin);
+		out->NumPieces = 1;
+	}
+	else if (mu >= 0.0f)
+	{
+		out->Pieces[0] = MakeAdaptiveRayPiece(0.0f, tEnd, r0, mu, hMin);
+		out->NumPieces = 1;
+	}
+	else
+	{
+		const float tp = HFX_MIN(-r0 * mu, tEnd);
+		const float rp = HFX_MAX(pg.Rg, r0 * std::sqrt(HFX_MAX(0.0f, 1.0f - mu * mu)));
+		out->Pieces[0] = MakeAdaptiveRayPiece(tp, 0.0f, rp, 0.0f, hMin);
+		out->Pieces[1] = MakeAdaptiveRayPiece(tp, tEnd, rp, 0.0f, hMin);
+		out->NumPieces = 2;
+	}
+}
+
+// 조각을 N 구간으로 나눈 j번째 점 (j = 0..N, t 순서). 구간 수를 두 배로 하면 2j번째 점이 원래 j번째 점이다
+static inline void AdaptiveRayNode(const AdaptiveRayPiece& p, int j, int N, float* t, float* dtdu)
+{
+	const float u = float(j) / float(N);
+	const float e = std::exp(p.K * ((p.Sign > 0.0f) ? u : 1.0f - u));
+	*t = p.TLow + p.Sign * p.W * (e - 1.0f);
+	*dtdu = p.K * p.W * e;
+}
+
+// 적응형 광학 두께. 조각별 사다리꼴 합을 구간 수를 두 배씩 늘리며 갱신한다 (새 점은 기존 구간의 중점뿐).
+// 광학 두께의 절대 변화 = 투과도의 상대 변화이므로 max_c |Δtau| <= Tolerance 에서 멈추고 Richardson 보정값을 돌려준다.
+static void AdaptiveOpticalDepthRGB(float r0, float mu, float tEnd, bool bHitsGround, const PlanetGeom& pg, const AtmosMedium& med, const AtmosQuadrature& quad, double* outTau)
+{
+	AdaptiveRay ray;
+	BuildAdaptiveRay(r0, mu, tEnd, bHitsGround, pg, med, &ray);
+
+	// Σ weight * ext * dt/du (du는 레벨마다 나눈다)
+	double sum[3] = {};
+	float h[ATMOS_STEP_BATCH], weight[ATMOS_STEP_BATCH];
+	float ext[3][ATMOS_STEP_BATCH];
+	int n = 0;
+	auto flush = [&]()
+		{
+			EvaluateMediumBatch(med, h, n, nullptr, nullptr, ext[0], ext[1], ext[2]);
+			for (int c = 0; c < 3; ++c)
+			{
+				for (int k = 0; k < n; ++k)
+				{
+					sum[c] += double(ext[c][k]) * weight[k];
+				}
+			}
+			n = 0;
+		};
+	auto push = [&](const AdaptiveRayPiece& p, int j, int N, float w)
+		{
+			float t, dtdu;
+			AdaptiveRayNode(p, j, N, &t, &dtdu);
+			h[n] = HFX_MAX(0.0f, std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu) - pg.Rg);
+			weight[n] = w * dtdu;
+			if (++n == ATMOS_STEP_BATCH)
+			{
+				flush();
+			}
+		};
+
+	int N = quad.MinSegments;
+	for (int p = 0; p < ray.NumPieces; ++p)
+	{
+		for (int j = 0; j <= N; ++j)
+		{
+			push(ray.Pieces[p], j, N, (j == 0 || j == N) ? 0.5f : 1.0f);
+		}
+	}
+	flush();
+	double prev[3] = { sum[0] / N, sum[1] / N, sum[2] / N };
+
+	while (true)
+	{
+		const int N2 = N * 2;
+		for (int p = 0; p < ray.NumPieces; ++p)
+		{
+			for (int j = 1; j < N2; j += 2)
+			{
+				push(ray.Pieces[p], j, N2, 1.0f);
+			}
+		}
+		flush();
+		N = N2;
+
+		double change = 0.0;
+		for (int c = 0; c < 3; ++c)
+		{
+			const double cur = sum[c] / N;
+			change = HFX_MAX(change, std::fabs(cur - prev[c]));
+			outTau[c] = HFX_MAX(0.0, (4.0 * cur - prev[c]) / 3.0);
+			prev[c] = cur;
+		}
+		if (change <= quad.Tolerance || N >= quad.MaxSegments)
+		{
+			return;
+		}
+	}
+}
+
+// 고도 r(행성중심거리)에서 주어진 mu 방향으로의 광학두께 적분 → 채널별 Transmittance 반환
+// extinction = RayleighScattering + MieExtinction + OzoneAbsorption (각각 밀도 가중)
+// 고정 모드는 ATMOS_STEP_BATCH 스텝씩 고도를 모아 SIMD 커널로 소광계수를 구하고, float 보상 합산으로 누적한다.
+static void IntegrateTransmittanceRGB(
+	float r0, float mu,
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outTrRGB, const AtmosQuadrature& quad, const bool* rayHitsGround)
+{
+	bool bHitsGround = false;
+	float tEnd = PathLengthToBoundary(r0, mu, pg, &bHitsGround, rayHitsGround);
+	if (tEnd <= 0.0f)
+	{
+		outTrRGB[0] = outTrRGB[1] = outTrRGB[2] = 1.0f;
+		return;
+	}
+
+	if (med.bAnalyticOpticalDepth)
+	{
+		double tau[3];
+		AnalyticOpticalDepthRGB(r0, mu, tEnd, bHitsGround, pg, med, tau);
+		outTrRGB[0] = (float)std::exp(-tau[0]);
+		outTrRGB[1] = (float)std::exp(-tau[1]);
+		outTrRGB[2] = (float)std::exp(-tau[2]);
+		return;
+	}
+
+	if (quad.bAdaptive)
+	{
+		double tau[3];
+		AdaptiveOpticalDepthRGB(r0, mu, tEnd, bHitsGround, pg, med, quad, tau);
+		outTrRGB[0] = (float)std::exp(-tau[0]);
+		outTrRGB[1] = (float)std::exp(-tau[1]);
+		outTrRGB[2] = (float)std::exp(-tau[2]);
+		return;
+	}
+
+	float tau[3];
+	FixedOpticalDepthRGB(r0, mu, tEnd, pg, med, quad, tau);
+	outTrRGB[0] = std::exp(-tau[0]);
+	outTrRGB[1] = std::exp(-tau[1]);
+	outTrRGB[2] = std::exp(-tau[2]);
+}
+
+// 고정 스텝 광학 두께 (midpoint, 채널별)
+static void FixedOpticalDepthRGB(float r0, float mu, float tEnd, const PlanetGeom& pg, const AtmosMedium& med, const AtmosQuadrature& quad, float* outTau)
+{
+	// 누적 광학두께 (ds는 마지막에 곱한다)
+	KahanSum tau[3];
+
+	const int numSteps = quad.FixedSteps;
+	const float ds = tEnd / float(numSteps);
+	const float Rg = pg.Rg;
+
+	float h[ATMOS_STEP_BATCH];
+	float ext[3][ATMOS_STEP_BATCH];
+	for (int i0 = 0; i0 < numSteps; i0 += ATMOS_STEP_BATCH)
+	{
+		const int n = HFX_MIN(ATMOS_STEP_BATCH, numSteps - i0);
+		for (int k = 0; k < n; ++k)
+		{
+			float t = (i0 + k + 0.5f) * ds;
+			// r(t) = sqrt(r0^2 + t^2 + 2 t r0 mu)
+			float r = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
+			h[k] = HFX_MAX(0.0f, r - Rg);
+		}
+
+		// channel별 extinction [1/m]
+		EvaluateMediumBatch(med, h, n, nullptr, nullptr, ext[0], ext[1], ext[2]);
+		for (int c = 0; c < 3; ++c)
+		{
+			tau[c].Add(CompensatedSum(ext[c], n));
+		}
+	}
+
+	outTau[0] = tau[0].Sum * ds;
+	outTau[1] = tau[1].Sum * ds;
+	outTau[2] = tau[2].Sum * ds;
+}
+
+// 샘플 지점 r0에서 태양 방향(muS)으로의 태양 투과도(직달광) 계산.
+// 태양이 지평선 아래이면 0.
+static void TransmittanceToSunRGB(
+	float r0, float muS,
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outTrSunRGB, const AtmosQuadrature& quad)
+{
+	bool sunHitsGround = false;
+	float tEnd = PathLengthToBoundary(r0, muS, pg, &sunHitsGround);
+	if (tEnd <= 0.0f || sunHitsGround)
+	{
+		outTrSunRGB[0] = outTrSunRGB[1] = outTrSunRGB[2] = 0.0f;
+		return;
+	}
+	IntegrateTransmittanceRGB(r0, muS, pg, med, outTrSunRGB, quad);
+}
+
+// Transmittance LUT bilinear 조회 (lut.Mapping의 texel 좌표)
+void LookupTransmittanceRGB(
+	const TransmittanceLUT& lut,
+	float r, float mu,
+	float* outTrRGB)
+{
+	float x, y;
+	lut.Mapping.TransmittanceParamsToTexel(r, mu, lut.W, lut.H, &x, &y);
+	const int x0 = (int)x, y0 = (int)y;
+	const int x1 = HFX_MIN(x0 + 1, lut.W - 1), y1 = HFX_MIN(y0 + 1, lut.H - 1);
+	const float fx = x - x0, fy = y - y0;
+
+	const float* t00 = &lut.RGB[((size_t)y0 * lut.W + x0) * 3];
+	const float* t10 = &lut.RGB[((size_t)y0 * lut.W + x1) * 3];
+	const float* t01 = &lut.RGB[((size_t)y1 * lut.W + x0) * 3];
+	const float* t11 = &lut.RGB[((size_t)y1 * lut.W + x1) * 3];
+	for (int c = 0; c < 3; ++c)
+	{
+		const float a = t00[c] + (t10[c] - t00[c]) * fx;
+		const float b = t01[c] + (t11[c] - t01[c]) * fx;
+		outTrRGB[c] = a + (b - a) * fy;
+	}
+}
+
+// TransmittanceToSunRGB의 LUT 버전 (지평선 아래 태양은 동일하게 0)
+// 균등 mu 매핑에서는 지평선 근처 감쇠가 급격해 bilinear가 지평선을 넘어 섞이므로, 지평선 ±2 texel 안쪽은 직접 적분한다
+// (Bruneton 매핑은 지평선 위 ray만 저장하고 지평선 쪽 texel이 촘촘해서 그대로 조회한다)
+static void TransmittanceToSunLUT(
+	const TransmittanceLUT& lut,
 	float r0, float muS,
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outTrSunRGB, int numSteps = 64)
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outTrSunRGB, const AtmosQuadrature& quad)
 {
 	bool sunHitsGround = false;
-	float tEnd = PathLengthToBoundary(r0, muS, pg, /*towardSun*/true, &sunHitsGround);
+	float tEnd = PathLengthToBoundary(r0, muS, pg, &sunHitsGround);
 	if (tEnd <= 0.0f || sunHitsGround)
 	{
 		outTrSunRGB[0] = outTrSunRGB[1] = outTrSunRGB[2] = 0.0f;
 		return;
 	}
-	IntegrateTransmittanceRGB(r0, muS, pg, in, outTrSunRGB, numSteps);
+
+	if (lut.Mapping.Mode == ATMOS_LUT_MAPPING_UNIFORM)
+	{
+		const float rho = pg.Rg / HFX_MAX(r0, pg.Rg);
+		const float muHorizon = -std::sqrt(HFX_MAX(0.0f, 1.0f - rho * rho));
+		const float band = 2.0f * 2.0f / float(lut.W);
+		if (std::fabs(muS - muHorizon) < band)
+		{
+			IntegrateTransmittanceRGB(r0, muS, pg, med, outTrSunRGB, quad);
+			return;
+		}
+	}
+	LookupTransmittanceRGB(lut, r0, muS, outTrSunRGB);
+}
+
+// 단산란 적응형 적분의 샘플 한 점 (레벨을 올려도 기존 점은 그대로 다시 쓴다)
+struct AdaptiveScatteringSample
+{
+	float T;
+	float DtDu;
+	float Ext[3];
+	float RhoR;
+	float RhoM;
+	float TrSun[3];
+};
+
+// IntegrateSingleScatteringUnphased의 적응형 경로 (tEndView > 0).
+// view ray를 AdaptiveRay 격자 위에서 사다리꼴로 적분하고 (view 감쇠도 같은 점들의 누적 사다리꼴),
+// 구간 수를 두 배씩 늘려 출력 채널마다 상대 변화가 Tolerance 이하가 되면 Richardson 보정값을 낸다.
+static void IntegrateSingleScatteringAdaptive(
+	float r0, float mu, float muS, float tEndView, bool bHitsGround,
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outRGBA, const AtmosQuadrature& viewQuad, const AtmosQuadrature& sunQuad,
+	const TransmittanceLUT* sunLUT, float* outMieRGB)
+{
+	AdaptiveRay ray;
+	BuildAdaptiveRay(r0, mu, tEndView, bHitsGround, pg, med, &ray);
+
+	// 샘플의 태양 감쇠는 muS 고정으로 구하므로 반지름 Rg / sqrt(1 - muS^2) 아래는 행성 그림자 (감쇠 0).
+	// view ray가 이 구면을 지나는 곳에서 조각을 나눠 계단 모양 피적분 함수가 구간 안에 걸리지 않게 한다
+	if (muS < 0.0f)
+	{
+		const float rShadow = pg.Rg / std::sqrt(HFX_MAX(1e-6f, 1.0f - muS * muS));
+		float tS0, tS1;
+		if (RaySphereIntersectT(r0, mu, rShadow, tS0, tS1))
+		{
+			SplitAdaptiveRay(&ray, tS0, r0, mu, med.MinScaleHeight);
+			SplitAdaptiveRay(&ray, tS1, r0, mu, med.MinScaleHeight);
+		}
+	}
+
+	const float* Sun = med.SolarIrradiance;
+	const double SunM = (Sun[0] + Sun[1] + Sun[2]) / 3.0;
+
+	// 레벨 간에 버퍼를 재사용 (ParallelFor 워커마다 하나)
+	static thread_local std::vector<AdaptiveScatteringSample> samples, refined;
+	static thread_local std::vector<int> pending;
+
+	// pending 점들의 매질과 태양 감쇠
+	auto evaluate = [&]()
+		{
+			float h[ATMOS_STEP_BATCH], radius[ATMOS_STEP_BATCH];
+			float rhoR[ATMOS_STEP_BATCH], rhoM[ATMOS_STEP_BATCH];
+			float ext[3][ATMOS_STEP_BATCH];
+			for (size_t i0 = 0; i0 < pending.size(); i0 += ATMOS_STEP_BATCH)
+			{
+				const int n = (int)HFX_MIN((size_t)ATMOS_STEP_BATCH, pending.size() - i0);
+				for (int k = 0; k < n; ++k)
+				{
+					const float t = samples[pending[i0 + k]].T;
+					radius[k] = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
+					h[k] = HFX_MAX(0.0f, radius[k] - pg.Rg);
+				}
+				EvaluateMediumBatch(med, h, n, rhoR, rhoM, ext[0], ext[1], ext[2]);
+				for (int k = 0; k < n; ++k)
+				{
+					AdaptiveScatteringSample& s = samples[pending[i0 + k]];
+					s.Ext[0] = ext[0][k]; s.Ext[1] = ext[1][k]; s.Ext[2] = ext[2][k];
+					s.RhoR = rhoR[k];
+					s.RhoM = rhoM[k];
+					if (sunLUT)
+					{
+						TransmittanceToSunLUT(*sunLUT, radius[k], muS, pg, med, s.TrSun, sunQuad);
+					}
+					else
+					{
+						TransmittanceToSunRGB(radius[k], muS, pg, med, s.TrSun, sunQuad);
+					}
+				}
+			}
+			pending.clear();
+		};
+
+	// [0..2] Rayleigh RGB, [3] Mie 스칼라, [4..6] Mie RGB
+	const int numOut = outMieRGB ? 7 : 4;
+	auto integrate = [&](int N, double* res)
+		{
+			const double du = 1.0 / N;
+			double tau[3] = {};
+			for (int i = 0; i < 7; ++i)
+			{
+				res[i] = 0.0;
+			}
+			for (int p = 0; p < ray.NumPieces; ++p)
+			{
+				const AdaptiveScatteringSample* piece = &samples[size_t(p) * (N + 1)];
+				for (int j = 0; j <= N; ++j)
+				{
+					const AdaptiveScatteringSample& s = piece[j];
+					double TrView[3];
+					for (int c = 0; c < 3; ++c)
+					{
+						if (j > 0)
+						{
+							tau[c] += 0.5 * du * (double(piece[j - 1].Ext[c]) * piece[j - 1].DtDu + double(s.Ext[c]) * s.DtDu);
+						}
+						TrView[c] = std::exp(-tau[c]);
+					}
+					const double w = du * s.DtDu * ((j == 0 || j == N) ? 0.5 : 1.0);
+					for (int c = 0; c < 3; ++c)
+					{
+						res[c] += TrView[c] * (med.RayleighScattering[c] * s.RhoR) * s.TrSun[c] * Sun[c] * w;
+						res[4 + c] += TrView[c] * (med.MieScattering[c] * s.RhoM) * s.TrSun[c] * Sun[c] * w;
+					}
+					const double TrViewM = (TrView[0] + TrView[1] + TrView[2]) / 3.0;
+					const double TrSunM = (s.TrSun[0] + s.TrSun[1] + s.TrSun[2]) / 3.0;
+					res[3] += TrViewM * (med.MieScatteringAvg * s.RhoM) * TrSunM * SunM * w;
+				}
+			}
+		};
+
+	int N = viewQuad.MinSegments;
+	samples.clear();
+	for (int p = 0; p < ray.NumPieces; ++p)
+	{
+		for (int j = 0; j <= N; ++j)
+		{
+			AdaptiveScatteringSample s;
+			AdaptiveRayNode(ray.Pieces[p], j, N, &s.T, &s.DtDu);
+			pending.push_back((int)samples.size());
+			samples.push_back(s);
+		}
+	}
+	evaluate();
+
+	double prev[7], cur[7];
+	integrate(N, prev);
+	while (true)
+	{
+		// 기존 점 사이에 중점을 끼워 넣는다
+		const int N2 = N * 2;
+		refined.clear();
+		for (int p = 0; p < ray.NumPieces; ++p)
+		{
+			for (int j = 0; j <= N; ++j)
+			{
+				refined.push_back(samples[size_t(p) * (N + 1) + j]);
+				if (j < N)
+				{
+					AdaptiveScatteringSample s;
+					AdaptiveRayNode(ray.Pieces[p], 2 * j + 1, N2, &s.T, &s.DtDu);
+					pending.push_back((int)refined.size());
+					refined.push_back(s);
+				}
+			}
+		}
+		samples.swap(refined);
+		evaluate();
+		N = N2;
+
+		integrate(N, cur);
+		bool bConverged = true;
+		for (int i = 0; i < numOut; ++i)
+		{
+			bConverged = bConverged && std::fabs(cur[i] - prev[i]) <= viewQuad.Tolerance * std::fabs(cur[i]);
+		}
+		if (bConverged || N >= viewQuad.MaxSegments)
+		{
+			break;
+		}
+		std::copy(cur, cur + 7, prev);
+	}
+
+	double out[7];
+	for (int i = 0; i < 7; ++i)
+	{
+		out[i] = HFX_MAX(0.0, (4.0 * cur[i] - prev[i]) / 3.0);
+	}
+	outRGBA[0] = (float)out[0];
+	outRGBA[1] = (float)out[1];
+	outRGBA[2] = (float)out[2];
+	outRGBA[3] = (float)out[3];
+	if (outMieRGB)
+	{
+		outMieRGB[0] = (float)out[4];
+		outMieRGB[1] = (float)out[5];
+		outMieRGB[2] = (float)out[6];
+	}
 }
 
 // 단산란(phase 미적용) 적분: Rayleigh/Mie 성분을 분리해 반환 (RGB=Rayleigh, A=Mie)
 // view 경로 감쇠 * (beta_s * rho) * 태양직달감쇠 * ds 를 적분. (phase는 런타임에서 곱)
+// sunLUT != nullptr 이면 태양직달감쇠를 LUT에서 읽는다. view 감쇠는 어차피 매 샘플 밀도를 구하므로 누적 tau를 그대로 쓴다.
+// 밀도/소광계수와 view 감쇠 exp는 ATMOS_STEP_BATCH 스텝 단위로 SIMD 커널에서 구한다.
 static void IntegrateSingleScatteringUnphased(
 	float r0, float mu, float muS,
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outRGBA, int numViewSteps, int numSunSteps)
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outRGBA, const AtmosQuadrature& viewQuad, const AtmosQuadrature& sunQuad,
+	const TransmittanceLUT* sunLUT, float* outMieRGB, const bool* rayHitsGround)
 {
 	// view 경로 길이
-	float tEndView = PathLengthToBoundary(r0, mu, pg, /*towardSun*/false, nullptr);
+	bool bHitsGround = false;
+	float tEndView = PathLengthToBoundary(r0, mu, pg, &bHitsGround, rayHitsGround);
 	if (tEndView <= 0.0f)
 	{
 		outRGBA[0] = outRGBA[1] = outRGBA[2] = outRGBA[3] = 0.0f;
+		if (outMieRGB)
+		{
+			outMieRGB[0] = outMieRGB[1] = outMieRGB[2] = 0.0f;
+		}
+		return;
+	}
+
+	if (viewQuad.bAdaptive)
+	{
+		IntegrateSingleScatteringAdaptive(r0, mu, muS, tEndView, bHitsGround, pg, med, outRGBA, viewQuad, sunQuad, sunLUT, outMieRGB);
 		return;
 	}
 
 	// 누적 결과
-	double SR = 0.0, SG = 0.0, SB = 0.0; // Rayleigh
-	double SM = 0.0;                 // Mie (단일산란 성분)
+	KahanSum S[3];	// Rayleigh
+	KahanSum SM;	// Mie (단일산란 성분)
+	KahanSum SMRGB[3];	// Mie 채널별 (다중산란 입력용)
 
-	// view 경로 누적 tau (채널별)
-	double tauVR = 0.0, tauVG = 0.0, tauVB = 0.0;
+	// view 경로 누적 tau (채널별, ds 곱하기 전)
+	KahanSum tauV[3];
 
+	const int numViewSteps = viewQuad.FixedSteps;
 	const float ds = tEndView / float(numViewSteps);
 	const float Rg = pg.Rg;
 
-	for (int i = 0; i < numViewSteps; ++i)
-	{
-		float t = (i + 0.5f) * ds;
-		float r = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
-		float h = HFX_MAX(0.0f, r - Rg);
-
-		float rhoR = SampleDensity(in.Rayleigh, h);
-		float rhoM = SampleDensity(in.Mie, h);
-		float rhoO = SampleDensity(in.Ozone, h);
+	// 태양 복사 (TOA)
+	const float* Sun = med.SolarIrradiance;
+	const float SunM = (Sun[0] + Sun[1] + Sun[2]) / 3.0f;
 
-		// view 경로 감쇠 (midpoint 누적)
-		tauVR += (in.RayleighScattering.x * rhoR
-			+ in.MieExtinction.x * rhoM
-			+ in.OzoneAbsorption.x * rhoO) * ds;
-		tauVG += (in.RayleighScattering.y * rhoR
-			+ in.MieExtinction.y * rhoM
-			+ in.OzoneAbsorption.y * rhoO) * ds;
-		tauVB += (in.RayleighScattering.z * rhoR
-			+ in.MieExtinction.z * rhoM
-			+ in.OzoneAbsorption.z * rhoO) * ds;
+	float radius[ATMOS_STEP_BATCH], h[ATMOS_STEP_BATCH];
+	float rhoR[ATMOS_STEP_BATCH], rhoM[ATMOS_STEP_BATCH];
+	float ext[3][ATMOS_STEP_BATCH];
+	float tauAt[3][ATMOS_STEP_BATCH];
+	float TrView[3][ATMOS_STEP_BATCH];
 
-		float TrView[3] =
+	for (int i0 = 0; i0 < numViewSteps; i0 += ATMOS_STEP_BATCH)
+	{
+		const int n = HFX_MIN(ATMOS_STEP_BATCH, numViewSteps - i0);
+		for (int k = 0; k < n; ++k)
 		{
-			float(std::exp(-tauVR)),
-			float(std::exp(-tauVG)),
-			float(std::exp(-tauVB))
-		};
-
-		// 태양 방향 직달 감쇠
-		float TrSun[3];
-		TransmittanceToSunRGB(r, muS, pg, in, TrSun, numSunSteps);
-
-		// 산란 계수(산란량용, Rayleigh는 extinction==scattering 가정)
-		double bR_x = double(in.RayleighScattering.x) * double(rhoR);
-		double bR_y = double(in.RayleighScattering.y) * double(rhoR);
-		double bR_z = double(in.RayleighScattering.z) * double(rhoR);
+			float t = (i0 + k + 0.5f) * ds;
+			radius[k] = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
+			h[k] = HFX_MAX(0.0f, radius[k] - Rg);
+		}
+		EvaluateMediumBatch(med, h, n, rhoR, rhoM, ext[0], ext[1], ext[2]);
 
-		double bM = ((double)in.MieScattering.x + (double)in.MieScattering.y + (double)in.MieScattering.z) / 3.0; // 스칼라 근사
-		bM *= double(rhoM);
+		// view 경로 감쇠 (midpoint 누적, 현재 스텝 포함)
+		for (int c = 0; c < 3; ++c)
+		{
+			for (int k = 0; k < n; ++k)
+			{
+				tauV[c].Add(ext[c][k]);
+				tauAt[c][k] = tauV[c].Sum * ds;
+			}
+			ExpNegBatch(tauAt[c], n, TrView[c]);
+		}
 
-		// 태양 복사 (TOA)
-		double SunR = in.SolarIrradiance.x;
-		double SunG = in.SolarIrradiance.y;
-		double SunB = in.SolarIrradiance.z;
+		for (int k = 0; k < n; ++k)
+		{
+			// 태양 방향 직달 감쇠
+			float TrSun[3];
+			if (sunLUT)
+			{
+				TransmittanceToSunLUT(*sunLUT, radius[k], muS, pg, med, TrSun, sunQuad);
+			}
+			else
+			{
+				TransmittanceToSunRGB(radius[k], muS, pg, med, TrSun, sunQuad);
+			}
 
-		// 단산란 기여 (phase 제외): Tr_view * (beta_s * rho) * Tr_sun * Sun * ds
-		SR += TrView[0] * bR_x * TrSun[0] * SunR * ds;
-		SG += TrView[1] * bR_y * TrSun[1] * SunG * ds;
-		SB += TrView[2] * bR_z * TrSun[2] * SunB * ds;
+			// 단산란 기여 (phase 제외): Tr_view * (beta_s * rho) * Tr_sun * Sun * ds
+			// 산란 계수(산란량용, Rayleigh는 extinction==scattering 가정)
+			for (int c = 0; c < 3; ++c)
+			{
+				S[c].Add(TrView[c][k] * (med.RayleighScattering[c] * rhoR[k]) * TrSun[c] * Sun[c] * ds);
+			}
 
-		// Mie는 채널 독립 스칼라로 누적 (A 채널에 저장)
-		double TrViewM = (TrView[0] + TrView[1] + TrView[2]) / 3.0;
-		double TrSunM = (TrSun[0] + TrSun[1] + TrSun[2]) / 3.0;
-		double SunM = (SunR + SunG + SunB) / 3.0;
-		SM += TrViewM * bM * TrSunM * SunM * ds;
+			// Mie는 채널 독립 스칼라로 누적 (A 채널에 저장)
+			const float TrViewM = (TrView[0][k] + TrView[1][k] + TrView[2][k]) / 3.0f;
+			const float TrSunM = (TrSun[0] + TrSun[1] + TrSun[2]) / 3.0f;
+			SM.Add(TrViewM * (med.MieScatteringAvg * rhoM[k]) * TrSunM * SunM * ds);
+			if (outMieRGB)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					SMRGB[c].Add(TrView[c][k] * (med.MieScattering[c] * rhoM[k]) * TrSun[c] * Sun[c] * ds);
+				}
+			}
+		}
 	}
 
-	outRGBA[0] = float(SR);
-	outRGBA[1] = float(SG);
-	outRGBA[2] = float(SB);
-	outRGBA[3] = float(SM);
+	outRGBA[0] = S[0].Sum;
+	outRGBA[1] = S[1].Sum;
+	outRGBA[2] = S[2].Sum;
+	outRGBA[3] = SM.Sum;
+	if (outMieRGB)
+	{
+		outMieRGB[0] = SMRGB[0].Sum;
+		outMieRGB[1] = SMRGB[1].Sum;
+		outMieRGB[2] = SMRGB[2].Sum;
+	}
 }
 
 // 단순화된 직접 조도(irradiance): E ≈ SolarIrradiance * max(muS,0) * TransmittanceToSun
 static void ComputeDirectIrradianceRGB(
 	float r0, float muS,
-	const PlanetGeom& pg, const AtmosParams& in,
-	float* outRGB, int numStepsSun)
+	const PlanetGeom& pg, const AtmosMedium& med,
+	float* outRGB, const AtmosQuadrature& sunQuad)
 {
 	float TrSun[3];
-	TransmittanceToSunRGB(r0, muS, pg, in, TrSun, numStepsSun);
+	TransmittanceToSunRGB(r0, muS, pg, med, TrSun, sunQuad);
 	float cosTerm = HFX_MAX(0.0f, muS);
-	outRGB[0] = in.SolarIrradiance.x * TrSun[0] * cosTerm;
-	outRGB[1] = in.SolarIrradiance.y * TrSun[1] * cosTerm;
-	outRGB[2] = in.SolarIrradiance.z * TrSun[2] * cosTerm;
+	outRGB[0] = med.SolarIrradiance[0] * TrSun[0] * cosTerm;
+	outRGB[1] = med.SolarIrradiance[1] * TrSun[1] * cosTerm;
+	outRGB[2] = med.SolarIrradiance[2] * TrSun[2] * cosTerm;
+}
+
+// ---------------------------- Spectral lanes ----------------------------
+// AtmosSpectralBake의 적분기. RGB 적분기와 같은 경로/격자를 쓰되 SpeciesMed로 종별 광학 두께만 구하고,
+// 파장별 투과도와 단산란 누적은 lane 커널 (SpectralTransmittanceBatch / AccumulateSpectralScattering)에 넘긴다.
+
+AtmosSpectralBake::AtmosSpectralBake(AtmosBakePreset* groups, int numGroups)
+	: Groups(groups), NumGroups(numGroups), SpeciesMed(groups[0].Med), Lanes{}, RayleighScattering{}, MieScattering{}, SolarIrradiance{},
+	ColumnLUT{ nullptr, 0, 0, groups[0].Map }
+{
+	const int numUsed = 3 * numGroups;
+	ASSERT(numGroups > 0 && numUsed <= ATMOS_SPECTRAL_MAX_LANES, "Too many spectral groups.");
+
+	// 묶음마다 밀도 프로파일은 같고 계수만 다르다. 종 기준값은 lane 최댓값 (적응형 허용 오차가 가장 진한 파장 기준이 되게)
+	float extinction[3][ATMOS_SPECTRAL_MAX_LANES] = {};
+	float ref[3] = {};
+	for (int g = 0; g < numGroups; ++g)
+	{
+		const AtmosMedium& med = groups[g].Med;
+		for (int c = 0; c < 3; ++c)
+		{
+			const int l = 3 * g + c;
+			extinction[0][l] = med.RayleighScattering[c];
+			extinction[1][l] = med.MieExtinction[c];
+			extinction[2][l] = med.OzoneAbsorption[c];
+			RayleighScattering[l] = med.RayleighScattering[c];
+			MieScattering[l] = med.MieScattering[c];
+			SolarIrradiance[l] = med.SolarIrradiance[c];
+		}
+	}
+	for (int sp = 0; sp < 3; ++sp)
+	{
+		for (int l = 0; l < numUsed; ++l)
+		{
+			ref[sp] = HFX_MAX(ref[sp], extinction[sp][l]);
+		}
+		for (int l = 0; l < numUsed; ++l)
+		{
+			Lanes.Extinction[sp][l] = (ref[sp] > 0.0f) ? extinction[sp][l] / ref[sp] : 0.0f;
+		}
+	}
+	Lanes.NumLanes = (numUsed + 7) & ~7;
+
+	// 채널 = 종. EvaluateMediumBatch의 ext[s]가 곧 종 s의 (기준값 단위) 소광계수가 된다
+	for (int c = 0; c < 3; ++c)
+	{
+		SpeciesMed.RayleighScattering[c] = (c == 0) ? ref[0] : 0.0f;
+		SpeciesMed.MieExtinction[c] = (c == 1) ? ref[1] : 0.0f;
+		SpeciesMed.OzoneAbsorption[c] = (c == 2) ? ref[2] : 0.0f;
+	}
+
+	const AtmosParams& in = *groups[0].In;
+	ColumnRGB.resize(size_t(in.TransmittanceW) * in.TransmittanceH * 3);
+	ColumnLUT = { ColumnRGB.data(), in.TransmittanceW, in.TransmittanceH, groups[0].Map };
+}
+
+// IntegrateTransmittanceRGB의 광학 두께 부분 (exp 전). med = SpeciesMed이면 종별 광학 두께
+static void SpeciesOpticalDepth(float r0, float mu, float tEnd, bool bHitsGround, const PlanetGeom& pg, const AtmosMedium& med, const AtmosQuadrature& quad, float* outTau)
+{
+	if (med.bAnalyticOpticalDepth || quad.bAdaptive)
+	{
+		double tau[3];
+		if (med.bAnalyticOpticalDepth)
+		{
+			AnalyticOpticalDepthRGB(r0, mu, tEnd, bHitsGround, pg, med, tau);
+		}
+		else
+		{
+			AdaptiveOpticalDepthRGB(r0, mu, tEnd, bHitsGround, pg, med, quad, tau);
+		}
+		outTau[0] = (float)tau[0];
+		outTau[1] = (float)tau[1];
+		outTau[2] = (float)tau[2];
+		return;
+	}
+	FixedOpticalDepthRGB(r0, mu, tEnd, pg, med, quad, outTau);
+}
+
+// TransmittanceToSunRGB / TransmittanceToSunLUT의 종별 광학 두께 버전. 태양이 지평선 아래면 false (감쇠 0).
+// bUseLUT이면 ColumnLUT에서 광학 두께를 bilinear로 읽는다 (균등 매핑의 지평선 띠는 TransmittanceToSunLUT처럼 직접 적분)
+static bool SpectralSunOpticalDepth(const AtmosSpectralBake& s, float r0, float muS, bool bUseLUT, const AtmosQuadrature& quad, float* outTau)
+{
+	const PlanetGeom& pg = s.Groups[0].Pg;
+	bool sunHitsGround = false;
+	const float tEnd = PathLengthToBoundary(r0, muS, pg, &sunHitsGround);
+	if (tEnd <= 0.0f || sunHitsGround)
+	{
+		return false;
+	}
+
+	if (bUseLUT)
+	{
+		bool bDirect = false;
+		if (s.ColumnLUT.Mapping.Mode == ATMOS_LUT_MAPPING_UNIFORM)
+		{
+			const float rho = pg.Rg / HFX_MAX(r0, pg.Rg);
+			const float muHorizon = -std::sqrt(HFX_MAX(0.0f, 1.0f - rho * rho));
+			bDirect = std::fabs(muS - muHorizon) < 2.0f * 2.0f / float(s.ColumnLUT.W);
+		}
+		if (!bDirect)
+		{
+			LookupTransmittanceRGB(s.ColumnLUT, r0, muS, outTau);
+			return true;
+		}
+	}
+	SpeciesOpticalDepth(r0, muS, tEnd, /*bHitsGround*/false, pg, s.SpeciesMed, quad, outTau);
+	return true;
+}
+
+static void ComputeSpectralTransmittanceRow(AtmosSpectralBake& s, int j)
+{
+	const AtmosBakePreset& b0 = s.Groups[0];
+	const int TW = b0.In->TransmittanceW, TH = b0.In->TransmittanceH;
+	const bool bTransmittanceToTop = false;
+	const bool* transmittanceSide = (b0.Map.Mode == ATMOS_LUT_MAPPING_BRUNETON) ? &bTransmittanceToTop : nullptr;
+
+	alignas(32) float Tr[ATMOS_SPECTRAL_MAX_LANES];
+	for (int i = 0; i < TW; ++i)
+	{
+		float r, mu;
+		b0.Map.TransmittanceTexelToParams(i, j, TW, TH, &r, &mu);
+
+		bool bHitsGround = false;
+		float tau[3] = {};
+		const float tEnd = PathLengthToBoundary(r, mu, b0.Pg, &bHitsGround, transmittanceSide);
+		if (tEnd > 0.0f)
+		{
+			SpeciesOpticalDepth(r, mu, tEnd, bHitsGround, b0.Pg, s.SpeciesMed, b0.Quad.Transmittance, tau);
+		}
+		SpectralTransmittanceBatch(s.Lanes, tau, Tr);
+
+		const size_t idx = (size_t(j) * TW + i) * 3;
+		for (int c = 0; c < 3; ++c)
+		{
+			s.ColumnRGB[idx + c] = tau[c];
+		}
+		for (int g = 0; g < s.NumGroups; ++g)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				s.Groups[g].Out->TransmittanceRGB[idx + c] = Tr[3 * g + c];
+			}
+		}
+	}
+}
+
+// 단산란 적응형 샘플 (AdaptiveScatteringSample의 종별 버전). 태양 감쇠는 광학 두께로 들고 있다
+struct SpectralScatteringSample
+{
+	float T;
+	float DtDu;
+	float Ext[3];
+	float RhoR;
+	float RhoM;
+	float TauSun[3];
+	bool bLit;
+};
+
+// IntegrateSingleScatteringUnphased의 lane 버전. out->R[l] / M[l] = ∫ T_view,l T_sun,l ρ dt (β_s와 태양 복사는 호출 쪽에서 곱한다)
+static void IntegrateSpectralSingleScattering(const AtmosSpectralBake& s, float r0, float mu, float muS, const bool* rayHitsGround, AtmosSpectralSums* out)
+{
+	const AtmosBakePreset& b0 = s.Groups[0];
+	const PlanetGeom& pg = b0.Pg;
+	const AtmosMedium& med = s.SpeciesMed;
+	const AtmosQuadrature& viewQuad = b0.Quad.View;
+	const AtmosQuadrature& sunQuad = b0.Quad.Sun;
+	const bool bUseLUT = b0.In->bUseTransmittanceLUT;
+
+	*out = {};
+	bool bHitsGround = false;
+	const float tEndView = PathLengthToBoundary(r0, mu, pg, &bHitsGround, rayHitsGround);
+	if (tEndView <= 0.0f)
+	{
+		return;
+	}
+
+	if (!viewQuad.bAdaptive)
+	{
+		const int numViewSteps = viewQuad.FixedSteps;
+		const float ds = tEndView / float(numViewSteps);
+		KahanSum tauV[3];
+		float radius[ATMOS_STEP_BATCH], h[ATMOS_STEP_BATCH];
+		float rhoR[ATMOS_STEP_BATCH], rhoM[ATMOS_STEP_BATCH];
+		float ext[3][ATMOS_STEP_BATCH];
+		for (int i0 = 0; i0 < numViewSteps; i0 += ATMOS_STEP_BATCH)
+		{
+			const int n = HFX_MIN(ATMOS_STEP_BATCH, numViewSteps - i0);
+			for (int k = 0; k < n; ++k)
+			{
+				const float t = (i0 + k + 0.5f) * ds;
+				radius[k] = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
+				h[k] = HFX_MAX(0.0f, radius[k] - pg.Rg);
+			}
+			EvaluateMediumBatch(med, h, n, rhoR, rhoM, ext[0], ext[1], ext[2]);
+
+			for (int k = 0; k < n; ++k)
+			{
+				// view 경로 감쇠는 midpoint 누적 (현재 스텝 포함)
+				float tau[3];
+				for (int c = 0; c < 3; ++c)
+				{
+					tauV[c].Add(ext[c][k]);
+					tau[c] = tauV[c].Sum * ds;
+				}
+				float tauSun[3];
+				if (!SpectralSunOpticalDepth(s, radius[k], muS, bUseLUT, sunQuad, tauSun))
+				{
+					continue;
+				}
+				for (int c = 0; c < 3; ++c)
+				{
+					tau[c] += tauSun[c];
+				}
+				AccumulateSpectralScattering(s.Lanes, tau, rhoR[k] * ds, rhoM[k] * ds, out);
+			}
+		}
+		return;
+	}
+
+	// 적응형: IntegrateSingleScatteringAdaptive와 같은 격자 / 그림자 분할 / 수렴 판정 (lane마다 상대 변화)
+	AdaptiveRay ray;
+	BuildAdaptiveRay(r0, mu, tEndView, bHitsGround, pg, med, &ray);
+	if (muS < 0.0f)
+	{
+		const float rShadow = pg.Rg / std::sqrt(HFX_MAX(1e-6f, 1.0f - muS * muS));
+		float tS0, tS1;
+		if (RaySphereIntersectT(r0, mu, rShadow, tS0, tS1))
+		{
+			SplitAdaptiveRay(&ray, tS0, r0, mu, med.MinScaleHeight);
+			SplitAdaptiveRay(&ray, tS1, r0, mu, med.MinScaleHeight);
+		}
+	}
+
+	static thread_local std::vector<SpectralScatteringSample> samples, refined;
+	static thread_local std::vector<int> pending;
+
+	auto evaluate = [&]()
+		{
+			float h[ATMOS_STEP_BATCH], radius[ATMOS_STEP_BATCH];
+			float rhoR[ATMOS_STEP_BATCH], rhoM[ATMOS_STEP_BATCH];
+			float ext[3][ATMOS_STEP_BATCH];
+			for (size_t i0 = 0; i0 < pending.size(); i0 += ATMOS_STEP_BATCH)
+			{
+				const int n = (int)HFX_MIN((size_t)ATMOS_STEP_BATCH, pending.size() - i0);
+				for (int k = 0; k < n; ++k)
+				{
+					const float t = samples[pending[i0 + k]].T;
+					radius[k] = std::sqrt(r0 * r0 + t * t + 2.0f * t * r0 * mu);
+					h[k] = HFX_MAX(0.0f, radius[k] - pg.Rg);
+				}
+				EvaluateMediumBatch(med, h, n, rhoR, rhoM, ext[0], ext[1], ext[2]);
+				for (int k = 0; k < n; ++k)
+				{
+					SpectralScatteringSample& sm = samples[pending[i0 + k]];
+					sm.Ext[0] = ext[0][k]; sm.Ext[1] = ext[1][k]; sm.Ext[2] = ext[2][k];
+					sm.RhoR = rhoR[k];
+					sm.RhoM = rhoM[k];
+					sm.bLit = SpectralSunOpticalDepth(s, radius[k], muS, bUseLUT, sunQuad, sm.TauSun);
+				}
+			}
+			pending.clear();
+		};
+
+	auto integrate = [&](int N, AtmosSpectralSums* res)
+		{
+			const double du = 1.0 / N;
+			double tauV[3] = {};
+			*res = {};
+			for (int p = 0; p < ray.NumPieces; ++p)
+			{
+				const SpectralScatteringSample* piece = &samples[size_t(p) * (N + 1)];
+				for (int j = 0; j <= N; ++j)
+				{
+					const SpectralScatteringSample& sm = piece[j];
+					for (int c = 0; c < 3; ++c)
+					{
+						if (j > 0)
+						{
+							tauV[c] += 0.5 * du * (double(piece[j - 1].Ext[c]) * piece[j - 1].DtDu + double(sm.Ext[c]) * sm.DtDu);
+						}
+					}
+					if (!sm.bLit)
+					{
+						continue;
+					}
+					const float w = float(du * sm.DtDu * ((j == 0 || j == N) ? 0.5 : 1.0));
+					const float tau[3] = { float(tauV[0]) + sm.TauSun[0], float(tauV[1]) + sm.TauSun[1], float(tauV[2]) + sm.TauSun[2] };
+					AccumulateSpectralScattering(s.Lanes, tau, sm.RhoR * w, sm.RhoM * w, res);
+				}
+			}
+		};
+
+	int N = viewQuad.MinSegments;
+	samples.clear();
+	for (int p = 0; p < ray.NumPieces; ++p)
+	{
+		for (int j = 0; j <= N; ++j)
+		{
+			SpectralScatteringSample sm;
+			AdaptiveRayNode(ray.Pieces[p], j, N, &sm.T, &sm.DtDu);
+			pending.push_back((int)samples.size());
+			samples.push_back(sm);
+		}
+	}
+	evaluate();
+
+	const int numUsed = 3 * s.NumGroups;
+	AtmosSpectralSums prev, cur;
+	integrate(N, &prev);
+	while (true)
+	{
+		const int N2 = N * 2;
+		refined.clear();
+		for (int p = 0; p < ray.NumPieces; ++p)
+		{
+			for (int j = 0; j <= N; ++j)
+			{
+				refined.push_back(samples[size_t(p) * (N + 1) + j]);
+				if (j < N)
+				{
+					SpectralScatteringSample sm;
+					AdaptiveRayNode(ray.Pieces[p], 2 * j + 1, N2, &sm.T, &sm.DtDu);
+					pending.push_back((int)refined.size());
+					refined.push_back(sm);
+				}
+			}
+		}
+		samples.swap(refined);
+		evaluate();
+		N = N2;
+
+		integrate(N, &cur);
+		bool bConverged = true;
+		for (int l = 0; l < numUsed && bConverged; ++l)
+		{
+			bConverged = std::fabs(cur.R[l] - prev.R[l]) <= viewQuad.Tolerance * std::fabs(cur.R[l])
+				&& std::fabs(cur.M[l] - prev.M[l]) <= viewQuad.Tolerance * std::fabs(cur.M[l]);
+		}
+		if (bConverged || N >= viewQuad.MaxSegments)
+		{
+			break;
+		}
+		prev = cur;
+	}
+
+	for (int l = 0; l < numUsed; ++l)
+	{
+		out->R[l] = HFX_MAX(0.0f, (4.0f * cur.R[l] - prev.R[l]) / 3.0f);
+		out->M[l] = HFX_MAX(0.0f, (4.0f * cur.M[l] - prev.M[l]) / 3.0f);
+	}
+}
+
+// ComputeSingleScatteringJob의 lane 버전. 묶음 g의 RGB = lane 3g..3g+2, A = 묶음 Mie RGB 평균 (ResolveSpectralPreset이 SingleM에서 다시 구한다)
+static void ComputeSpectralSingleScatteringJob(AtmosSpectralBake& s, int job)
+{
+	const AtmosBakePreset& b0 = s.Groups[0];
+	const int SMU = b0.In->ScatteringMu, SMUS = b0.In->ScatteringMuS;
+	const int storedNU = b0.StoredNU;
+	const int ir = job / SMU;
+	const int imu = job % SMU;
+
+	bool bRayHitsGround = false;
+	const float r = b0.Map.ScatteringR(ir, b0.In->ScatteringR);
+	const float mu = b0.Map.ScatteringMu(r, imu, SMU, &bRayHitsGround);
+
+	AtmosSpectralSums sums;
+	for (int imus = 0; imus < SMUS; ++imus)
+	{
+		const float muS = b0.Map.ScatteringMuS(imus, SMUS);
+		IntegrateSpectralSingleScattering(s, r, mu, muS, &bRayHitsGround, &sums);
+
+		const size_t idx3 = (((size_t)ir * SMU + imu) * SMUS + imus) * 3;
+		for (int g = 0; g < s.NumGroups; ++g)
+		{
+			AtmosBakePreset& b = s.Groups[g];
+			float rayleigh[3], mie[3];
+			for (int c = 0; c < 3; ++c)
+			{
+				const int l = 3 * g + c;
+				rayleigh[c] = sums.R[l] * s.RayleighScattering[l] * s.SolarIrradiance[l];
+				mie[c] = sums.M[l] * s.MieScattering[l] * s.SolarIrradiance[l];
+				if (b.bMultipleScattering)
+				{
+					b.SingleR[idx3 + c] = rayleigh[c];
+				}
+				b.SingleM[idx3 + c] = mie[c];
+			}
+
+			const float mieA = (mie[0] + mie[1] + mie[2]) / 3.0f;
+			for (int inu = 0; inu < storedNU; ++inu)
+			{
+				const size_t base = ((((size_t)ir * SMU + imu) * SMUS + imus) * storedNU + inu) * 4;
+				b.Out->ScatteringRGBA[base + 0] = rayleigh[0];
+				b.Out->ScatteringRGBA[base + 1] = rayleigh[1];
+				b.Out->ScatteringRGBA[base + 2] = rayleigh[2];
+				b.Out->ScatteringRGBA[base + 3] = mieA;
+			}
+		}
+	}
+}
+
+// ComputeDirectIrradianceRow의 lane 버전 (태양 감쇠는 ComputeDirectIrradianceRGB처럼 LUT 없이 직접 적분)
+static void ComputeSpectralDirectIrradianceRow(AtmosSpectralBake& s, int j)
+{
+	const AtmosBakePreset& b0 = s.Groups[0];
+	const int EW = b0.In->IrradianceW, EH = b0.In->IrradianceH;
+	alignas(32) float TrSun[ATMOS_SPECTRAL_MAX_LANES];
+	for (int i = 0; i < EW; ++i)
+	{
+		float r, muS;
+		b0.Map.IrradianceTexelToParams(i, j, EW, EH, &r, &muS);
+
+		float tau[3];
+		if (SpectralSunOpticalDepth(s, r, muS, /*bUseLUT*/false, b0.Quad.IrradianceSun, tau))
+		{
+			SpectralTransmittanceBatch(s.Lanes, tau, TrSun);
+		}
+		else
+		{
+			std::fill(TrSun, TrSun + ATMOS_SPECTRAL_MAX_LANES, 0.0f);
+		}
+
+		const float cosTerm = HFX_MAX(0.0f, muS);
+		const size_t idx = (size_t(j) * EW + i) * 3;
+		for (int g = 0; g < s.NumGroups; ++g)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				const int l = 3 * g + c;
+				s.Groups[g].Out->IrradianceRGB[idx + c] = s.SolarIrradiance[l] * TrSun[l] * cosTerm;
+			}
+		}
+	}
+}
+
+// bUseTransmittanceLUT로 구운 Scattering LUT를 strided subset에서 brute force 적분과 비교해 로그로 남긴다
+static void ReportScatteringLUTError(const PlanetGeom& pg, const AtmosLutMapping& map, const AtmosMedium& med, const AtmosQuadratureSet& quad, const AtmosResult* out)
+{
+	const int SR = out->ScatteringR, SMU = out->ScatteringMu, SMUS = out->ScatteringMuS, SNU = out->ScatteringNu;
+	const int strideR = HFX_MAX(1, SR / 8), strideMu = HFX_MAX(1, SMU / 16), strideMuS = HFX_MAX(1, SMUS / 8);
+
+	// 무시할 만큼 어두운 texel은 상대 오차에서 제외 (LUT 최댓값 기준)
+	double peak = 0.0;
+	const size_t Ssize = size_t(SR) * size_t(SMU) * size_t(SMUS) * size_t(SNU) * 4;
+	for (size_t i = 0; i < Ssize; ++i)
+	{
+		peak = HFX_MAX(peak, (double)out->ScatteringRGBA[i]);
+	}
+
+	double maxRel = 0.0, sumRel = 0.0;
+	int numChecked = 0;
+	for (int ir = strideR / 2; ir < SR; ir += strideR)
+	{
+		for (int imu = strideMu / 2; imu < SMU; imu += strideMu)
+		{
+			for (int imus = strideMuS / 2; imus < SMUS; imus += strideMuS)
+			{
+				bool bRayHitsGround = false;
+				const float r = map.ScatteringR(ir, SR);
+				const float mu = map.ScatteringMu(r, imu, SMU, &bRayHitsGround);
+				const float muS = map.ScatteringMuS(imus, SMUS);
+				const float* lut = &out->ScatteringRGBA[((((size_t)ir * SMU + imu) * SMUS + imus) * SNU) * 4];
+
+				float ref[4];
+				IntegrateSingleScatteringUnphased(r, mu, muS, pg, med, ref, quad.View, quad.Sun, nullptr, nullptr, &bRayHitsGround);
+				for (int c = 0; c < 4; ++c)
+				{
+					if (ref[c] < 1e-4 * peak) continue;
+					const double rel = std::fabs((double)lut[c] - (double)ref[c]) / (double)ref[c];
+					maxRel = HFX_MAX(maxRel, rel);
+					sumRel += rel;
+					++numChecked;
+				}
+			}
+		}
+	}
+	std::cout << "[Prelight] Transmittance LUT vs brute force: max rel err " << maxRel
+		<< ", mean " << (numChecked ? sumRel / numChecked : 0.0)
+		<< " (" << numChecked << " samples)" << std::endl;
+}
+
+// ---------------------------- Multiple scattering (Bruneton 2017) ----------------------------
+// 차수 n (>= 2) 마다
+//   1) (r, mu_s) texel마다 구면 방향별 입사 radiance L_{n-1}(ω_i) (+ 지표 반사: T_ground * albedo / π * ΔE)
+//   2) scattering density J_n(r, mu, mu_s, nu) = Σ β_s ρ(r) ∫ L_{n-1}(ω_i) P(ω·ω_i) dω_i
+//      Rayleigh 위상은 (1 + (ω·ω_i)^2) 이라 ∫L + ωᵀ(∫L ω_i ω_iᵀ)ω 로 정확히 풀린다 → (r, mu_s)마다 모멘트 7개만 쌓는다
+//   3) 간접 조도 ΔE(r, mu_s) = ∫_{윗반구} L_{n-1}(ω_i) (ω_i·up) dω_i  → 다음 차수의 지표 반사에 사용
+//   4) ΔS_n(r, mu, mu_s, nu) = ∫ T(x, x_t) J_n(x_t) dt
+// 를 구해 Scattering RGB에는 ΔS_n / RayleighPhase(nu)를, Irradiance에는 ΔE를 더한다.
+// r, mu_s, nu 격자는 texel 중심이라 1)/2)는 같은 (r, mu_s)에서 보간 없이 L을 공유하고,
+// 4)는 (r, mu) view ray 하나의 위치/투과도를 (mu_s, nu) 전체가 공유한다.
+
+static constexpr int MS_SPHERE_THETA = 16;		// 구면 적분 θ 분할 (Bruneton SAMPLE_COUNT)
+static constexpr int MS_SPHERE_PHI = 32;		// 구면 적분 φ 분할
+static constexpr int MS_SPHERE_DIRS = MS_SPHERE_THETA * MS_SPHERE_PHI;
+static constexpr int MS_IRRADIANCE_THETA = 16;	// 간접 조도 윗반구 θ 분할
+static constexpr int MS_IRRADIANCE_PHI = 32;
+static constexpr int MS_VIEW_STEPS = 32;		// ΔS view ray 스텝 (<= ATMOS_STEP_BATCH)
+static constexpr float MS_PI = 3.14159265358979f;
+
+static inline float RayleighPhase(float nu)
+{
+	return 3.0f / (16.0f * MS_PI) * (1.0f + nu * nu);
+}
+
+// AtmosphericSky.hlsl과 같은 Henyey-Greenstein
+static inline float HenyeyGreensteinPhase(float nu, float g)
+{
+	const float gg = g * g;
+	const float x = HFX_MAX(1.0f + gg - 2.0f * g * nu, 1e-6f);
+	return (1.0f - gg) / (4.0f * MS_PI * x * std::sqrt(x));
+}
+
+// texel 좌표 (AtmosLutMapping 출력, 이미 [0, n-1]로 clamp됨) → 보간할 두 texel과 가중치
+static inline void TexelLerp(float x, int n, int* i0, int* i1, float* f)
+{
+	*i0 = (int)x;
+	*i1 = HFX_MIN(*i0 + 1, n - 1);
+	*f = x - (float)*i0;
+}
+
+// sun = (sqrt(1 - mu_s^2), 0, mu_s) 좌표계에서 (mu, nu)를 만족하는 view 방향.
+// 기하적으로 불가능한 nu는 가능한 범위로 clamp 하고 실제 nu를 돌려준다.
+static inline void ViewDirInSunFrame(float mu, float muS, float nu, float* outDir, float* outNu)
+{
+	const float sinS = std::sqrt(HFX_MAX(0.0f, 1.0f - muS * muS));
+	const float sinV = std::sqrt(HFX_MAX(0.0f, 1.0f - mu * mu));
+	float x = (sinS > 1e-6f) ? (nu - mu * muS) / sinS : 0.0f;
+	x = HFX_CLAMP(x, -sinV, sinV);
+	outDir[0] = x;
+	outDir[1] = std::sqrt(HFX_MAX(0.0f, sinV * sinV - x * x));
+	outDir[2] = mu;
+	*outNu = x * sinS + mu * muS;
+}
+
+// (r, mu, mu_s, nu) RGB 테이블 (ScatteringRGBA와 같은 순서, 채널 3개). 단산란 테이블은 NU = 1.
+struct ScatteringTableRGB
+{
+	const float* RGB;
+	int R, MU, MUS, NU;
+};
+
+static void SampleScatteringTableRGB(
+	const ScatteringTableRGB& t, const AtmosLutMapping& map,
+	float r, float mu, float muS, float nu, bool rayHitsGround,
+	float* outRGB)
+{
+	int ri[2], mi[2], si[2], ni[2];
+	float fr, fm, fs, fn;
+	TexelLerp(map.ScatteringRToTexel(r, t.R), t.R, &ri[0], &ri[1], &fr);
+	TexelLerp(map.ScatteringMuToTexel(r, mu, rayHitsGround, t.MU), t.MU, &mi[0], &mi[1], &fm);
+	TexelLerp(map.ScatteringMuSToTexel(muS, t.MUS), t.MUS, &si[0], &si[1], &fs);
+	TexelLerp(map.ScatteringNuToTexel(nu, t.NU), t.NU, &ni[0], &ni[1], &fn);
+	const float rw[2] = { 1.0f - fr, fr }, mw[2] = { 1.0f - fm, fm }, sw[2] = { 1.0f - fs, fs }, nw[2] = { 1.0f - fn, fn };
+
+	outRGB[0] = outRGB[1] = outRGB[2] = 0.0f;
+	for (int a = 0; a < 2; ++a)
+	{
+		for (int b = 0; b < 2; ++b)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				for (int d = 0; d < 2; ++d)
+				{
+					const float w = rw[a] * mw[b] * sw[c] * nw[d];
+					if (w == 0.0f)
+					{
+						continue;
+					}
+					const float* v = &t.RGB[((((size_t)ri[a] * t.MU + mi[b]) * t.MUS + si[c]) * t.NU + ni[d]) * 3];
+					outRGB[0] += w * v[0];
+					outRGB[1] += w * v[1];
+					outRGB[2] += w * v[2];
+				}
+			}
+		}
+	}
+}
+
+// Irradiance 2D (r, mu_s) RGB bilinear 조회
+static void SampleIrradianceRGB(
+	const float* E, int W, int H, const AtmosLutMapping& map,
+	float r, float muS,
+	float* outRGB)
+{
+	int x0, x1, y0, y1;
+	float fx, fy, tx, ty;
+	map.IrradianceParamsToTexel(r, muS, W, H, &tx, &ty);
+	TexelLerp(tx, W, &x0, &x1, &fx);
+	TexelLerp(ty, H, &y0, &y1, &fy);
+
+	const float* e00 = &E[((size_t)y0 * W + x0) * 3];
+	const float* e10 = &E[((size_t)y0 * W + x1) * 3];
+	const float* e01 = &E[((size_t)y1 * W + x0) * 3];
+	const float* e11 = &E[((size_t)y1 * W + x1) * 3];
+	for (int c = 0; c < 3; ++c)
+	{
+		const float a = e00[c] + (e10[c] - e00[c]) * fx;
+		const float b = e01[c] + (e11[c] - e01[c]) * fx;
+		outRGB[c] = a + (b - a) * fy;
+	}
+}
+
+// 구면 방향 (up = z, 태양은 xz 평면)과 입체각. 파라미터와 무관해서 한 번 만들어 모든 프리셋/호출이 공유한다
+struct MSSphereDirs
+{
+	float X[MS_SPHERE_DIRS], Y[MS_SPHERE_DIRS], Z[MS_SPHERE_DIRS], W[MS_SPHERE_DIRS];
+
+	MSSphereDirs()
+	{
+		const float dTheta = MS_PI / MS_SPHERE_THETA;
+		const float dPhi = 2.0f * MS_PI / MS_SPHERE_PHI;
+		for (int j = 0; j < MS_SPHERE_THETA; ++j)
+		{
+			const float theta = (j + 0.5f) * dTheta;
+			for (int k = 0; k < MS_SPHERE_PHI; ++k)
+			{
+				const float phi = (k + 0.5f) * dPhi;
+				const int d = j * MS_SPHERE_PHI + k;
+				X[d] = std::sin(theta) * std::cos(phi);
+				Y[d] = std::sin(theta) * std::sin(phi);
+				Z[d] = std::cos(theta);
+				W[d] = std::sin(theta) * dTheta * dPhi;
+			}
+		}
+	}
+};
+
+static const MSSphereDirs& GetMSSphereDirs()
+{
+	static const MSSphereDirs dirs;
+	return dirs;
+}
+
+// 프리셋 하나의 다중산란 상태. 하위 단계 1) ~ 4)를 작업 단위 함수로 나눠 여러 프리셋의 작업을 한 풀에 섞는다
+struct MultipleScatteringBake
+{
+	// 지표로 향하는 방향의 지표까지 거리/투과도. 차수와 무관하고 개수도 적어서 LUT 대신 직접 적분한다.
+	struct GroundHit
+	{
+		float T[3];
+		float Dist;
+		bool bHit;
+	};
+
+	AtmosBakePreset* B;
+	int SR, SMU, SMUS, SNU, EW, EH;
+	float Albedo[3];
+	ScatteringTableRGB SingleRTable, SingleMTable, DeltaMSTable;
+
+	std::vector<float> DeltaMS;		// ΔS (위상 적용된 radiance). 차수마다 덮어쓴다
+	std::vector<float> Density;		// J
+	std::vector<float> DeltaE;		// 처음엔 직접 조도
+	std::vector<float> Incoming;	// [mu_s][dir][c][r], dω 포함 (Mie용)
+	std::vector<float> Moments;		// [mu_s][r][c][∫L, ∫L xx, yy, zz, xy, xz, yz] (Rayleigh용)
+	std::vector<float> RhoR, RhoM;	// texel 고도의 밀도 (J의 β_s ρ)
+	std::vector<GroundHit> GroundHits;
+
+	explicit MultipleScatteringBake(AtmosBakePreset* b)
+		: B(b), SR(b->Out->ScatteringR), SMU(b->Out->ScatteringMu), SMUS(b->Out->ScatteringMuS), SNU(b->Out->ScatteringNu),
+		EW(b->Out->IrradianceW), EH(b->Out->IrradianceH),
+		Albedo{ b->In->GroundAlbedo.x, b->In->GroundAlbedo.y, b->In->GroundAlbedo.z },
+		SingleRTable{ b->SingleR.data(), SR, SMU, SMUS, 1 }, SingleMTable{ b->SingleM.data(), SR, SMU, SMUS, 1 }, DeltaMSTable{}
+	{
+		const size_t numTexels = size_t(SR) * SMU * SMUS * SNU;
+		DeltaMS.assign(numTexels * 3, 0.0f);
+		Density.assign(numTexels * 3, 0.0f);
+		DeltaE.assign(b->Out->IrradianceRGB, b->Out->IrradianceRGB + size_t(EW) * EH * 3);
+		Incoming.resize(size_t(SMUS) * MS_SPHERE_DIRS * 3 * SR);
+		Moments.resize(size_t(SMUS) * SR * 3 * 7);
+		GroundHits.resize(size_t(SR) * MS_SPHERE_THETA);
+		DeltaMSTable = { DeltaMS.data(), SR, SMU, SMUS, SNU };
+
+		RhoR.resize(SR);
+		RhoM.resize(SR);
+		for (int ir0 = 0; ir0 < SR; ir0 += ATMOS_STEP_BATCH)
+		{
+			const int n = HFX_MIN(ATMOS_STEP_BATCH, SR - ir0);
+			float h[ATMOS_STEP_BATCH], ext[3][ATMOS_STEP_BATCH];
+			for (int k = 0; k < n; ++k)
+			{
+				h[k] = b->Map.ScatteringR(ir0 + k, SR) - b->Pg.Rg;
+			}
+			EvaluateMediumBatch(b->Med, h, n, &RhoR[ir0], &RhoM[ir0], ext[0], ext[1], ext[2]);
+		}
+	}
+
+	MultipleScatteringBake(const MultipleScatteringBake&) = delete;
+	MultipleScatteringBake& operator=(const MultipleScatteringBake&) = delete;
+
+	size_t TexelIndex(int ir, int imu, int imus, int inu) const
+	{
+		return (((size_t)ir * SMU + imu) * SMUS + imus) * SNU + inu;
+	}
+
+	void ComputeGroundHits(int ir);
+	void IncomingRadiance(int order, float r, float mu, float muS, float nu, float* L) const;
+	void ComputeIncoming(int order, int job);
+	void ComputeDensity(int job);
+	void ComputeIndirectIrradiance(int order, int j);
+	void ComputeDeltaScattering(int job);
+};
+
+void MultipleScatteringBake::ComputeGroundHits(int ir)
+{
+	const MSSphereDirs& dirs = GetMSSphereDirs();
+	const float r = B->Map.ScatteringR(ir, SR);
+	for (int j = 0; j < MS_SPHERE_THETA; ++j)
+	{
+		GroundHit& g = GroundHits[(size_t)ir * MS_SPHERE_THETA + j];
+		const float mu = dirs.Z[j * MS_SPHERE_PHI];
+		g.Dist = PathLengthToBoundary(r, mu, B->Pg, &g.bHit);
+		g.T[0] = g.T[1] = g.T[2] = 0.0f;
+		if (g.bHit)
+		{
+			IntegrateTransmittanceRGB(r, mu, B->Pg, B->Med, g.T, B->Quad.Transmittance);
+		}
+	}
+}
+
+// L_{n-1}: 2차에서는 단산란에 위상을 곱하고, 이후에는 직전 차수 ΔS
+void MultipleScatteringBake::IncomingRadiance(int order, float r, float mu, float muS, float nu, float* L) const
+{
+	const AtmosLutMapping& map = B->Map;
+	const bool bRayHitsGround = map.RayIntersectsGround(r, mu);
+	if (order == 2)
+	{
+		float sR[3], sM[3];
+		SampleScatteringTableRGB(SingleRTable, map, r, mu, muS, 0.0f, bRayHitsGround, sR);
+		SampleScatteringTableRGB(SingleMTable, map, r, mu, muS, 0.0f, bRayHitsGround, sM);
+		const float pR = RayleighPhase(nu);
+		const float pM = HenyeyGreensteinPhase(nu, B->In->MieG);
+		for (int c = 0; c < 3; ++c)
+		{
+			L[c] = sR[c] * pR + sM[c] * pM;
+		}
+	}
+	else
+	{
+		SampleScatteringTableRGB(DeltaMSTable, map, r, mu, muS, nu, bRayHitsGround, L);
+	}
+}
+
+// 1) 입사 radiance: (r, mu_s) 단위
+void MultipleScatteringBake::ComputeIncoming(int order, int job)
+{
+	const MSSphereDirs& dirs = GetMSSphereDirs();
+	const AtmosLutMapping& map = B->Map;
+	const int ir = job / SMUS;
+	const int imus = job % SMUS;
+	const float r = map.ScatteringR(ir, SR);
+	const float muS = map.ScatteringMuS(imus, SMUS);
+	const float sinS = std::sqrt(HFX_MAX(0.0f, 1.0f - muS * muS));
+
+	float M[3][7] = {};
+	for (int d = 0; d < MS_SPHERE_DIRS; ++d)
+	{
+		const float nu = dirs.X[d] * sinS + dirs.Z[d] * muS;
+		float L[3];
+		IncomingRadiance(order, r, dirs.Z[d], muS, nu, L);
+
+		// 지표 반사 (Lambert)
+		const GroundHit& g = GroundHits[(size_t)ir * MS_SPHERE_THETA + d / MS_SPHERE_PHI];
+		if (g.bHit)
+		{
+			const float px = g.Dist * dirs.X[d], py = g.Dist * dirs.Y[d], pz = r + g.Dist * dirs.Z[d];
+			const float muSGround = (px * sinS + pz * muS) / length3(px, py, pz);
+			float E[3];
+			SampleIrradianceRGB(DeltaE.data(), EW, EH, map, B->Pg.Rg, muSGround, E);
+			for (int c = 0; c < 3; ++c)
+			{
+				L[c] += g.T[c] * Albedo[c] / MS_PI * E[c];
+			}
+		}
+
+		const float x = dirs.X[d], y = dirs.Y[d], z = dirs.Z[d];
+		for (int c = 0; c < 3; ++c)
+		{
+			const float Lw = L[c] * dirs.W[d];
+			Incoming[(((size_t)imus * MS_SPHERE_DIRS + d) * 3 + c) * SR + ir] = Lw;
+			M[c][0] += Lw;
+			M[c][1] += Lw * x * x;
+			M[c][2] += Lw * y * y;
+			M[c][3] += Lw * z * z;
+			M[c][4] += Lw * x * y;
+			M[c][5] += Lw * x * z;
+			M[c][6] += Lw * y * z;
+		}
+	}
+	std::copy(&M[0][0], &M[0][0] + 21, &Moments[((size_t)imus * SR + ir) * 21]);
+}
+
+// 2) J: (mu_s, mu) 단위. r별 Mie 위상 행렬 [방향][r]을 만든 뒤 모든 r에 적용한다 (r이 안쪽이라 벡터화된다).
+//    Bruneton 매핑은 texel의 mu가 r마다 달라 위상도 r마다 구하고, 균등 매핑은 mu가 같아 위상 한 줄을 모든 r이 공유한다.
+void MultipleScatteringBake::ComputeDensity(int job)
+{
+	const MSSphereDirs& dirs = GetMSSphereDirs();
+	const AtmosLutMapping& map = B->Map;
+	const AtmosMedium& med = B->Med;
+	const int imus = job / SMU;
+	const int imu = job % SMU;
+	const float muS = map.ScatteringMuS(imus, SMUS);
+
+	std::vector<float> muR(SR), w(size_t(SR) * 3);
+	bool bSharedMu = true;
+	for (int ir = 0; ir < SR; ++ir)
+	{
+		bool bRayHitsGround = false;
+		muR[ir] = map.ScatteringMu(map.ScatteringR(ir, SR), imu, SMU, &bRayHitsGround);
+		bSharedMu = bSharedMu && (muR[ir] == muR[0]);
+	}
+
+	// 위상 [방향][r] (공유면 [방향])
+	const int phaseStride = bSharedMu ? 1 : SR;
+	std::vector<float> phaseM(size_t(MS_SPHERE_DIRS) * phaseStride);
+	std::vector<float> acc(size_t(3) * SR);
+	float phaseRow[MS_SPHERE_DIRS];
+	for (int inu = 0; inu < SNU; ++inu)
+	{
+		const float nuTexel = map.ScatteringNu(inu, SNU);
+		for (int ir = 0; ir < SR; ++ir)
+		{
+			float nu;
+			float* wr = &w[(size_t)ir * 3];
+			ViewDirInSunFrame(muR[ir], muS, nuTexel, wr, &nu);
+			if (ir >= phaseStride)
+			{
+				continue;
+			}
+			HenyeyGreensteinBatch(wr[0], wr[1], wr[2], dirs.X, dirs.Y, dirs.Z, MS_SPHERE_DIRS, B->In->MieG, phaseRow);
+			for (int d = 0; d < MS_SPHERE_DIRS; ++d)
+			{
+				phaseM[(size_t)d * phaseStride + ir] = phaseRow[d];
+			}
+		}
+
+		std::fill(acc.begin(), acc.end(), 0.0f);
+		for (int d = 0; d < MS_SPHERE_DIRS; ++d)
+		{
+			const float* L = &Incoming[((size_t)imus * MS_SPHERE_DIRS + d) * 3 * SR];
+			const float* P = &phaseM[(size_t)d * phaseStride];
+			for (int c = 0; c < 3; ++c)
+			{
+				float* accM = &acc[(size_t)c * SR];
+				const float* Lc = L + (size_t)c * SR;
+				if (bSharedMu)
+				{
+					const float p = P[0];
+					for (int ir = 0; ir < SR; ++ir)
+					{
+						accM[ir] += p * Lc[ir];
+					}
+				}
+				else
+				{
+					for (int ir = 0; ir < SR; ++ir)
+					{
+						accM[ir] += P[ir] * Lc[ir];
+					}
+				}
+			}
+		}
+
+		const float kRayleigh = 3.0f / (16.0f * MS_PI);
+		for (int ir = 0; ir < SR; ++ir)
+		{
+			const float* Mr = &Moments[((size_t)imus * SR + ir) * 21];
+			const float* wr = &w[(size_t)ir * 3];
+			float* J = &Density[TexelIndex(ir, imu, imus, inu) * 3];
+			for (int c = 0; c < 3; ++c)
+			{
+				const float* m = Mr + c * 7;
+				const float quad = wr[0] * wr[0] * m[1] + wr[1] * wr[1] * m[2] + wr[2] * wr[2] * m[3]
+					+ 2.0f * (wr[0] * wr[1] * m[4] + wr[0] * wr[2] * m[5] + wr[1] * wr[2] * m[6]);
+				const float accR = kRayleigh * (m[0] + quad);
+				J[c] = med.RayleighScattering[c] * RhoR[ir] * accR
+					+ med.MieScattering[c] * RhoM[ir] * acc[(size_t)c * SR + ir];
+			}
+		}
+	}
+}
+
+// 3) 간접 조도 (L_{n-1}의 윗반구 적분). 1)에서 ΔE를 다 읽었으므로 덮어쓴다.
+void MultipleScatteringBake::ComputeIndirectIrradiance(int order, int j)
+{
+	const float dTheta = 0.5f * MS_PI / MS_IRRADIANCE_THETA;
+	const float dPhi = 2.0f * MS_PI / MS_IRRADIANCE_PHI;
+	for (int i = 0; i < EW; ++i)
+	{
+		float r, muS;
+		B->Map.IrradianceTexelToParams(i, j, EW, EH, &r, &muS);
+		const float sinS = std::sqrt(HFX_MAX(0.0f, 1.0f - muS * muS));
+
+		float E[3] = { 0.0f, 0.0f, 0.0f };
+		for (int jt = 0; jt < MS_IRRADIANCE_THETA; ++jt)
+		{
+			const float theta = (jt + 0.5f) * dTheta;
+			const float cosT = std::cos(theta), sinT = std::sin(theta);
+			for (int k = 0; k < MS_IRRADIANCE_PHI; ++k)
+			{
+				const float phi = (k + 0.5f) * dPhi;
+				const float nu = sinT * std::cos(phi) * sinS + cosT * muS;
+				float L[3];
+				IncomingRadiance(order, r, cosT, muS, nu, L);
+				const float weight = cosT * sinT * dTheta * dPhi;
+				E[0] += L[0] * weight;
+				E[1] += L[1] * weight;
+				E[2] += L[2] * weight;
+			}
+		}
+
+		const size_t idx = (size_t(j) * EW + i) * 3;
+		for (int c = 0; c < 3; ++c)
+		{
+			DeltaE[idx + c] = E[c];
+			B->Out->IrradianceRGB[idx + c] += E[c];
+		}
+	}
+}
+
+// 4) ΔS_n: (r, mu) 단위. view ray 위치/투과도와 (r_t, mu_t) 보간 좌표는 (mu_s, nu) 전체가 공유
+void MultipleScatteringBake::ComputeDeltaScattering(int job)
+{
+	const PlanetGeom& pg = B->Pg;
+	const int ir = job / SMU;
+	const int imu = job % SMU;
+	const AtmosLutMapping m = B->Map;	// 지역 복사: 아래 float 저장과 별칭이 아니어서 매핑 상수가 레지스터에 남는다
+	bool bRayHitsGround = false;
+	const float r = m.ScatteringR(ir, SR);
+	const float mu = m.ScatteringMu(r, imu, SMU, &bRayHitsGround);
+	const float tEnd = PathLengthToBoundary(r, mu, pg, nullptr, &bRayHitsGround);
+	const float ds = tEnd / float(MS_VIEW_STEPS);
+
+	float t[MS_VIEW_STEPS], rt[MS_VIEW_STEPS], h[MS_VIEW_STEPS];
+	float ext[3][MS_VIEW_STEPS], tau[3][MS_VIEW_STEPS], Tr[3][MS_VIEW_STEPS];
+	int r0[MS_VIEW_STEPS], r1[MS_VIEW_STEPS], m0[MS_VIEW_STEPS], m1[MS_VIEW_STEPS];
+	float fr[MS_VIEW_STEPS], fm[MS_VIEW_STEPS];
+	for (int s = 0; s < MS_VIEW_STEPS; ++s)
+	{
+		t[s] = (s + 0.5f) * ds;
+		rt[s] = std::sqrt(r * r + t[s] * t[s] + 2.0f * t[s] * r * mu);
+		h[s] = HFX_MAX(0.0f, rt[s] - pg.Rg);
+		const float mut = HFX_CLAMP((r * mu + t[s]) / rt[s], -1.0f, 1.0f);
+		// ray 위의 점은 원래 ray와 같은 쪽 (지표/하늘) texel에서 읽는다
+		TexelLerp(m.ScatteringRToTexel(rt[s], SR), SR, &r0[s], &r1[s], &fr[s]);
+		TexelLerp(m.ScatteringMuToTexel(rt[s], mut, bRayHitsGround, SMU), SMU, &m0[s], &m1[s], &fm[s]);
+	}
+
+	// x → x_t 투과도 (스텝 중간점까지 광학두께)
+	EvaluateMediumBatch(B->Med, h, MS_VIEW_STEPS, nullptr, nullptr, ext[0], ext[1], ext[2]);
+	for (int c = 0; c < 3; ++c)
+	{
+		KahanSum sum;
+		for (int s = 0; s < MS_VIEW_STEPS; ++s)
+		{
+			tau[c][s] = (sum.Sum + 0.5f * ext[c][s]) * ds;
+			sum.Add(ext[c][s]);
+		}
+		ExpNegBatch(tau[c], MS_VIEW_STEPS, Tr[c]);
+	}
+
+	float* scattering = B->Out->ScatteringRGBA;
+	for (int imus = 0; imus < SMUS; ++imus)
+	{
+		const float muS = m.ScatteringMuS(imus, SMUS);
+		for (int inu = 0; inu < SNU; ++inu)
+		{
+			float w[3], nu;
+			ViewDirInSunFrame(mu, muS, m.ScatteringNu(inu, SNU), w, &nu);
+
+			float S[3] = { 0.0f, 0.0f, 0.0f };
+			if (tEnd > 0.0f)
+			{
+				for (int s = 0; s < MS_VIEW_STEPS; ++s)
+				{
+					const float muSt = HFX_CLAMP((r * muS + t[s] * nu) / rt[s], -1.0f, 1.0f);
+					int s0, s1;
+					float fs;
+					TexelLerp(m.ScatteringMuSToTexel(muSt, SMUS), SMUS, &s0, &s1, &fs);
+
+					// nu는 ray를 따라 변하지 않으므로 같은 nu slice에서 (r, mu, mu_s) trilinear
+					const int ri[2] = { r0[s], r1[s] }, mi[2] = { m0[s], m1[s] }, si[2] = { s0, s1 };
+					const float rw[2] = { 1.0f - fr[s], fr[s] }, mw[2] = { 1.0f - fm[s], fm[s] }, sw[2] = { 1.0f - fs, fs };
+					float J[3] = { 0.0f, 0.0f, 0.0f };
+					for (int a = 0; a < 2; ++a)
+					{
+						for (int b = 0; b < 2; ++b)
+						{
+							for (int e = 0; e < 2; ++e)
+							{
+								const float weight = rw[a] * mw[b] * sw[e];
+								const float* v = &Density[TexelIndex(ri[a], mi[b], si[e], inu) * 3];
+								J[0] += weight * v[0];
+								J[1] += weight * v[1];
+								J[2] += weight * v[2];
+							}
+						}
+					}
+					for (int c = 0; c < 3; ++c)
+					{
+						S[c] += Tr[c][s] * J[c] * ds;
+					}
+				}
+			}
+
+			const size_t idx = TexelIndex(ir, imu, imus, inu);
+			const float invPhase = 1.0f / RayleighPhase(nu);
+			for (int c = 0; c < 3; ++c)
+			{
+				DeltaMS[idx * 3 + c] = S[c];
+				scattering[idx * 4 + c] += S[c] * invPhase;
+			}
+		}
+	}
+}
+
+// 다중산란을 켠 프리셋 전부를 차수별로 함께 진행한다. 차수가 적은 프리셋은 자기 차수가 끝나면 작업 수 0으로 빠진다
+static void AccumulateMultipleScatteringBatch(std::vector<AtmosBakePreset>& presets, int numThreads)
+{
+	std::vector<std::unique_ptr<MultipleScatteringBake>> bakes;
+	int maxOrders = 1;
+	for (AtmosBakePreset& b : presets)
+	{
+		if (b.bMultipleScattering)
+		{
+			bakes.emplace_back(std::make_unique<MultipleScatteringBake>(&b));
+			maxOrders = HFX_MAX(maxOrders, b.In->MultipleScatteringOrders);
+		}
+	}
+	using BakePtr = std::unique_ptr<MultipleScatteringBake>;
+
+	ParallelForPresets(bakes, numThreads,
+		[](const BakePtr& ms) { return ms->SR; },
+		[](BakePtr& ms, int ir) { ms->ComputeGroundHits(ir); });
+
+	for (int order = 2; order <= maxOrders; ++order)
+	{
+		const auto orderBegin = std::chrono::steady_clock::now();
+		auto active = [order](const BakePtr& ms) { return order <= ms->B->In->MultipleScatteringOrders; };
+
+		ParallelForPresets(bakes, numThreads,
+			[&](const BakePtr& ms) { return active(ms) ? ms->SR * ms->SMUS : 0; },
+			[order](BakePtr& ms, int job) { ms->ComputeIncoming(order, job); });
+		ParallelForPresets(bakes, numThreads,
+			[&](const BakePtr& ms) { return active(ms) ? ms->SMUS * ms->SMU : 0; },
+			[](BakePtr& ms, int job) { ms->ComputeDensity(job); });
+		ParallelForPresets(bakes, numThreads,
+			[&](const BakePtr& ms) { return active(ms) ? ms->EH : 0; },
+			[order](BakePtr& ms, int j) { ms->ComputeIndirectIrradiance(order, j); });
+		ParallelForPresets(bakes, numThreads,
+			[&](const BakePtr& ms) { return active(ms) ? ms->SR * ms->SMU : 0; },
+			[](BakePtr& ms, int job) { ms->ComputeDeltaScattering(job); });
+
+		const double orderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - orderBegin).count();
+		std::cout << "[Prelight] Multiple scattering order " << order << ": " << orderMs << "ms" << std::endl;
+	}
 }
@@ -1,4 +1,25 @@
 ﻿#pragma once
 #include "Interface/AtmosStruct.h"
 
+struct AtmosMedium;
+
 void ComputeAtmosCPU(const AtmosParams& in, AtmosResult* out);
+
+// 프리셋 count개를 함께 굽는다 (out[i] ← in[i]). 단계마다 모든 프리셋의 작업을 한 스레드 풀 (in[0].NumThreads)에 넣는다.
+// 결과는 프리셋마다 ComputeAtmosCPU와 비트 단위로 같다. 프리셋끼리 해상도/매핑이 달라도 된다
+void ComputeAtmosBatchCPU(const AtmosParams* in, int count, AtmosResult* out);
+
+// 참조용 Transmittance LUT (RGB, in.LutMapping 매핑)
+struct TransmittanceLUT
+{
+	const float* RGB;
+	int W, H;
+	AtmosLutMapping Mapping;
+};
+
+// ComputeAtmosCPU의 transmittance 단계만 실행 (in.TransmittanceW x H, in.LutMapping, in.Quality)
+// 전체 bake 없이 투과도만 필요한 곳 (스카이뷰 컨텍스트)에서 같은 적분을 쓴다. outRGB = W * H * 3
+void ComputeTransmittanceLUT(const AtmosParams& in, const AtmosMedium& med, int numThreads, float* outRGB);
+
+// Transmittance LUT bilinear 조회 (lut.Mapping의 texel 좌표)
+void LookupTransmittanceRGB(const TransmittanceLUT& lut, float r, float mu, float* outTrRGB);
@@ -2,6 +2,8 @@
 #include "pch.h"
 #include "Common/Common.h"
 #include <array>
+#include <cfloat>
+#include <fstream>
 
 // ------------------------ Key packing & 인덱싱 ------------------------
 static inline uint64_t pack3x21(int x, int y, int z)
@@ -54,6 +56,90 @@ struct TileCPU
 	}
 };
 
+// ------------------------ 복셀 속성 채널 (타일 단위 지연 할당) ------------------------
+// 그리드의 타일 인덱스(ValVector 값)를 그대로 키로 쓴다. 속성을 쓰는 타일만 32^3 페이지를 할당
+template<class T>
+class VoxelAttributeChannel
+{
+public:
+	static constexpr int PAGE_SIZE = TileCPU::TILE_VOXELS;
+
+	T Default{};
+	std::vector<int> TilePage;	// 타일 인덱스 → 페이지 (-1 = 미할당)
+	std::vector<T> Data;		// 페이지 * PAGE_SIZE + localIdx
+
+	bool HasTile(int tileIdx) const
+	{
+		return tileIdx >= 0 && tileIdx < (int)TilePage.size() && TilePage[(size_t)tileIdx] >= 0;
+	}
+	T Get(int tileIdx, uint16_t li) const
+	{
+		if (!HasTile(tileIdx)) return Default;
+		return Data[(size_t)TilePage[(size_t)tileIdx] * PAGE_SIZE + li];
+	}
+	T& GetOrAllocate(int tileIdx, uint16_t li)
+	{
+		if (tileIdx >= (int)TilePage.size())
+		{
+			TilePage.resize((size_t)tileIdx + 1, -1);
+		}
+		int& page = TilePage[(size_t)tileIdx];
+		if (page < 0)
+		{
+			page = (int)(Data.size() / PAGE_SIZE);
+			Data.resize(Data.size() + PAGE_SIZE, Default);
+		}
+		return Data[(size_t)page * PAGE_SIZE + li];
+	}
+	void ResetTile(int tileIdx)
+	{
+		if (!HasTile(tileIdx)) return;
+		const size_t base = (size_t)TilePage[(size_t)tileIdx] * PAGE_SIZE;
+		std::fill(Data.begin() + base, Data.begin() + base + PAGE_SIZE, Default);
+	}
+	void Clear()
+	{
+		TilePage.clear();
+		Data.clear();
+	}
+	int NumPages() const { return (int)(Data.size() / PAGE_SIZE); }
+	size_t MemoryBytes() const
+	{
+		return TilePage.capacity() * sizeof(int) + Data.capacity() * sizeof(T);
+	}
+};
+
+// 옥타헤드럴 법선 인코딩 (x: 하위 8bit, y: 상위 8bit)
+static inline uint16_t EncodeOctNormal(const FLOAT3& n)
+{
+	const float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	if (!(l1 > 0.0f)) return 0x8080;
+	float u = n.x / l1, v = n.y / l1;
+	if (n.z < 0.0f)
+	{
+		const float pu = u, pv = v;
+		u = (1.0f - fabsf(pv)) * (pu >= 0.0f ? 1.0f : -1.0f);
+		v = (1.0f - fabsf(pu)) * (pv >= 0.0f ? 1.0f : -1.0f);
+	}
+	const uint16_t qu = (uint16_t)std::clamp((int)std::lround((u * 0.5f + 0.5f) * 255.0f), 0, 255);
+	const uint16_t qv = (uint16_t)std::clamp((int)std::lround((v * 0.5f + 0.5f) * 255.0f), 0, 255);
+	return (uint16_t)(qu | (qv << 8));
+}
+static inline FLOAT3 DecodeOctNormal(uint16_t e)
+{
+	const float u = (float)(e & 0xFF) / 255.0f * 2.0f - 1.0f;
+	const float v = (float)(e >> 8) / 255.0f * 2.0f - 1.0f;
+	FLOAT3 n{ u, v, 1.0f - fabsf(u) - fabsf(v) };
+	if (n.z < 0.0f)
+	{
+		const float px = n.x, py = n.y;
+		n.x = (1.0f - fabsf(py)) * (px >= 0.0f ? 1.0f : -1.0f);
+		n.y = (1.0f - fabsf(px)) * (py >= 0.0f ? 1.0f : -1.0f);
+	}
+	const float len = n.Magnitude();
+	return (len > 0.0f) ? n / len : FLOAT3{ 0.0f, 0.0f, 1.0f };
+}
+
 // ------------------------ GPU-친화 희소 그리드(해시) ------------------------
 class GpuFriendlySparseGridFB
 {
@@ -70,6 +156,15 @@ public:
 	std::vector<int> ValVector; // EMPTY = -1
 	std::vector<TileCPU> TileVector;
 
+	// 선택적 속성 채널 (AttributeMask(EVoxelAttribute)로 켠 채널만 복셀화 시 기록)
+	uint32_t AttributeMask = VOXEL_ATTR_NONE;
+	VoxelAttributeChannel<uint16_t> NormalChannel;
+	VoxelAttributeChannel<uint16_t> MaterialChannel;
+	VoxelAttributeChannel<uint16_t> MaterialWeightChannel;	// MaterialChannel 후보의 가중 다수결 득표 (면적 * MATERIAL_WEIGHT_SCALE)
+	VoxelAttributeChannel<uint8_t> CoverageChannel;
+
+	static constexpr float MATERIAL_WEIGHT_SCALE = 4096.0f;
+
 	explicit GpuFriendlySparseGridFB(float cell = 1.0f, FLOAT3 origin = { 0,0,0 }, int T_ = 32)
 		: T(T_)
 		, Cell(cell)
@@ -88,6 +183,10 @@ public:
 		Size = 0; TileVector.clear();
 		std::fill(KeyVector.begin(), KeyVector.end(), 0xFFFFFFFFFFFFFFFFull);
 		std::fill(ValVector.begin(), ValVector.end(), -1);
+		NormalChannel.Clear();
+		MaterialChannel.Clear();
+		MaterialWeightChannel.Clear();
+		CoverageChannel.Clear();
 	}
 
 	inline void SetVoxelIndex(int x, int y, int z, bool on = true)
@@ -111,6 +210,21 @@ public:
 		}
 	}
 
+	// 타일 내용을 비운다 (해시 슬롯은 유지, 빈 BITSET 타일로)
+	void ClearTile(int tx, int ty, int tz)
+	{
+		int tileIdx = findTile(tx, ty, tz);
+		if (tileIdx < 0) return;
+		TileCPU& tile = TileVector[(size_t)tileIdx];
+		tile.Mode = TileCPU::BITSET;
+		tile.Count = 0;
+		tile.Bits = {};
+		NormalChannel.ResetTile(tileIdx);
+		MaterialChannel.ResetTile(tileIdx);
+		MaterialWeightChannel.ResetTile(tileIdx);
+		CoverageChannel.ResetTile(tileIdx);
+	}
+
 	inline bool GetVoxelIndex(int x, int y, int z) const
 	{
 		int tx, ty, tz; indexToTile(x, y, z, tx, ty, tz);
@@ -130,6 +244,44 @@ public:
 
 	int findTileIndex(int tx, int ty, int tz) const { return findTile(tx, ty, tz); }
 
+	// 속성 조회 (해당 타일에 채널이 없으면 채널 Default)
+	inline FLOAT3 GetNormal(int x, int y, int z) const
+	{
+		int tx, ty, tz; indexToTile(x, y, z, tx, ty, tz);
+		return DecodeOctNormal(NormalChannel.Get(findTile(tx, ty, tz), (uint16_t)localIdx(x, y, z)));
+	}
+	inline uint16_t GetMaterial(int x, int y, int z) const
+	{
+		int tx, ty, tz; indexToTile(x, y, z, tx, ty, tz);
+		return MaterialChannel.Get(findTile(tx, ty, tz), (uint16_t)localIdx(x, y, z));
+	}
+	inline float GetCoverage(int x, int y, int z) const
+	{
+		int tx, ty, tz; indexToTile(x, y, z, tx, ty, tz);
+		return (float)CoverageChannel.Get(findTile(tx, ty, tz), (uint16_t)localIdx(x, y, z)) / 255.0f;
+	}
+
+	uint64_t CountVoxels() const
+	{
+		uint64_t n = 0;
+		for (const TileCPU& tile : TileVector)
+		{
+			n += (tile.Mode == TileCPU::FULL) ? (uint64_t)TileCPU::TILE_VOXELS : (uint64_t)tile.Count;
+		}
+		return n;
+	}
+
+	size_t MemoryBytes() const
+	{
+		return TileVector.capacity() * sizeof(TileCPU)
+			+ KeyVector.capacity() * sizeof(uint64_t)
+			+ ValVector.capacity() * sizeof(int)
+			+ NormalChannel.MemoryBytes()
+			+ MaterialChannel.MemoryBytes()
+			+ MaterialWeightChannel.MemoryBytes()
+			+ CoverageChannel.MemoryBytes();
+	}
+
 	template<class F>
 	void forEachTile(F&& f) const {
 		for (int i = 0; i < Capacity; ++i) {
@@ -252,12 +404,185 @@ struct VoxelComponent
     int maxX = -INT32_MAX, maxY = -INT32_MAX, maxZ = -INT32_MAX;
 };
 
+// 복셀화 통계 (플래너 보정/로그용)
+struct VoxelizeStats
+{
+	int Nx = 0, Ny = 0, Nz = 0;		// dense 그리드 크기
+	uint64_t SatTests = 0;			// tri-box SAT 호출 수
+	uint64_t SurfaceVoxels = 0;
+	uint64_t SolidVoxels = 0;
+	double SurfaceMs = 0.0;			// 표면 복셀화 시간
+	double FillMs = 0.0;			// Solid 채우기 시간
+};
+
+// VoxelizeToSparse와 동일한 그리드 배치(원점 스냅 + 셀 수) 계산
+void ComputeVoxelGridLayout(
+	const Bounds& meshBounds,
+	float voxelSize,
+	FLOAT3* outOrigin,
+	int* outNx, int* outNy, int* outNz);
+// 그리드 공간 삼각형 하나를 [clipMin, clipMax] 복셀 범위 안에서만 표면 복셀화. SAT 테스트 수 반환
+// surface.AttributeMask가 켜져 있으면 materialId와 함께 속성 채널도 누적
+uint64_t VoxelizeTriangleSAT(
+	const FLOAT3& a, const FLOAT3& b, const FLOAT3& c,
+	const int clipMin[3], const int clipMax[3],
+	GpuFriendlySparseGridFB& surface,
+	uint16_t materialId = 0);
+// dense [0,n) 그리드 경계에서 flood fill → 바깥이 아닌 복셀(내부 + 표면)을 outSolid에 기록
+void MakeSolidFromSurfaceSparse(
+	int nx, int ny, int nz,
+	const GpuFriendlySparseGridFB& surface,
+	GpuFriendlySparseGridFB* outSolid);
 void VoxelizeToSparse(
-	const std::vector<FLOAT3> vertices,
-	const std::vector<uint16_t> indices,
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<uint32_t>& indices,
 	const Bounds& meshBounds,
 	float voxelSize,
-	GpuFriendlySparseGridFB* outSolidVoxelGrid);
+	GpuFriendlySparseGridFB* outSolidVoxelGrid,
+	VoxelizeStats* outStats = nullptr,
+	GpuFriendlySparseGridFB* outSurface = nullptr,	// 표면 그리드 (AttributeMask로 속성 채널 선택)
+	uint16_t materialId = 0);
+// 메쉬 크기/표면적 + 저해상도 사전 복셀화로 예산에 맞는 셀 크기를 고른다.
+bool PlanVoxelSize(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<const std::vector<uint32_t>*>& sectionIndices,
+	const Bounds& meshBounds,
+	const VoxelBudget& budget,
+	VoxelPlan* outPlan);
+
+// ------------------------ 증분 복셀화 (편집 중인 메쉬용) ------------------------
+// Build()로 한 번 전체 복셀화한 뒤, 삼각형이 일부 바뀌면 Update()/UpdateRange()로
+//  1) 삼각형 해시 diff → 제거/추가된 삼각형
+//  2) 그 삼각형이 걸친 타일만 비우고, 해당 타일에 걸친 삼각형들로 재복셀화
+//  3) 변경 타일 AABB + HaloTiles 만큼 확장한 영역에서만 Solid flood fill 재실행
+// 영역 경계의 바깥/안 판정은 이전 결과를 신뢰한다. 편집이 영역 밖까지 이어지는 공동(cavity)을
+// 새로 열거나, 구멍을 막아 영역 밖 공간이 내부가 될 수 있으면 (편집 전 영역 안에서 이어져 있던
+// 바깥 씨드가 갈라짐) 전체 채우기로 전환한다. HaloTiles는 불필요한 전체 채우기를 줄이는 여유일 뿐이다.
+class IncrementalVoxelizer
+{
+public:
+	int HaloTiles = 1;
+
+	void Build(
+		const std::vector<FLOAT3>& vertices,
+		const std::vector<uint32_t>& indices,
+		const Bounds& meshBounds,
+		float voxelSize);
+
+	// 전체 삼각형 집합을 해시로 비교. 그리드 범위를 벗어나는 편집이면 전체 재빌드 후 false 반환
+	bool Update(const std::vector<FLOAT3>& vertices, const std::vector<uint32_t>& indices);
+	// 삼각형 [firstTriangle, firstTriangle + numTriangles) 만 바뀐 경우 (삼각형 수는 동일해야 함)
+	bool UpdateRange(
+		const std::vector<FLOAT3>& vertices,
+		const std::vector<uint32_t>& indices,
+		int firstTriangle, int numTriangles);
+
+	const GpuFriendlySparseGridFB& GetSolid() const { return m_Solid; }
+	const GpuFriendlySparseGridFB& GetSurface() const { return m_Surface; }
+	float GetCell() const { return m_Cell; }
+	void GetGridSize(int* outNx, int* outNy, int* outNz) const { *outNx = m_N[0]; *outNy = m_N[1]; *outNz = m_N[2]; }
+
+	// 마지막 갱신 통계
+	int LastDirtyTiles = 0;
+	uint64_t LastRefilledVoxels = 0;
+	bool bLastFullRefill = false;
+
+private:
+	struct TriangleRecord
+	{
+		FLOAT3 V[3];		// 그리드 공간 좌표
+		int RefCount = 0;	// 동일 삼각형 중복 허용
+	};
+
+	uint64_t hashTriangle(const FLOAT3& a, const FLOAT3& b, const FLOAT3& c) const;
+	FLOAT3 toGrid(const FLOAT3& p) const;
+	void tileRangeOf(const TriangleRecord& tri, int tileMin[3], int tileMax[3]) const;
+	bool fitsGrid(const FLOAT3& a, const FLOAT3& b, const FLOAT3& c) const;
+	void applyDiff(
+		const std::vector<uint64_t>& removed,
+		const std::vector<std::pair<uint64_t, TriangleRecord>>& added);
+	void revoxelizeTiles(const std::vector<uint64_t>& dirtyTiles);
+	void refillRegion(const int voxMin[3], const int voxMax[3]);
+
+	float m_Cell = 1.0f;
+	FLOAT3 m_Origin{ 0,0,0 };
+	int m_N[3] = { 0,0,0 };
+	Bounds m_Bounds;
+
+	GpuFriendlySparseGridFB m_Surface;
+	GpuFriendlySparseGridFB m_Solid;
+
+	std::unordered_map<uint64_t, TriangleRecord> m_Triangles;				// 해시 → 삼각형
+	std::unordered_map<uint64_t, std::vector<uint64_t>> m_TileTriangles;	// 타일 키 → 삼각형 해시
+	std::vector<uint64_t> m_IndexHashes;									// 삼각형 인덱스 → 해시 (UpdateRange용)
+};
+
+// ------------------------ 복셀 레이 쿼리 (계층 DDA) ------------------------
+// VoxelRay / VoxelRayHit는 Interface/VoxelStruct.h (IPrelight로 노출). t는 Origin + Direction * t 의 파라미터
+// 빈 타일/빈 64비트 워드(32x2x1 블록)는 박스 단위로 건너뛰고, FULL 타일은 타일 하나를 통째로 점유 구간으로 본다.
+// 레이별 첫 번째 점유 복셀
+void RayFirstHitBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const VoxelRay* rays, int numRays,
+	VoxelRayHit* outHits);
+// 선분 [from, to] 중 점유 복셀 안에 있는 길이의 비율 (0~1)
+void SegmentOccupancyBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const FLOAT3* from, const FLOAT3* to, int numSegments,
+	float* outOccupancy);
+// 두 점 사이 가시성 (1 = 보임). 양 끝에서 endBias(월드 길이)만큼은 검사하지 않는다 (표면 위 점의 자기 가림 방지)
+void VisibilityBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const FLOAT3* from, const FLOAT3* to, int numPairs,
+	float endBias,
+	uint8_t* outVisible);
+
+// ------------------------ 바이너리 그리드 포맷 (HVOX) ------------------------
+// [VoxelGridFileHeader][VoxelGridFileTile + (BITSET이면 uint64_t x 512)] x TileCount
+struct VoxelGridFileHeader
+{
+	static constexpr uint32_t MAGIC = 0x584F5648; // 'HVOX'
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t Magic = MAGIC;
+	uint32_t Version = VERSION;
+	float Cell = 1.0f;
+	float Origin[3] = { 0,0,0 };
+	int32_t Nx = 0, Ny = 0, Nz = 0;
+	uint32_t TileCount = 0;
+};
+struct VoxelGridFileTile
+{
+	int32_t Tx, Ty, Tz;
+	uint16_t Mode;		// TileCPU::Mode
+	uint16_t Count;
+};
+
+// 타일을 하나씩 덧붙이는 스트리밍 writer (TileCount는 Close에서 헤더에 기록)
+class VoxelGridWriter
+{
+public:
+	bool Open(const wchar_t* path, float cell, const FLOAT3& origin, int nx, int ny, int nz);
+	bool WriteTile(int tx, int ty, int tz, const TileCPU& tile);
+	bool Close();
+
+	uint32_t GetTileCount() const { return m_Header.TileCount; }
+
+private:
+	std::ofstream m_File;
+	VoxelGridFileHeader m_Header;
+};
+
+bool SaveSparseGrid(const wchar_t* path, const GpuFriendlySparseGridFB& grid, int nx, int ny, int nz);
+bool LoadSparseGrid(const wchar_t* path, GpuFriendlySparseGridFB* outGrid, int* outNx, int* outNy, int* outNz);
+
+// 바이너리 STL → 표면 복셀 HVOX 파일 (out-of-core, 메모리 상한 = desc.MaxResidentBytes)
+bool VoxelizeStreamingSTL(
+	const wchar_t* stlPath,
+	const wchar_t* outGridPath,
+	const StreamingVoxelDesc& desc,
+	StreamingVoxelStats* outStats = nullptr);
+
 void ExtractConnectedComponents6(
 	const GpuFriendlySparseGridFB& solid,
 	std::vector<VoxelComponent>& outComponents);
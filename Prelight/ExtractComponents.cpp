@@ -168,6 +168,10 @@ void ExtractConnectedComponents6(
         const TileCoord c0 = coordLUT[startIdx];
         if (c0.tx == INT32_MAX) { visited[startIdx] = 1; continue; }
 
+        // 증분 갱신 등으로 비워진 타일은 컴포넌트를 만들지 않는다
+        const TileCPU& T0 = solid.TileVector[startIdx];
+        if (T0.Mode == TileCPU::BITSET && T0.Count == 0) { visited[startIdx] = 1; continue; }
+
         // 새 컴포넌트
         VoxelComponent comp;
         comp.id = (int)outComponents.size();
@@ -0,0 +1,470 @@
+﻿// ============================================================================
+// 증분 복셀화 (CPU)
+//  - 삼각형 해시 diff 또는 dirty 인덱스 범위로 변경 삼각형을 찾는다
+//  - 변경 삼각형이 걸친 타일만 비우고 재복셀화 (타일별 삼각형 목록 유지)
+//  - 변경 타일 AABB + halo 영역에서만 Solid flood fill 재실행
+//  - 영역 밖 공동이 열리거나 (구멍이 뚫림) 닫히면 (구멍이 막힘) 전체 채우기로 전환
+// ============================================================================
+
+#include "pch.h"
+#include "ConvexDecomposition.h"
+#include <cstring>
+#include <algorithm>
+#include <queue>
+
+static inline void unpack3x21(uint64_t key, int& tx, int& ty, int& tz)
+{
+	tx = (int)((int64_t)((key) & ((1ull << 21) - 1)) - (1 << 20));
+	ty = (int)((int64_t)((key >> 21) & ((1ull << 21) - 1)) - (1 << 20));
+	tz = (int)((int64_t)((key >> 42) & ((1ull << 21) - 1)) - (1 << 20));
+}
+
+uint64_t IncrementalVoxelizer::hashTriangle(const FLOAT3& a, const FLOAT3& b, const FLOAT3& c) const
+{
+	// FNV-1a over the raw position bits (vertex order matters)
+	uint32_t words[9];
+	std::memcpy(&words[0], &a, sizeof(FLOAT3));
+	std::memcpy(&words[3], &b, sizeof(FLOAT3));
+	std::memcpy(&words[6], &c, sizeof(FLOAT3));
+	uint64_t h = 1469598103934665603ull;
+	for (uint32_t w : words)
+	{
+		h ^= w;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+FLOAT3 IncrementalVoxelizer::toGrid(const FLOAT3& p) const
+{
+	return FLOAT3{ (p.x - m_Origin.x) / m_Cell, (p.y - m_Origin.y) / m_Cell, (p.z - m_Origin.z) / m_Cell };
+}
+
+// VoxelizeTriangleSAT가 건드리는 복셀 범위를 타일 단위로
+void IncrementalVoxelizer::tileRangeOf(const TriangleRecord& tri, int tileMin[3], int tileMax[3]) const
+{
+	for (int k = 0; k < 3; ++k)
+	{
+		const float mn = std::min(tri.V[0][k], std::min(tri.V[1][k], tri.V[2][k]));
+		const float mx = std::max(tri.V[0][k], std::max(tri.V[1][k], tri.V[2][k]));
+		const int v0 = std::max((int)std::floor(mn - 0.5f) - 1, 0);
+		const int v1 = std::min((int)std::ceil(mx + 0.5f) + 1, m_N[k] - 1);
+		tileMin[k] = v0 >> 5;
+		tileMax[k] = v1 >> 5;
+	}
+}
+
+bool IncrementalVoxelizer::fitsGrid(const FLOAT3& a, const FLOAT3& b, const FLOAT3& c) const
+{
+	for (int k = 0; k < 3; ++k)
+	{
+		const float mn = std::min(a[k], std::min(b[k], c[k]));
+		const float mx = std::max(a[k], std::max(b[k], c[k]));
+		if (mn < 0.0f || mx > (float)m_N[k]) return false;
+	}
+	return true;
+}
+
+void IncrementalVoxelizer::Build(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<uint32_t>& indices,
+	const Bounds& meshBounds,
+	float voxelSize)
+{
+	m_Cell = voxelSize;
+	m_Bounds = meshBounds;
+	ComputeVoxelGridLayout(meshBounds, voxelSize, &m_Origin, &m_N[0], &m_N[1], &m_N[2]);
+
+	m_Surface.Clear();
+	m_Solid.Clear();
+	m_Surface.Reconfigure(m_Cell, m_Origin);
+	m_Solid.Reconfigure(m_Cell, m_Origin);
+	m_Triangles.clear();
+	m_TileTriangles.clear();
+
+	const int numTriangles = (int)(indices.size() / 3);
+	m_IndexHashes.resize((size_t)numTriangles);
+
+	const int clipMin[3] = { 0, 0, 0 };
+	const int clipMax[3] = { m_N[0] - 1, m_N[1] - 1, m_N[2] - 1 };
+	for (int f = 0; f < numTriangles; ++f)
+	{
+		const FLOAT3& p0 = vertices[indices[3 * f + 0]];
+		const FLOAT3& p1 = vertices[indices[3 * f + 1]];
+		const FLOAT3& p2 = vertices[indices[3 * f + 2]];
+		const uint64_t h = hashTriangle(p0, p1, p2);
+		m_IndexHashes[(size_t)f] = h;
+
+		TriangleRecord& rec = m_Triangles[h];
+		if (rec.RefCount++ > 0) continue; // 중복 삼각형은 한 번만 복셀화
+
+		rec.V[0] = toGrid(p0);
+		rec.V[1] = toGrid(p1);
+		rec.V[2] = toGrid(p2);
+
+		int tMin[3], tMax[3];
+		tileRangeOf(rec, tMin, tMax);
+		for (int tz = tMin[2]; tz <= tMax[2]; ++tz)
+			for (int ty = tMin[1]; ty <= tMax[1]; ++ty)
+				for (int tx = tMin[0]; tx <= tMax[0]; ++tx)
+					m_TileTriangles[pack3x21(tx, ty, tz)].push_back(h);
+
+		VoxelizeTriangleSAT(rec.V[0], rec.V[1], rec.V[2], clipMin, clipMax, m_Surface);
+	}
+
+	MakeSolidFromSurfaceSparse(m_N[0], m_N[1], m_N[2], m_Surface, &m_Solid);
+
+	LastDirtyTiles = 0;
+	LastRefilledVoxels = (uint64_t)m_N[0] * m_N[1] * m_N[2];
+	bLastFullRefill = true;
+}
+
+bool IncrementalVoxelizer::Update(const std::vector<FLOAT3>& vertices, const std::vector<uint32_t>& indices)
+{
+	struct NewEntry { int Count; int FirstTriangle; };
+
+	const int numTriangles = (int)(indices.size() / 3);
+	std::vector<uint64_t> newIndexHashes((size_t)numTriangles);
+	std::unordered_map<uint64_t, NewEntry> newSet;
+	newSet.reserve((size_t)numTriangles);
+	for (int f = 0; f < numTriangles; ++f)
+	{
+		const uint64_t h = hashTriangle(vertices[indices[3 * f + 0]], vertices[indices[3 * f + 1]], vertices[indices[3 * f + 2]]);
+		newIndexHashes[(size_t)f] = h;
+		auto it = newSet.find(h);
+		if (it == newSet.end()) newSet.emplace(h, NewEntry{ 1, f });
+		else ++it->second.Count;
+	}
+
+	// 제거: 기존 참조 수가 새 집합보다 많은 만큼
+	std::vector<uint64_t> removed;
+	for (const auto& [h, rec] : m_Triangles)
+	{
+		auto it = newSet.find(h);
+		const int newCount = (it == newSet.end()) ? 0 : it->second.Count;
+		for (int i = newCount; i < rec.RefCount; ++i) removed.push_back(h);
+	}
+
+	// 추가: 새 집합의 참조 수가 기존보다 많은 만큼
+	std::vector<std::pair<uint64_t, TriangleRecord>> added;
+	for (const auto& [h, entry] : newSet)
+	{
+		auto it = m_Triangles.find(h);
+		const int oldCount = (it == m_Triangles.end()) ? 0 : it->second.RefCount;
+		if (entry.Count <= oldCount) continue;
+
+		TriangleRecord rec;
+		const int f = entry.FirstTriangle;
+		rec.V[0] = toGrid(vertices[indices[3 * f + 0]]);
+		rec.V[1] = toGrid(vertices[indices[3 * f + 1]]);
+		rec.V[2] = toGrid(vertices[indices[3 * f + 2]]);
+		if (!fitsGrid(rec.V[0], rec.V[1], rec.V[2]))
+		{
+			// 그리드 배치가 바뀌어야 하는 편집 → 전체 재빌드
+			Bounds bounds;
+			for (const FLOAT3& p : vertices) bounds.Encapsulate(p);
+			Build(vertices, indices, bounds, m_Cell);
+			return false;
+		}
+		for (int i = oldCount; i < entry.Count; ++i) added.emplace_back(h, rec);
+	}
+
+	m_IndexHashes.swap(newIndexHashes);
+	applyDiff(removed, added);
+	return true;
+}
+
+bool IncrementalVoxelizer::UpdateRange(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<uint32_t>& indices,
+	int firstTriangle, int numTriangles)
+{
+	if (indices.size() / 3 != m_IndexHashes.size())
+	{
+		return Update(vertices, indices); // 삼각형 수가 바뀌면 범위로 추적 불가
+	}
+
+	const int begin = std::max(firstTriangle, 0);
+	const int end = std::min(firstTriangle + numTriangles, (int)m_IndexHashes.size());
+
+	std::vector<uint64_t> removed;
+	std::vector<std::pair<uint64_t, TriangleRecord>> added;
+	for (int f = begin; f < end; ++f)
+	{
+		const FLOAT3& p0 = vertices[indices[3 * f + 0]];
+		const FLOAT3& p1 = vertices[indices[3 * f + 1]];
+		const FLOAT3& p2 = vertices[indices[3 * f + 2]];
+		const uint64_t h = hashTriangle(p0, p1, p2);
+		if (h == m_IndexHashes[(size_t)f]) continue;
+
+		TriangleRecord rec;
+		rec.V[0] = toGrid(p0);
+		rec.V[1] = toGrid(p1);
+		rec.V[2] = toGrid(p2);
+		if (!fitsGrid(rec.V[0], rec.V[1], rec.V[2]))
+		{
+			Bounds bounds;
+			for (const FLOAT3& p : vertices) bounds.Encapsulate(p);
+			Build(vertices, indices, bounds, m_Cell);
+			return false;
+		}
+
+		removed.push_back(m_IndexHashes[(size_t)f]);
+		added.emplace_back(h, rec);
+		m_IndexHashes[(size_t)f] = h;
+	}
+
+	applyDiff(removed, added);
+	return true;
+}
+
+void IncrementalVoxelizer::applyDiff(
+	const std::vector<uint64_t>& removed,
+	const std::vector<std::pair<uint64_t, TriangleRecord>>& added)
+{
+	std::unordered_set<uint64_t> dirtySet;
+
+	for (uint64_t h : removed)
+	{
+		auto it = m_Triangles.find(h);
+		if (it == m_Triangles.end()) continue;
+		if (--it->second.RefCount > 0) continue; // 아직 같은 삼각형이 남아 있음
+
+		int tMin[3], tMax[3];
+		tileRangeOf(it->second, tMin, tMax);
+		for (int tz = tMin[2]; tz <= tMax[2]; ++tz)
+			for (int ty = tMin[1]; ty <= tMax[1]; ++ty)
+				for (int tx = tMin[0]; tx <= tMax[0]; ++tx)
+				{
+					const uint64_t key = pack3x21(tx, ty, tz);
+					auto lit = m_TileTriangles.find(key);
+					if (lit != m_TileTriangles.end())
+					{
+						std::vector<uint64_t>& list = lit->second;
+						list.erase(std::remove(list.begin(), list.end(), h), list.end());
+					}
+					dirtySet.insert(key);
+				}
+		m_Triangles.erase(it);
+	}
+
+	for (const auto& [h, src] : added)
+	{
+		TriangleRecord& rec = m_Triangles[h];
+		if (rec.RefCount++ > 0) continue;
+
+		rec.V[0] = src.V[0]; rec.V[1] = src.V[1]; rec.V[2] = src.V[2];
+		int tMin[3], tMax[3];
+		tileRangeOf(rec, tMin, tMax);
+		for (int tz = tMin[2]; tz <= tMax[2]; ++tz)
+			for (int ty = tMin[1]; ty <= tMax[1]; ++ty)
+				for (int tx = tMin[0]; tx <= tMax[0]; ++tx)
+				{
+					const uint64_t key = pack3x21(tx, ty, tz);
+					m_TileTriangles[key].push_back(h);
+					dirtySet.insert(key);
+				}
+	}
+
+	LastDirtyTiles = (int)dirtySet.size();
+	LastRefilledVoxels = 0;
+	bLastFullRefill = false;
+	if (dirtySet.empty()) return;
+
+	const std::vector<uint64_t> dirtyTiles(dirtySet.begin(), dirtySet.end());
+	revoxelizeTiles(dirtyTiles);
+
+	// 변경 타일 AABB + halo (복셀 인덱스, 그리드로 클램프)
+	int tMin[3] = { INT32_MAX, INT32_MAX, INT32_MAX };
+	int tMax[3] = { INT32_MIN, INT32_MIN, INT32_MIN };
+	for (uint64_t key : dirtyTiles)
+	{
+		int t[3];
+		unpack3x21(key, t[0], t[1], t[2]);
+		for (int k = 0; k < 3; ++k)
+		{
+			tMin[k] = std::min(tMin[k], t[k]);
+			tMax[k] = std::max(tMax[k], t[k]);
+		}
+	}
+	// halo가 최소 1타일은 돼야 영역 경계의 표면이 이번 편집과 무관하다
+	const int halo = std::max(HaloTiles, 1);
+	int voxMin[3], voxMax[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		voxMin[k] = std::max((tMin[k] - halo) * TileCPU::T, 0);
+		voxMax[k] = std::min((tMax[k] + halo + 1) * TileCPU::T - 1, m_N[k] - 1);
+	}
+	refillRegion(voxMin, voxMax);
+}
+
+void IncrementalVoxelizer::revoxelizeTiles(const std::vector<uint64_t>& dirtyTiles)
+{
+	for (uint64_t key : dirtyTiles)
+	{
+		int tx, ty, tz;
+		unpack3x21(key, tx, ty, tz);
+		m_Surface.ClearTile(tx, ty, tz);
+
+		auto lit = m_TileTriangles.find(key);
+		if (lit == m_TileTriangles.end()) continue;
+		if (lit->second.empty())
+		{
+			m_TileTriangles.erase(lit);
+			continue;
+		}
+
+		// 타일 영역으로 클립해서 이 타일의 복셀만 다시 찍는다
+		const int clipMin[3] = { tx * TileCPU::T, ty * TileCPU::T, tz * TileCPU::T };
+		const int clipMax[3] =
+		{
+			std::min(clipMin[0] + TileCPU::T - 1, m_N[0] - 1),
+			std::min(clipMin[1] + TileCPU::T - 1, m_N[1] - 1),
+			std::min(clipMin[2] + TileCPU::T - 1, m_N[2] - 1)
+		};
+		for (uint64_t h : lit->second)
+		{
+			const TriangleRecord& rec = m_Triangles[h];
+			VoxelizeTriangleSAT(rec.V[0], rec.V[1], rec.V[2], clipMin, clipMax, m_Surface);
+		}
+	}
+}
+
+void IncrementalVoxelizer::refillRegion(const int voxMin[3], const int voxMax[3])
+{
+	const int dx = voxMax[0] - voxMin[0] + 1;
+	const int dy = voxMax[1] - voxMin[1] + 1;
+	const int dz = voxMax[2] - voxMin[2] + 1;
+	if (dx <= 0 || dy <= 0 || dz <= 0) return;
+
+	auto idOf = [&](int x, int y, int z)->size_t
+		{
+			return ((size_t)(z - voxMin[2]) * dy + (size_t)(y - voxMin[1])) * dx + (size_t)(x - voxMin[0]);
+		};
+	auto onGridBoundary = [&](int x, int y, int z)->bool
+		{
+			return x == 0 || y == 0 || z == 0 || x == m_N[0] - 1 || y == m_N[1] - 1 || z == m_N[2] - 1;
+		};
+	auto onRegionBoundary = [&](int x, int y, int z)->bool
+		{
+			return x == voxMin[0] || y == voxMin[1] || z == voxMin[2] || x == voxMax[0] || y == voxMax[1] || z == voxMax[2];
+		};
+
+	// 영역 경계 씨드: 그리드 경계면이면 무조건 바깥, 아니면 이전 Solid 결과(halo 밖은 불변)를 신뢰
+	std::vector<int3> seeds;
+	auto seed = [&](int x, int y, int z)
+		{
+			if (onGridBoundary(x, y, z) || !m_Solid.GetVoxelIndex(x, y, z)) seeds.push_back({ x, y, z });
+		};
+	for (int y = voxMin[1]; y <= voxMax[1]; ++y) for (int x = voxMin[0]; x <= voxMax[0]; ++x) { seed(x, y, voxMin[2]); seed(x, y, voxMax[2]); }
+	for (int z = voxMin[2]; z <= voxMax[2]; ++z) for (int x = voxMin[0]; x <= voxMax[0]; ++x) { seed(x, voxMin[1], z); seed(x, voxMax[1], z); }
+	for (int z = voxMin[2]; z <= voxMax[2]; ++z) for (int y = voxMin[1]; y <= voxMax[1]; ++y) { seed(voxMin[0], y, z); seed(voxMax[0], y, z); }
+
+	// 씨드마다 영역 안에서만 flood fill 해서 바깥 공간의 연결 성분 라벨을 매긴다 (-1 = 벽 또는 내부)
+	// bExterior[성분] = 그 성분이 영역 안에서 그리드 경계에 닿는다
+	const int off[6][3] = { {1,0,0},{-1,0,0},{0,1,0},{0,-1,0},{0,0,1},{0,0,-1} };
+	auto labelOutside = [&](auto isWall, std::vector<int>& label, std::vector<uint8_t>& bExterior)
+		{
+			label.assign((size_t)dx * dy * dz, -1);
+			bExterior.clear();
+			std::queue<int3> q;
+			auto push = [&](int x, int y, int z, int comp)
+				{
+					if (x < voxMin[0] || y < voxMin[1] || z < voxMin[2] || x > voxMax[0] || y > voxMax[1] || z > voxMax[2]) return;
+					const size_t id = idOf(x, y, z);
+					if (label[id] >= 0) return;
+					if (isWall(x, y, z)) return;
+					label[id] = comp;
+					if (onGridBoundary(x, y, z)) bExterior[(size_t)comp] = 1;
+					q.push({ x,y,z });
+				};
+			for (const int3& s : seeds)
+			{
+				if (label[idOf(s.x, s.y, s.z)] >= 0 || isWall(s.x, s.y, s.z)) continue;
+				const int comp = (int)bExterior.size();
+				bExterior.push_back(0);
+				push(s.x, s.y, s.z, comp);
+				while (!q.empty())
+				{
+					auto p = q.front(); q.pop();
+					for (auto& d : off)
+					{
+						push(p.x + d[0], p.y + d[1], p.z + d[2], comp);
+					}
+				}
+			}
+		};
+
+	auto fullRefill = [&]()
+		{
+			m_Solid.Clear();
+			MakeSolidFromSurfaceSparse(m_N[0], m_N[1], m_N[2], m_Surface, &m_Solid);
+			LastRefilledVoxels = (uint64_t)m_N[0] * m_N[1] * m_N[2];
+			bLastFullRefill = true;
+		};
+
+	// 편집 전 (이전 Solid 기준) / 후 (새 표면 기준) 바깥 성분
+	std::vector<int> oldLabel, newLabel;
+	std::vector<uint8_t> oldExterior, newExterior;
+	labelOutside([&](int x, int y, int z) { return m_Solid.GetVoxelIndex(x, y, z); }, oldLabel, oldExterior);
+	labelOutside([&](int x, int y, int z) { return m_Surface.GetVoxelIndex(x, y, z); }, newLabel, newExterior);
+
+	// 구멍이 막혔는지: 편집 전 영역 안에서 이어져 있던 씨드끼리는 편집 후에도 같은 성분이어야 한다.
+	// 영역 밖 공간은 바뀌지 않았으므로 이 조건이 지켜지면 영역 밖 복셀의 바깥/안 판정도 그대로다.
+	// 깨지면 영역 밖 공간이 새로 내부가 됐을 수 있으므로 전체 채우기 (영역 안에서만 갈라진 경우도 보수적으로 포함)
+	constexpr int EXTERIOR = INT32_MAX;
+	constexpr int UNSET = -1;
+	std::vector<int> oldToNew(oldExterior.size(), UNSET);
+	for (const int3& s : seeds)
+	{
+		const size_t id = idOf(s.x, s.y, s.z);
+		const int o = oldLabel[id];
+		if (o < 0) continue;
+		const int nl = newLabel[id];
+		const int newKey = (nl < 0) ? UNSET : (newExterior[(size_t)nl] ? EXTERIOR : nl);
+		int& mapped = oldToNew[(size_t)o];
+		const bool bSealed = (newKey == UNSET)
+			|| (oldExterior[(size_t)o] && newKey != EXTERIOR)
+			|| (mapped != UNSET && mapped != newKey);
+		if (bSealed)
+		{
+			fullRefill();
+			return;
+		}
+		mapped = newKey;
+	}
+
+	// 바깥 공간이 영역 경계의 (이전) 내부 복셀까지 닿았다 → 영역 밖 공동이 열렸으므로 전체 채우기
+	for (int z = voxMin[2]; z <= voxMax[2]; ++z)
+	{
+		for (int y = voxMin[1]; y <= voxMax[1]; ++y)
+		{
+			for (int x = voxMin[0]; x <= voxMax[0]; ++x)
+			{
+				if (!onRegionBoundary(x, y, z) || onGridBoundary(x, y, z)) continue;
+				if (newLabel[idOf(x, y, z)] >= 0 && m_Solid.GetVoxelIndex(x, y, z))
+				{
+					fullRefill();
+					return;
+				}
+			}
+		}
+	}
+
+	// MakeSolidFromSurfaceSparse와 동일하게 바깥이 아닌 복셀(내부 + 표면)을 기록
+	for (int z = voxMin[2]; z <= voxMax[2]; ++z)
+	{
+		for (int y = voxMin[1]; y <= voxMax[1]; ++y)
+		{
+			for (int x = voxMin[0]; x <= voxMax[0]; ++x)
+			{
+				const bool on = newLabel[idOf(x, y, z)] < 0;
+				if (m_Solid.GetVoxelIndex(x, y, z) != on)
+				{
+					m_Solid.SetVoxelIndex(x, y, z, on);
+				}
+			}
+		}
+	}
+	LastRefilledVoxels = (uint64_t)dx * dy * dz;
+}
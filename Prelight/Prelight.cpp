@@ -54,20 +54,122 @@ bool ENGINECALL Prelight::PrecomputeAtmos(const AtmosParams& in, AtmosResult* ou
 	return true;
 }
 
+bool ENGINECALL Prelight::PrecomputeAtmosBatch(const AtmosParams* in, int count, AtmosResult* out) const
+{
+	if (!in || !out || count <= 0)
+	{
+		return false;
+	}
+	ComputeAtmosBatchCPU(in, count, out);
+	return out[0].TransmittanceRGB != nullptr;
+}
+
+#include "AtmosSkyView.h"
+
+void* ENGINECALL Prelight::CreateSkyViewContext(const AtmosParams& in) const
+{
+	return CreateAtmosSkyViewContext(in);
+}
+
+bool ENGINECALL Prelight::UpdateSkyView(void* pSkyViewContext, const AtmosSkyViewParams& in, AtmosSkyViewResult* out) const
+{
+	if (!pSkyViewContext || !out)
+	{
+		return false;
+	}
+	UpdateAtmosSkyView((AtmosSkyViewContext*)pSkyViewContext, in, out);
+	return true;
+}
+
+void ENGINECALL Prelight::DeleteSkyViewContext(void* pSkyViewContext) const
+{
+	DeleteAtmosSkyViewContext((AtmosSkyViewContext*)pSkyViewContext);
+}
+
+#include "AtmosSampler.h"
+
+void* ENGINECALL Prelight::CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut) const
+{
+	if (!lut.TransmittanceRGB || !lut.ScatteringRGBA || !lut.IrradianceRGB)
+	{
+		return nullptr;
+	}
+	return ::CreateAtmosSampler(in, lut);
+}
+
+void ENGINECALL Prelight::SampleAtmos(const void* pSampler, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* outSamples) const
+{
+	if (!pSampler || count <= 0 || !queries || !outSamples)
+	{
+		return;
+	}
+	SampleAtmosBatch((const AtmosSampler*)pSampler, sunDir, queries, count, outSamples);
+}
+
+void ENGINECALL Prelight::ProjectSkyIrradianceSH(const void* pSampler, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* outSH) const
+{
+	if (!pSampler || !outSH)
+	{
+		return;
+	}
+	::ProjectSkyIrradianceSH((const AtmosSampler*)pSampler, sunDir, posPlanetCoord, outSH);
+}
+
+void ENGINECALL Prelight::DeleteAtmosSampler(void* pSampler) const
+{
+	::DeleteAtmosSampler((AtmosSampler*)pSampler);
+}
+
 #include "ConvexDecomposition.h"
 #include <fstream>
 
-bool ENGINECALL Prelight::DecomposeToConvex(const StaticMesh& m) const
+bool ENGINECALL Prelight::PlanVoxelization(const StaticMesh& m, const VoxelBudget& budget, VoxelPlan* outPlan) const
 {
+	std::vector<const std::vector<uint32_t>*> sectionIndices;
+	sectionIndices.reserve(m.Sections.size());
+	for (const MeshSection& section : m.Sections)
+	{
+		sectionIndices.push_back(&section.Indices);
+	}
+	return PlanVoxelSize(m.Positions, sectionIndices, m.MeshBounds, budget, outPlan);
+}
+
+bool ENGINECALL Prelight::DecomposeToConvex(const StaticMesh& m, const VoxelBudget& budget) const
+{
+	VoxelPlan plan = {};
+	if (!PlanVoxelization(m, budget, &plan))
+	{
+		std::cerr << "[Prelight] DecomposeToConvex: voxel planning failed." << std::endl;
+		return false;
+	}
+	std::cout << "[Prelight] Voxel plan: cell=" << plan.Cell
+		<< " grid=" << plan.Nx << "x" << plan.Ny << "x" << plan.Nz
+		<< " voxels(surface/solid)=" << plan.PredictedSurfaceVoxels << "/" << plan.PredictedSolidVoxels
+		<< " tiles=" << plan.PredictedTiles
+		<< " memory=" << (plan.PredictedBytes >> 20) << "MB"
+		<< " time=" << plan.PredictedMs << "ms" << std::endl;
+
+	// 속성을 요청했을 때만 섹션별 표면 그리드를 남긴다 (아니면 VoxelizeToSparse 안의 임시 그리드)
+	const bool bKeepSurface = budget.AttributeMask != VOXEL_ATTR_NONE;
 	std::vector<GpuFriendlySparseGridFB> solidVoxelGrid(m.Sections.size());
+	std::vector<GpuFriendlySparseGridFB> surfaceVoxelGrid(bKeepSurface ? m.Sections.size() : 0);
 	for (int sectionIndex = 0; sectionIndex < (int)m.Sections.size(); ++sectionIndex)
     {
+        GpuFriendlySparseGridFB* pSurface = nullptr;
+        if (bKeepSurface)
+        {
+            pSurface = &surfaceVoxelGrid[sectionIndex];
+            pSurface->AttributeMask = budget.AttributeMask;
+        }
         VoxelizeToSparse(
             m.Positions,
             m.Sections[sectionIndex].Indices,
             m.MeshBounds,
-            0.05f,
-            &solidVoxelGrid[sectionIndex]);
+            plan.Cell,
+            &solidVoxelGrid[sectionIndex],
+            nullptr,
+            pSurface,
+            (uint16_t)sectionIndex);
 	}
 
     // 섹션별 연결 성분 추출
@@ -93,7 +195,15 @@ bool ENGINECALL Prelight::DecomposeToConvex(const StaticMesh& m) const
             const FLOAT3 origin = solidVoxelGrid[si].Origin;
             ofs << " - Section " << si
                 << " | Cell Size: " << cell
-                << " | Origin: (" << origin.x << ", " << origin.y << ", " << origin.z << ")\n";
+                << " | Origin: (" << origin.x << ", " << origin.y << ", " << origin.z << ")";
+            if (bKeepSurface)
+            {
+                const GpuFriendlySparseGridFB& surface = surfaceVoxelGrid[si];
+                ofs << " | Surface: " << surface.CountVoxels()
+                    << " voxels, attribute pages " << surface.CoverageChannel.NumPages()
+                    << " (" << (surface.MemoryBytes() >> 10) << "KB)";
+            }
+            ofs << "\n";
         }
         ofs << "\n";
 
@@ -181,4 +291,184 @@ bool ENGINECALL Prelight::DecomposeToConvex(const StaticMesh& m) const
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool ENGINECALL Prelight::VoxelizeStreaming(const wchar_t* stlPath, const wchar_t* outGridPath, const StreamingVoxelDesc& desc, StreamingVoxelStats* outStats) const
+{
+	StreamingVoxelStats stats = {};
+	if (!VoxelizeStreamingSTL(stlPath, outGridPath, desc, &stats))
+	{
+		return false;
+	}
+	std::cout << "[Prelight] Streaming voxelization: grid=" << stats.Nx << "x" << stats.Ny << "x" << stats.Nz
+		<< " triangles=" << stats.Triangles << " (binned " << stats.BinnedTriangles << ")"
+		<< " regions=" << stats.Regions << " (" << stats.RegionTiles << "^3 tiles)"
+		<< " tiles=" << stats.Tiles << " voxels=" << stats.SurfaceVoxels
+		<< " resident=" << (stats.PeakResidentBytes >> 20) << "MB"
+		<< " time(bounds/bin/voxelize)=" << stats.BoundsMs << "/" << stats.BinMs << "/" << stats.VoxelizeMs << "ms" << std::endl;
+	if (outStats) *outStats = stats;
+	return true;
+}
+
+// 편집 중인 메쉬: 모든 섹션의 인덱스를 이어 붙여 하나의 IncrementalVoxelizer로 관리
+struct IncrementalVoxelContext
+{
+	IncrementalVoxelizer Voxelizer;
+	std::vector<uint32_t> Indices;
+};
+
+static void GatherSectionIndices(const StaticMesh& m, std::vector<uint32_t>* outIndices)
+{
+	outIndices->clear();
+	for (const MeshSection& section : m.Sections)
+	{
+		outIndices->insert(outIndices->end(), section.Indices.begin(), section.Indices.end());
+	}
+}
+
+static void GetIncrementalVoxelStats(const IncrementalVoxelizer& voxelizer, IncrementalVoxelStats* outStats)
+{
+	if (!outStats) return;
+	*outStats = {};
+	voxelizer.GetGridSize(&outStats->Nx, &outStats->Ny, &outStats->Nz);
+	outStats->Cell = voxelizer.GetCell();
+	outStats->DirtyTiles = voxelizer.LastDirtyTiles;
+	outStats->RefilledVoxels = voxelizer.LastRefilledVoxels;
+	outStats->bFullRebuild = voxelizer.bLastFullRefill;
+	outStats->SolidVoxels = voxelizer.GetSolid().CountVoxels();
+}
+
+void* ENGINECALL Prelight::CreateIncrementalVoxelizer(const StaticMesh& m, const VoxelBudget& budget, IncrementalVoxelStats* outStats) const
+{
+	VoxelPlan plan = {};
+	if (!PlanVoxelization(m, budget, &plan))
+	{
+		return nullptr;
+	}
+	IncrementalVoxelContext* pContext = new IncrementalVoxelContext;
+	GatherSectionIndices(m, &pContext->Indices);
+	pContext->Voxelizer.Build(m.Positions, pContext->Indices, m.MeshBounds, plan.Cell);
+	GetIncrementalVoxelStats(pContext->Voxelizer, outStats);
+	return pContext;
+}
+
+bool ENGINECALL Prelight::UpdateIncrementalVoxelizer(void* pVoxelizer, const StaticMesh& m, int firstTriangle, int numTriangles, IncrementalVoxelStats* outStats) const
+{
+	if (!pVoxelizer)
+	{
+		return false;
+	}
+	IncrementalVoxelContext* pContext = (IncrementalVoxelContext*)pVoxelizer;
+	GatherSectionIndices(m, &pContext->Indices);
+	if (numTriangles > 0)
+	{
+		pContext->Voxelizer.UpdateRange(m.Positions, pContext->Indices, firstTriangle, numTriangles);
+	}
+	else
+	{
+		pContext->Voxelizer.Update(m.Positions, pContext->Indices);
+	}
+	GetIncrementalVoxelStats(pContext->Voxelizer, outStats);
+	return true;
+}
+
+bool ENGINECALL Prelight::SaveIncrementalVoxelGrid(const void* pVoxelizer, const wchar_t* outGridPath) const
+{
+	if (!pVoxelizer || !outGridPath)
+	{
+		return false;
+	}
+	const IncrementalVoxelizer& voxelizer = ((const IncrementalVoxelContext*)pVoxelizer)->Voxelizer;
+	int nx, ny, nz;
+	voxelizer.GetGridSize(&nx, &ny, &nz);
+	return SaveSparseGrid(outGridPath, voxelizer.GetSolid(), nx, ny, nz);
+}
+
+void ENGINECALL Prelight::DeleteIncrementalVoxelizer(void* pVoxelizer) const
+{
+	delete (IncrementalVoxelContext*)pVoxelizer;
+}
+
+// 레이 쿼리용 솔리드 그리드 (메쉬에서 복셀화하거나 HVOX 파일에서 로드)
+struct VoxelGridContext
+{
+	GpuFriendlySparseGridFB Grid;
+	int N[3] = { 0,0,0 };
+};
+
+static void GetVoxelGridInfo(const VoxelGridContext& context, VoxelGridInfo* outInfo)
+{
+	if (!outInfo) return;
+	*outInfo = {};
+	outInfo->Nx = context.N[0]; outInfo->Ny = context.N[1]; outInfo->Nz = context.N[2];
+	outInfo->Cell = context.Grid.Cell;
+	outInfo->Origin = context.Grid.Origin;
+	outInfo->OccupiedVoxels = context.Grid.CountVoxels();
+}
+
+void* ENGINECALL Prelight::CreateVoxelGrid(const StaticMesh& m, const VoxelBudget& budget, VoxelGridInfo* outInfo) const
+{
+	VoxelPlan plan = {};
+	if (!PlanVoxelization(m, budget, &plan))
+	{
+		return nullptr;
+	}
+	std::vector<uint32_t> indices;
+	GatherSectionIndices(m, &indices);
+
+	VoxelGridContext* pContext = new VoxelGridContext;
+	VoxelizeStats stats = {};
+	VoxelizeToSparse(m.Positions, indices, m.MeshBounds, plan.Cell, &pContext->Grid, &stats);
+	pContext->N[0] = stats.Nx; pContext->N[1] = stats.Ny; pContext->N[2] = stats.Nz;
+	GetVoxelGridInfo(*pContext, outInfo);
+	return pContext;
+}
+
+void* ENGINECALL Prelight::LoadVoxelGrid(const wchar_t* gridPath, VoxelGridInfo* outInfo) const
+{
+	if (!gridPath)
+	{
+		return nullptr;
+	}
+	VoxelGridContext* pContext = new VoxelGridContext;
+	if (!LoadSparseGrid(gridPath, &pContext->Grid, &pContext->N[0], &pContext->N[1], &pContext->N[2]))
+	{
+		delete pContext;
+		return nullptr;
+	}
+	GetVoxelGridInfo(*pContext, outInfo);
+	return pContext;
+}
+
+void ENGINECALL Prelight::GetVoxelOccupancy(const void* pGrid, const int3* voxels, int count, uint8_t* outOccupied) const
+{
+	ASSERT(pGrid && voxels && outOccupied, "Input or output pointer is null.");
+	const GpuFriendlySparseGridFB& grid = ((const VoxelGridContext*)pGrid)->Grid;
+	for (int i = 0; i < count; ++i)
+	{
+		outOccupied[i] = grid.GetVoxelIndex(voxels[i].x, voxels[i].y, voxels[i].z) ? 1 : 0;
+	}
+}
+
+void ENGINECALL Prelight::RayFirstHitBatch(const void* pGrid, const VoxelRay* rays, int numRays, VoxelRayHit* outHits) const
+{
+	ASSERT(pGrid, "Voxel grid is null.");
+	::RayFirstHitBatch(((const VoxelGridContext*)pGrid)->Grid, rays, numRays, outHits);
+}
+
+void ENGINECALL Prelight::SegmentOccupancyBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numSegments, float* outOccupancy) const
+{
+	ASSERT(pGrid, "Voxel grid is null.");
+	::SegmentOccupancyBatch(((const VoxelGridContext*)pGrid)->Grid, from, to, numSegments, outOccupancy);
+}
+
+void ENGINECALL Prelight::VisibilityBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numPairs, float endBias, uint8_t* outVisible) const
+{
+	ASSERT(pGrid, "Voxel grid is null.");
+	::VisibilityBatch(((const VoxelGridContext*)pGrid)->Grid, from, to, numPairs, endBias, outVisible);
+}
+
+void ENGINECALL Prelight::DeleteVoxelGrid(void* pGrid) const
+{
+	delete (VoxelGridContext*)pGrid;
+}
@@ -10,7 +10,28 @@ public:
 	void ENGINECALL Cleanup() override;
 
 	bool ENGINECALL PrecomputeAtmos(const AtmosParams& in, AtmosResult* out) const override;
-	bool ENGINECALL DecomposeToConvex(const StaticMesh& m) const override;
+	bool ENGINECALL PrecomputeAtmosBatch(const AtmosParams* in, int count, AtmosResult* out) const override;
+	void* ENGINECALL CreateSkyViewContext(const AtmosParams& in) const override;
+	bool ENGINECALL UpdateSkyView(void* pSkyViewContext, const AtmosSkyViewParams& in, AtmosSkyViewResult* out) const override;
+	void ENGINECALL DeleteSkyViewContext(void* pSkyViewContext) const override;
+	void* ENGINECALL CreateAtmosSampler(const AtmosParams& in, const AtmosResult& lut) const override;
+	void ENGINECALL SampleAtmos(const void* pSampler, const FLOAT3& sunDir, const AtmosSampleQuery* queries, int count, AtmosSample* outSamples) const override;
+	void ENGINECALL ProjectSkyIrradianceSH(const void* pSampler, const FLOAT3& sunDir, const FLOAT3& posPlanetCoord, AtmosSkySH* outSH) const override;
+	void ENGINECALL DeleteAtmosSampler(void* pSampler) const override;
+	bool ENGINECALL PlanVoxelization(const StaticMesh& m, const VoxelBudget& budget, VoxelPlan* outPlan) const override;
+	bool ENGINECALL DecomposeToConvex(const StaticMesh& m, const VoxelBudget& budget) const override;
+	bool ENGINECALL VoxelizeStreaming(const wchar_t* stlPath, const wchar_t* outGridPath, const StreamingVoxelDesc& desc, StreamingVoxelStats* outStats) const override;
+	void* ENGINECALL CreateIncrementalVoxelizer(const StaticMesh& m, const VoxelBudget& budget, IncrementalVoxelStats* outStats) const override;
+	bool ENGINECALL UpdateIncrementalVoxelizer(void* pVoxelizer, const StaticMesh& m, int firstTriangle, int numTriangles, IncrementalVoxelStats* outStats) const override;
+	bool ENGINECALL SaveIncrementalVoxelGrid(const void* pVoxelizer, const wchar_t* outGridPath) const override;
+	void ENGINECALL DeleteIncrementalVoxelizer(void* pVoxelizer) const override;
+	void* ENGINECALL CreateVoxelGrid(const StaticMesh& m, const VoxelBudget& budget, VoxelGridInfo* outInfo) const override;
+	void* ENGINECALL LoadVoxelGrid(const wchar_t* gridPath, VoxelGridInfo* outInfo) const override;
+	void ENGINECALL GetVoxelOccupancy(const void* pGrid, const int3* voxels, int count, uint8_t* outOccupied) const override;
+	void ENGINECALL RayFirstHitBatch(const void* pGrid, const VoxelRay* rays, int numRays, VoxelRayHit* outHits) const override;
+	void ENGINECALL SegmentOccupancyBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numSegments, float* outOccupancy) const override;
+	void ENGINECALL VisibilityBatch(const void* pGrid, const FLOAT3* from, const FLOAT3* to, int numPairs, float endBias, uint8_t* outVisible) const override;
+	void ENGINECALL DeleteVoxelGrid(void* pGrid) const override;
 
 	// Internal methods
 	Prelight() = default;
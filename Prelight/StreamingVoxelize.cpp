@@ -0,0 +1,444 @@
+﻿#include "pch.h"
+#include "ConvexDecomposition.h"
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+// ===============================================================
+// Out-of-core 표면 복셀화 (바이너리 STL → HVOX)
+//  1) 매핑 view를 밀어가며 삼각형 스트리밍 → 메쉬 AABB
+//  2) 삼각형을 그리드 공간으로 바꿔 R^3 타일 영역 버킷에 분배
+//     (버킷마다 고정 크기 버퍼, 가득 차면 spill 파일에 청크로 덧붙임 → 청크 역방향 연결 리스트)
+//  3) 영역 하나씩: 버킷 청크를 읽어 영역 클립 박스로 SAT 복셀화 → 타일을 HVOX로 기록 후 비움
+// 상주 메모리 = view + 버킷 버퍼 + 청크 scratch + 영역 하나의 타일 (메쉬 크기와 무관)
+// Solid 채우기는 전역 flood fill이 필요하므로 여기서는 하지 않는다
+// ===============================================================
+
+static constexpr uint64_t DEFAULT_RESIDENT_BYTES = 256ull << 20;
+static constexpr uint64_t STL_HEADER_BYTES = 84;
+static constexpr uint64_t STL_TRIANGLE_BYTES = 50;
+static constexpr uint64_t MAX_VIEW_BYTES = 64ull << 20;
+static constexpr uint64_t MAX_BUCKET_TRIANGLES = 16384;
+
+namespace
+{
+	struct GridTriangle
+	{
+		FLOAT3 V[3]; // 그리드 공간
+	};
+
+	struct BucketChunkHeader
+	{
+		int64_t Prev;	// 같은 버킷의 이전 청크 오프셋 (-1 = 끝)
+		uint32_t Count;
+		uint32_t Reserved;
+	};
+
+	// ---------------------- 바이너리 STL 스트리밍 (sliding view) ----------------------
+	class MappedSTLReader
+	{
+	public:
+		~MappedSTLReader() { Close(); }
+
+		bool Open(const wchar_t* path, uint64_t viewBytes)
+		{
+			m_File = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (m_File == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_File, &size) || (uint64_t)size.QuadPart < STL_HEADER_BYTES)
+			{
+				return false;
+			}
+			m_FileSize = (uint64_t)size.QuadPart;
+
+			m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!m_Mapping)
+			{
+				return false;
+			}
+
+			SYSTEM_INFO si;
+			GetSystemInfo(&si);
+			m_Granularity = si.dwAllocationGranularity;
+			// view 하나에 최소 삼각형 하나는 들어가야 한다 (시작 오프셋 정렬로 최대 granularity만큼 손해)
+			m_ViewBytes = std::max<uint64_t>(viewBytes / m_Granularity * m_Granularity, 2 * m_Granularity);
+
+			const void* head = MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, (SIZE_T)STL_HEADER_BYTES);
+			if (!head)
+			{
+				return false;
+			}
+			uint32_t count;
+			memcpy(&count, (const uint8_t*)head + 80, sizeof(count));
+			UnmapViewOfFile(head);
+
+			m_NumTriangles = count;
+			if (STL_HEADER_BYTES + m_NumTriangles * STL_TRIANGLE_BYTES > m_FileSize)
+			{
+				std::cerr << "[Prelight] VoxelizeStreamingSTL: input is not a binary STL (ASCII STL is not supported)." << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+		void Close()
+		{
+			if (m_Mapping) { CloseHandle(m_Mapping); m_Mapping = nullptr; }
+			if (m_File != INVALID_HANDLE_VALUE) { CloseHandle(m_File); m_File = INVALID_HANDLE_VALUE; }
+		}
+
+		uint64_t GetTriangleCount() const { return m_NumTriangles; }
+		uint64_t GetViewBytes() const { return m_ViewBytes; }
+
+		// f(const FLOAT3 v[3]) → false 반환 시 중단
+		template<class F>
+		bool ForEachTriangle(F&& f) const
+		{
+			uint64_t tri = 0;
+			while (tri < m_NumTriangles)
+			{
+				const uint64_t begin = STL_HEADER_BYTES + tri * STL_TRIANGLE_BYTES;
+				const uint64_t mapStart = begin / m_Granularity * m_Granularity;
+				const uint64_t mapEnd = std::min(m_FileSize, mapStart + m_ViewBytes);
+				const uint64_t numInView = std::min((mapEnd - begin) / STL_TRIANGLE_BYTES, m_NumTriangles - tri);
+
+				const void* view = MapViewOfFile(m_Mapping, FILE_MAP_READ, (DWORD)(mapStart >> 32), (DWORD)(mapStart & 0xFFFFFFFFull), (SIZE_T)(mapEnd - mapStart));
+				if (!view)
+				{
+					return false;
+				}
+				const uint8_t* p = (const uint8_t*)view + (begin - mapStart);
+				for (uint64_t i = 0; i < numInView; ++i, p += STL_TRIANGLE_BYTES)
+				{
+					float f32[12]; // normal + v0 + v1 + v2
+					memcpy(f32, p, sizeof(f32));
+					const FLOAT3 v[3] = { { f32[3], f32[4], f32[5] }, { f32[6], f32[7], f32[8] }, { f32[9], f32[10], f32[11] } };
+					if (!f(v))
+					{
+						UnmapViewOfFile(view);
+						return false;
+					}
+				}
+				UnmapViewOfFile(view);
+				tri += numInView;
+			}
+			return true;
+		}
+
+	private:
+		HANDLE m_File = INVALID_HANDLE_VALUE;
+		HANDLE m_Mapping = nullptr;
+		uint64_t m_FileSize = 0;
+		uint64_t m_ViewBytes = 0;
+		uint64_t m_Granularity = 65536;
+		uint64_t m_NumTriangles = 0;
+	};
+
+	// ---------------------- 디스크 버킷 ----------------------
+	class BucketSpill
+	{
+	public:
+		bool Open(const std::filesystem::path& path, size_t numBuckets, size_t trianglesPerBuffer)
+		{
+			m_Path = path;
+			m_File.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+			if (!m_File)
+			{
+				return false;
+			}
+			m_PerBuffer = trianglesPerBuffer;
+			m_Buffers.resize(numBuckets * trianglesPerBuffer);
+			m_Counts.assign(numBuckets, 0);
+			m_Heads.assign(numBuckets, -1);
+			m_End = 0;
+			return true;
+		}
+
+		void CloseAndDelete()
+		{
+			if (m_File.is_open()) m_File.close();
+			std::error_code ec;
+			std::filesystem::remove(m_Path, ec);
+		}
+
+		bool Append(size_t bucket, const GridTriangle& tri)
+		{
+			m_Buffers[bucket * m_PerBuffer + m_Counts[bucket]] = tri;
+			if (++m_Counts[bucket] == m_PerBuffer)
+			{
+				return flush(bucket);
+			}
+			return true;
+		}
+
+		bool FlushAll()
+		{
+			for (size_t b = 0; b < m_Counts.size(); ++b)
+			{
+				if (m_Counts[b] > 0 && !flush(b)) return false;
+			}
+			m_File.flush();
+			return (bool)m_File;
+		}
+
+		bool IsEmpty(size_t bucket) const { return m_Heads[bucket] < 0; }
+
+		// 버킷의 청크를 순서대로 읽어 f(const GridTriangle*, count) 호출. scratch는 청크 하나 크기로 제한
+		template<class F>
+		bool ForEachChunk(size_t bucket, std::vector<GridTriangle>& scratch, F&& f)
+		{
+			int64_t offset = m_Heads[bucket];
+			while (offset >= 0)
+			{
+				BucketChunkHeader header;
+				m_File.seekg(offset, std::ios::beg);
+				m_File.read(reinterpret_cast<char*>(&header), sizeof(header));
+				scratch.resize(header.Count);
+				m_File.read(reinterpret_cast<char*>(scratch.data()), sizeof(GridTriangle) * header.Count);
+				if (!m_File)
+				{
+					return false;
+				}
+				f(scratch.data(), (size_t)header.Count);
+				offset = header.Prev;
+			}
+			return true;
+		}
+
+		uint64_t ResidentBytes() const
+		{
+			return m_Buffers.capacity() * sizeof(GridTriangle) + m_Counts.capacity() * sizeof(size_t) + m_Heads.capacity() * sizeof(int64_t);
+		}
+
+	private:
+		bool flush(size_t bucket)
+		{
+			BucketChunkHeader header = {};
+			header.Prev = m_Heads[bucket];
+			header.Count = (uint32_t)m_Counts[bucket];
+			m_File.seekp(m_End, std::ios::beg);
+			m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			m_File.write(reinterpret_cast<const char*>(&m_Buffers[bucket * m_PerBuffer]), sizeof(GridTriangle) * header.Count);
+			m_Heads[bucket] = m_End;
+			m_End += (int64_t)(sizeof(header) + sizeof(GridTriangle) * header.Count);
+			m_Counts[bucket] = 0;
+			return (bool)m_File;
+		}
+
+		std::filesystem::path m_Path;
+		std::fstream m_File;
+		size_t m_PerBuffer = 0;
+		std::vector<GridTriangle> m_Buffers;	// 버킷별 고정 크기 버퍼 (bucket * m_PerBuffer)
+		std::vector<size_t> m_Counts;
+		std::vector<int64_t> m_Heads;			// 마지막 청크 오프셋
+		int64_t m_End = 0;
+	};
+
+	// VoxelizeTriangleSAT와 같은 복셀 범위 (그리드 밖은 클램프)
+	void TriangleVoxelRange(const GridTriangle& t, const int n[3], int lo[3], int hi[3])
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			const float mn = std::min(t.V[0][k], std::min(t.V[1][k], t.V[2][k]));
+			const float mx = std::max(t.V[0][k], std::max(t.V[1][k], t.V[2][k]));
+			lo[k] = std::max((int)std::floor(mn - 0.5f) - 1, 0);
+			hi[k] = std::min((int)std::ceil(mx + 0.5f) + 1, n[k] - 1);
+		}
+	}
+}
+
+bool VoxelizeStreamingSTL(
+	const wchar_t* stlPath,
+	const wchar_t* outGridPath,
+	const StreamingVoxelDesc& desc,
+	StreamingVoxelStats* outStats)
+{
+	ASSERT(stlPath && outGridPath, "Path is null.");
+	using Clock = std::chrono::steady_clock;
+
+	StreamingVoxelStats stats = {};
+	const uint64_t budget = (desc.MaxResidentBytes > 0) ? desc.MaxResidentBytes : DEFAULT_RESIDENT_BYTES;
+	const float cell = desc.Cell;
+	if (!(cell > 0.0f))
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: invalid cell size." << std::endl;
+		return false;
+	}
+
+	MappedSTLReader reader;
+	if (!reader.Open(stlPath, std::min<uint64_t>(budget / 8, MAX_VIEW_BYTES)))
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: failed to open input." << std::endl;
+		return false;
+	}
+	stats.Triangles = reader.GetTriangleCount();
+
+	// ---------------------- 1) Bounds ----------------------
+	const auto t0 = Clock::now();
+	Bounds meshBounds;
+	reader.ForEachTriangle([&](const FLOAT3 v[3]) -> bool
+		{
+			meshBounds.Encapsulate(v[0]);
+			meshBounds.Encapsulate(v[1]);
+			meshBounds.Encapsulate(v[2]);
+			return true;
+		});
+	if (stats.Triangles == 0)
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: no triangles." << std::endl;
+		return false;
+	}
+
+	FLOAT3 origin;
+	int n[3];
+	ComputeVoxelGridLayout(meshBounds, cell, &origin, &n[0], &n[1], &n[2]);
+	stats.Nx = n[0]; stats.Ny = n[1]; stats.Nz = n[2];
+
+	// ---------------------- 메모리 배분 ----------------------
+	// 영역 타일: 예산의 절반 (타일 + 해시 + vector 성장 여유로 타일당 ~2.5배)
+	const uint64_t perTileBytes = sizeof(TileCPU) * 5 / 2;
+	int regionTiles = std::max(1, (int)std::cbrt((double)(budget / 2) / (double)perTileBytes));
+	int numTiles[3], numRegions[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		numTiles[k] = (n[k] + TileCPU::T - 1) / TileCPU::T;
+	}
+	regionTiles = std::min(regionTiles, std::max(numTiles[0], std::max(numTiles[1], numTiles[2])));
+	for (int k = 0; k < 3; ++k)
+	{
+		numRegions[k] = (numTiles[k] + regionTiles - 1) / regionTiles;
+	}
+	const size_t totalRegions = (size_t)numRegions[0] * numRegions[1] * numRegions[2];
+	stats.RegionTiles = regionTiles;
+
+	// 버킷 버퍼: 나머지 (view, 영역 타일 제외)를 버킷 수로 나누고, 청크 scratch 하나만큼 남긴다
+	const uint64_t regionBytes = (uint64_t)regionTiles * regionTiles * regionTiles * perTileBytes;
+	const uint64_t fixedBytes = reader.GetViewBytes() + regionBytes + totalRegions * (sizeof(size_t) + sizeof(int64_t));
+	if (fixedBytes >= budget)
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: MaxResidentBytes is too small for this grid." << std::endl;
+		return false;
+	}
+	const size_t trianglesPerBuffer = (size_t)std::min<uint64_t>(MAX_BUCKET_TRIANGLES,
+		(budget - fixedBytes) / ((uint64_t)(totalRegions + 1) * sizeof(GridTriangle)));
+	if (trianglesPerBuffer == 0)
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: MaxResidentBytes is too small for " << totalRegions << " buckets." << std::endl;
+		return false;
+	}
+
+	// ---------------------- 2) Bin ----------------------
+	const auto t1 = Clock::now();
+	const std::filesystem::path spillPath = desc.TempPath
+		? std::filesystem::path(desc.TempPath)
+		: std::filesystem::path(outGridPath).concat(L".bins");
+	BucketSpill buckets;
+	if (!buckets.Open(spillPath, totalRegions, trianglesPerBuffer))
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: failed to create bucket file." << std::endl;
+		return false;
+	}
+
+	const int regionVoxels = regionTiles * TileCPU::T;
+	bool bOk = reader.ForEachTriangle([&](const FLOAT3 v[3]) -> bool
+		{
+			GridTriangle tri;
+			for (int i = 0; i < 3; ++i)
+			{
+				// VoxelizeToSparse와 같은 식 (나눗셈) → 메모리 내 복셀화와 비트 단위로 같은 결과
+				tri.V[i] = FLOAT3{ (v[i].x - origin.x) / cell, (v[i].y - origin.y) / cell, (v[i].z - origin.z) / cell };
+			}
+			int lo[3], hi[3];
+			TriangleVoxelRange(tri, n, lo, hi);
+			for (int rz = lo[2] / regionVoxels; rz <= hi[2] / regionVoxels; ++rz)
+			{
+				for (int ry = lo[1] / regionVoxels; ry <= hi[1] / regionVoxels; ++ry)
+				{
+					for (int rx = lo[0] / regionVoxels; rx <= hi[0] / regionVoxels; ++rx)
+					{
+						const size_t bucket = ((size_t)rz * numRegions[1] + (size_t)ry) * numRegions[0] + (size_t)rx;
+						if (!buckets.Append(bucket, tri)) return false;
+						++stats.BinnedTriangles;
+					}
+				}
+			}
+			return true;
+		});
+	bOk = bOk && buckets.FlushAll();
+	reader.Close();
+	if (!bOk)
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: binning failed." << std::endl;
+		buckets.CloseAndDelete();
+		return false;
+	}
+
+	// ---------------------- 3) 영역별 복셀화 ----------------------
+	const auto t2 = Clock::now();
+	VoxelGridWriter writer;
+	if (!writer.Open(outGridPath, cell, origin, n[0], n[1], n[2]))
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: failed to create output." << std::endl;
+		buckets.CloseAndDelete();
+		return false;
+	}
+
+	GpuFriendlySparseGridFB region(cell, origin);
+	std::vector<GridTriangle> scratch;
+	scratch.reserve(trianglesPerBuffer);
+	uint64_t peakRegionBytes = 0;
+	for (int rz = 0; rz < numRegions[2] && bOk; ++rz)
+	{
+		for (int ry = 0; ry < numRegions[1] && bOk; ++ry)
+		{
+			for (int rx = 0; rx < numRegions[0] && bOk; ++rx)
+			{
+				const size_t bucket = ((size_t)rz * numRegions[1] + (size_t)ry) * numRegions[0] + (size_t)rx;
+				if (buckets.IsEmpty(bucket)) continue;
+
+				const int clipMin[3] = { rx * regionVoxels, ry * regionVoxels, rz * regionVoxels };
+				const int clipMax[3] =
+				{
+					std::min(clipMin[0] + regionVoxels, n[0]) - 1,
+					std::min(clipMin[1] + regionVoxels, n[1]) - 1,
+					std::min(clipMin[2] + regionVoxels, n[2]) - 1,
+				};
+
+				region.Clear();
+				bOk = buckets.ForEachChunk(bucket, scratch, [&](const GridTriangle* tris, size_t count)
+					{
+						for (size_t i = 0; i < count; ++i)
+						{
+							VoxelizeTriangleSAT(tris[i].V[0], tris[i].V[1], tris[i].V[2], clipMin, clipMax, region);
+						}
+					});
+
+				region.forEachTile([&](uint64_t, int tileIdx, int tx, int ty, int tz)
+					{
+						bOk = bOk && writer.WriteTile(tx, ty, tz, region.TileVector[(size_t)tileIdx]);
+					});
+				stats.SurfaceVoxels += region.CountVoxels();
+				peakRegionBytes = std::max<uint64_t>(peakRegionBytes, region.MemoryBytes());
+				++stats.Regions;
+			}
+		}
+	}
+	bOk = writer.Close() && bOk;
+	const auto t3 = Clock::now();
+
+	stats.Tiles = writer.GetTileCount();
+	stats.PeakResidentBytes = reader.GetViewBytes() + buckets.ResidentBytes() + scratch.capacity() * sizeof(GridTriangle) + peakRegionBytes;
+	stats.BoundsMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+	stats.BinMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+	stats.VoxelizeMs = std::chrono::duration<double, std::milli>(t3 - t2).count();
+	buckets.CloseAndDelete();
+
+	if (outStats) *outStats = stats;
+	if (!bOk)
+	{
+		std::cerr << "[Prelight] VoxelizeStreamingSTL: voxelization failed." << std::endl;
+	}
+	return bOk;
+}
@@ -0,0 +1,126 @@
+﻿#include "pch.h"
+#include "ConvexDecomposition.h"
+#include <filesystem>
+// ===============================================================
+// HVOX 바이너리 그리드 입출력
+// - 헤더 + 타일 레코드 나열 (빈 BITSET 타일은 기록하지 않음)
+// - FULL 타일은 레코드 헤더만, BITSET 타일은 512 워드를 그대로 기록
+// ===============================================================
+
+bool VoxelGridWriter::Open(const wchar_t* path, float cell, const FLOAT3& origin, int nx, int ny, int nz)
+{
+	m_File.open(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+	if (!m_File)
+	{
+		return false;
+	}
+
+	m_Header = VoxelGridFileHeader{};
+	m_Header.Cell = cell;
+	m_Header.Origin[0] = origin.x; m_Header.Origin[1] = origin.y; m_Header.Origin[2] = origin.z;
+	m_Header.Nx = nx; m_Header.Ny = ny; m_Header.Nz = nz;
+	m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+	return (bool)m_File;
+}
+
+bool VoxelGridWriter::WriteTile(int tx, int ty, int tz, const TileCPU& tile)
+{
+	if (tile.Mode == TileCPU::BITSET && tile.Count == 0)
+	{
+		return true;
+	}
+
+	VoxelGridFileTile rec = {};
+	rec.Tx = tx; rec.Ty = ty; rec.Tz = tz;
+	rec.Mode = (uint16_t)tile.Mode;
+	rec.Count = tile.Count;
+	m_File.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+	if (tile.Mode == TileCPU::BITSET)
+	{
+		m_File.write(reinterpret_cast<const char*>(tile.Bits.data()), sizeof(uint64_t) * TileCPU::BITSET_WORDS);
+	}
+	++m_Header.TileCount;
+	return (bool)m_File;
+}
+
+bool VoxelGridWriter::Close()
+{
+	if (!m_File.is_open())
+	{
+		return false;
+	}
+	m_File.seekp(0, std::ios::beg);
+	m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+	const bool bOk = (bool)m_File;
+	m_File.close();
+	return bOk;
+}
+
+bool SaveSparseGrid(const wchar_t* path, const GpuFriendlySparseGridFB& grid, int nx, int ny, int nz)
+{
+	VoxelGridWriter writer;
+	if (!writer.Open(path, grid.Cell, grid.Origin, nx, ny, nz))
+	{
+		return false;
+	}
+	bool bOk = true;
+	grid.forEachTile([&](uint64_t, int tileIdx, int tx, int ty, int tz)
+		{
+			bOk = bOk && writer.WriteTile(tx, ty, tz, grid.TileVector[(size_t)tileIdx]);
+		});
+	return writer.Close() && bOk;
+}
+
+bool LoadSparseGrid(const wchar_t* path, GpuFriendlySparseGridFB* outGrid, int* outNx, int* outNy, int* outNz)
+{
+	ASSERT(outGrid, "Output pointer is null.");
+	std::ifstream ifs(std::filesystem::path(path), std::ios::binary);
+	if (!ifs)
+	{
+		return false;
+	}
+
+	VoxelGridFileHeader header;
+	ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!ifs || header.Magic != VoxelGridFileHeader::MAGIC || header.Version != VoxelGridFileHeader::VERSION)
+	{
+		std::cerr << "[Prelight] LoadSparseGrid: not a HVOX v" << VoxelGridFileHeader::VERSION << " file." << std::endl;
+		return false;
+	}
+
+	outGrid->Clear();
+	outGrid->Reconfigure(header.Cell, FLOAT3{ header.Origin[0], header.Origin[1], header.Origin[2] });
+	for (uint32_t i = 0; i < header.TileCount; ++i)
+	{
+		VoxelGridFileTile rec;
+		ifs.read(reinterpret_cast<char*>(&rec), sizeof(rec));
+		if (!ifs)
+		{
+			return false;
+		}
+
+		// 빈 타일을 만든 뒤 내용을 통째로 채운다
+		const int x0 = rec.Tx * TileCPU::T, y0 = rec.Ty * TileCPU::T, z0 = rec.Tz * TileCPU::T;
+		outGrid->SetVoxelIndex(x0, y0, z0, false);
+		TileCPU& tile = outGrid->TileVector[(size_t)outGrid->findTileIndex(rec.Tx, rec.Ty, rec.Tz)];
+		tile.Mode = (rec.Mode == TileCPU::FULL) ? TileCPU::FULL : TileCPU::BITSET;
+		tile.Count = rec.Count;
+		if (tile.Mode == TileCPU::BITSET)
+		{
+			ifs.read(reinterpret_cast<char*>(tile.Bits.data()), sizeof(uint64_t) * TileCPU::BITSET_WORDS);
+			if (!ifs)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			tile.Bits = {};
+		}
+	}
+
+	if (outNx) *outNx = header.Nx;
+	if (outNy) *outNy = header.Ny;
+	if (outNz) *outNz = header.Nz;
+	return true;
+}
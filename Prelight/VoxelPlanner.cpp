@@ -0,0 +1,278 @@
+﻿// ============================================================================
+// 복셀 크기 플래너 (CPU)
+//  - 메쉬 AABB, 표면적, 저해상도(coarse) 사전 복셀화로 내부 부피/표면 복셀 밀도/단가를 보정
+//  - 목표 복셀 수 또는 메모리 예산을 만족하는 가장 작은 셀 크기를 로그 공간 이분 탐색
+//  - 예측 복셀 수, 타일 수, 피크 메모리, 소요 시간을 실제 실행 전에 보고
+// ============================================================================
+
+#include "pch.h"
+#include "ConvexDecomposition.h"
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+static constexpr int COARSE_RESOLUTION = 48;					// coarse pass 최장축 셀 수
+static constexpr uint64_t DEFAULT_TARGET_VOXELS = 1ull << 21;	// 예산 미지정 시 목표 복셀 수
+static constexpr int PLANNER_ITERATIONS = 40;					// 이분 탐색 반복 수
+
+// coarse pass에서 얻은 보정값
+struct CoarseCalibration
+{
+	double SolidVolume = 0.0;		// 추정 내부 부피 (mesh unit^3). 닫힌 내부가 없으면 (얇은 껍질) 0
+	double SurfaceDensity = 1.5;	// 표면 복셀 수 * cell^2 / area (보수적 SAT 복셀화는 ~1.5)
+	double NsPerSatTest = 0.0;		// 표면 복셀화 단가
+	double NsPerFillCell = 0.0;		// Solid 채우기 단가 (dense 셀당)
+};
+
+struct VoxelPrediction
+{
+	int Nx = 0, Ny = 0, Nz = 0;
+	uint64_t SurfaceVoxels = 0;
+	uint64_t SolidVoxels = 0;		// 표면 껍질 포함 (VoxelizeToSparse의 Solid 그리드와 같은 기준)
+	uint64_t Tiles = 0;
+	uint64_t Bytes = 0;
+};
+
+static uint64_t NextPow2(uint64_t v)
+{
+	uint64_t p = 1;
+	while (p < v) p <<= 1;
+	return p;
+}
+
+// 해시 테이블(load factor <= 0.5) + 타일 배열 메모리
+static uint64_t SparseGridBytes(uint64_t tiles)
+{
+	const uint64_t capacity = std::max<uint64_t>(256, NextPow2(tiles * 2));
+	return tiles * sizeof(TileCPU) + capacity * (sizeof(uint64_t) + sizeof(int));
+}
+
+// 표면 그리드 타일 하나에 붙는 속성 페이지 바이트 (VoxelAttributeChannel, coverage는 속성이 하나라도 켜지면 항상 기록)
+static uint64_t AttributePageBytes(uint32_t attributeMask)
+{
+	if (attributeMask == VOXEL_ATTR_NONE)
+	{
+		return 0;
+	}
+	uint64_t bytesPerVoxel = sizeof(uint8_t);
+	if (attributeMask & VOXEL_ATTR_NORMAL) bytesPerVoxel += sizeof(uint16_t);
+	if (attributeMask & VOXEL_ATTR_MATERIAL) bytesPerVoxel += 2 * sizeof(uint16_t); // ID + 다수결 가중치
+	return bytesPerVoxel * TileCPU::TILE_VOXELS;
+}
+
+// 섹션별 삼각형 면적 (표면 그리드는 섹션마다 따로 만들어진다)
+static std::vector<double> SumTriangleArea(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<const std::vector<uint32_t>*>& sectionIndices)
+{
+	std::vector<double> areas;
+	areas.reserve(sectionIndices.size());
+	for (const std::vector<uint32_t>* indices : sectionIndices)
+	{
+		double area = 0.0;
+		for (size_t i = 0; i + 2 < indices->size(); i += 3)
+		{
+			const FLOAT3& a = vertices[(*indices)[i + 0]];
+			const FLOAT3& b = vertices[(*indices)[i + 1]];
+			const FLOAT3& c = vertices[(*indices)[i + 2]];
+			area += 0.5 * (double)FLOAT3::Cross(b - a, c - a).Magnitude();
+		}
+		areas.push_back(area);
+	}
+	return areas;
+}
+
+// VoxelizeSurface_SAT_ToSparse와 같은 범위로 SAT 호출 수를 계산 (복셀화 없이 O(삼각형))
+static uint64_t CountSatTests(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<const std::vector<uint32_t>*>& sectionIndices,
+	const FLOAT3& origin, float cell,
+	int nx, int ny, int nz)
+{
+	uint64_t tests = 0;
+	const float inv = 1.0f / cell;
+	for (const std::vector<uint32_t>* indices : sectionIndices)
+	{
+		for (size_t i = 0; i + 2 < indices->size(); i += 3)
+		{
+			const FLOAT3& a = vertices[(*indices)[i + 0]];
+			const FLOAT3& b = vertices[(*indices)[i + 1]];
+			const FLOAT3& c = vertices[(*indices)[i + 2]];
+
+			int lo[3], hi[3];
+			const int n[3] = { nx, ny, nz };
+			for (int k = 0; k < 3; ++k)
+			{
+				const float pa = (a[k] - origin[k]) * inv;
+				const float pb = (b[k] - origin[k]) * inv;
+				const float pc = (c[k] - origin[k]) * inv;
+				lo[k] = std::max((int)std::floor(std::min(pa, std::min(pb, pc)) - 0.5f) - 1, 0);
+				hi[k] = std::min((int)std::ceil(std::max(pa, std::max(pb, pc)) + 0.5f) + 1, n[k] - 1);
+			}
+			tests += (uint64_t)std::max(0, hi[0] - lo[0] + 1) * (uint64_t)std::max(0, hi[1] - lo[1] + 1) * (uint64_t)std::max(0, hi[2] - lo[2] + 1);
+		}
+	}
+	return tests;
+}
+
+static VoxelPrediction Predict(
+	const CoarseCalibration& cal,
+	const Bounds& meshBounds,
+	const std::vector<double>& sectionAreas,
+	uint32_t attributeMask,
+	float cell)
+{
+	VoxelPrediction p;
+	FLOAT3 origin;
+	ComputeVoxelGridLayout(meshBounds, cell, &origin, &p.Nx, &p.Ny, &p.Nz);
+
+	double area = 0.0;
+	for (double a : sectionAreas) area += a;
+
+	// Solid 그리드는 표면 껍질을 포함한다. 껍질 복셀은 평균적으로 절반이 내부 부피에 걸치므로
+	// Solid ≈ 내부 부피 / cell^3 + 표면 / 2, 닫힌 내부가 없으면 표면 수가 하한
+	const double c = (double)cell;
+	const double surface = cal.SurfaceDensity * area / (c * c);
+	const double solid = std::max(surface, cal.SolidVolume / (c * c * c) + 0.5 * surface);
+	p.SurfaceVoxels = (uint64_t)surface;
+	p.SolidVoxels = (uint64_t)solid;
+
+	// 타일: 표면이 지나가는 타일 + 내부를 채우는 타일 (바운딩 타일 수로 상한)
+	const double tileEdge = c * TileCPU::T;
+	const uint64_t boundingTiles =
+		(uint64_t)((p.Nx + TileCPU::T - 1) / TileCPU::T) *
+		(uint64_t)((p.Ny + TileCPU::T - 1) / TileCPU::T) *
+		(uint64_t)((p.Nz + TileCPU::T - 1) / TileCPU::T);
+	auto surfaceTilesOf = [&](double a) { return std::min(boundingTiles, (uint64_t)std::ceil(cal.SurfaceDensity * a / (tileEdge * tileEdge))); };
+	const uint64_t surfaceTiles = surfaceTilesOf(area);
+	const uint64_t solidTiles = std::min(boundingTiles, (uint64_t)std::ceil(cal.SolidVolume / (tileEdge * tileEdge * tileEdge)) + surfaceTiles);
+	p.Tiles = surfaceTiles + solidTiles;
+
+	// 표면 그리드: 속성을 기록하면 섹션마다 (타일 + 속성 페이지)가 끝까지 남고,
+	// 아니면 복셀화 중인 섹션 하나의 임시 그리드만 살아 있다
+	const uint64_t pageBytes = AttributePageBytes(attributeMask);
+	uint64_t surfaceBytes = 0;
+	for (double a : sectionAreas)
+	{
+		const uint64_t tiles = surfaceTilesOf(a);
+		const uint64_t bytes = SparseGridBytes(tiles) + tiles * pageBytes;
+		surfaceBytes = (attributeMask != VOXEL_ATTR_NONE) ? surfaceBytes + bytes : std::max(surfaceBytes, bytes);
+	}
+
+	// 피크 메모리: 섹션 하나의 dense outside 마스크 + BFS 프런티어 + 표면 그리드 + (모든 섹션의) Solid 그리드
+	const uint64_t cells = (uint64_t)p.Nx * (uint64_t)p.Ny * (uint64_t)p.Nz;
+	const uint64_t frontier = 2ull * ((uint64_t)p.Nx * p.Ny + (uint64_t)p.Ny * p.Nz + (uint64_t)p.Nz * p.Nx) * sizeof(int3);
+	p.Bytes = cells * sizeof(uint8_t) + frontier + surfaceBytes + SparseGridBytes(solidTiles) + (uint64_t)(sectionAreas.size() - 1) * SparseGridBytes(0);
+	return p;
+}
+
+bool PlanVoxelSize(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<const std::vector<uint32_t>*>& sectionIndices,
+	const Bounds& meshBounds,
+	const VoxelBudget& budget,
+	VoxelPlan* outPlan)
+{
+	ASSERT(outPlan, "Output pointer is null.");
+	if (vertices.empty() || sectionIndices.empty())
+	{
+		return false;
+	}
+
+	const FLOAT3 size = meshBounds.Size();
+	const float maxExtent = std::max(size.x, std::max(size.y, size.z));
+	if (!(maxExtent > 0.0f))
+	{
+		std::cerr << "[Prelight] PlanVoxelSize: degenerate mesh bounds." << std::endl;
+		return false;
+	}
+
+	const std::vector<double> sectionAreas = SumTriangleArea(vertices, sectionIndices);
+	double area = 0.0;
+	for (double a : sectionAreas) area += a;
+
+	// ---------------------- Coarse pre-voxelization ----------------------
+	const float coarseCell = maxExtent / (float)COARSE_RESOLUTION;
+	CoarseCalibration cal;
+	{
+		uint64_t surfaceVoxels = 0, solidVoxels = 0, satTests = 0, fillCells = 0;
+		double surfaceMs = 0.0, fillMs = 0.0;
+		GpuFriendlySparseGridFB coarseSolid;
+		for (const std::vector<uint32_t>* indices : sectionIndices)
+		{
+			VoxelizeStats stats;
+			VoxelizeToSparse(vertices, *indices, meshBounds, coarseCell, &coarseSolid, &stats);
+			surfaceVoxels += stats.SurfaceVoxels;
+			solidVoxels += stats.SolidVoxels;
+			satTests += stats.SatTests;
+			fillCells += (uint64_t)stats.Nx * stats.Ny * stats.Nz;
+			surfaceMs += stats.SurfaceMs;
+			fillMs += stats.FillMs;
+		}
+
+		const double c = (double)coarseCell;
+		// solidVoxels는 이미 표면 껍질을 포함한다. 껍질은 평균적으로 절반만 내부에 걸치므로 절반을 뺀다.
+		// 껍질 말고 채워진 복셀이 없으면 (열린 메쉬, 얇은 판) 내부 부피는 0
+		cal.SolidVolume = (solidVoxels > surfaceVoxels) ? ((double)solidVoxels - 0.5 * (double)surfaceVoxels) * c * c * c : 0.0;
+		if (area > 0.0 && surfaceVoxels > 0)
+		{
+			cal.SurfaceDensity = (double)surfaceVoxels * c * c / area;
+		}
+		cal.NsPerSatTest = (satTests > 0) ? surfaceMs * 1e6 / (double)satTests : 0.0;
+		cal.NsPerFillCell = (fillCells > 0) ? fillMs * 1e6 / (double)fillCells : 0.0;
+	}
+
+	// ---------------------- Budget search ----------------------
+	const uint64_t targetVoxels = (budget.TargetVoxelCount == 0 && budget.MaxBytes == 0)
+		? DEFAULT_TARGET_VOXELS : budget.TargetVoxelCount;
+	auto fits = [&](const VoxelPrediction& p) -> bool
+		{
+			if (targetVoxels > 0 && p.SolidVoxels > targetVoxels) return false;
+			if (budget.MaxBytes > 0 && p.Bytes > budget.MaxBytes) return false;
+			return true;
+		};
+
+	// 예측치는 셀 크기에 대해 단조 감소 → 로그 공간에서 가장 작은 feasible 셀을 찾는다
+	double logLo = std::log((double)maxExtent / 8192.0);
+	double logHi = std::log((double)maxExtent);
+	if (!fits(Predict(cal, meshBounds, sectionAreas, budget.AttributeMask, (float)std::exp(logHi))))
+	{
+		std::cerr << "[Prelight] PlanVoxelSize: budget cannot be met, using a single-cell grid." << std::endl;
+		logLo = logHi;
+	}
+	for (int it = 0; it < PLANNER_ITERATIONS && logHi - logLo > 1e-4; ++it)
+	{
+		const double mid = 0.5 * (logLo + logHi);
+		if (fits(Predict(cal, meshBounds, sectionAreas, budget.AttributeMask, (float)std::exp(mid))))
+		{
+			logHi = mid;
+		}
+		else
+		{
+			logLo = mid;
+		}
+	}
+
+	float cell = (float)std::exp(logHi);
+	if (budget.MinCell > 0.0f) cell = std::max(cell, budget.MinCell);
+	if (budget.MaxCell > 0.0f) cell = std::min(cell, budget.MaxCell);
+
+	// ---------------------- Report ----------------------
+	const VoxelPrediction p = Predict(cal, meshBounds, sectionAreas, budget.AttributeMask, cell);
+	FLOAT3 origin;
+	int nx, ny, nz;
+	ComputeVoxelGridLayout(meshBounds, cell, &origin, &nx, &ny, &nz);
+	const uint64_t satTests = CountSatTests(vertices, sectionIndices, origin, cell, nx, ny, nz);
+	const double fillCells = (double)nx * ny * nz * (double)sectionIndices.size();
+
+	outPlan->Cell = cell;
+	outPlan->Nx = p.Nx; outPlan->Ny = p.Ny; outPlan->Nz = p.Nz;
+	outPlan->SurfaceArea = (float)area;
+	outPlan->SolidVolume = (float)cal.SolidVolume;
+	outPlan->PredictedSurfaceVoxels = p.SurfaceVoxels;
+	outPlan->PredictedSolidVoxels = p.SolidVoxels;
+	outPlan->PredictedTiles = p.Tiles;
+	outPlan->PredictedBytes = p.Bytes;
+	outPlan->PredictedMs = (cal.NsPerSatTest * (double)satTests + cal.NsPerFillCell * fillCells) * 1e-6;
+	return true;
+}
@@ -0,0 +1,313 @@
+﻿#include "pch.h"
+#include "ConvexDecomposition.h"
+#include <bit>
+#include <climits>
+// ===============================================================
+// Ray queries over GpuFriendlySparseGridFB (hierarchical 3D-DDA)
+// - 없는 타일 / 빈 BITSET 타일 → 32^3 박스째 건너뜀
+// - FULL 타일 → 타일 박스 전체를 하나의 점유 구간으로 처리
+// - BITSET 타일: 64비트 워드(32x2x1)가 0이면 블록째 건너뜀,
+//   아니면 레이가 지나는 x행 구간을 비트마스크로 한 번에 검사
+// ===============================================================
+
+namespace
+{
+	// 타일이 존재하는 복셀 공간 범위 [Lo, Hi)
+	struct GridExtent
+	{
+		int Lo[3] = { 0,0,0 };
+		int Hi[3] = { 0,0,0 };
+		bool bEmpty = true;
+	};
+
+	GridExtent ComputeGridExtent(const GpuFriendlySparseGridFB& grid)
+	{
+		GridExtent ext;
+		int tmin[3] = { INT_MAX, INT_MAX, INT_MAX };
+		int tmax[3] = { INT_MIN, INT_MIN, INT_MIN };
+		grid.forEachTile([&](uint64_t, int, int tx, int ty, int tz)
+			{
+				const int tc[3] = { tx, ty, tz };
+				for (int k = 0; k < 3; ++k)
+				{
+					tmin[k] = std::min(tmin[k], tc[k]);
+					tmax[k] = std::max(tmax[k], tc[k]);
+				}
+			});
+		if (tmin[0] > tmax[0]) return ext;
+
+		for (int k = 0; k < 3; ++k)
+		{
+			ext.Lo[k] = tmin[k] * TileCPU::T;
+			ext.Hi[k] = (tmax[k] + 1) * TileCPU::T;
+		}
+		ext.bEmpty = false;
+		return ext;
+	}
+
+	// 복셀 공간 레이: p(t) = O + D * t
+	struct GridRay
+	{
+		float O[3];
+		float D[3];
+		float Inv[3];
+	};
+
+	GridRay ToGridRay(const GpuFriendlySparseGridFB& grid, const FLOAT3& origin, const FLOAT3& direction)
+	{
+		GridRay r;
+		const float invCell = 1.0f / grid.Cell;
+		for (int k = 0; k < 3; ++k)
+		{
+			r.O[k] = (origin[k] - grid.Origin[k]) * invCell;
+			r.D[k] = direction[k] * invCell;
+			r.Inv[k] = (r.D[k] != 0.0f) ? 1.0f / r.D[k] : 0.0f;
+		}
+		return r;
+	}
+
+	// 박스 [lo, hi)를 빠져나가는 t와 축
+	inline float BoxExit(const GridRay& r, const int lo[3], const int hi[3], int* outAxis)
+	{
+		float best = FLT_MAX;
+		int axis = 0;
+		for (int k = 0; k < 3; ++k)
+		{
+			float t;
+			if (r.D[k] > 0.0f) t = ((float)hi[k] - r.O[k]) * r.Inv[k];
+			else if (r.D[k] < 0.0f) t = ((float)lo[k] - r.O[k]) * r.Inv[k];
+			else continue;
+			if (t < best) { best = t; axis = k; }
+		}
+		*outAxis = axis;
+		return best;
+	}
+
+	// 박스를 빠져나간 다음 복셀로 이동. 나가는 축은 정수로 한 칸, 나머지 축은 박스 안으로 클램프 + 단조 증가
+	inline void StepOutOfBox(const GridRay& r, const int lo[3], const int hi[3], float tExit, int axis, int v[3])
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			if (k == axis) continue;
+			int c = (int)std::floor(r.O[k] + r.D[k] * tExit);
+			c = std::clamp(c, lo[k], hi[k] - 1);
+			if (r.D[k] > 0.0f) v[k] = std::max(v[k], c);
+			else if (r.D[k] < 0.0f) v[k] = std::min(v[k], c);
+		}
+		v[axis] = (r.D[axis] > 0.0f) ? hi[axis] : lo[axis] - 1;
+	}
+
+	// [tStart, tEnd] 구간에서 점유 구간마다 onSpan(t0, t1, voxel, entryAxis) 호출. false 반환 시 중단
+	//  - entryAxis: 진입 면의 축 (시작점이 점유 복셀 안이면 -1)
+	template<class F>
+	void TraverseGrid(
+		const GpuFriendlySparseGridFB& grid,
+		const GridExtent& ext,
+		const GridRay& r,
+		float tStart, float tEnd,
+		F&& onSpan)
+	{
+		if (ext.bEmpty) return;
+
+		// 그리드 범위로 클리핑
+		float t0 = tStart, t1 = tEnd;
+		int entryAxis = -1;
+		for (int k = 0; k < 3; ++k)
+		{
+			if (r.D[k] == 0.0f)
+			{
+				if (r.O[k] < (float)ext.Lo[k] || r.O[k] >= (float)ext.Hi[k]) return;
+				continue;
+			}
+			float ta = ((float)ext.Lo[k] - r.O[k]) * r.Inv[k];
+			float tb = ((float)ext.Hi[k] - r.O[k]) * r.Inv[k];
+			if (ta > tb) std::swap(ta, tb);
+			if (ta > t0) { t0 = ta; entryAxis = k; }
+			t1 = std::min(t1, tb);
+		}
+		if (!(t0 < t1)) return;
+
+		int v[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			v[k] = std::clamp((int)std::floor(r.O[k] + r.D[k] * t0), ext.Lo[k], ext.Hi[k] - 1);
+		}
+		if (entryAxis >= 0)
+		{
+			v[entryAxis] = (r.D[entryAxis] > 0.0f) ? ext.Lo[entryAxis] : ext.Hi[entryAxis] - 1;
+		}
+
+		int cachedTile[3] = { INT_MIN, INT_MIN, INT_MIN };
+		const TileCPU* tile = nullptr;
+		float t = t0;
+		while (t < t1)
+		{
+			if (v[0] < ext.Lo[0] || v[1] < ext.Lo[1] || v[2] < ext.Lo[2] ||
+				v[0] >= ext.Hi[0] || v[1] >= ext.Hi[1] || v[2] >= ext.Hi[2])
+			{
+				break;
+			}
+
+			int tc[3];
+			indexToTile(v[0], v[1], v[2], tc[0], tc[1], tc[2]);
+			if (tc[0] != cachedTile[0] || tc[1] != cachedTile[1] || tc[2] != cachedTile[2])
+			{
+				const int tileIdx = grid.findTileIndex(tc[0], tc[1], tc[2]);
+				tile = (tileIdx < 0) ? nullptr : &grid.TileVector[(size_t)tileIdx];
+				cachedTile[0] = tc[0]; cachedTile[1] = tc[1]; cachedTile[2] = tc[2];
+			}
+
+			const int x0 = tc[0] * TileCPU::T;
+			int lo[3] = { x0, tc[1] * TileCPU::T, tc[2] * TileCPU::T };
+			int hi[3] = { lo[0] + TileCPU::T, lo[1] + TileCPU::T, lo[2] + TileCPU::T };
+			int axis;
+			float tExit;
+
+			if (!tile || (tile->Mode == TileCPU::BITSET && tile->Count == 0))
+			{
+				// 빈 타일: 타일 박스째 건너뜀
+				tExit = BoxExit(r, lo, hi, &axis);
+			}
+			else if (tile->Mode == TileCPU::FULL)
+			{
+				tExit = BoxExit(r, lo, hi, &axis);
+				if (!onSpan(t, std::min(tExit, t1), v, entryAxis)) return;
+			}
+			else
+			{
+				const int lx = v[0] & 31, ly = v[1] & 31, lz = v[2] & 31;
+				const uint64_t w = tile->Bits[(size_t)(localIdx(lx, ly, lz) >> 6)];
+				if (w == 0)
+				{
+					// 빈 워드: 32x2x1 블록째 건너뜀
+					lo[1] = v[1] & ~1; hi[1] = lo[1] + 2;
+					lo[2] = v[2];      hi[2] = lo[2] + 1;
+					tExit = BoxExit(r, lo, hi, &axis);
+				}
+				else
+				{
+					// 현재 x행(y, z 고정)에서 레이가 지나는 x 구간을 한 번에 검사
+					lo[1] = v[1]; hi[1] = v[1] + 1;
+					lo[2] = v[2]; hi[2] = v[2] + 1;
+					tExit = BoxExit(r, lo, hi, &axis);
+
+					int xb = lx;
+					if (r.D[0] != 0.0f)
+					{
+						xb = (axis == 0)
+							? ((r.D[0] > 0.0f) ? 31 : 0)
+							: std::clamp((int)std::floor(r.O[0] + r.D[0] * std::min(tExit, t1)) - x0, 0, 31);
+						xb = (r.D[0] > 0.0f) ? std::max(xb, lx) : std::min(xb, lx);
+					}
+					const int xa = std::min(lx, xb), xz = std::max(lx, xb);
+					const uint32_t range = (uint32_t)((~0ull >> (63 - (xz - xa))) << xa);
+					const uint32_t row = (uint32_t)(w >> ((ly & 1) * 32));
+					const uint32_t hits = row & range;
+					if (hits)
+					{
+						const int hx = (r.D[0] < 0.0f) ? 31 - std::countl_zero(hits) : std::countr_zero(hits);
+						float tv = t;
+						int hitAxis = entryAxis;
+						if (hx != lx)
+						{
+							tv = std::max(t, ((float)(x0 + hx + ((r.D[0] > 0.0f) ? 0 : 1)) - r.O[0]) * r.Inv[0]);
+							hitAxis = 0;
+						}
+						if (tv >= t1) return;
+
+						v[0] = x0 + hx;
+						lo[0] = v[0]; hi[0] = v[0] + 1;
+						tExit = BoxExit(r, lo, hi, &axis);
+						if (!onSpan(tv, std::min(tExit, t1), v, hitAxis)) return;
+					}
+				}
+			}
+
+			StepOutOfBox(r, lo, hi, tExit, axis, v);
+			t = std::max(t, tExit);
+			entryAxis = axis;
+		}
+	}
+}
+
+void RayFirstHitBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const VoxelRay* rays, int numRays,
+	VoxelRayHit* outHits)
+{
+	ASSERT(rays && outHits, "Input or output pointer is null.");
+	const GridExtent ext = ComputeGridExtent(grid);
+	for (int i = 0; i < numRays; ++i)
+	{
+		const VoxelRay& ray = rays[i];
+		const GridRay r = ToGridRay(grid, ray.Origin, ray.Direction);
+
+		VoxelRayHit hit;
+		TraverseGrid(grid, ext, r, ray.TMin, ray.TMax,
+			[&](float t0, float, const int v[3], int entryAxis) -> bool
+			{
+				hit.bHit = true;
+				hit.T = t0;
+				hit.Voxel = { v[0], v[1], v[2] };
+				if (entryAxis >= 0)
+				{
+					float n[3] = { 0.0f, 0.0f, 0.0f };
+					n[entryAxis] = (r.D[entryAxis] > 0.0f) ? -1.0f : 1.0f;
+					hit.Normal = { n[0], n[1], n[2] };
+				}
+				return false;
+			});
+		outHits[i] = hit;
+	}
+}
+
+void SegmentOccupancyBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const FLOAT3* from, const FLOAT3* to, int numSegments,
+	float* outOccupancy)
+{
+	ASSERT(from && to && outOccupancy, "Input or output pointer is null.");
+	const GridExtent ext = ComputeGridExtent(grid);
+	for (int i = 0; i < numSegments; ++i)
+	{
+		// t ∈ [0, 1] 이므로 점유 구간 길이의 합이 곧 비율
+		const GridRay r = ToGridRay(grid, from[i], to[i] - from[i]);
+		float occupied = 0.0f;
+		TraverseGrid(grid, ext, r, 0.0f, 1.0f,
+			[&](float t0, float t1, const int*, int) -> bool
+			{
+				occupied += std::max(0.0f, t1 - t0);
+				return true;
+			});
+		outOccupancy[i] = std::min(occupied, 1.0f);
+	}
+}
+
+void VisibilityBatch(
+	const GpuFriendlySparseGridFB& grid,
+	const FLOAT3* from, const FLOAT3* to, int numPairs,
+	float endBias,
+	uint8_t* outVisible)
+{
+	ASSERT(from && to && outVisible, "Input or output pointer is null.");
+	const GridExtent ext = ComputeGridExtent(grid);
+	for (int i = 0; i < numPairs; ++i)
+	{
+		const FLOAT3 d = to[i] - from[i];
+		const float len = d.Magnitude();
+		const float tb = (len > 0.0f) ? endBias / len : 1.0f;
+
+		bool bVisible = true;
+		if (tb < 0.5f)
+		{
+			const GridRay r = ToGridRay(grid, from[i], d);
+			TraverseGrid(grid, ext, r, tb, 1.0f - tb,
+				[&](float, float, const int*, int) -> bool
+				{
+					bVisible = false;
+					return false;
+				});
+		}
+		outVisible[i] = bVisible ? 1 : 0;
+	}
+}
@@ -16,6 +16,7 @@
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <chrono>
 
 // --------------------- SAT: tri-box overlap (그리드공간) ---------------------
 static inline bool TriBoxOverlapGridF32(
@@ -108,75 +109,201 @@ static inline bool TriBoxOverlapGridF32(
 	return true;
 }
 
+// ----------------------- 복셀 안 삼각형 면적 (그리드공간) -----------------------
+// 삼각형을 단위 복셀 박스 [x, x+1]^3 로 Sutherland-Hodgman 클리핑한 다각형 면적
+static float ClippedTriangleAreaInVoxel(const FLOAT3& a, const FLOAT3& b, const FLOAT3& c, int x, int y, int z)
+{
+	FLOAT3 bufA[9], bufB[9];
+	FLOAT3* poly = bufA;
+	FLOAT3* next = bufB;
+	int count = 3;
+	poly[0] = a; poly[1] = b; poly[2] = c;
+
+	const int cell[3] = { x, y, z };
+	for (int axis = 0; axis < 3 && count > 0; ++axis)
+	{
+		for (int side = 0; side < 2 && count > 0; ++side)
+		{
+			// side 0: p[axis] >= cell, side 1: p[axis] <= cell + 1
+			const float plane = (float)(cell[axis] + side);
+			const float sign = side ? -1.0f : 1.0f;
+			int n = 0;
+			for (int i = 0; i < count; ++i)
+			{
+				const FLOAT3& p = poly[i];
+				const FLOAT3& q = poly[(i + 1) % count];
+				const float dp = (p[axis] - plane) * sign;
+				const float dq = (q[axis] - plane) * sign;
+				if (dp >= 0.0f) next[n++] = p;
+				if ((dp >= 0.0f) != (dq >= 0.0f))
+				{
+					next[n++] = p + (q - p) * (dp / (dp - dq));
+				}
+			}
+			std::swap(poly, next);
+			count = n;
+		}
+	}
+	if (count < 3) return 0.0f;
+
+	FLOAT3 sum{ 0.0f, 0.0f, 0.0f };
+	for (int i = 1; i + 1 < count; ++i)
+	{
+		sum += FLOAT3::Cross(poly[i] - poly[0], poly[i + 1] - poly[0]);
+	}
+	return 0.5f * sum.Magnitude();
+}
+
+// 표면 복셀 하나에 삼각형 기여를 누적 (coverage 가중)
+static void AccumulateVoxelAttributes(
+	GpuFriendlySparseGridFB& surface,
+	uint32_t mask,
+	int x, int y, int z,
+	float area,
+	const FLOAT3& triNormal,
+	uint16_t materialId)
+{
+	int tx, ty, tz; indexToTile(x, y, z, tx, ty, tz);
+	const int tileIdx = surface.findTileIndex(tx, ty, tz);
+	const uint16_t li = (uint16_t)localIdx(x, y, z);
+
+	uint8_t& coverage = surface.CoverageChannel.GetOrAllocate(tileIdx, li);
+	const float oldCoverage = (float)coverage / 255.0f;
+	const bool bFirst = (coverage == 0);
+
+	if (mask & VOXEL_ATTR_NORMAL)
+	{
+		uint16_t& n = surface.NormalChannel.GetOrAllocate(tileIdx, li);
+		FLOAT3 blended = bFirst ? triNormal : DecodeOctNormal(n) * oldCoverage + triNormal * area;
+		if (!(blended.SqrMagnitude() > 0.0f)) blended = triNormal;
+		n = EncodeOctNormal(blended);
+	}
+	if (mask & VOXEL_ATTR_MATERIAL)
+	{
+		// 면적 가중 다수결 (Boyer-Moore): 같은 머티리얼이면 득표 +area, 다르면 -area 하고 0 아래로 내려가면 교체.
+		// 어떤 머티리얼이 복셀 면적의 절반 이상을 덮으면 삼각형 순서와 무관하게 그 머티리얼이 남는다
+		uint16_t& m = surface.MaterialChannel.GetOrAllocate(tileIdx, li);
+		uint16_t& w = surface.MaterialWeightChannel.GetOrAllocate(tileIdx, li);
+		const float weight = (float)w / GpuFriendlySparseGridFB::MATERIAL_WEIGHT_SCALE;
+		float newWeight;
+		if (bFirst || m == materialId)
+		{
+			newWeight = (bFirst ? 0.0f : weight) + area;
+			m = materialId;
+		}
+		else if (area > weight)
+		{
+			newWeight = area - weight;
+			m = materialId;
+		}
+		else
+		{
+			newWeight = weight - area;
+		}
+		w = (uint16_t)std::clamp((int)std::lround(newWeight * GpuFriendlySparseGridFB::MATERIAL_WEIGHT_SCALE), 0, 65535);
+	}
+	coverage = (uint8_t)std::clamp((int)std::lround(std::min(1.0f, oldCoverage + area) * 255.0f), bFirst ? 1 : (int)coverage, 255);
+}
+
+// ----------------------- 삼각형 하나 복셀화 (클립 박스 내부만) -----------------------
+// a,b,c는 그리드 공간 좌표. clipMin/clipMax는 포함 범위 [min, max]의 복셀 인덱스.
+// surface.AttributeMask가 켜져 있으면 법선/머티리얼/coverage도 기록 (법선·머티리얼은 coverage로 가중하므로 coverage 채널은 항상 함께 기록)
+// 반환값: 수행한 SAT 테스트 수
+uint64_t VoxelizeTriangleSAT(
+	const FLOAT3& a, const FLOAT3& b, const FLOAT3& c,
+	const int clipMin[3], const int clipMax[3],
+	GpuFriendlySparseGridFB& surface,
+	uint16_t materialId)
+{
+	const float minx = fminf(a.x, fminf(b.x, c.x));
+	const float miny = fminf(a.y, fminf(b.y, c.y));
+	const float minz = fminf(a.z, fminf(b.z, c.z));
+	const float maxx = fmaxf(a.x, fmaxf(b.x, c.x));
+	const float maxy = fmaxf(a.y, fmaxf(b.y, c.y));
+	const float maxz = fmaxf(a.z, fmaxf(b.z, c.z));
+
+	int gx0 = (int)std::floor(minx - 0.5f) - 1;
+	int gy0 = (int)std::floor(miny - 0.5f) - 1;
+	int gz0 = (int)std::floor(minz - 0.5f) - 1;
+	int gx1 = (int)std::ceil(maxx + 0.5f) + 1;
+	int gy1 = (int)std::ceil(maxy + 0.5f) + 1;
+	int gz1 = (int)std::ceil(maxz + 0.5f) + 1;
+
+	gx0 = std::max(gx0, clipMin[0]);
+	gy0 = std::max(gy0, clipMin[1]);
+	gz0 = std::max(gz0, clipMin[2]);
+	gx1 = std::min(gx1, clipMax[0]);
+	gy1 = std::min(gy1, clipMax[1]);
+	gz1 = std::min(gz1, clipMax[2]);
+
+	const float V0[3] = { a.x, a.y, a.z };
+	const float V1[3] = { b.x, b.y, b.z };
+	const float V2[3] = { c.x, c.y, c.z };
+
+	const uint32_t attributeMask = surface.AttributeMask;
+	FLOAT3 triNormal = FLOAT3::Cross(b - a, c - a);
+	const float triNormalLen = triNormal.Magnitude();
+	triNormal = (triNormalLen > 0.0f) ? triNormal / triNormalLen : FLOAT3{ 0.0f, 0.0f, 1.0f };
+
+	for (int z = gz0; z <= gz1; ++z)
+	{
+		for (int y = gy0; y <= gy1; ++y)
+		{
+			for (int x = gx0; x <= gx1; ++x)
+			{
+				const float center[3] = { x + 0.5f, y + 0.5f, z + 0.5f };
+				if (TriBoxOverlapGridF32(center, V0, V1, V2))
+				{
+					surface.SetVoxelIndex(x, y, z, true);
+					if (attributeMask != VOXEL_ATTR_NONE)
+					{
+						const float area = ClippedTriangleAreaInVoxel(a, b, c, x, y, z);
+						AccumulateVoxelAttributes(surface, attributeMask, x, y, z, area, triNormal, materialId);
+					}
+				}
+			}
+		}
+	}
+	return (uint64_t)std::max(0, gx1 - gx0 + 1) * (uint64_t)std::max(0, gy1 - gy0 + 1) * (uint64_t)std::max(0, gz1 - gz0 + 1);
+}
+
 // ----------------------- 표면 복셀화 (Surface만 세팅) -----------------------
 static void VoxelizeSurface_SAT_ToSparse(
 	const FLOAT3* vertices,
-	const uint16_t* indices,
+	const uint32_t* indices,
 	int numTriangles,
 	int nx, int ny, int nz,
 	float cell,
 	const FLOAT3& origin,
-	GpuFriendlySparseGridFB& surface)
+	GpuFriendlySparseGridFB& surface,
+	uint16_t materialId,
+	uint64_t* outSatTests)
 {
+	uint64_t satTests = 0;
 	auto toGrid = [&](const FLOAT3& p)->FLOAT3
 		{
 			return FLOAT3{ (p.x - origin.x) / cell, (p.y - origin.y) / cell, (p.z - origin.z) / cell };
 		};
 
+	const int clipMin[3] = { 0, 0, 0 };
+	const int clipMax[3] = { nx - 1, ny - 1, nz - 1 };
 	for (int f = 0; f < numTriangles; ++f)
 	{
-		const uint16_t i0 = indices[3 * f + 0];
-		const uint16_t i1 = indices[3 * f + 1];
-		const uint16_t i2 = indices[3 * f + 2];
+		const uint32_t i0 = indices[3 * f + 0];
+		const uint32_t i1 = indices[3 * f + 1];
+		const uint32_t i2 = indices[3 * f + 2];
 
 		const FLOAT3 a = toGrid(vertices[i0]);
 		const FLOAT3 b = toGrid(vertices[i1]);
 		const FLOAT3 c = toGrid(vertices[i2]);
 
-		const float minx = fminf(a.x, fminf(b.x, c.x));
-		const float miny = fminf(a.y, fminf(b.y, c.y));
-		const float minz = fminf(a.z, fminf(b.z, c.z));
-		const float maxx = fmaxf(a.x, fmaxf(b.x, c.x));
-		const float maxy = fmaxf(a.y, fmaxf(b.y, c.y));
-		const float maxz = fmaxf(a.z, fmaxf(b.z, c.z));
-
-		int gx0 = (int)std::floor(minx - 0.5f) - 1;
-		int gy0 = (int)std::floor(miny - 0.5f) - 1;
-		int gz0 = (int)std::floor(minz - 0.5f) - 1;
-		int gx1 = (int)std::ceil(maxx + 0.5f) + 1;
-		int gy1 = (int)std::ceil(maxy + 0.5f) + 1;
-		int gz1 = (int)std::ceil(maxz + 0.5f) + 1;
-
-		gx0 = std::max(gx0, 0);
-		gy0 = std::max(gy0, 0);
-		gz0 = std::max(gz0, 0);
-		gx1 = std::min(gx1, nx - 1);
-		gy1 = std::min(gy1, ny - 1);
-		gz1 = std::min(gz1, nz - 1);
-
-		const float V0[3] = { a.x, a.y, a.z };
-		const float V1[3] = { b.x, b.y, b.z };
-		const float V2[3] = { c.x, c.y, c.z };
-
-		for (int z = gz0; z <= gz1; ++z)
-		{
-			for (int y = gy0; y <= gy1; ++y)
-			{
-				for (int x = gx0; x <= gx1; ++x)
-				{
-					const float center[3] = { x + 0.5f, y + 0.5f, z + 0.5f };
-					if (TriBoxOverlapGridF32(center, V0, V1, V2))
-					{
-						surface.SetVoxelIndex(x, y, z, true);
-					}
-				}
-			}
-		}
+		satTests += VoxelizeTriangleSAT(a, b, c, clipMin, clipMax, surface, materialId);
 	}
+	if (outSatTests) *outSatTests = satTests;
 }
 
 // ----------------------------- Solid 만들기 -----------------------------
-static void MakeSolidFromSurfaceSparse(
+void MakeSolidFromSurfaceSparse(
 	int nx, int ny, int nz,
 	const GpuFriendlySparseGridFB& surface,
 	GpuFriendlySparseGridFB* outSolid)
@@ -230,20 +357,13 @@ static void MakeSolidFromSurfaceSparse(
 	}
 }
 
-// ---------------------- 엔트리: Sparse로 직접 생성 ----------------------
-// 사용법:
-//   GpuFriendlySparseGridFB surface(voxelSize, originInit), solid(voxelSize, originInit);
-//   VoxelizeToSparse(mesh, voxelSize, surface, solid, result);
-//   (옵션) DumpSolidToUnityTxt(surface/solid, result);
-void VoxelizeToSparse(
-	const std::vector<FLOAT3> vertices,
-	const std::vector<uint16_t> indices,
+// ---------------------- 그리드 배치 (대칭 정렬) ----------------------
+void ComputeVoxelGridLayout(
 	const Bounds& meshBounds,
 	float voxelSize,
-	GpuFriendlySparseGridFB* outSolidVoxelGrid)
+	FLOAT3* outOrigin,
+	int* outNx, int* outNy, int* outNz)
 {
-	GpuFriendlySparseGridFB surface;
-	// Bounds & 그리드 배치(대칭 정렬)
 	Bounds bounds = meshBounds;
 	const float s = voxelSize;
 
@@ -255,10 +375,38 @@ void VoxelizeToSparse(
 	snappedMin.y = std::floor(bounds.Min.y / s) * s;
 	snappedMin.z = std::floor(bounds.Min.z / s) * s;
 
-	const int nx = (int)std::ceil((bounds.Max.x - snappedMin.x) / s);
-	const int ny = (int)std::ceil((bounds.Max.y - snappedMin.y) / s);
-	const int nz = (int)std::ceil((bounds.Max.z - snappedMin.z) / s);
+	*outOrigin = snappedMin;
+	*outNx = (int)std::ceil((bounds.Max.x - snappedMin.x) / s);
+	*outNy = (int)std::ceil((bounds.Max.y - snappedMin.y) / s);
+	*outNz = (int)std::ceil((bounds.Max.z - snappedMin.z) / s);
+}
 
+// ---------------------- 엔트리: Sparse로 직접 생성 ----------------------
+// 사용법:
+//   GpuFriendlySparseGridFB solid;
+//   VoxelizeToSparse(positions, indices, meshBounds, voxelSize, &solid);
+//   (옵션) VoxelizeStats로 단계별 시간/복셀 수 확인
+//   (옵션) outSurface에 표면 그리드를 받고, outSurface->AttributeMask로 속성 채널 기록 (materialId는 섹션/머티리얼 ID)
+void VoxelizeToSparse(
+	const std::vector<FLOAT3>& vertices,
+	const std::vector<uint32_t>& indices,
+	const Bounds& meshBounds,
+	float voxelSize,
+	GpuFriendlySparseGridFB* outSolidVoxelGrid,
+	VoxelizeStats* outStats,
+	GpuFriendlySparseGridFB* outSurface,
+	uint16_t materialId)
+{
+	using Clock = std::chrono::steady_clock;
+
+	GpuFriendlySparseGridFB localSurface;
+	GpuFriendlySparseGridFB& surface = outSurface ? *outSurface : localSurface;
+	const float s = voxelSize;
+
+	// Bounds & 그리드 배치(대칭 정렬)
+	FLOAT3 snappedMin;
+	int nx, ny, nz;
+	ComputeVoxelGridLayout(meshBounds, s, &snappedMin, &nx, &ny, &nz);
 
 	// 그리드 재설정
 	surface.Clear();
@@ -267,15 +415,31 @@ void VoxelizeToSparse(
 	outSolidVoxelGrid->Reconfigure(s, snappedMin);
 
 	// 표면 복셀화 → Surface
+	const auto t0 = Clock::now();
+	uint64_t satTests = 0;
 	VoxelizeSurface_SAT_ToSparse(
 		vertices.data(),
 		indices.data(),
-		indices.size() / 3,
+		(int)(indices.size() / 3),
 		nx, ny, nz, 
 		s,
 		snappedMin, 
-		surface);
+		surface,
+		materialId,
+		&satTests);
 
 	// Solid 만들기
+	const auto t1 = Clock::now();
 	MakeSolidFromSurfaceSparse(nx, ny, nz, surface, outSolidVoxelGrid);
-}
+	const auto t2 = Clock::now();
+
+	if (outStats)
+	{
+		outStats->Nx = nx; outStats->Ny = ny; outStats->Nz = nz;
+		outStats->SatTests = satTests;
+		outStats->SurfaceVoxels = surface.CountVoxels();
+		outStats->SolidVoxels = outSolidVoxelGrid->CountVoxels();
+		outStats->SurfaceMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+		outStats->FillMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+	}
+}
\ No newline at end of file
@@ -52,60 +52,14 @@ bool ENGINECALL BasicMeshObject::BeginCreateMesh(const Vertex* vertices, uint nu
 	return true;
 }
 
-bool ENGINECALL BasicMeshObject::InsertTriGroup(const uint16_t* indices, uint numTriangles, const WCHAR* wchTexFileName)
+bool ENGINECALL BasicMeshObject::InsertTriGroup(const uint32_t* indices, uint numTriangles, const WCHAR* wchTexFileName)
 {
-	ID3D12Device5* pD3DDeivce = m_pRenderer->GetD3DDevice();
-	size_t srvDescriptorSize = m_pRenderer->GetSrvDescriptorSize();
-	D3D12ResourceManager* pResourceManager = m_pRenderer->GetResourceManager();
-	SingleDescriptorAllocator* pSingleDescriptorAllocator = m_pRenderer->GetSingleDescriptorAllocator();
-	bool bUseGpuUploadHeaps = m_pRenderer->IsGpuUploadHeapsEnabledInl();
-
-	ID3D12Resource* pIndexBuffer = nullptr;
-	D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
-
-	ASSERT(m_NumTriGroups < m_MaxNumTriGroups, "Too many tri-groups.");
-
-	if (FAILED(pResourceManager->CreateIndexBuffer(numTriangles * 3, &indexBufferView, &pIndexBuffer, (void*)indices, bUseGpuUploadHeaps)))
-	{
-		ASSERT(false, "Failed to create index buffer.");
-		return false;
-	}
-	IndexedTriGroup* pTriGroup = m_pTriGroupList + m_NumTriGroups;
-	pTriGroup->IndexBuffer = pIndexBuffer;
-	pTriGroup->IndexBufferView = indexBufferView;
-	pTriGroup->NumTriangles = static_cast<uint>(numTriangles);
-	pTriGroup->pTexHandle = (TextureHandle*)m_pRenderer->CreateTextureFromFile(wchTexFileName);
-	pTriGroup->bOpaque = true;
-	m_NumTriGroups++;
-	return true;
+	return insertTriGroup(indices, sizeof(uint32_t), numTriangles, (TextureHandle*)m_pRenderer->CreateTextureFromFile(wchTexFileName));
 }
 
-bool ENGINECALL BasicMeshObject::InsertTriGroup(const uint16_t* indices, uint numTriangles, const Material& material)
+bool ENGINECALL BasicMeshObject::InsertTriGroup(const uint32_t* indices, uint numTriangles, const Material& material)
 {
-	ID3D12Device5* pD3DDeivce = m_pRenderer->GetD3DDevice();
-	size_t srvDescriptorSize = m_pRenderer->GetSrvDescriptorSize();
-	D3D12ResourceManager* pResourceManager = m_pRenderer->GetResourceManager();
-	SingleDescriptorAllocator* pSingleDescriptorAllocator = m_pRenderer->GetSingleDescriptorAllocator();
-	bool bUseGpuUploadHeaps = m_pRenderer->IsGpuUploadHeapsEnabledInl();
-
-	ID3D12Resource* pIndexBuffer = nullptr;
-	D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
-
-	ASSERT(m_NumTriGroups < m_MaxNumTriGroups, "Too many tri-groups.");
-
-	if (FAILED(pResourceManager->CreateIndexBuffer(numTriangles * 3, &indexBufferView, &pIndexBuffer, (void*)indices, bUseGpuUploadHeaps)))
-	{
-		ASSERT(false, "Failed to create index buffer.");
-		return false;
-	}
-	IndexedTriGroup* pTriGroup = m_pTriGroupList + m_NumTriGroups;
-	pTriGroup->IndexBuffer = pIndexBuffer;
-	pTriGroup->IndexBufferView = indexBufferView;
-	pTriGroup->NumTriangles = static_cast<uint>(numTriangles);
-	pTriGroup->pTexHandle = (TextureHandle*)m_pRenderer->CreateImmutableTexture(material.Diffuse);
-	pTriGroup->bOpaque = true;
-	m_NumTriGroups++;
-	return true;
+	return insertTriGroup(indices, sizeof(uint32_t), numTriangles, (TextureHandle*)m_pRenderer->CreateImmutableTexture(material.Diffuse));
 }
 
 void ENGINECALL BasicMeshObject::EndCreateMesh(bool bOpaque, bool bUseRayTracingIfSupported)
@@ -215,6 +169,62 @@ void BasicMeshObject::UpdateBLASTransform(const Matrix4x4& worldMatrix)
 	pRayTracingManager->UpdateBLASTransform(m_pBLASHandle, worldMatrix);
 }
 
+bool BasicMeshObject::InsertPackedTriGroup(const void* indices, uint indexSizeInBytes, uint numTriangles, const WCHAR* wchTexFileName)
+{
+	ASSERT(indexSizeInBytes == sizeof(uint16_t) || indexSizeInBytes == sizeof(uint32_t), "Index size must be 2 or 4 bytes.");
+
+	TextureHandle* pTexHandle = wchTexFileName ? (TextureHandle*)m_pRenderer->CreateTextureFromFile(wchTexFileName) : (TextureHandle*)m_pRenderer->CreateImmutableTexture(Image());
+	return insertTriGroup(indices, indexSizeInBytes, numTriangles, pTexHandle);
+}
+
+bool BasicMeshObject::insertTriGroup(const void* indices, uint indexSizeInBytes, uint numTriangles, TextureHandle* pTexHandle)
+{
+	ID3D12Resource* pIndexBuffer = nullptr;
+	D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+
+	ASSERT(m_NumTriGroups < m_MaxNumTriGroups, "Too many tri-groups.");
+
+	if (!createIndexBuffer(indices, indexSizeInBytes, numTriangles, &pIndexBuffer, &indexBufferView))
+	{
+		return false;
+	}
+	IndexedTriGroup* pTriGroup = m_pTriGroupList + m_NumTriGroups;
+	pTriGroup->IndexBuffer = pIndexBuffer;
+	pTriGroup->IndexBufferView = indexBufferView;
+	pTriGroup->NumTriangles = static_cast<uint>(numTriangles);
+	pTriGroup->pTexHandle = pTexHandle;
+	pTriGroup->bOpaque = true;
+	m_NumTriGroups++;
+	return true;
+}
+
+bool BasicMeshObject::createIndexBuffer(const void* indices, uint indexSizeInBytes, uint numTriangles, ID3D12Resource** ppOutBuffer, D3D12_INDEX_BUFFER_VIEW* pOutIndexBufferView)
+{
+	D3D12ResourceManager* pResourceManager = m_pRenderer->GetResourceManager();
+	bool bUseGpuUploadHeaps = m_pRenderer->IsGpuUploadHeapsEnabledInl();
+
+	// 모든 인덱스가 16bit에 들어가면 R16으로 줄여서 올린다 (메모리 / 대역폭 절반)
+	// 이미 16bit로 들어온 인덱스 (쿠킹된 메시)는 그대로 올린다
+	const size_t numIndices = size_t(numTriangles) * 3;
+	const uint32_t* indices32 = static_cast<const uint32_t*>(indices);
+	const bool bIndex32 = indexSizeInBytes == sizeof(uint32_t) && GetIndexSizeInBytes(indices32, numIndices) == sizeof(uint32_t);
+
+	std::vector<uint16_t> indices16;
+	void* pInitData = (void*)indices;
+	if (!bIndex32 && indexSizeInBytes == sizeof(uint32_t))
+	{
+		indices16.assign(indices32, indices32 + numIndices);
+		pInitData = indices16.data();
+	}
+
+	if (FAILED(pResourceManager->CreateIndexBuffer(numIndices, bIndex32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, pOutIndexBufferView, ppOutBuffer, pInitData, bUseGpuUploadHeaps)))
+	{
+		ASSERT(false, "Failed to create index buffer.");
+		return false;
+	}
+	return true;
+}
+
 bool BasicMeshObject::initPipelineState()
 {
 	HRESULT hr = S_OK;
@@ -28,8 +28,8 @@ public:
 
 	// Derived from IMeshObject
 	bool ENGINECALL BeginCreateMesh(const Vertex* vertices, uint numVertices, uint numTriGroups) override;
-	bool ENGINECALL InsertTriGroup(const uint16_t* indices, uint numTriangles, const WCHAR* wchTexFileName) override;
-	bool ENGINECALL InsertTriGroup(const uint16_t* indices, uint numTriangles, const Material& material) override;
+	bool ENGINECALL InsertTriGroup(const uint32_t* indices, uint numTriangles, const WCHAR* wchTexFileName) override;
+	bool ENGINECALL InsertTriGroup(const uint32_t* indices, uint numTriangles, const Material& material) override;
 	void ENGINECALL EndCreateMesh(bool bOpaque, bool bUseRayTracingIfSupported) override;
 
 	uint ENGINECALL GetRenderPass() override;
@@ -42,8 +42,13 @@ public:
 	void Draw(int threadIndex, ID3D12GraphicsCommandList6* pCommandList, const Matrix4x4* worldMatrix);
 	void UpdateBLASTransform(const Matrix4x4& worldMatrix);
 
+	// indices: uint16_t or uint32_t per indexSizeInBytes (e.g. straight from a mapped .hmesh). wchTexFileName may be null
+	bool InsertPackedTriGroup(const void* indices, uint indexSizeInBytes, uint numTriangles, const WCHAR* wchTexFileName);
+
 private:
 	bool initPipelineState();
+	bool insertTriGroup(const void* indices, uint indexSizeInBytes, uint numTriangles, TextureHandle* pTexHandle);
+	bool createIndexBuffer(const void* indices, uint indexSizeInBytes, uint numTriangles, ID3D12Resource** ppOutBuffer, D3D12_INDEX_BUFFER_VIEW* pOutIndexBufferView);
 
 	void deleteTriGroup(IndexedTriGroup* pTriGroup);
 	void cleanup();
@@ -33,12 +33,13 @@ struct CONSTANT_BUFFER_PER_FRAME
 	float _pad0;
 	FLOAT3 LightColor; // Light color
 	float _pad1;
-	FLOAT3 Ambient; // Ambient light color
-	float _pad2;
 
 	float Near;
 	float Far;
 	uint MaxRadianceRayRecursionDepth;
+	uint _pad2;
+
+	FLOAT4 AmbientSH[9]; // Ambient irradiance L2 SH (AtmosSkySH order), rgb = coefficient, w unused
 };
 
 struct CONSTANT_BUFFER_MESH_OBJECT
@@ -87,4 +88,18 @@ struct CONSTANT_BUFFER_ATMOS
 	float SMU;
 	float SMUS;
 	float SNU;
+
+	uint LutMapping;	// EAtmosLutMapping the LUTs were baked with
+	uint UseSkyView;	// 1: per-frame sky-view LUT (t3) / aerial perspective (t4), 0: precomputed LUTs only
+
+	// Per-frame sky-view / aerial perspective (valid when UseSkyView != 0)
+	float SkyViewCameraRadius;	// camera radius the sky-view LUT was built for
+	float SkyViewSunZenithCos;
+	float AerialMaxDistance;	// [m], end of the last slice
+	float AerialD;				// slice count (0 = no aerial volume)
+
+	float SkyViewW;
+	float SkyViewH;
+	float AerialW;
+	float AerialH;
 };
\ No newline at end of file
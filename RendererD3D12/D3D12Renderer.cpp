@@ -412,9 +412,13 @@ void ENGINECALL D3D12Renderer::Cleanup()
 
 void ENGINECALL D3D12Renderer::Update(float dt)
 {
-	m_PerFrameCB.LightDir = FLOAT3(-0.577f, -0.577f, -0.577f);
+	m_PerFrameCB.LightDir = m_LightDir;
 	m_PerFrameCB.LightColor = FLOAT3(1.0f, 1.0f, 1.0f);
-	m_PerFrameCB.Ambient = FLOAT3(0.3f, 0.3f, 0.3f);
+	for (int i = 0; i < 9; ++i)
+	{
+		const FLOAT3& c = m_AmbientSH.Coeffs[i];
+		m_PerFrameCB.AmbientSH[i] = { c.x, c.y, c.z, 0.0f };
+	}
 
 	m_PerFrameCB.Near = NEAR_Z;
 	m_PerFrameCB.Far = FAR_Z;
@@ -684,6 +688,27 @@ void ENGINECALL D3D12Renderer::RenderSprite(
 	RenderSpriteWithTex(pSprObjHandle, posX, posY, scaleX, scaleY, nullptr, z, nullptr);
 }
 
+void ENGINECALL D3D12Renderer::UpdateAtmosSky(const AtmosSkyViewParams& params, const AtmosSkyViewResult& result)
+{
+	m_pSkyObject->UpdateSkyView(params, result);
+
+	// 방향광도 하늘의 태양을 따라간다 (Sun -> Ground)
+	FLOAT3 sunDir = params.SunDir;
+	const float len = std::sqrt(sunDir.x * sunDir.x + sunDir.y * sunDir.y + sunDir.z * sunDir.z);
+	if (len > 0.0f)
+	{
+		m_LightDir = FLOAT3(sunDir.x / len, sunDir.y / len, sunDir.z / len);
+	}
+
+	// ambient도 하늘 조도 SH를 따라간다 (시간대에 따라 밝기 / 색이 바뀐다)
+	m_AmbientSH = result.AmbientSH;
+}
+
+void ENGINECALL D3D12Renderer::SetAtmosParams(const AtmosParams& params)
+{
+	m_pSkyObject->SetAtmosParams(params);
+}
+
 IMeshObject* ENGINECALL D3D12Renderer::CreateBasicMeshObject(bool bOpaque, bool bUseRayTracingIfSupported)
 {
 	BasicMeshObject* pMeshObj = new BasicMeshObject;
@@ -703,7 +728,27 @@ IMeshObject* ENGINECALL D3D12Renderer::CreateBasicMeshObject(const StaticMesh& s
 	for (size_t i = 0; i < numSections; i++)
 	{
 		const MeshSection& section = staticMesh.Sections[i];
-		pMeshObj->InsertTriGroup(section.Indices.data(), section.Indices.size(), section.Material);
+		pMeshObj->InsertTriGroup(section.Indices.data(), (uint)(section.Indices.size() / 3), section.Material);
+	}
+	pMeshObj->EndCreateMesh(bOpaque, bUseRayTracingIfSupported);
+
+	return pMeshObj;
+}
+
+IMeshObject* ENGINECALL D3D12Renderer::CreateBasicMeshObject(const StaticMeshView& meshView, bool bOpaque, bool bUseRayTracingIfSupported)
+{
+	BasicMeshObject* pMeshObj = new BasicMeshObject;
+	pMeshObj->Initialize(this);
+
+	// 정점은 SoA → Vertex 인터리브만 하고, 인덱스는 매핑된 파일에서 바로 업로드 버퍼로 복사된다
+	std::vector<Vertex> vertices = meshView.GetVertexArray();
+	size_t numSections = meshView.Sections.size();
+	pMeshObj->BeginCreateMesh(vertices.data(), (uint)vertices.size(), (uint)numSections);
+	for (size_t i = 0; i < numSections; i++)
+	{
+		const StaticMeshViewSection& section = meshView.Sections[i];
+		const std::filesystem::path& diffuse = section.Textures[HMESH_TEXTURE_DIFFUSE];
+		pMeshObj->InsertPackedTriGroup(section.Indices, section.IndexSizeInBytes, section.NumIndices / 3, diffuse.empty() ? nullptr : diffuse.c_str());
 	}
 	pMeshObj->EndCreateMesh(bOpaque, bUseRayTracingIfSupported);
 
@@ -42,9 +42,12 @@ public:
 	void ENGINECALL RenderMeshObject(IMeshObject* pMeshObj, const Matrix4x4* pMatWorld) override;
 	void ENGINECALL RenderSpriteWithTex(void* pSprObjHandle, int posX, int posY, float scaleX, float scaleY, const RECT* pRect, float z, void* pTexHandle) override;
 	void ENGINECALL RenderSprite(void* pSprObjHandle, int posX, int posY, float scaleX, float scaleY, float z) override;
+	void ENGINECALL UpdateAtmosSky(const AtmosSkyViewParams& params, const AtmosSkyViewResult& result) override;
+	void ENGINECALL SetAtmosParams(const AtmosParams& params) override;
 
 	IMeshObject* ENGINECALL CreateBasicMeshObject(bool bOpaque, bool bUseRayTracingIfSupported) override;
 	IMeshObject* ENGINECALL CreateBasicMeshObject(const StaticMesh& staticMesh, bool bOpaque, bool bUseRayTracingIfSupported) override;
+	IMeshObject* ENGINECALL CreateBasicMeshObject(const StaticMeshView& meshView, bool bOpaque, bool bUseRayTracingIfSupported) override;
 	ISprite* ENGINECALL CreateSpriteObject() override;
 	ISprite* ENGINECALL CreateSpriteObject(const WCHAR* wchTexFileName) override;
 	ISprite* ENGINECALL CreateSpriteObject(const WCHAR* wchTexFileName, int posX, int posY, int width, int height) override;
@@ -88,11 +91,13 @@ public:
 	ShaderManager* GetShaderManager() { return m_pShaderManager; }
 	RootSignatureManager* GetRootSignatureManager() { return m_pRootSignatureManager; }
 	PSOManager* GetPSOManager() { return m_pPSOManager; }
+	TextureManager* GetTextureManager() { return m_pTextureManager; }
 
 	DescriptorPool* GetDescriptorPool(int threadIndex) const { return m_ppDescriptorPool[m_CurrContextIndex][threadIndex]; }
 	SimpleConstantBufferPool* GetConstantBufferPool(CONSTANT_BUFFER_TYPE type, int threadIndex) const;
 
 	inline uint32_t GetSrvDescriptorSize() const { return m_srvDescriptorSize; }
+	inline int GetCurrContextIndex() const { return m_CurrContextIndex; }
 	inline SingleDescriptorAllocator* GetSingleDescriptorAllocator() const { return m_pSingleDescriptorAllocator; }
 	inline int GetScreenWidth() const { return m_Width; }
 	inline int GetScreenHeight() const { return m_Height; }
@@ -194,6 +199,8 @@ private:
 
 	int	m_CurrContextIndex = 0;
 	CONSTANT_BUFFER_PER_FRAME m_PerFrameCB = {};
+	FLOAT3 m_LightDir = FLOAT3(-0.577f, -0.577f, -0.577f);	// UpdateAtmosSky가 태양 방향으로 갱신
+	AtmosSkySH m_AmbientSH = { { FLOAT3(DEFAULT_AMBIENT / SH_Y00, DEFAULT_AMBIENT / SH_Y00, DEFAULT_AMBIENT / SH_Y00) } };	// UpdateAtmosSky가 하늘 조도 SH로 갱신
 
 	FLOAT3 m_CamPos = {};
 	FLOAT3 m_CamDir = {};
@@ -204,6 +211,8 @@ private:
 	float m_fCamRoll = 0.0f;
 
 	static constexpr float NEAR_Z = 0.1f;
+	static constexpr float DEFAULT_AMBIENT = 0.3f;	// 하늘 SH가 들어오기 전의 상수 ambient (L0 계수 하나 = 모든 법선에 같은 값)
+	static constexpr float SH_Y00 = 0.282095f;
 	static constexpr float FAR_Z = 1000.0f;
 
 	SkyObject* m_pSkyObject = {};
@@ -129,14 +129,18 @@ lb_return:
 	return hr;
 }
 
-HRESULT D3D12ResourceManager::CreateIndexBuffer(size_t numIndices, D3D12_INDEX_BUFFER_VIEW* pOutIndexBufferView, ID3D12Resource **ppOutBuffer, void* pInitData, bool bUseGpuUploadHeaps)
+HRESULT D3D12ResourceManager::CreateIndexBuffer(size_t numIndices, DXGI_FORMAT indexFormat, D3D12_INDEX_BUFFER_VIEW* pOutIndexBufferView, ID3D12Resource **ppOutBuffer, void* pInitData, bool bUseGpuUploadHeaps)
 {
+	ASSERT(indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT, "Index format must be R16_UINT or R32_UINT.");
+
 	HRESULT hr = S_OK;
 
 	D3D12_INDEX_BUFFER_VIEW	indexBufferView = {};
 	ID3D12Resource*	pIndexBuffer = nullptr;
 	ID3D12Resource*	pUploadBuffer = nullptr;
-	size_t indexBufferSize = sizeof(WORD) * numIndices;
+	size_t indexBufferSize = (indexFormat == DXGI_FORMAT_R32_UINT ? sizeof(uint32_t) : sizeof(uint16_t)) * numIndices;
+	// 레이트레이싱은 인덱스 버퍼를 4bytes 단위 RAW SRV로 읽는다. 16bit 인덱스 수가 홀수여도 마지막 인덱스까지 읽히도록 리소스는 4bytes 배수로 잡는다
+	size_t resourceSize = (indexBufferSize + 3) & ~size_t(3);
 	
 	D3D12_HEAP_PROPERTIES heapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 	if (bUseGpuUploadHeaps)
@@ -147,7 +151,7 @@ HRESULT D3D12ResourceManager::CreateIndexBuffer(size_t numIndices, D3D12_INDEX_B
 	hr = m_pD3DDevice->CreateCommittedResource(
 		&heapProp,
 		D3D12_HEAP_FLAG_NONE,
-		&CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize),
+		&CD3DX12_RESOURCE_DESC::Buffer(resourceSize),
 		D3D12_RESOURCE_STATE_COMMON,
 		nullptr,
 		IID_PPV_ARGS(&pIndexBuffer));
@@ -185,7 +189,7 @@ HRESULT D3D12ResourceManager::CreateIndexBuffer(size_t numIndices, D3D12_INDEX_B
 			hr = m_pD3DDevice->CreateCommittedResource(
 				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
 				D3D12_HEAP_FLAG_NONE,
-				&CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize),
+				&CD3DX12_RESOURCE_DESC::Buffer(resourceSize),
 				D3D12_RESOURCE_STATE_COMMON,
 				nullptr,
 				IID_PPV_ARGS(&pUploadBuffer));
@@ -226,7 +230,7 @@ HRESULT D3D12ResourceManager::CreateIndexBuffer(size_t numIndices, D3D12_INDEX_B
 
 	// Initialize the vertex buffer view.
 	indexBufferView.BufferLocation = pIndexBuffer->GetGPUVirtualAddress();
-	indexBufferView.Format = DXGI_FORMAT_R16_UINT;
+	indexBufferView.Format = indexFormat;
 	indexBufferView.SizeInBytes = static_cast<uint>(indexBufferSize);
 
 	*pOutIndexBufferView = indexBufferView;
@@ -312,7 +316,7 @@ bool D3D12ResourceManager::CreateTexture(ID3D12Resource** ppOutResource, uint wi
 	return true;
 }
 
-bool D3D12ResourceManager::CreateTexturePair(ID3D12Resource** ppOutResource, ID3D12Resource** ppOutUploadBuffer, uint Width, uint Height, DXGI_FORMAT format)
+bool D3D12ResourceManager::CreateTexturePair(ID3D12Resource** ppOutResource, ID3D12Resource** ppOutUploadBuffer, uint Width, uint Height, DXGI_FORMAT format, uint Depth)
 {
 	HRESULT hr = S_OK;
 	ID3D12Resource*	pTexResource = nullptr;
@@ -324,10 +328,10 @@ bool D3D12ResourceManager::CreateTexturePair(ID3D12Resource** ppOutResource, ID3
 	textureDesc.Width = Width;
 	textureDesc.Height = Height;
 	textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-	textureDesc.DepthOrArraySize = 1;
+	textureDesc.DepthOrArraySize = (UINT16)Depth;
 	textureDesc.SampleDesc.Count = 1;
 	textureDesc.SampleDesc.Quality = 0;
-	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	textureDesc.Dimension = Depth > 1 ? D3D12_RESOURCE_DIMENSION_TEXTURE3D : D3D12_RESOURCE_DIMENSION_TEXTURE2D;	// Depth > 1 이면 볼륨 텍스처
 
 	hr = m_pD3DDevice->CreateCommittedResource(
 		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
@@ -286,7 +286,7 @@ BLASHandle* RayTracingManager::buildBLAS(
 		pGeomDescList[i].Type = D3D12_RAYTRACING_GEOMETRY_TYPE_TRIANGLES;
 		pGeomDescList[i].Triangles.IndexBuffer = IB_GPU_Ptr;
 		pGeomDescList[i].Triangles.IndexCount = pTriGroupInfoList[i].NumTriangles * 3;
-		pGeomDescList[i].Triangles.IndexFormat = DXGI_FORMAT_R16_UINT;
+		pGeomDescList[i].Triangles.IndexFormat = pTriGroupInfoList[i].IndexBufferView.Format;
 		pGeomDescList[i].Triangles.Transform3x4 = 0;
 		pGeomDescList[i].Triangles.VertexFormat = DXGI_FORMAT_R32G32B32_FLOAT;
 		pGeomDescList[i].Triangles.VertexCount = numVertices;
@@ -394,15 +394,17 @@ BLASHandle* RayTracingManager::buildBLAS(
 			srvCpu.Offset(1, m_DescriptorSize);
 			srvGpu.Offset(1, m_DescriptorSize);
 
-			// Create Shader Resource from Index Buffer			
+			// Create Shader Resource from Index Buffer (버퍼 크기는 CreateIndexBuffer에서 4bytes 배수로 올려 둔다)
+			const uint indexSize = (pTriGroupInfoList[i].IndexBufferView.Format == DXGI_FORMAT_R32_UINT) ? 4 : 2;
 			srvDesc.Buffer.FirstElement = 0;
-			srvDesc.Buffer.NumElements = (pTriGroupInfoList[i].NumTriangles * 3 * 2) / 4;	// compute shader에서 4bytes 단위로 읽어야 하므로...
+			srvDesc.Buffer.NumElements = (pTriGroupInfoList[i].NumTriangles * 3 * indexSize + 3) / 4;	// compute shader에서 4bytes 단위로 읽어야 하므로...
 			srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
 			srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
 			srvDesc.Buffer.StructureByteStride = 0;
 
 			m_pD3DDevice->CreateShaderResourceView(pTriGroupInfoList[i].IndexBuffer, &srvDesc, srvCpu);
 			pBLASHandle->pRootArg[i].SrvIB = srvGpu;
+			pBLASHandle->pRootArg[i].IndexSizeInBytes = indexSize;
 			srvCpu.Offset(1, m_DescriptorSize);
 			srvGpu.Offset(1, m_DescriptorSize);
 
@@ -721,11 +723,13 @@ void RayTracingManager::createRootSignatures()
 	// Local Root Signature
 	// space1
 	// t0 : vertex buffer, t1 : index buffer, t2 : diffuse texture
+	// b0 : index size in bytes (2 or 4)
 	CD3DX12_DESCRIPTOR_RANGE localRanges[1] = {};
 	localRanges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 0, 1);	// space1
 
-	CD3DX12_ROOT_PARAMETER localRootParameters[1] = {};
+	CD3DX12_ROOT_PARAMETER localRootParameters[2] = {};
 	localRootParameters[0].InitAsDescriptorTable(_countof(localRanges), localRanges, D3D12_SHADER_VISIBILITY_ALL);
+	localRootParameters[1].InitAsConstants(1, 0, 1, D3D12_SHADER_VISIBILITY_ALL);	// RootArgument::IndexSizeInBytes
 
 	CD3DX12_ROOT_SIGNATURE_DESC localRootSignatureDesc(ARRAYSIZE(localRootParameters), localRootParameters, 0, nullptr);
 	localRootSignatureDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_LOCAL_ROOT_SIGNATURE;
@@ -49,12 +49,16 @@ struct ShaderHandle
 	uint CodeBuffer[1];
 };
 
+// Local root signature 순서대로 배치: [0] SRV 테이블 (8 bytes), [1] 32bit 상수 (offset 8)
 struct RootArgument
 {
-	D3D12_GPU_DESCRIPTOR_HANDLE SrvVB;
+	D3D12_GPU_DESCRIPTOR_HANDLE SrvVB;		// 테이블 시작 (t0 VB, t1 IB, t2 diffuse / space1)
+	uint IndexSizeInBytes;					// b0, space1 : 2 (R16) or 4 (R32)
+	uint _pad0;
 	D3D12_GPU_DESCRIPTOR_HANDLE SrvIB;
 	D3D12_GPU_DESCRIPTOR_HANDLE SrvTexDiffuse;
 };
+static_assert(offsetof(RootArgument, IndexSizeInBytes) == 8, "Root constant must follow the descriptor table.");
 
 struct BLASHandle
 {
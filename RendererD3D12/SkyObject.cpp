@@ -8,6 +8,10 @@
 #include "PSOManager.h"
 #include "SingleDescriptorAllocator.h"
 #include "ShaderManager.h"
+#include "TextureManager.h"
+#include "D3DUtil.h"
+#include "Common/AtmosLutMapping.h"
+#include "Interface/AtmosStruct.h"
 
 bool SkyObject::Initialize(D3D12Renderer* pRenderer)
 {
@@ -37,6 +41,12 @@ void SkyObject::Cleanup()
 	SAFE_CLEANUP(m_pTransmittanceTex, m_pRenderer->DeleteTexture);
 	SAFE_CLEANUP(m_pScatteringTex, m_pRenderer->DeleteTexture);
 	SAFE_CLEANUP(m_pIrradianceTex, m_pRenderer->DeleteTexture);
+	for (uint i = 0; i < MAX_PENDING_FRAME_COUNT; i++)
+	{
+		SAFE_CLEANUP(m_pSkyViewTex[i], m_pRenderer->DeleteTexture);
+		SAFE_CLEANUP(m_pAerialTex[i], m_pRenderer->DeleteTexture);
+	}
+	m_SkyViewContextIndex = -1;
 
 	SAFE_CLEANUP(m_pPSOHandle, m_pRenderer->GetPSOManager()->ReleasePSO);
 }
@@ -171,32 +181,82 @@ void SkyObject::Draw(int threadIndex, ID3D12GraphicsCommandList6* pCommandList)
 		ASSERT(false, "Sky: Unknown atmosphere preset");
 	}
 
-	// Fixed parameters. Resolution must match the precomputed LUTs.
-	atmosCB->PlanetRadius = 6'360'000.0f; // [m]
-	atmosCB->AtmosphereHeight = 60'000.0f; // [m]
+	// Radii come from SetAtmosParams (the same AtmosParams as the sky-view bake). Resolution must match the precomputed LUTs.
+	atmosCB->PlanetRadius = m_PlanetRadius; // [m]
+	atmosCB->AtmosphereHeight = m_AtmosphereHeight; // [m]
 	atmosCB->TopRadius = atmosCB->PlanetRadius + atmosCB->AtmosphereHeight;
 	atmosCB->TW = 256.0f;	// Transmittance W
 	atmosCB->TH = 64.0f;	// Transmittance H
-	atmosCB->SR = 32.0f;	// Scattering R
-	atmosCB->SMU = 128.0f;	// Scattering Mu
+	atmosCB->SR = 16.0f;	// Scattering R
+	atmosCB->SMU = 64.0f;	// Scattering Mu
 	atmosCB->SMUS = 32.0f;	// Scattering MuS
 	atmosCB->SNU = 8.0f;	// Scattering Nu
+	atmosCB->LutMapping = ATMOS_LUT_MAPPING_BRUNETON;
 
-	// SRV table (t0=Transmittance, t1=Scattering, t2=Irradiance)
+	// Per-frame sky-view LUT. 카메라/태양은 LUT를 만든 값으로 덮어쓴다
+	// 이번 프레임에 갱신이 없었으면 마지막으로 갱신한 context의 텍스처를 그대로 쓴다 (같은 큐라 읽기 순서는 보장됨)
+	TextureHandle* pSkyViewTex = nullptr;
+	TextureHandle* pAerialTex = nullptr;
+	if (m_SkyViewContextIndex >= 0)
+	{
+		pSkyViewTex = m_pSkyViewTex[m_SkyViewContextIndex];
+		pAerialTex = m_pAerialTex[m_SkyViewContextIndex];
+		for (TextureHandle* pTexHandle : { pSkyViewTex, pAerialTex })
+		{
+			if (pTexHandle && pTexHandle->bUpdated)
+			{
+				D3DUtil::UpdateTexture(pDevice, pCommandList, pTexHandle->pTexResource, pTexHandle->pUploadBuffer);
+				pTexHandle->bUpdated = false;
+			}
+		}
+		atmosCB->CameraPosPlanetCoord = m_SkyViewCameraPos;
+		atmosCB->SunDir = m_SkyViewSunDir;
+	}
+	atmosCB->UseSkyView = pSkyViewTex ? 1 : 0;
+	atmosCB->SkyViewCameraRadius = m_SkyViewCameraRadius;
+	atmosCB->SkyViewSunZenithCos = m_SkyViewSunZenithCos;
+	atmosCB->AerialMaxDistance = m_AerialMaxDistance;
+	atmosCB->SkyViewW = atmosCB->SkyViewH = 0.0f;
+	atmosCB->AerialW = atmosCB->AerialH = atmosCB->AerialD = 0.0f;
+	if (pSkyViewTex)
+	{
+		D3D12_RESOURCE_DESC desc = pSkyViewTex->pTexResource->GetDesc();
+		atmosCB->SkyViewW = (float)desc.Width;
+		atmosCB->SkyViewH = (float)desc.Height;
+	}
+	if (pAerialTex)
+	{
+		D3D12_RESOURCE_DESC desc = pAerialTex->pTexResource->GetDesc();
+		atmosCB->AerialW = (float)desc.Width;
+		atmosCB->AerialH = (float)desc.Height;
+		atmosCB->AerialD = (float)desc.DepthOrArraySize;
+	}
+
+	// SRV table (t0=Transmittance, t1=Scattering, t2=Irradiance, t3=SkyView, t4=AerialPerspective)
 	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDescriptorTable = {};
 	CD3DX12_GPU_DESCRIPTOR_HANDLE gpuDescriptorTable = {};
 	ID3D12DescriptorHeap* pSRVDescriptorHeap = pDescriptorPool->GetDescriptorHeap();
-	const uint requiredSrvCount = 3; // Transmittance, Scattering, Irradiance
+	const uint requiredSrvCount = 3 + (pSkyViewTex ? 1 : 0) + (pAerialTex ? 1 : 0);
 	bool bOk = pDescriptorPool->AllocDescriptorTable(&cpuDescriptorTable, &gpuDescriptorTable, requiredSrvCount);
 	ASSERT(bOk, "Sky: Failed to allocate descriptor table for LUTs.");
 
-	// Copy 3 LUT SRVs to the descriptor table
+	// Copy LUT SRVs to the descriptor table
 	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuCurr = cpuDescriptorTable;
 	pDevice->CopyDescriptorsSimple(1, cpuCurr, m_pTransmittanceTex->SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	cpuCurr.Offset(1, srvDescriptorSize);
 	pDevice->CopyDescriptorsSimple(1, cpuCurr, m_pScatteringTex->SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	cpuCurr.Offset(1, srvDescriptorSize);
 	pDevice->CopyDescriptorsSimple(1, cpuCurr, m_pIrradianceTex->SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	if (pSkyViewTex)
+	{
+		cpuCurr.Offset(1, srvDescriptorSize);
+		pDevice->CopyDescriptorsSimple(1, cpuCurr, pSkyViewTex->SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
+	if (pAerialTex)
+	{
+		cpuCurr.Offset(1, srvDescriptorSize);
+		pDevice->CopyDescriptorsSimple(1, cpuCurr, pAerialTex->SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
 
 	// ---- RS/PSO/IA
 	pCommandList->SetGraphicsRootSignature(pRootSigatureManager->Query(ERootSignatureType::GraphicsDefault));
@@ -208,12 +268,98 @@ void SkyObject::Draw(int threadIndex, ID3D12GraphicsCommandList6* pCommandList)
 	pCommandList->SetGraphicsRootConstantBufferView(/*slot b0*/0, cb0->pGPUMemAddr);
 	pCommandList->SetGraphicsRootConstantBufferView(/*slot b1*/1, cb1->pGPUMemAddr);
 
-	// --- SRV (t0, t1, t2)
+	// --- SRV (t0 ~ t4)
 	pCommandList->SetGraphicsRootDescriptorTable(2, gpuDescriptorTable);
 
 	pCommandList->DrawInstanced(4, 1, 0, 0);
 }
 
+void SkyObject::UpdateSkyView(const AtmosSkyViewParams& params, const AtmosSkyViewResult& result)
+{
+	const int contextIndex = m_pRenderer->GetCurrContextIndex();
+
+	if (!result.SkyViewRGBA || !ensureDynamicLUT(&m_pSkyViewTex[contextIndex], result.SkyViewW, result.SkyViewH, 1))
+	{
+		m_SkyViewContextIndex = -1;
+		return;
+	}
+	uploadDynamicLUT(m_pSkyViewTex[contextIndex], result.SkyViewRGBA, result.SkyViewW, result.SkyViewH, 1);
+
+	// slice가 하나면 2D 텍스처가 되므로 볼륨은 2장 이상일 때만 쓴다
+	if (result.AerialRGBA && result.AerialD > 1 && ensureDynamicLUT(&m_pAerialTex[contextIndex], result.AerialW, result.AerialH, result.AerialD))
+	{
+		uploadDynamicLUT(m_pAerialTex[contextIndex], result.AerialRGBA, result.AerialW, result.AerialH, result.AerialD);
+	}
+	else
+	{
+		SAFE_CLEANUP(m_pAerialTex[contextIndex], m_pRenderer->DeleteTexture);
+	}
+
+	m_SkyViewContextIndex = contextIndex;
+	m_SkyViewCameraPos = params.CameraPosPlanetCoord;
+	m_SkyViewSunDir = params.SunDir;
+	m_SkyViewCameraRadius = result.CameraRadius;
+	m_SkyViewSunZenithCos = result.SunZenithCos;
+	m_AerialMaxDistance = result.AerialMaxDistance;
+}
+
+void SkyObject::SetAtmosParams(const AtmosParams& params)
+{
+	m_PlanetRadius = params.PlanetRadius;
+	m_AtmosphereHeight = params.AtmosphereHeight;
+}
+
+bool SkyObject::ensureDynamicLUT(TextureHandle** ppTexHandle, uint width, uint height, uint depth)
+{
+	if (*ppTexHandle)
+	{
+		D3D12_RESOURCE_DESC desc = (*ppTexHandle)->pTexResource->GetDesc();
+		if (desc.Width == width && desc.Height == height && desc.DepthOrArraySize == depth)
+		{
+			return true;
+		}
+		// 해상도가 바뀌면 다시 만든다 (DeleteTexture가 GPU 완료를 기다리므로 자주 바꾸지 말 것)
+		m_pRenderer->DeleteTexture(*ppTexHandle);
+		*ppTexHandle = nullptr;
+	}
+	*ppTexHandle = m_pRenderer->GetTextureManager()->CreateDynamicTexture(width, height, DXGI_FORMAT_R32G32B32A32_FLOAT, depth);
+	return *ppTexHandle != nullptr;
+}
+
+void SkyObject::uploadDynamicLUT(TextureHandle* pTexHandle, const float* pSrcRGBA, uint width, uint height, uint depth)
+{
+	ID3D12Device5* pDevice = m_pRenderer->GetD3DDevice();
+	D3D12_RESOURCE_DESC desc = pTexHandle->pTexResource->GetDesc();
+
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	uint rows = 0;
+	uint64_t rowSize = 0;
+	uint64_t totalBytes = 0;
+	pDevice->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, &rows, &rowSize, &totalBytes);
+
+	uint8_t* pMappedPtr = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	HRESULT hr = pTexHandle->pUploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pMappedPtr));
+	ASSERT(SUCCEEDED(hr), "Sky: Failed to map the upload buffer.");
+
+	// RowPitch 정렬된 행 단위 복사. 3D는 slice마다 RowPitch * rows
+	const size_t srcRowSize = (size_t)width * 4 * sizeof(float);
+	const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(pSrcRGBA);
+	for (uint z = 0; z < depth; z++)
+	{
+		uint8_t* pDest = pMappedPtr + footprint.Offset + (size_t)z * footprint.Footprint.RowPitch * rows;
+		for (uint y = 0; y < height; y++)
+		{
+			memcpy(pDest, pSrc, srcRowSize);
+			pSrc += srcRowSize;
+			pDest += footprint.Footprint.RowPitch;
+		}
+	}
+	pTexHandle->pUploadBuffer->Unmap(0, nullptr);
+
+	pTexHandle->bUpdated = true;
+}
+
 bool SkyObject::initPipelineState()
 {
 	HRESULT hr = S_OK;
@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include "ConstantBuffer.h"
 
+struct AtmosParams;
+struct AtmosSkyViewParams;
+struct AtmosSkyViewResult;
 struct PSOHandle;
 class D3D12Renderer;
 
@@ -11,11 +14,20 @@ public:
 	void Cleanup();
 	void Draw(int threadIndex, ID3D12GraphicsCommandList6* pCommandList);
 
+	// 매 프레임 스카이뷰 LUT / aerial perspective 볼륨 갱신 (BeginRender 전에 호출)
+	// 이후 Draw는 사전계산 LUT 대신 스카이뷰 LUT를 샘플링하고, 카메라 위치/태양 방향도 params 값을 쓴다
+	void UpdateSkyView(const AtmosSkyViewParams& params, const AtmosSkyViewResult& result);
+
+	// 셰이더가 쓰는 행성/대기 반지름. 스카이뷰 컨텍스트를 만든 AtmosParams와 같은 값을 넘긴다
+	void SetAtmosParams(const AtmosParams& params);
+
 	SkyObject() = default;
 	~SkyObject() { Cleanup(); };
 
 private:
 	bool initPipelineState();
+	bool ensureDynamicLUT(TextureHandle** ppTexHandle, uint width, uint height, uint depth);
+	void uploadDynamicLUT(TextureHandle* pTexHandle, const float* pSrcRGBA, uint width, uint height, uint depth);
 
 private:
 	D3D12Renderer* m_pRenderer = nullptr;
@@ -29,4 +41,18 @@ private:
 	TextureHandle* m_pTransmittanceTex = nullptr;
 	TextureHandle* m_pScatteringTex = nullptr;
 	TextureHandle* m_pIrradianceTex = nullptr;
+
+	// 스카이뷰 LUT (t3) / aerial perspective (t4). upload buffer를 GPU가 읽는 동안 덮어쓰지 않도록 frame context마다 하나씩
+	TextureHandle* m_pSkyViewTex[MAX_PENDING_FRAME_COUNT] = {};
+	TextureHandle* m_pAerialTex[MAX_PENDING_FRAME_COUNT] = {};
+	int m_SkyViewContextIndex = -1;		// 마지막으로 갱신한 context (-1 = 스카이뷰 미사용)
+	FLOAT3 m_SkyViewCameraPos = {};
+	FLOAT3 m_SkyViewSunDir = {};
+	float m_SkyViewCameraRadius = 0.0f;
+	float m_SkyViewSunZenithCos = 0.0f;
+	float m_AerialMaxDistance = 0.0f;
+
+	// SetAtmosParams 전에는 Resources/Atmos의 사전계산 LUT를 구운 지구 값
+	float m_PlanetRadius = 6'360'000.0f;	// [m]
+	float m_AtmosphereHeight = 60'000.0f;	// [m]
 };
\ No newline at end of file
@@ -326,7 +326,7 @@ bool SpriteObject::initMesh()
 		return false;
 	}
 
-	if (FAILED(pResourceManager->CreateIndexBuffer((DWORD)_countof(indices), &m_IndexBufferView, &m_pIndexBuffer, indices, bUseGpuUploadHeaps)))
+	if (FAILED(pResourceManager->CreateIndexBuffer((DWORD)_countof(indices), DXGI_FORMAT_R16_UINT, &m_IndexBufferView, &m_pIndexBuffer, indices, bUseGpuUploadHeaps)))
 	{
 		ASSERT(false, "Failed to create index buffer");
 		return false;
@@ -97,7 +97,7 @@ TextureHandle* TextureManager::CreateTextureFromFile(const WCHAR* wchFileName)
 	return pOutTexHandle;
 }
 
-TextureHandle* TextureManager::CreateDynamicTexture(uint texWidth, uint texHeight)
+TextureHandle* TextureManager::CreateDynamicTexture(uint texWidth, uint texHeight, DXGI_FORMAT texFormat, uint texDepth)
 {
 	ID3D12Device* pD3DDevice = m_pRenderer->GetD3DDevice();
 	SingleDescriptorAllocator* pSingleDescriptorAllocator = m_pRenderer->GetSingleDescriptorAllocator();
@@ -107,15 +107,21 @@ TextureHandle* TextureManager::CreateDynamicTexture(uint texWidth, uint texHeigh
 	ID3D12Resource* pUploadBuffer = nullptr;
 	D3D12_CPU_DESCRIPTOR_HANDLE srv = {};
 
-	DXGI_FORMAT texFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
-
-	if (m_pResourceManager->CreateTexturePair(&pTexResource, &pUploadBuffer, texWidth, texHeight, texFormat))
+	if (m_pResourceManager->CreateTexturePair(&pTexResource, &pUploadBuffer, texWidth, texHeight, texFormat, texDepth))
 	{
 		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 		srvDesc.Format = texFormat;
 		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MipLevels = 1;
+		if (texDepth > 1)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+			srvDesc.Texture3D.MipLevels = 1;
+		}
+		else
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MipLevels = 1;
+		}
 
 		if (pSingleDescriptorAllocator->AllocDescriptorHandle(&srv))
 		{
@@ -125,6 +131,7 @@ TextureHandle* TextureManager::CreateDynamicTexture(uint texWidth, uint texHeigh
 			pTexHandle->pTexResource = pTexResource;
 			pTexHandle->pUploadBuffer = pUploadBuffer;
 			pTexHandle->SRV = srv;
+			pTexHandle->Dimension = srvDesc.ViewDimension;
 		}
 		else
 		{
@@ -11,7 +11,7 @@ public:
 
 	bool Initialize(D3D12Renderer* pRenderer, int numExpectedItems);
 	TextureHandle* CreateTextureFromFile(const WCHAR* wchFileName);
-	TextureHandle* CreateDynamicTexture(uint texWidth, uint texHeight);
+	TextureHandle* CreateDynamicTexture(uint texWidth, uint texHeight, DXGI_FORMAT texFormat = DXGI_FORMAT_R8G8B8A8_UNORM, uint texDepth = 1);
 	TextureHandle* CreateImmutableTexture(uint texWidth, uint texHeight, DXGI_FORMAT format, const uint8_t* pInitImage);
 	void DeleteTexture(TextureHandle* pTexHandle);
 	void Cleanup();
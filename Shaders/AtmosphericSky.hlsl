@@ -2,17 +2,26 @@
 // Atmospheric Sky - SampleSky (Precomputed Single Scattering)
 // Author: you & gpt
 // Assumptions:
-//  - Transmittance 2D: r∈[Rg,Rt], mu∈[-1,1], uniform texel-center mapping
+//  - Texel mapping: g_LutMapping, mirrors Common/AtmosLutMapping.h (uniform or Bruneton 2017)
+//  - Transmittance 2D: x = mu, y = r
 //  - Scattering 3D (packed): dims = (SNU*SMUS, SMU, SR)
+//      compact single-scattering layout (ATMOS_SCATTERING_LAYOUT_R_MU_MUS) is SNU = 1
 //      value = float4(RayleighRGB, MieScalar)
 //      includes view-path transmittance (no phase applied)
+//      RayleighRGB also carries multiple scattering divided by RayleighPhase(nu)
 //  - All textures are LINEAR (no sRGB sampling)
+//  - g_UseSkyView: per-frame sky-view LUT (t3) replaces the scattering LUT, mapping mirrors AtmosSkyViewMapping
+//      value = float4(RGB radiance with phase and solar irradiance applied, 1)
+//    aerial perspective (t4): camera-centered froxels, xy = sky-view mapping, z = quadratic distance slices
+//      value = float4(in-scattered RGB from the camera to the slice end, mean transmittance)
 // ==========================================================
 
 // ---------- Resources ----------
 Texture2D<float3> g_TransmittanceLUT : register(t0); // R^3
 Texture3D<float4> g_ScatteringLUT : register(t1); // RGBA
 Texture2D<float3> g_IrradianceLUT : register(t2); // optional
+Texture2D<float4> g_SkyViewLUT : register(t3); // bound only when g_UseSkyView != 0
+Texture3D<float4> g_AerialPerspectiveLUT : register(t4); // bound only when g_AerialD > 0
 SamplerState g_LinearClamp : register(s1);
 
 // ---------- Constants ----------
@@ -31,8 +40,6 @@ cbuffer PerFrame : register(b0)
     float _pad0;
     float3 g_LightColor; // Light color
     float _pad1;
-    float3 g_Ambient; // Ambient light color
-    float _pad2;
 };
 
 cbuffer AtmosConstants : register(b1)
@@ -64,6 +71,20 @@ cbuffer AtmosConstants : register(b1)
     float g_SMU;
     float g_SMUS;
     float g_SNU;
+    
+    uint g_LutMapping; // EAtmosLutMapping (0 = uniform, 1 = Bruneton)
+    uint g_UseSkyView; // 1: sample the per-frame sky-view LUT
+    
+    // Per-frame sky-view / aerial perspective
+    float g_SkyViewCameraRadius; // camera radius the LUTs were built for
+    float g_SkyViewSunZenithCos;
+    float g_AerialMaxDistance; // [m], end of the last slice
+    float g_AerialD; // slice count (0 = none)
+    
+    float g_SkyViewW;
+    float g_SkyViewH;
+    float g_AerialW;
+    float g_AerialH;
 }
 
 // ==========================================================
@@ -128,45 +149,204 @@ float3 Tonemap_ACES(float3 x)
 }
 
 // ==========================================================
-// LUT mapping (uniform with texel centers)
-//  - Transmittance: (mu ∈ [-1,1], r ∈ [Rg,Rt])  -> (u,v)
-//  - Scattering 3D packed dims: X = SNU * SMUS, Y = SMU, Z = SR
-//    Input params: r, mu, muS, nu
+// LUT mapping (mirrors Common/AtmosLutMapping.h)
+//  - Texel coordinates are continuous indices in [0, n - 1]; integers are texel centers.
+//    Uniform: texel i at x = (i + 0.5) / n, Bruneton: texel i at x = i / (n - 1)
+//  - Scattering 3D packed dims: X = SNU * SMUS (nu minor), Y = SMU, Z = SR
 // ==========================================================
 
-// map to texel-center UV in [0,1]
-float2 GetMapTransmittanceUV(float r, float mu)
+static const uint ATMOS_LUT_MAPPING_BRUNETON = 1;
+static const float ATMOS_LUT_MU_S_MIN = -0.2;
+
+float UnitToTexel(float x, float n)
+{
+    float c = (g_LutMapping == ATMOS_LUT_MAPPING_BRUNETON) ? x * (n - 1.0) : x * n - 0.5;
+    return clamp(c, 0.0, n - 1.0);
+}
+
+// Differences of squared radii are factored as in AtmosLutMapping.h: r * r - Rg * Rg cancels at km scale,
+// and the result would depend on where the compiler emits mad.
+float RhoSq(float r)
+{
+    return (r - g_PlanetRadius) * (r + g_PlanetRadius);
+}
+
+float DistanceToTop(float r, float mu)
+{
+    float rmu = r * mu;
+    float disc = rmu * rmu + (g_TopRadius - r) * (g_TopRadius + r);
+    return max(-rmu + sqrt(max(disc, 0.0)), 0.0);
+}
+
+bool RayIntersectsGround(float r, float mu)
+{
+    float rmu = r * mu;
+    return mu < 0.0 && rmu * rmu >= RhoSq(r);
+}
+
+// sqrt(Rt^2 - Rg^2), rho(r) = sqrt(r^2 - Rg^2)
+float HorizonLength()
+{
+    return sqrt((g_TopRadius - g_PlanetRadius) * (g_TopRadius + g_PlanetRadius));
+}
+
+float Rho(float r)
 {
-    // grid counts
-    float TW = g_TW;
-    float TH = g_TH;
+    return sqrt(max(RhoSq(r), 0.0));
+}
 
-    // index at texel centers
-    float iu = ((mu + 1.0) * 0.5) * (TW - 1.0);
-    float iv = ((r - g_PlanetRadius) / (g_TopRadius - g_PlanetRadius)) * (TH - 1.0);
+float ScatteringRTexel(float r, float n)
+{
+    if (g_LutMapping == ATMOS_LUT_MAPPING_BRUNETON)
+        return UnitToTexel(Rho(r) / HorizonLength(), n);
+    return UnitToTexel((r - g_PlanetRadius) / (g_TopRadius - g_PlanetRadius), n);
+}
 
-    float2 uv = (float2(iu + 0.5, iv + 0.5)) / float2(TW, TH);
-    return uv;
+// Bruneton: [0, n/2) rays hitting the ground (horizon -> down), [n/2, n) rays reaching the top (up -> horizon)
+float ScatteringMuTexel(float r, float mu, bool rayHitsGround, float n)
+{
+    if (g_LutMapping == ATMOS_LUT_MAPPING_BRUNETON)
+    {
+        float nGround = floor(n * 0.5);
+        float nSky = n - nGround;
+        float H = HorizonLength();
+        float rho = Rho(r);
+        float rmu = r * mu;
+        float disc = rmu * rmu - RhoSq(r);
+        if (rayHitsGround)
+        {
+            float d = -rmu - sqrt(max(disc, 0.0));
+            float dMin = r - g_PlanetRadius;
+            float dMax = rho;
+            float x = (dMax == dMin) ? 0.0 : saturate((d - dMin) / (dMax - dMin));
+            return (nGround - 1.0) * (1.0 - x);
+        }
+        float d = -rmu + sqrt(max(rmu * rmu + (g_TopRadius - r) * (g_TopRadius + r), 0.0));
+        float dMin = g_TopRadius - r;
+        float dMax = rho + H;
+        return nGround + (nSky - 1.0) * saturate((d - dMin) / (dMax - dMin));
+    }
+    return UnitToTexel((mu + 1.0) * 0.5, n);
 }
 
-float3 GetMapScatteringUVW(float r, float mu, float muS, float nu)
+float ScatteringMuSTexel(float muS, float n)
+{
+    if (g_LutMapping == ATMOS_LUT_MAPPING_BRUNETON)
+    {
+        float H = HorizonLength();
+        float dMin = g_TopRadius - g_PlanetRadius;
+        float dMax = H;
+        float A = (DistanceToTop(g_PlanetRadius, ATMOS_LUT_MU_S_MIN) - dMin) / (dMax - dMin);
+        float a = (DistanceToTop(g_PlanetRadius, muS) - dMin) / (dMax - dMin);
+        return UnitToTexel(max(1.0 - a / A, 0.0) / (1.0 + a), n);
+    }
+    return UnitToTexel((muS + 1.0) * 0.5, n);
+}
+
+float2 GetMapTransmittanceUV(float r, float mu)
+{
+    float2 c;
+    if (g_LutMapping == ATMOS_LUT_MAPPING_BRUNETON)
+    {
+        float H = HorizonLength();
+        float rho = Rho(r);
+        float dMin = g_TopRadius - r;
+        float dMax = rho + H;
+        c = float2(UnitToTexel((DistanceToTop(r, mu) - dMin) / (dMax - dMin), g_TW),
+                   UnitToTexel(rho / H, g_TH));
+    }
+    else
+    {
+        c = float2(UnitToTexel((mu + 1.0) * 0.5, g_TW),
+                   UnitToTexel((r - g_PlanetRadius) / (g_TopRadius - g_PlanetRadius), g_TH));
+    }
+    return (c + 0.5) / float2(g_TW, g_TH);
+}
+
+// mu_s and nu share the X axis (X = mus * SNU + nu), so hardware filtering along X would blend
+// neighbouring mu_s blocks. Two taps at the mu_s neighbours, each filtered only within its nu block, lerped manually.
+float4 SampleScatteringLUT(float r, float mu, float muS, float nu)
 {
-    // dimensions
-    float SR = g_SR;
-    float SMU = g_SMU;
     float SMUS = g_SMUS;
     float SNU = g_SNU;
 
-    // index at texel centers (uniform bins)
-    float ix = (((muS + 1.0) * 0.5) * (SMUS - 1.0)) * SNU // mus bin
-             + (((nu + 1.0) * 0.5) * (SNU - 1.0)); // nu  bin
+    bool rayHitsGround = RayIntersectsGround(r, mu);
+    float cz = ScatteringRTexel(r, g_SR);
+    float cy = ScatteringMuTexel(r, mu, rayHitsGround, g_SMU);
+    float cmus = ScatteringMuSTexel(muS, SMUS);
+    float cnu = UnitToTexel((nu + 1.0) * 0.5, SNU);
+
+    float mus0 = floor(cmus);
+    float mus1 = min(mus0 + 1.0, SMUS - 1.0);
+    float f = cmus - mus0;
+
+    float3 dim = float3(SNU * SMUS, g_SMU, g_SR);
+    float3 uvw0 = (float3(mus0 * SNU + cnu, cy, cz) + 0.5) / dim;
+    float3 uvw1 = (float3(mus1 * SNU + cnu, cy, cz) + 0.5) / dim;
+    return lerp(g_ScatteringLUT.SampleLevel(g_LinearClamp, uvw0, 0),
+                g_ScatteringLUT.SampleLevel(g_LinearClamp, uvw1, 0), f);
+}
 
-    float iy = (((mu + 1.0) * 0.5) * (SMU - 1.0)); // mu  bin
-    float iz = (((r - g_PlanetRadius) / (g_TopRadius - g_PlanetRadius)) * (SR - 1.0)); // r bin
+// ==========================================================
+// Sky-view mapping (mirrors AtmosSkyViewMapping in Common/AtmosLutMapping.h)
+//  - v < 0.5: rays reaching the top (zenith -> horizon), v >= 0.5: rays hitting the ground (horizon -> nadir)
+//    both halves are squared toward the horizon
+//  - u: azimuth from the sun, lightViewCos = 1 - 2u^2
+//  - Unit coordinates map to texels as i / (n - 1)
+// ==========================================================
 
-    float3 dim = float3(SNU * SMUS, SMU, SR);
-    float3 uvw = (float3(ix + 0.5, iy + 0.5, iz + 0.5)) / dim;
-    return uvw;
+float2 SkyViewParamsToUnit(float r, float mu, float lightViewCos, bool rayHitsGround)
+{
+    float rr = max(r, g_PlanetRadius);
+    float beta = acos(clamp(sqrt(RhoSq(rr)) / rr, -1.0, 1.0));
+    float zenithHorizonAngle = PI - beta;
+    float zenith = acos(clamp(mu, -1.0, 1.0));
+
+    float v;
+    if (!rayHitsGround)
+        v = 0.5 * (1.0 - sqrt(1.0 - saturate(zenith / zenithHorizonAngle)));
+    else
+        v = 0.5 + 0.5 * sqrt(saturate((zenith - zenithHorizonAngle) / beta));
+    float u = sqrt(saturate(0.5 - 0.5 * lightViewCos));
+    return float2(u, v);
+}
+
+// View direction -> sky-view unit coordinates. The azimuth is measured on the local horizontal plane from the sun.
+float2 SkyViewUnitFromDir(float3 viewDir, float3 sunDir, float3 up)
+{
+    float r = g_SkyViewCameraRadius;
+    float mu = dot(viewDir, up);
+    float3 viewH = viewDir - mu * up;
+    float3 sunH = sunDir - dot(sunDir, up) * up;
+    float lenV = length(viewH);
+    float lenS = length(sunH);
+    float lightViewCos = (lenV > 1e-5 && lenS > 1e-5) ? dot(viewH, sunH) / (lenV * lenS) : 1.0;
+    return SkyViewParamsToUnit(r, mu, lightViewCos, RayIntersectsGround(r, mu));
+}
+
+float3 SampleSkyViewLUT(float3 viewDir, float3 sunDir, float3 up)
+{
+    float2 dim = float2(g_SkyViewW, g_SkyViewH);
+    float2 uv = (SkyViewUnitFromDir(viewDir, sunDir, up) * (dim - 1.0) + 0.5) / dim;
+    return g_SkyViewLUT.SampleLevel(g_LinearClamp, uv, 0).rgb;
+}
+
+// Aerial perspective toward viewDir at distance [m]: rgb = in-scattered radiance, a = transmittance.
+// Slice k ends at max * ((k + 1) / D)^2; distances before the first slice end fade in from (0, 1).
+// Not used by the sky pass itself; shared with passes that shade geometry.
+float4 SampleAerialPerspective(float3 viewDir, float3 sunDir, float3 up, float dist)
+{
+    if (g_AerialD <= 0.0)
+        return float4(0.0, 0.0, 0.0, 1.0);
+
+    float slice = g_AerialD * sqrt(saturate(dist / g_AerialMaxDistance)) - 1.0;
+    float weight = saturate(slice + 1.0);
+
+    float2 dim = float2(g_AerialW, g_AerialH);
+    float2 uv = (SkyViewUnitFromDir(viewDir, sunDir, up) * (dim - 1.0) + 0.5) / dim;
+    float w = (max(slice, 0.0) + 0.5) / g_AerialD;
+    float4 ap = g_AerialPerspectiveLUT.SampleLevel(g_LinearClamp, float3(uv, w), 0);
+    return float4(ap.rgb * weight, lerp(1.0, ap.a, weight));
 }
 
 // ==========================================================
@@ -182,6 +362,13 @@ float3 SampleSky(float3 viewDirWorld)
     float r = length(g_CameraPosPlanetCoord); // camera radius
     float3 up = GetUp(g_CameraPosPlanetCoord); // local up
 
+    if (g_UseSkyView != 0)
+    {
+        // Phase functions and solar irradiance are already in the sky-view LUT
+        float3 Lsv = SampleSkyViewLUT(viewDir, sunDir, up);
+        return Lsv * g_SunIrradiance * g_SunExposure;
+    }
+
     // Direction cosines
     float mu = dot(viewDir, up); // angle between view and local up
     float muS = dot(sunDir, up); // angle between sun and local up
@@ -194,14 +381,13 @@ float3 SampleSky(float3 viewDirWorld)
     nu = clamp(nu, -1.0, 1.0);
 
     // --- Sample scattering LUT (RayleighRGB, MieScalar) ---
-    float3 uvw = GetMapScatteringUVW(r, mu, muS, nu);
-    float4 scat = g_ScatteringLUT.Sample(g_LinearClamp, uvw);
+    float4 scat = SampleScatteringLUT(r, mu, muS, nu);
 
     // --- Phase functions (your LUT excludes phase) ---
-    // NOTE: S is "sun -> ground". For usual phase angle θ between "light direction" and -V,
-    // cosθ = dot(-S, V) = -dot(S, V) = -nu. If your definition wants cosθ = dot(V, -S),
-    // it's the same value (-nu). We'll use cosθ = -nu below.
-    float cosTheta = -nu;
+    // NOTE: θ is the angle between the light's travel direction (g_SunDir = -sunDir) and the
+    // direction scattered toward the camera (-V): cosθ = dot(-sunDir, -V) = nu.
+    // Forward (Mie) scattering therefore peaks when looking at the sun, as in the bake and the sky-view LUT.
+    float cosTheta = nu;
 
     float PR = RayleighPhase(cosTheta);
     float PM = HenyeyGreenstein(cosTheta, g_MieG);
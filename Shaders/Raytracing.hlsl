@@ -94,8 +94,7 @@ void MyClosestHitShader_RadianceRay(inout RadiancePayload rayPayload, in BuiltIn
     uint instanceID = InstanceID(); // The instance ID as specified in the instance desc.
     uint systemInstanceIndex = InstanceIndex(); // The autogenerated index of the current instance in the top-level structure.
     
-    uint baseIndex = PrimitiveIndex() * g_TriangleIndexStride; // The base index of the hit triangle's first 16 bit index.
-    uint3 indices = Load3x16BitIndices(baseIndex);
+    uint3 indices = LoadTriangleIndices(PrimitiveIndex());
     
     // Get vertex attributes.
     float2 vertexUV[3] =
@@ -18,6 +18,11 @@ StructuredBuffer<Vertex> l_Vertices : register(t0, space1);
 ByteAddressBuffer l_Indices : register(t1, space1);
 Texture2D<float4> l_DiffuseTexture : register(t2, space1);
 
+cbuffer LOCAL_CONSTANTS : register(b0, space1)
+{
+    uint l_IndexSizeInBytes; // 2 (R16_UINT) or 4 (R32_UINT), chosen per tri-group
+};
+
 cbuffer CONSTANT_BUFFER_PER_FRAME : register(b0)
 {
     matrix g_View;
@@ -31,12 +36,13 @@ cbuffer CONSTANT_BUFFER_PER_FRAME : register(b0)
     float _pad0;
     float3 g_LightColor; // Light color
     float _pad1;
-    float3 g_Ambient; // Ambient light color
-    float _pad2;
     
     float g_Near;
     float g_Far;
     uint g_MaxRadianceRayRecursionDepth;
+    uint _pad2;
+    
+    float4 g_AmbientSH[9]; // Ambient irradiance L2 SH (AtmosSkySH order), rgb = coefficient
 };
 
 // Interpolate vertex attribute using barycentric coordinates.
@@ -99,5 +105,16 @@ static uint3 Load3x16BitIndices(uint offsetBytes)
     return indices;
 }
 
+// Load the three indices of a triangle from a 16 or 32 bit index buffer.
+static uint3 LoadTriangleIndices(uint primitiveIndex)
+{
+    const uint offsetBytes = primitiveIndex * g_IndicesPerTriangle * l_IndexSizeInBytes;
+    if (l_IndexSizeInBytes == 4)
+    {
+        return l_Indices.Load3(offsetBytes);
+    }
+    return Load3x16BitIndices(offsetBytes);
+}
+
 
 #endif // RAYTRACING_COMMON_HLSL
@@ -9,9 +9,7 @@
 
 #define HitDistanceOnMiss 0
 
-static const uint g_IndexSizeInBytes = 2;
 static const uint g_IndicesPerTriangle = 3;
-static const uint g_TriangleIndexStride = g_IndicesPerTriangle * g_IndexSizeInBytes;
 
 
 struct Vertex
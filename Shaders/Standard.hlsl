@@ -13,12 +13,13 @@ cbuffer CONSTANT_BUFFER_PER_FRAME : register(b0)
     float _pad0;
     float3 g_LightColor; // Light color
     float _pad1;
-    float3 g_Ambient; // Ambient light color
-    float _pad2;
     
     float g_Near;
     float g_Far;
     uint g_MaxRadianceRayRecursionDepth;
+    uint _pad2;
+    
+    float4 g_AmbientSH[9]; // Ambient irradiance L2 SH (AtmosSkySH order), rgb = coefficient
 };
 
 cbuffer CONSTANT_BUFFER_PER_OBJECT : register(b1)
@@ -71,14 +72,30 @@ PSInput VSMain(VSInput input)
     return vsout;
 }
 
+// Irradiance from the cosine-convolved L2 SH (basis order Y00, Y1-1, Y10, Y11, Y2-2, Y2-1, Y20, Y21, Y22)
+float3 EvalAmbientSH(float3 n)
+{
+    float3 e = g_AmbientSH[0].rgb * 0.282095;
+    e += g_AmbientSH[1].rgb * (0.488603 * n.y);
+    e += g_AmbientSH[2].rgb * (0.488603 * n.z);
+    e += g_AmbientSH[3].rgb * (0.488603 * n.x);
+    e += g_AmbientSH[4].rgb * (1.092548 * n.x * n.y);
+    e += g_AmbientSH[5].rgb * (1.092548 * n.y * n.z);
+    e += g_AmbientSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0));
+    e += g_AmbientSH[7].rgb * (1.092548 * n.x * n.z);
+    e += g_AmbientSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(e, 0.0); // L2 ringing can dip below zero on the dark side
+}
+
 float4 PSMain(PSInput input) : SV_TARGET
 {
     float4 texColor = texDiffuse.Sample(g_SamplerWrap, input.TexCoord);
 
     // Diffuse lighting (Lambert)
-    float NdotL = saturate(dot(normalize(input.Normal), -normalize(g_LightDir)));
+    float3 N = normalize(input.Normal);
+    float NdotL = saturate(dot(N, -normalize(g_LightDir)));
     float3 diffuse = g_LightColor * NdotL;
-    float3 ambient = g_Ambient;
+    float3 ambient = EvalAmbientSH(N);
 
     float3 finalColor = texColor.rgb * (diffuse + ambient);
 